@@ -0,0 +1,14 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-build-repo/Module.h>
+
+// [ply module="ArenaBenchmark"]
+void module_ArenaBenchmark(ModuleArgs* args) {
+    args->buildTarget->targetType = BuildTargetType::EXE;
+    args->addSourceFiles(".", false);
+    args->addIncludeDir(Visibility::Private, ".");
+    args->addTarget(Visibility::Private, "cpp");
+    args->addTarget(Visibility::Private, "pylon");
+}
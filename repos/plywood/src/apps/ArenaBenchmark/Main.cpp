@@ -0,0 +1,124 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-cpp/Parser.h>
+#include <ply-cpp/PPVisitedFiles.h>
+#include <pylon/Parse.h>
+
+// Measures short-lived parsing phases with and without a ScopedArena. Every header in the runtime
+// module is parsed the way plytool parses it, and a generated pylon file is parsed into a Node tree
+// by pylon::Parser. Each result is destroyed before the next parse begins. With an arena, every
+// allocation made by the parse comes from the Arena, and the Arena is rewound after each parse.
+//
+// Usage: ArenaBenchmark [numPasses]
+
+namespace ply {
+namespace cpp {
+void parsePlywoodSrcFile(StringView absSrcPath, cpp::PPVisitedFiles* visitedFiles,
+                         ParseSupervisor* visor);
+} // namespace cpp
+} // namespace ply
+
+using namespace ply;
+
+static constexpr u32 PylonFileSize = 16 * 1024 * 1024;
+
+struct CountingSupervisor : cpp::ParseSupervisor {
+    u32 numDeclarations = 0;
+
+    virtual void onGotDeclaration(const cpp::grammar::Declaration&) override {
+        this->numDeclarations++;
+    }
+    virtual bool handleError(Owned<cpp::BaseError>&&) override {
+        return true;
+    }
+};
+
+Array<String> findRuntimeHeaders() {
+    Array<String> paths;
+    String runtimeFolder = NativePath::join(PLY_WORKSPACE_FOLDER, "repos/plywood/src/runtime");
+    for (const WalkTriple& triple : FileSystem::native()->walk(runtimeFolder, 0)) {
+        for (const WalkTriple::FileInfo& file : triple.files) {
+            if (file.name.endsWith(".h")) {
+                paths.append(NativePath::join(triple.dirPath, file.name));
+            }
+        }
+    }
+    return paths;
+}
+
+String generatePylonSource() {
+    MemOutStream mout;
+    mout << "{\n  records: [\n";
+    for (u32 i = 0; mout.getSeekPos() < PylonFileSize; i++) {
+        mout.format("    {{\n      name: \"record {}\"\n      id: {}\n", i, i);
+        mout.format("      pos: [{}, {}, {}]\n", i * 0.25f, i * -0.5f, (i % 1000) * 0.125f);
+        mout.format("      tags: [{}, {}, {}, {}]\n", i % 7, i % 11, i % 13, i % 17);
+        mout << "    }\n";
+    }
+    mout << "  ]\n}\n";
+    return mout.moveToString();
+}
+
+// Returns the time taken to call body() numPasses times, each time in a new ScopedArena. When
+// arena is null, body() allocates from the heap.
+template <typename Body>
+float timePasses(u32 numPasses, Arena* arena, const Body& body) {
+    CPUTimer::Point start = CPUTimer::get();
+    for (u32 i = 0; i < numPasses; i++) {
+        ScopedArena scope{arena};
+        body();
+    }
+    return CPUTimer::Converter{}.toSeconds(CPUTimer::get() - start);
+}
+
+int main(int argc, char* argv[]) {
+    u32 numPasses = 5;
+    if (argc > 1) {
+        numPasses = max<u32>(StringView{argv[1]}.to<u32>(), 1);
+    }
+    OutStream outs = StdOut::text();
+    Arena arena;
+
+    Array<String> cppPaths = findRuntimeHeaders();
+    u32 numDeclarations = 0;
+    auto parseCpp = [&] {
+        for (StringView path : cppPaths) {
+            cpp::PPVisitedFiles visitedFiles;
+            CountingSupervisor visor;
+            cpp::parsePlywoodSrcFile(path, &visitedFiles, &visor);
+            numDeclarations += visor.numDeclarations;
+        }
+    };
+    float cppHeap = timePasses(numPasses, nullptr, parseCpp);
+    ureg cppArenaBytes = 0;
+    float cppArena = timePasses(numPasses, &arena, [&] {
+        parseCpp();
+        cppArenaBytes = max(cppArenaBytes, arena.getUsedBytes());
+    });
+    outs.format("C++ parser, {} files, {} declarations per pass:\n", cppPaths.numItems(),
+                numDeclarations / (numPasses * 2));
+    outs.format("    heap {} ms, arena {} ms ({} KB used)\n", cppHeap * 1000 / numPasses,
+                cppArena * 1000 / numPasses, cppArenaBytes / 1024);
+
+    String pylonSource = generatePylonSource();
+    u32 numRecords = 0;
+    auto parsePylon = [&] {
+        pylon::Parser parser;
+        Owned<pylon::Node> root = parser.parse(pylonSource).root;
+        numRecords += root->get("records")->arrayView().numItems;
+    };
+    float pylonHeap = timePasses(numPasses, nullptr, parsePylon);
+    ureg pylonArenaBytes = 0;
+    float pylonArena = timePasses(numPasses, &arena, [&] {
+        parsePylon();
+        pylonArenaBytes = max(pylonArenaBytes, arena.getUsedBytes());
+    });
+    outs.format("pylon::Parser, {} bytes, {} records per pass:\n", pylonSource.numBytes,
+                numRecords / (numPasses * 2));
+    outs.format("    heap {} ms, arena {} ms ({} KB used)\n", pylonHeap * 1000 / numPasses,
+                pylonArena * 1000 / numPasses, pylonArenaBytes / 1024);
+    return 0;
+}
@@ -0,0 +1,13 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-build-repo/Module.h>
+
+// [ply module="ConcurrentMapBenchmark"]
+void module_ConcurrentMapBenchmark(ModuleArgs* args) {
+    args->buildTarget->targetType = BuildTargetType::EXE;
+    args->addSourceFiles(".", false);
+    args->addIncludeDir(Visibility::Private, ".");
+    args->addTarget(Visibility::Private, "runtime");
+}
@@ -0,0 +1,162 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/container/ConcurrentMap.h>
+#include <ply-runtime/thread/Affinity.h>
+#include <ply-runtime/thread/RWLock.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-runtime/algorithm/Random.h>
+
+// Measures how the throughput of a shared map scales from 1 to N threads. Every thread performs a
+// mix of lookups and assignments on random keys, as a shared cache would. ConcurrentMap is compared
+// against a HashMap protected by an RWLock.
+//
+// Usage: ConcurrentMapBenchmark [maxThreads]
+
+using namespace ply;
+
+static constexpr u32 NumKeys = 1 << 16;
+static constexpr u32 OpsPerThread = 1000000;
+static constexpr u32 WritesPer256Ops = 26; // About 10% writes
+static constexpr u32 QuiescentInterval = 256;
+// ConcurrentMap reserves the values 0 and 1, so every value stored is at least 2
+
+struct LockedMap {
+    struct Traits {
+        using Key = u32;
+        struct Item {
+            u32 key;
+            uptr value = 0;
+            PLY_INLINE Item(u32 key) : key{key} {
+            }
+        };
+        static PLY_INLINE bool match(const Item& item, u32 key) {
+            return item.key == key;
+        }
+    };
+
+    RWLock lock;
+    HashMap<Traits> map;
+
+    PLY_INLINE void beginThread() {
+    }
+    PLY_INLINE void onQuiescentState() {
+    }
+    PLY_INLINE void endThread() {
+    }
+    PLY_INLINE uptr get(u32 key) {
+        SharedLockGuard<RWLock> guard{this->lock};
+        auto cursor = this->map.find(key);
+        return cursor.wasFound() ? cursor->value : 0;
+    }
+    PLY_INLINE void assign(u32 key, uptr value) {
+        ExclusiveLockGuard<RWLock> guard{this->lock};
+        this->map.insertOrFind(key)->value = value;
+    }
+};
+
+struct LockFreeMap {
+    QSBR qsbr;
+    ConcurrentMap<u32, uptr> map{&qsbr};
+    static ThreadLocal<QSBR::Context> context;
+
+    PLY_INLINE void beginThread() {
+        context.store(this->qsbr.createContext());
+    }
+    PLY_INLINE void onQuiescentState() {
+        this->qsbr.onQuiescentState(context.load());
+    }
+    PLY_INLINE void endThread() {
+        this->qsbr.destroyContext(context.load());
+    }
+    PLY_INLINE uptr get(u32 key) {
+        return this->map.get(key);
+    }
+    PLY_INLINE void assign(u32 key, uptr value) {
+        this->map.assign(key, value);
+    }
+};
+
+ThreadLocal<QSBR::Context> LockFreeMap::context;
+
+template <typename Map>
+float runBenchmark(u32 numThreads, u64* checksum) {
+    Map map;
+    map.beginThread();
+    for (u32 key = 1; key <= NumKeys; key++) {
+        map.assign(key, key + 1);
+    }
+    map.endThread();
+
+    Atomic<u32> numReady = 0;
+    Atomic<bool> go = false;
+    Atomic<u64> sum = 0;
+    Array<Thread> threads;
+    threads.resize(numThreads);
+    for (u32 t = 0; t < numThreads; t++) {
+        threads[t].run([&, t] {
+            map.beginThread();
+            Random random{t + 1};
+            u64 localSum = 0;
+            numReady.fetchAdd(1, Relaxed);
+            while (!go.load(Acquire)) {
+            }
+            for (u32 i = 0; i < OpsPerThread; i++) {
+                u64 r = random.next64();
+                u32 key = u32(r % NumKeys) + 1;
+                if (((r >> 32) & 255) < WritesPer256Ops) {
+                    map.assign(key, uptr(r >> 40) + 2);
+                } else {
+                    localSum += map.get(key);
+                }
+                if (i % QuiescentInterval == 0) {
+                    map.onQuiescentState();
+                }
+            }
+            sum.fetchAdd(localSum, Relaxed);
+            map.endThread();
+        });
+    }
+    while (numReady.load(Acquire) < numThreads) {
+    }
+
+    CPUTimer::Converter cvt;
+    CPUTimer::Point start = CPUTimer::get();
+    go.store(true, Release);
+    for (Thread& thread : threads) {
+        thread.join();
+    }
+    CPUTimer::Point end = CPUTimer::get();
+    *checksum = sum.load(Relaxed);
+    return cvt.toSeconds(end - start);
+}
+
+int main(int argc, char* argv[]) {
+    u32 maxThreads = max<u32>(Affinity{}.getNumHWThreads(), 1);
+    if (argc > 1) {
+        maxThreads = max<u32>(StringView{argv[1]}.to<u32>(), 1);
+    }
+
+    StdOut::text().format("{} keys, {} operations per thread, {}% writes\n", NumKeys, OpsPerThread,
+                          WritesPer256Ops * 100 / 256);
+    for (u32 numThreads = 1;; numThreads = min(numThreads * 2, maxThreads)) {
+        u64 lockedChecksum = 0;
+        u64 lockFreeChecksum = 0;
+        float lockedTime = runBenchmark<LockedMap>(numThreads, &lockedChecksum);
+        float lockFreeTime = runBenchmark<LockFreeMap>(numThreads, &lockFreeChecksum);
+        float totalOps = float(numThreads) * OpsPerThread;
+        StdOut::text().format("{} threads: HashMap+RWLock {} Mops/s, ConcurrentMap {} Mops/s\n",
+                              numThreads, totalOps / lockedTime * 1e-6f,
+                              totalOps / lockFreeTime * 1e-6f);
+        // With more than one thread, the order of reads and writes isn't deterministic
+        if (numThreads == 1 && lockedChecksum != lockFreeChecksum) {
+            StdErr::text() << "Error: Maps returned different results\n";
+            return 1;
+        }
+        if (numThreads == maxThreads)
+            break;
+    }
+    return 0;
+}
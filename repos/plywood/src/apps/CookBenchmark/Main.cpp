@@ -0,0 +1,221 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-cook/CookJob.h>
+#include <ply-cook/CookCache.h>
+
+// Compares a cold cook, which cooks every job from scratch, against a warm cook that starts from a
+// DependencyTracker loaded from disk. Nothing changes between the two, so the warm cook should
+// only need to check the modification time of each source file.
+//
+// Then measures content hashing: every source file is rewritten with the same contents, which
+// recooks every job when only modification times are checked, but no jobs when contents are
+// hashed. Finally, a CookCache is filled and then used by a DependencyTracker that starts empty,
+// both from the same source folder and from a copy of it at another location.
+
+using namespace ply;
+
+static constexpr u32 NumSourceFiles = 2000;
+static constexpr u32 LinesPerFile = 200;
+
+struct CookResult_LineCount : cook::CookResult {
+    PLY_REFLECT()
+    u32 numLines = 0;
+    u32 numBytes = 0;
+    // ply reflect off
+};
+
+extern cook::CookJobType CookJobType_LineCount;
+u32 numJobsCooked = 0;
+
+String srcFolder;
+
+void LineCount_cook(cook::CookResult* cookResult_, TypedPtr) {
+    auto* result = static_cast<CookResult_LineCount*>(cookResult_);
+    numJobsCooked++;
+    Owned<InStream> ins =
+        result->openFileAsDependency(NativePath::join(srcFolder, result->job->id.desc));
+    if (!ins)
+        return;
+    String contents = ins->readRemainingContents();
+    result->numBytes = contents.numBytes;
+    for (u32 i = 0; i < contents.numBytes; i++) {
+        if (contents[i] == '\n') {
+            result->numLines++;
+        }
+    }
+}
+
+cook::CookJobType CookJobType_LineCount = {
+    "lineCount",
+    TypeResolver<CookResult_LineCount>::get(),
+    nullptr,
+    LineCount_cook,
+};
+
+// If touch is true, files are rewritten even if their contents are unchanged
+void writeSourceFiles(bool touch) {
+    for (u32 i = 0; i < NumSourceFiles; i++) {
+        MemOutStream mout;
+        for (u32 j = 0; j < LinesPerFile; j++) {
+            mout.format("// Line {} of source file {}\n", j, i);
+        }
+        String path = NativePath::join(srcFolder, String::format("file{}.txt", i));
+        if (touch) {
+            FileSystem::native()->openStreamForWrite(path)->write(mout.moveToString());
+        } else {
+            FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(path, mout.moveToString());
+        }
+    }
+}
+
+// Cooks every job and returns the elapsed time in seconds
+float cookAll(cook::DependencyTracker* depTracker, bool hashFileContents = false,
+              cook::CookCache* cache = nullptr) {
+    CPUTimer::Point start = CPUTimer::get();
+    cook::CookContext ctx;
+    ctx.depTracker = depTracker;
+    ctx.hashFileContents = hashFileContents;
+    ctx.cache = cache;
+    ctx.beginCook();
+    Array<Reference<cook::CookJob>> rootRefs;
+    for (u32 i = 0; i < NumSourceFiles; i++) {
+        rootRefs.append(ctx.cook({&CookJobType_LineCount, String::format("file{}.txt", i)}));
+    }
+    ctx.cookDeferred();
+    depTracker->setRootReferences(std::move(rootRefs));
+    ctx.endCook();
+    return CPUTimer::Converter{}.toSeconds(CPUTimer::get() - start);
+}
+
+u64 getTotalLines(cook::DependencyTracker* depTracker) {
+    u64 totalLines = 0;
+    for (cook::CookJob* job : depTracker->rootReferences) {
+        totalLines += job->castResult<CookResult_LineCount>()->numLines;
+    }
+    return totalLines;
+}
+
+int main() {
+    String dataFolder = NativePath::join(PLY_WORKSPACE_FOLDER, "data/CookBenchmark");
+    srcFolder = NativePath::join(dataFolder, "src");
+    String dbPath = NativePath::join(dataFolder, "depTracker.db");
+    String cachePath = NativePath::join(dataFolder, "cache");
+    cook::registerCookJobTypes({&CookJobType_LineCount});
+    writeSourceFiles(false);
+
+    // Cold cook
+    {
+        cook::DependencyTracker depTracker;
+        numJobsCooked = 0;
+        float seconds = cookAll(&depTracker);
+        StdOut::text().format("Cold cook: {} ms, {} jobs cooked, {} lines\n", seconds * 1000,
+                              numJobsCooked, getTotalLines(&depTracker));
+
+        CPUTimer::Point start = CPUTimer::get();
+        MemOutStream mout;
+        depTracker.save(&mout);
+        String db = mout.moveToString();
+        FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(dbPath, db);
+        seconds = CPUTimer::Converter{}.toSeconds(CPUTimer::get() - start);
+        StdOut::text().format("Save:      {} ms, {} bytes\n", seconds * 1000, db.numBytes);
+    }
+
+    // Warm cook
+    {
+        cook::DependencyTracker depTracker;
+        CPUTimer::Point start = CPUTimer::get();
+        Owned<InStream> ins = FileSystem::native()->openStreamForRead(dbPath);
+        if (!ins || !depTracker.load(ins)) {
+            StdErr::text().format("Error: Can't load \"{}\"\n", dbPath);
+            return 1;
+        }
+        float seconds = CPUTimer::Converter{}.toSeconds(CPUTimer::get() - start);
+        StdOut::text().format("Load:      {} ms\n", seconds * 1000);
+
+        numJobsCooked = 0;
+        seconds = cookAll(&depTracker);
+        StdOut::text().format("Warm cook: {} ms, {} jobs cooked, {} lines\n", seconds * 1000,
+                              numJobsCooked, getTotalLines(&depTracker));
+        if (numJobsCooked != 0) {
+            StdErr::text() << "Error: Warm cook should not have cooked any jobs\n";
+            return 1;
+        }
+    }
+
+    // Content hashing
+    {
+        cook::DependencyTracker mtimeTracker;
+        cookAll(&mtimeTracker);
+        cook::DependencyTracker hashTracker;
+        numJobsCooked = 0;
+        float seconds = cookAll(&hashTracker, true);
+        StdOut::text().format("Cold cook (hashed):         {} ms, {} jobs cooked\n",
+                              seconds * 1000, numJobsCooked);
+
+        writeSourceFiles(true);
+        numJobsCooked = 0;
+        seconds = cookAll(&mtimeTracker);
+        StdOut::text().format("Touched files, mtime only:  {} ms, {} jobs cooked\n",
+                              seconds * 1000, numJobsCooked);
+        writeSourceFiles(true);
+        numJobsCooked = 0;
+        seconds = cookAll(&hashTracker, true);
+        StdOut::text().format("Touched files, hashed:      {} ms, {} jobs cooked\n",
+                              seconds * 1000, numJobsCooked);
+        if (numJobsCooked != 0) {
+            StdErr::text() << "Error: Touching files should not have cooked any jobs\n";
+            return 1;
+        }
+    }
+
+    // Content-addressed cache
+    {
+        if (FileSystem::native()->isDir(cachePath)) {
+            FileSystem::native()->removeDirTree(cachePath);
+        }
+        cook::CookCache cache{cachePath, srcFolder};
+        {
+            cook::DependencyTracker depTracker;
+            numJobsCooked = 0;
+            float seconds = cookAll(&depTracker, true, &cache);
+            StdOut::text().format("Fill cache:                 {} ms, {} jobs cooked\n",
+                                  seconds * 1000, numJobsCooked);
+        }
+        {
+            cook::DependencyTracker depTracker;
+            numJobsCooked = 0;
+            float seconds = cookAll(&depTracker, true, &cache);
+            StdOut::text().format("Cook from cache:            {} ms, {} jobs cooked, {} lines\n",
+                                  seconds * 1000, numJobsCooked, getTotalLines(&depTracker));
+        }
+        cook::CookCache::Stats stats = cache.getStats();
+        StdOut::text().format("Cache: {} hits, {} misses, {} stores\n", stats.numHits,
+                              stats.numMisses, stats.numStores);
+        if (stats.numHits != NumSourceFiles) {
+            StdErr::text() << "Error: Every job should have been loaded from the cache\n";
+            return 1;
+        }
+    }
+
+    // Content-addressed cache used from a copy of the source folder
+    {
+        srcFolder = NativePath::join(dataFolder, "srcCopy");
+        writeSourceFiles(false);
+        cook::CookCache cache{cachePath, srcFolder};
+        cook::DependencyTracker depTracker;
+        numJobsCooked = 0;
+        float seconds = cookAll(&depTracker, true, &cache);
+        StdOut::text().format("Cook copy from cache:       {} ms, {} jobs cooked, {} lines\n",
+                              seconds * 1000, numJobsCooked, getTotalLines(&depTracker));
+        if (cache.getStats().numHits != NumSourceFiles) {
+            StdErr::text() << "Error: Every job should have been loaded from the cache\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#include "codegen/Main.inl" //%%
@@ -0,0 +1,145 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/algorithm/Map.h>
+#include <web-common/RequestParser.h>
+
+// Compares the time taken to parse a buffer of pipelined HTTP requests using the line-by-line
+// approach that serverThreadEntry used before RequestParser existed, against RequestParser itself.
+// RequestParser is measured twice: once with the whole buffer available up front, and once with
+// the buffer arriving in small pieces, as it might from a socket.
+
+using namespace ply;
+using namespace ply::web;
+
+StringView SampleRequest =
+    "GET /docs/api/runtime/io/InStream HTTP/1.1\r\n"
+    "Host: plywood.arc80.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:78.0) Gecko/20100101 Firefox/78.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://plywood.arc80.com/docs/api/runtime/io/OutStream\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=4f3c2a1b0e9d8c7b6a5f4e3d2c1b0a99; theme=dark\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "\r\n";
+
+static constexpr u32 NumRequests = 20000;
+static constexpr u32 NumPasses = 10;
+static constexpr u32 ArrivalChunkBytes = 64;
+
+//-----------------------------------------------------------------------
+// The line-by-line approach, as previously implemented in Server.cpp
+//-----------------------------------------------------------------------
+bool parseRequestLines(Request* request, ArrayView<const StringView> lines) {
+    Array<StringView> tokens = lines[0].rtrim(isWhite).splitByte(' ');
+    if (tokens.numItems() != 3)
+        return false;
+    request->startLine = {tokens[0], tokens[1], tokens[2]};
+    for (u32 i = 1; i < lines.numItems; i++) {
+        if (isWhite(lines[i][0]))
+            continue;
+        s32 colonPos = lines[i].findByte(':');
+        if (colonPos < 0)
+            return false;
+        request->headerFields.append(
+            {lines[i].left(colonPos).rtrim(isWhite), lines[i].subStr(colonPos + 1).trim(isWhite)});
+    }
+    return true;
+}
+
+u64 parseLineByLine(StringView buf) {
+    ViewInStream ins{buf};
+    u64 numFields = 0;
+    for (;;) {
+        Request request;
+        Array<String> lines;
+        for (;;) {
+            // The server read from a pipe, which copies each line into a new String
+            String line = ins.readView<fmt::Line>();
+            if (!line && ins.atEOF())
+                return numFields;
+            if (line.findByte([](char u) { return !isWhite(u); }) < 0)
+                break; // Blank line
+            lines.append(line);
+        }
+        Array<StringView> lineViews = map(lines, [](const String& line) { return line.view(); });
+        if (!parseRequestLines(&request, lineViews))
+            return numFields;
+        numFields += request.headerFields.numItems();
+    }
+}
+
+//-----------------------------------------------------------------------
+// RequestParser
+//-----------------------------------------------------------------------
+u64 parseInPlace(StringView buf) {
+    RequestParser parser;
+    Request request;
+    u64 numFields = 0;
+    while (buf.numBytes > 0) {
+        if (parser.parse(&request, buf) != RequestParser::Complete)
+            break;
+        numFields += request.headerFields.numItems();
+        buf.offsetHead(parser.getHeaderSize());
+        parser.reset();
+    }
+    return numFields;
+}
+
+u64 parseIncrementally(StringView buf) {
+    RequestParser parser;
+    Request request;
+    u64 numFields = 0;
+    u32 numAvailable = 0;
+    while (buf.numBytes > 0) {
+        numAvailable = min(numAvailable + ArrivalChunkBytes, buf.numBytes);
+        RequestParser::Result result = parser.parse(&request, buf.left(numAvailable));
+        if (result == RequestParser::Incomplete)
+            continue;
+        if (result != RequestParser::Complete)
+            break;
+        numFields += request.headerFields.numItems();
+        buf.offsetHead(parser.getHeaderSize());
+        numAvailable -= parser.getHeaderSize();
+        parser.reset();
+    }
+    return numFields;
+}
+
+template <typename ParseFunc>
+void measure(StringView name, StringView buf, u64 expectedFields, const ParseFunc& parseFunc) {
+    float bestSeconds = Limits<float>::Max;
+    for (u32 pass = 0; pass < NumPasses; pass++) {
+        CPUTimer::Point start = CPUTimer::get();
+        u64 numFields = parseFunc(buf);
+        float seconds = CPUTimer::Converter{}.toSeconds(CPUTimer::get() - start);
+        if (numFields != expectedFields) {
+            StdErr::text().format("Error: {} parsed {} header fields, expected {}\n", name,
+                                  numFields, expectedFields);
+            exit(1);
+        }
+        bestSeconds = min(bestSeconds, seconds);
+    }
+    StdOut::text().format("{}: {} requests/sec, {} MB/sec\n", name,
+                          u64(NumRequests / bestSeconds),
+                          u64(buf.numBytes / bestSeconds / (1024 * 1024)));
+}
+
+int main() {
+    MemOutStream mout;
+    for (u32 i = 0; i < NumRequests; i++) {
+        mout << SampleRequest;
+    }
+    String buf = mout.moveToString();
+    u64 expectedFields = u64(NumRequests) * 10;
+
+    measure("Line by line       ", buf, expectedFields, parseLineByLine);
+    measure("RequestParser      ", buf, expectedFields, parseInPlace);
+    measure("RequestParser (64B)", buf, expectedFields, parseIncrementally);
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/container/Hash128.h>
+#include <ply-runtime/algorithm/Random.h>
+
+// Measures hashing throughput for key sizes from 8 bytes to 1 MB. Compares the murmur3 word loop
+// that Hasher used to apply to strings against XXH3, and SpookyHash (Hash128) against XXH3's
+// 128-bit variant (FastHash128).
+
+using namespace ply;
+
+static constexpr u32 BytesPerMeasurement = 64 << 20;
+
+// The string hashing loop used by Hasher when PLY_HASHER_STRING_MODE is 0
+u32 hashMurmurWords(StringView buf) {
+    Hasher hasher;
+    while (buf.numBytes >= 4) {
+        u32 word;
+        memcpy(&word, buf.bytes, 4);
+        hasher << word;
+        buf.bytes += 4;
+        buf.numBytes -= 4;
+    }
+    u32 v = 0;
+    while (buf.numBytes > 0) {
+        v = (v << 8) | *(const u8*) buf.bytes;
+        buf.bytes++;
+        buf.numBytes--;
+    }
+    hasher << v;
+    return hasher.result();
+}
+
+// Hashes numBytes-sized keys taken from consecutive offsets in data, and returns the throughput
+// in MB/s. The keys overlap so that short keys aren't always aligned.
+template <typename HashFunc>
+float measure(StringView data, u32 numBytes, u64* checksum, const HashFunc& hashFunc) {
+    u32 numKeys = max<u32>(BytesPerMeasurement / numBytes, 1);
+    u32 maxOffset = data.numBytes - numBytes;
+    CPUTimer::Converter cvt;
+    CPUTimer::Point start = CPUTimer::get();
+    u64 sum = 0;
+    for (u32 i = 0; i < numKeys; i++) {
+        u32 offset = (i * 61) % (maxOffset + 1);
+        sum += hashFunc(data.subStr(offset, numBytes));
+    }
+    CPUTimer::Point end = CPUTimer::get();
+    *checksum += sum;
+    return (float(numKeys) * numBytes) / cvt.toSeconds(end - start) / (1024 * 1024);
+}
+
+int main() {
+    // Random input, large enough for the biggest key plus some room to vary the offset
+    String data = String::allocate((1 << 20) + 4096);
+    Random random{1};
+    for (u32 i = 0; i < data.numBytes; i++) {
+        data.bytes[i] = (char) random.next8();
+    }
+
+    u64 checksum = 0;
+    for (u32 numBytes = 8; numBytes <= (1 << 20); numBytes *= 2) {
+        float murmur = measure(data, numBytes, &checksum, hashMurmurWords);
+        float xxh64 = measure(data, numBytes, &checksum, XXH3::hash64);
+        float spooky = measure(data, numBytes, &checksum,
+                               [](StringView view) { return Hash128::compute(view).lo; });
+        float xxh128 = measure(data, numBytes, &checksum,
+                               [](StringView view) { return FastHash128::compute(view).lo; });
+        StdOut::text().format(
+            "{} bytes: murmur3 {} MB/s, XXH3-64 {} MB/s, Spooky128 {} MB/s, XXH3-128 {} MB/s\n",
+            numBytes, murmur, xxh64, spooky, xxh128);
+    }
+
+    // Hashing a message in pieces must give the same result as hashing it at once
+    for (u32 numBytes : {0u, 100u, 240u, 241u, 1000u, 100000u}) {
+        StringView message = StringView{data}.left(numBytes);
+        FastHash128 hasher;
+        for (u32 i = 0; i < numBytes; i += 37) {
+            hasher.append(message.subStr(i, min<u32>(37, numBytes - i)));
+        }
+        if (hasher.get() != FastHash128::compute(message)) {
+            StdErr::text() << "Error: Incremental hash doesn't match\n";
+            return 1;
+        }
+    }
+    StdOut::text().format("(checksum {})\n", checksum);
+    return 0;
+}
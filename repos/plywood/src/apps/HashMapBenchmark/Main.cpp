@@ -0,0 +1,156 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/container/FlatHashMap.h>
+#include <ply-runtime/algorithm/Random.h>
+
+// Compares HashMap against FlatHashMap for insert, find-hit, find-miss and erase, using integer
+// keys and using string keys like those in a symbol table.
+
+using namespace ply;
+
+static constexpr u32 NumIntKeys = 1000000;
+static constexpr u32 NumStringKeys = 200000;
+
+struct IntTraits {
+    using Key = u32;
+    struct Item {
+        u32 key;
+        u32 value = 0;
+        PLY_INLINE Item(u32 key) : key{key} {
+        }
+    };
+    static PLY_INLINE bool match(const Item& item, u32 key) {
+        return item.key == key;
+    }
+};
+
+struct StringTraits {
+    using Key = StringView;
+    struct Item {
+        String name;
+        u32 value = 0;
+        PLY_INLINE Item(StringView name) : name{name} {
+        }
+    };
+    static PLY_INLINE bool match(const Item& item, StringView key) {
+        return item.name == key;
+    }
+};
+
+struct Timings {
+    float insert = 0;
+    float findHit = 0;
+    float findMiss = 0;
+    float erase = 0;
+};
+
+template <typename Map, typename Key>
+Timings runBenchmark(ArrayView<const Key> keys, ArrayView<const Key> missingKeys,
+                     u32* checksum) {
+    CPUTimer::Converter cvt;
+    Timings timings;
+    Map map;
+
+    CPUTimer::Point start = CPUTimer::get();
+    for (u32 i = 0; i < keys.numItems; i++) {
+        map.insertOrFind(keys[i])->value = i;
+    }
+    CPUTimer::Point end = CPUTimer::get();
+    timings.insert = cvt.toSeconds(end - start);
+
+    u32 sum = 0;
+    start = CPUTimer::get();
+    for (const Key& key : keys) {
+        sum += map.find(key)->value;
+    }
+    end = CPUTimer::get();
+    timings.findHit = cvt.toSeconds(end - start);
+
+    start = CPUTimer::get();
+    for (const Key& key : missingKeys) {
+        sum += map.find(key).wasFound();
+    }
+    end = CPUTimer::get();
+    timings.findMiss = cvt.toSeconds(end - start);
+
+    start = CPUTimer::get();
+    for (const Key& key : keys) {
+        map.find(key).erase();
+    }
+    end = CPUTimer::get();
+    timings.erase = cvt.toSeconds(end - start);
+
+    PLY_ASSERT(map.numItems() == 0);
+    *checksum = sum;
+    return timings;
+}
+
+void report(StringView name, u32 numKeys, const Timings& timings) {
+    auto nsPerOp = [&](float seconds) { return seconds * 1e9f / numKeys; };
+    StdOut::text().format("{}: insert {} ns, find-hit {} ns, find-miss {} ns, erase {} ns\n", name,
+                          nsPerOp(timings.insert), nsPerOp(timings.findHit),
+                          nsPerOp(timings.findMiss), nsPerOp(timings.erase));
+}
+
+template <typename Traits, typename Key>
+bool compareMaps(StringView keyDesc, ArrayView<const Key> keys, ArrayView<const Key> missingKeys) {
+    u32 checksum = 0;
+    u32 flatChecksum = 0;
+    Timings timings = runBenchmark<HashMap<Traits>>(keys, missingKeys, &checksum);
+    Timings flatTimings = runBenchmark<FlatHashMap<Traits>>(keys, missingKeys, &flatChecksum);
+    report(String::format("HashMap, {}    ", keyDesc), keys.numItems, timings);
+    report(String::format("FlatHashMap, {}", keyDesc), keys.numItems, flatTimings);
+    if (checksum != flatChecksum) {
+        StdErr::text() << "Error: Maps returned different results\n";
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    Random random{1};
+
+    // Distinct integer keys, half of which are inserted
+    Array<u32> intKeys;
+    Array<u32> missingIntKeys;
+    for (u32 i = 0; i < NumIntKeys; i++) {
+        u32 key = random.next32() & ~1u;
+        intKeys.append(key | 1);
+        missingIntKeys.append(key);
+    }
+    // Random keys can repeat; remove the repeats
+    {
+        HashMap<IntTraits> seen;
+        u32 numUnique = 0;
+        for (u32 key : intKeys) {
+            if (!seen.insertOrFind(key).wasFound()) {
+                intKeys[numUnique++] = key;
+            }
+        }
+        intKeys.resize(numUnique);
+    }
+
+    // Identifier-like string keys
+    Array<String> stringKeys;
+    Array<String> missingStringKeys;
+    for (u32 i = 0; i < NumStringKeys; i++) {
+        stringKeys.append(String::format("symbol_{}_{}", random.next32() % 1000, i));
+        missingStringKeys.append(String::format("missing_{}_{}", random.next32() % 1000, i));
+    }
+    Array<StringView> stringKeyViews;
+    Array<StringView> missingStringKeyViews;
+    for (u32 i = 0; i < NumStringKeys; i++) {
+        stringKeyViews.append(stringKeys[i]);
+        missingStringKeyViews.append(missingStringKeys[i]);
+    }
+
+    if (!compareMaps<IntTraits, u32>("u32 keys   ", intKeys, missingIntKeys))
+        return 1;
+    if (!compareMaps<StringTraits, StringView>("string keys", stringKeyViews,
+                                               missingStringKeyViews))
+        return 1;
+    return 0;
+}
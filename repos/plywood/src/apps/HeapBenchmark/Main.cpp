@@ -0,0 +1,134 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/thread/Affinity.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-runtime/algorithm/Random.h>
+#include <ply-runtime/memory/impl/Heap_CRT.h>
+
+// Measures how allocation throughput scales from 1 to N threads. Heap_DL with its thread cache
+// (PlyHeap) is compared against Heap_DL without the cache, where every call locks the heap, and
+// against Heap_CRT.
+//
+// Two workloads are measured. In the local workload, every thread allocates and frees blocks in a
+// random order, the way String and Array objects come and go. In the remote workload, every block
+// is freed by a different thread than the one that allocated it, as in a producer/consumer queue.
+//
+// Usage: HeapBenchmark [maxThreads]
+
+using namespace ply;
+
+static constexpr u32 OpsPerThread = 2000000;
+static constexpr u32 NumSlots = 1024;
+static constexpr u32 BlocksPerThread = 200000;
+
+#if PLY_USE_DLMALLOC
+static Heap_DL uncachedHeap;
+#endif
+static Heap_CRT crtHeap;
+
+// Mostly small blocks, with an occasional larger one
+static PLY_INLINE ureg randomSize(u64 r) {
+    return ((r >> 8) & 15) == 0 ? 16 + (r >> 16) % 4096 : 8 + (r >> 16) % 248;
+}
+
+// Runs body(t) on numThreads threads at once and returns the elapsed time
+template <typename Body>
+float runThreads(u32 numThreads, const Body& body) {
+    Atomic<u32> numReady = 0;
+    Atomic<bool> go = false;
+    Array<Thread> threads;
+    threads.resize(numThreads);
+    for (u32 t = 0; t < numThreads; t++) {
+        threads[t].run([&, t] {
+            numReady.fetchAdd(1, Relaxed);
+            while (!go.load(Acquire)) {
+            }
+            body(t);
+        });
+    }
+    while (numReady.load(Acquire) < numThreads) {
+    }
+
+    CPUTimer::Converter cvt;
+    CPUTimer::Point start = CPUTimer::get();
+    go.store(true, Release);
+    for (Thread& thread : threads) {
+        thread.join();
+    }
+    return cvt.toSeconds(CPUTimer::get() - start);
+}
+
+// Returns millions of operations per second, counting each alloc and each free as one operation
+template <typename Heap>
+float runLocal(Heap& heap, u32 numThreads) {
+    float seconds = runThreads(numThreads, [&](u32 t) {
+        void* slots[NumSlots] = {};
+        Random random{t + 1};
+        for (u32 i = 0; i < OpsPerThread / 2; i++) {
+            u64 r = random.next64();
+            void*& slot = slots[r % NumSlots];
+            PLY_HEAP_DIRECT(heap).free(slot);
+            slot = PLY_HEAP_DIRECT(heap).alloc(randomSize(r));
+            *(char*) slot = 0;
+        }
+        for (void* slot : slots) {
+            PLY_HEAP_DIRECT(heap).free(slot);
+        }
+    });
+    return float(numThreads) * OpsPerThread / seconds * 1e-6f;
+}
+
+template <typename Heap>
+float runRemote(Heap& heap, u32 numThreads) {
+    Array<Array<void*>> blocks;
+    blocks.resize(numThreads);
+    for (Array<void*>& arr : blocks) {
+        arr.resize(BlocksPerThread);
+    }
+    float seconds = runThreads(numThreads, [&](u32 t) {
+        Random random{t + 1};
+        for (void*& block : blocks[t]) {
+            block = PLY_HEAP_DIRECT(heap).alloc(randomSize(random.next64()));
+            *(char*) block = 0;
+        }
+    });
+    seconds += runThreads(numThreads, [&](u32 t) {
+        for (void* block : blocks[(t + 1) % numThreads]) {
+            PLY_HEAP_DIRECT(heap).free(block);
+        }
+    });
+    return float(numThreads) * BlocksPerThread * 2 / seconds * 1e-6f;
+}
+
+template <typename Run>
+void printResults(StringView workload, u32 numThreads, const Run& run) {
+    OutStream outs = StdOut::text();
+    outs.format("{} threads, {}:", numThreads, workload);
+#if PLY_USE_DLMALLOC
+    outs.format(" Heap_DL+cache {} Mops/s, Heap_DL {} Mops/s,", run(PlyHeap), run(uncachedHeap));
+#endif
+    outs.format(" Heap_CRT {} Mops/s\n", run(crtHeap));
+}
+
+int main(int argc, char* argv[]) {
+    u32 maxThreads = max<u32>(Affinity{}.getNumHWThreads(), 1);
+    if (argc > 1) {
+        maxThreads = max<u32>(StringView{argv[1]}.to<u32>(), 1);
+    }
+#if PLY_USE_DLMALLOC
+    uncachedHeap.setThreadCacheEnabled(false);
+#endif
+
+    for (u32 numThreads = 1;; numThreads = min(numThreads * 2, maxThreads)) {
+        printResults("local", numThreads,
+                     [&](auto& heap) { return runLocal(heap, numThreads); });
+        printResults("remote", numThreads,
+                     [&](auto& heap) { return runRemote(heap, numThreads); });
+        if (numThreads == maxThreads)
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/algorithm/Random.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Checks that doubles and floats printed by OutStream parse back to the same value, then measures
+// the throughput of printing and parsing numbers. Doubles are compared against snprintf("%.17g"),
+// which also round-trips but isn't the shortest, and strtod(). Integers are compared against the
+// digit-at-a-time loop that OutStream used before.
+//
+// Usage: NumberFormatBenchmark [numValues]
+
+using namespace ply;
+
+// The integer printing loop used before digits were written two at a time
+void printDigitAtATime(OutStream* outs, u64 value) {
+    char digitBuffer[20];
+    s32 digitIndex = 20;
+    do {
+        u64 quotient = value / 10;
+        digitBuffer[--digitIndex] = char('0' + (value - quotient * 10));
+        value = quotient;
+    } while (value > 0);
+    outs->write({digitBuffer + digitIndex, u32(20 - digitIndex)});
+}
+
+// Random doubles with a mix of magnitudes: uniform bit patterns, values near 1, and short decimals
+Array<double> makeDoubles(u32 numValues) {
+    Array<double> values;
+    Random random{1};
+    while (values.numItems() < numValues) {
+        u64 bits = random.next64();
+        switch (values.numItems() % 3) {
+            case 0: {
+                break;
+            }
+            case 1: {
+                bits = (bits & 0x800fffffffffffffull) | (u64(1023 + bits % 40 - 20) << 52);
+                break;
+            }
+            default: {
+                values.append(double(s64(bits % 2000000) - 1000000) / 1000);
+                continue;
+            }
+        }
+        double value;
+        memcpy(&value, &bits, 8);
+        if (value == value && value - value == 0) { // Skip NaN and infinity
+            values.append(value);
+        }
+    }
+    return values;
+}
+
+// Prints every value on its own line
+template <typename T, typename PrintFunc>
+String printAll(const Array<T>& values, float* seconds, const PrintFunc& printFunc) {
+    MemOutStream mout;
+    CPUTimer::Converter cvt;
+    CPUTimer::Point start = CPUTimer::get();
+    for (const T& value : values) {
+        printFunc(&mout, value);
+        mout << '\n';
+    }
+    CPUTimer::Point end = CPUTimer::get();
+    *seconds = cvt.toSeconds(end - start);
+    return mout.moveToString();
+}
+
+template <typename ParseFunc>
+double parseAll(StringView text, float* seconds, const ParseFunc& parseFunc) {
+    double sum = 0;
+    CPUTimer::Converter cvt;
+    CPUTimer::Point start = CPUTimer::get();
+    while (text.numBytes > 0) {
+        s32 newline = text.findByte('\n');
+        sum += parseFunc(text.left(newline));
+        text.offsetHead(newline + 1);
+    }
+    CPUTimer::Point end = CPUTimer::get();
+    *seconds = cvt.toSeconds(end - start);
+    return sum;
+}
+
+int main(int argc, char* argv[]) {
+    u32 numValues = 1000000;
+    if (argc > 1) {
+        numValues = max<u32>(StringView{argv[1]}.to<u32>(), 1);
+    }
+    Array<double> values = makeDoubles(numValues);
+
+    // Correctness: every printed value must parse back exactly, with both parsers
+    for (double value : values) {
+        String str = String::from(value);
+        char cstr[64];
+        memcpy(cstr, str.bytes, str.numBytes);
+        cstr[str.numBytes] = 0;
+        float f = float(value);
+        String fstr = String::from(f);
+        if (str.to<double>() != value || strtod(cstr, nullptr) != value ||
+            (fstr.to<float>() != f && !fstr.endsWith("inf"))) {
+            StdErr::text().format("Error: {} doesn't round-trip\n", str);
+            return 1;
+        }
+    }
+
+    float printSecs = 0;
+    float snprintfSecs = 0;
+    float parseSecs = 0;
+    float strtodSecs = 0;
+    String shortest = printAll(values, &printSecs, [](OutStream* outs, double value) {
+        *outs << value;
+    });
+    String longest = printAll(values, &snprintfSecs, [](OutStream* outs, double value) {
+        char buf[32];
+        outs->write({buf, (u32) snprintf(buf, sizeof(buf), "%.17g", value)});
+    });
+    double sum0 = parseAll(shortest, &parseSecs, [](StringView str) { return str.to<double>(); });
+    double sum1 = parseAll(shortest, &strtodSecs, [](StringView str) {
+        char cstr[64];
+        memcpy(cstr, str.bytes, str.numBytes);
+        cstr[str.numBytes] = 0;
+        return strtod(cstr, nullptr);
+    });
+    if (sum0 != sum1) {
+        StdErr::text() << "Error: Parsers disagree\n";
+        return 1;
+    }
+    float mvps = numValues * 1e-6f;
+    StdOut::text().format("{} doubles, {} bytes shortest, {} bytes %.17g\n", numValues,
+                          shortest.numBytes, longest.numBytes);
+    StdOut::text().format("print: OutStream {} M/s, snprintf {} M/s\n", mvps / printSecs,
+                          mvps / snprintfSecs);
+    StdOut::text().format("parse: StringView::to {} M/s, strtod {} M/s\n", mvps / parseSecs,
+                          mvps / strtodSecs);
+
+    // Integers of every length
+    Array<u64> ints;
+    Random random{2};
+    for (u32 i = 0; i < numValues; i++) {
+        ints.append(random.next64() >> (random.next32() % 64));
+    }
+    float pairSecs = 0;
+    float digitSecs = 0;
+    String pairs =
+        printAll(ints, &pairSecs, [](OutStream* outs, u64 value) { *outs << value; });
+    String digits = printAll(ints, &digitSecs, printDigitAtATime);
+    if (pairs != digits) {
+        StdErr::text() << "Error: Integer printers disagree\n";
+        return 1;
+    }
+    StdOut::text().format("print u64: two digits at a time {} M/s, one digit at a time {} M/s\n",
+                          mvps / pairSecs, mvps / digitSecs);
+    return 0;
+}
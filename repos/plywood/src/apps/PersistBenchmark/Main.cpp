@@ -0,0 +1,153 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-reflect/Asset.h>
+
+// Measures the throughput of writeAsset and readAsset for assets made of large typed arrays. Arrays
+// of numbers, and of structs made only of numbers without padding, are copied in bulk. PaddedMesh
+// has padding after each vertex's flags, so its vertices are saved one member at a time, for
+// comparison. OldMesh is loaded as a Mesh, so its vertices are read by a compiled ReadPlan that
+// converts their positions and skips their ids.
+
+using namespace ply;
+
+static constexpr u32 NumVertices = 2000000;
+static constexpr u32 NumSamples = 8000000;
+
+struct Vertex {
+    PLY_REFLECT()
+    float pos[3];
+    float normal[3];
+    float uv[2];
+    // ply reflect off
+
+    bool operator==(const Vertex& other) const {
+        return memcmp(this, &other, sizeof(Vertex)) == 0;
+    }
+};
+
+struct Mesh {
+    PLY_REFLECT()
+    Array<Vertex> vertices;
+    Array<u32> indices;
+    // ply reflect off
+
+    bool operator==(const Mesh& other) const {
+        return this->vertices == other.vertices && this->indices == other.indices;
+    }
+};
+
+struct OldVertex {
+    PLY_REFLECT()
+    s32 pos[3];
+    float normal[3];
+    float uv[2];
+    u32 id;
+    // ply reflect off
+};
+
+struct OldMesh {
+    PLY_REFLECT()
+    Array<OldVertex> vertices;
+    Array<u32> indices;
+    // ply reflect off
+};
+
+struct PaddedVertex {
+    PLY_REFLECT()
+    float pos[3];
+    u8 flags;
+    // ply reflect off
+
+    bool operator==(const PaddedVertex& other) const {
+        return this->pos[0] == other.pos[0] && this->pos[1] == other.pos[1] &&
+               this->pos[2] == other.pos[2] && this->flags == other.flags;
+    }
+};
+
+struct PaddedMesh {
+    PLY_REFLECT()
+    Array<PaddedVertex> vertices;
+    Array<u32> indices;
+    // ply reflect off
+
+    bool operator==(const PaddedMesh& other) const {
+        return this->vertices == other.vertices && this->indices == other.indices;
+    }
+};
+
+struct AudioClip {
+    PLY_REFLECT()
+    u32 sampleRate = 0;
+    Array<s16> samples;
+    // ply reflect off
+
+    bool operator==(const AudioClip& other) const {
+        return this->sampleRate == other.sampleRate && this->samples == other.samples;
+    }
+};
+
+// Saves obj, loads it as a T, checks that the result is equal to expected and prints the throughput
+// of each
+template <typename T, typename Saved = T>
+bool runBenchmark(StringView name, const T& expected, Saved& obj) {
+    CPUTimer::Converter cvt;
+    MemOutStream mout;
+    CPUTimer::Point start = CPUTimer::get();
+    writeAsset(&mout, TypedPtr::bind(&obj));
+    float saveSeconds = cvt.toSeconds(CPUTimer::get() - start);
+    String saved = mout.moveToString();
+
+    ViewInStream vins{saved};
+    start = CPUTimer::get();
+    OwnTypedPtr loaded = readExpectedAsset(&vins, TypeResolver<T>::get());
+    float loadSeconds = cvt.toSeconds(CPUTimer::get() - start);
+    if (loaded.type != TypeResolver<T>::get() || !(*(T*) loaded.ptr == expected)) {
+        StdErr::text().format("Error: {} didn't load correctly\n", name);
+        return false;
+    }
+
+    float megabytes = saved.numBytes / (1024.f * 1024.f);
+    StdOut::text().format("{}: {} MB, save {} MB/s, load {} MB/s\n", name, megabytes,
+                          megabytes / saveSeconds, megabytes / loadSeconds);
+    return true;
+}
+
+int main() {
+    Mesh mesh;
+    OldMesh oldMesh;
+    PaddedMesh paddedMesh;
+    mesh.vertices.resize(NumVertices);
+    oldMesh.vertices.resize(NumVertices);
+    paddedMesh.vertices.resize(NumVertices);
+    for (u32 i = 0; i < NumVertices; i++) {
+        s32 x = s32(i % 1000);
+        s32 y = s32(i / 1000);
+        mesh.vertices[i] = {{float(x), float(y), 0}, {0, 0, 1}, {x / 1000.f, y / 1000.f}};
+        oldMesh.vertices[i] = {{x, y, 0}, {0, 0, 1}, {x / 1000.f, y / 1000.f}, i};
+        paddedMesh.vertices[i] = {{float(x), float(y), 0}, u8(i)};
+    }
+    for (u32 i = 0; i + 1001 < NumVertices; i += 2) {
+        u32 quad[] = {i, i + 1, i + 1000, i + 1, i + 1001, i + 1000};
+        mesh.indices.extend(ArrayView<const u32>{quad, 6});
+    }
+    oldMesh.indices = mesh.indices;
+    paddedMesh.indices = mesh.indices;
+
+    AudioClip clip;
+    clip.sampleRate = 48000;
+    clip.samples.resize(NumSamples);
+    for (u32 i = 0; i < NumSamples; i++) {
+        clip.samples[i] = s16((i * 2654435761u) >> 16);
+    }
+
+    if (!runBenchmark("Mesh", mesh, mesh) || !runBenchmark("OldMesh as Mesh", mesh, oldMesh) ||
+        !runBenchmark("PaddedMesh", paddedMesh, paddedMesh) ||
+        !runBenchmark("AudioClip", clip, clip))
+        return 1;
+    return 0;
+}
+
+#include "codegen/Main.inl" //%%
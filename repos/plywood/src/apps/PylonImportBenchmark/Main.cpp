@@ -0,0 +1,118 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <pylon/Parse.h>
+#include <pylon-reflect/Import.h>
+
+// Imports a 100MB pylon file into reflected objects two ways: by parsing it into a Node tree and
+// passing the tree to importInto, and by passing the source directly to importInto, which writes
+// into the objects as the source is tokenized. The results of both imports are compared.
+
+using namespace ply;
+
+static constexpr u32 TargetFileSize = 100 * 1024 * 1024;
+
+struct Record {
+    PLY_REFLECT()
+    String name;
+    u32 id = 0;
+    float pos[3] = {0, 0, 0};
+    bool enabled = false;
+    Array<u32> tags;
+    // ply reflect off
+
+    bool operator==(const Record& other) const {
+        return this->name == other.name && this->id == other.id &&
+               this->pos[0] == other.pos[0] && this->pos[1] == other.pos[1] &&
+               this->pos[2] == other.pos[2] && this->enabled == other.enabled &&
+               this->tags == other.tags;
+    }
+};
+
+struct RecordFile {
+    PLY_REFLECT()
+    Array<Record> records;
+    // ply reflect off
+};
+
+// Each record also has a "comment" property that isn't a member of Record, so both imports have
+// to skip it.
+String generateSource() {
+    MemOutStream mout;
+    mout << "{\n  records: [\n";
+    for (u32 i = 0; mout.getSeekPos() < TargetFileSize; i++) {
+        mout.format("    {{\n      name: \"record {}\"\n      id: {}\n", i, i);
+        mout.format("      pos: [{}, {}, {}]\n", i * 0.25f, i * -0.5f, (i % 1000) * 0.125f);
+        mout.format("      enabled: {}\n", (i % 3 == 0) ? "true" : "false");
+        mout.format("      tags: [{}, {}, {}, {}]\n", i % 7, i % 11, i % 13, i % 17);
+        mout.format("      comment: {{ author: \"generated\", lines: [\"first\", \"second\"] }}\n");
+        mout << "    }\n";
+    }
+    mout << "  ]\n}\n";
+    return mout.moveToString();
+}
+
+void onError(const pylon::ParseError& err) {
+    StdErr::text().format("Error at offset {}: {}\n", err.fileOfs, err.message);
+}
+
+int main() {
+    String dataFolder = NativePath::join(PLY_WORKSPACE_FOLDER, "data/PylonImportBenchmark");
+    String srcPath = NativePath::join(dataFolder, "records.pylon");
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(srcPath, generateSource());
+    String src = FileSystem::native()->loadBinary(srcPath);
+    StdOut::text().format("Source: {} bytes\n", src.numBytes);
+
+    // Node tree
+    RecordFile domFile;
+    {
+        CPUTimer::Point start = CPUTimer::get();
+        pylon::Parser parser;
+        parser.setErrorCallback(onError);
+        Owned<pylon::Node> root = parser.parse(src).root;
+        if (!root) {
+            return 1;
+        }
+        CPUTimer::Point parsed = CPUTimer::get();
+        pylon::importInto(TypedPtr::bind(&domFile), root);
+        CPUTimer::Point imported = CPUTimer::get();
+        root.clear();
+        CPUTimer::Point freed = CPUTimer::get();
+        CPUTimer::Converter cvt;
+        StdOut::text().format("Node tree: {} ms (parse {} ms, import {} ms, free {} ms)\n",
+                              cvt.toSeconds(freed - start) * 1000,
+                              cvt.toSeconds(parsed - start) * 1000,
+                              cvt.toSeconds(imported - parsed) * 1000,
+                              cvt.toSeconds(freed - imported) * 1000);
+    }
+
+    // Streaming
+    RecordFile streamFile;
+    {
+        CPUTimer::Point start = CPUTimer::get();
+        pylon::Parser parser;
+        parser.setErrorCallback(onError);
+        if (!pylon::importInto(parser, TypedPtr::bind(&streamFile), src)) {
+            return 1;
+        }
+        float seconds = CPUTimer::Converter{}.toSeconds(CPUTimer::get() - start);
+        StdOut::text().format("Streaming: {} ms\n", seconds * 1000);
+    }
+
+    if (domFile.records.numItems() != streamFile.records.numItems()) {
+        StdErr::text() << "Error: Imports have different numbers of records\n";
+        return 1;
+    }
+    for (u32 i = 0; i < domFile.records.numItems(); i++) {
+        if (!(domFile.records[i] == streamFile.records[i])) {
+            StdErr::text().format("Error: Imports differ at record {}\n", i);
+            return 1;
+        }
+    }
+    StdOut::text().format("{} records imported\n", streamFile.records.numItems());
+    return 0;
+}
+
+#include "codegen/Main.inl" //%%
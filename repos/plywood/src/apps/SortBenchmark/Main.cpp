@@ -0,0 +1,122 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/algorithm/ParallelSort.h>
+#include <ply-runtime/algorithm/Random.h>
+#include <algorithm>
+
+// Measures the time to sort 32-bit integers that are already sorted, sorted in reverse, random, or
+// drawn from a few distinct values. Compares the quicksort that sort() used to be against the
+// current sort(), stableSort(), radixSort(), parallelSort() and std::sort.
+//
+// Usage: SortBenchmark [numItems]
+
+using namespace ply;
+
+// The previous implementation of sort(): a recursive quicksort with a middle pivot
+void oldQuicksort(ArrayView<u32> view) {
+    if (view.numItems <= 1)
+        return;
+    u32 lo = 0;
+    u32 hi = view.numItems - 1;
+    u32 pivot = view.numItems / 2;
+    for (;;) {
+        while (lo < hi && view[lo] < view[pivot]) {
+            lo++;
+        }
+        while (lo < hi && view[pivot] < view[hi]) {
+            hi--;
+        }
+        if (lo >= hi)
+            break;
+        std::swap(view[lo], view[hi]);
+        if (lo == pivot) {
+            pivot = hi;
+        } else if (hi == pivot) {
+            pivot = lo;
+        }
+        lo++;
+    }
+    while (lo > 1) {
+        if (!(view[lo - 1] < view[pivot])) {
+            lo--;
+        } else {
+            oldQuicksort(view.subView(0, lo));
+            break;
+        }
+    }
+    while (hi + 1 < view.numItems) {
+        if (!(view[pivot] < view[hi])) {
+            hi++;
+        } else {
+            oldQuicksort(view.subView(hi));
+            break;
+        }
+    }
+}
+
+Array<u32> makeInput(u32 kind, u32 numItems) {
+    Array<u32> arr;
+    arr.resize(numItems);
+    Random random{1};
+    for (u32 i = 0; i < numItems; i++) {
+        switch (kind) {
+            case 0: arr[i] = i; break;
+            case 1: arr[i] = numItems - i; break;
+            case 2: arr[i] = random.next32(); break;
+            default: arr[i] = random.next32() % 16; break;
+        }
+    }
+    return arr;
+}
+
+// Sorts a copy of input and returns the time taken in milliseconds
+template <typename SortFunc>
+float measure(const Array<u32>& input, Array<u32>* result, const SortFunc& sortFunc) {
+    *result = input;
+    CPUTimer::Converter cvt;
+    CPUTimer::Point start = CPUTimer::get();
+    sortFunc(result->view());
+    CPUTimer::Point end = CPUTimer::get();
+    return cvt.toSeconds(end - start) * 1000.f;
+}
+
+int main(int argc, char* argv[]) {
+    u32 numItems = 1000000;
+    if (argc > 1) {
+        numItems = max<u32>(StringView{argv[1]}.to<u32>(), 1);
+    }
+    ThreadPool pool;
+
+    static const char* kindNames[] = {"sorted", "reversed", "random", "many duplicates"};
+    StdOut::text().format("{} items, {} worker threads\n", numItems, pool.getNumWorkers());
+    for (u32 kind = 0; kind < 4; kind++) {
+        Array<u32> input = makeInput(kind, numItems);
+        Array<u32> expected;
+        Array<u32> result;
+        float stdSort = measure(input, &expected, [](ArrayView<u32> view) {
+            std::sort(view.begin(), view.end());
+        });
+        float old = measure(input, &result, oldQuicksort);
+        bool ok = (result == expected);
+        float pdq = measure(input, &result, [](ArrayView<u32> view) { sort(view); });
+        ok = ok && (result == expected);
+        float stable = measure(input, &result, [](ArrayView<u32> view) { stableSort(view); });
+        ok = ok && (result == expected);
+        float radix = measure(input, &result, [](ArrayView<u32> view) { radixSort(view); });
+        ok = ok && (result == expected);
+        float parallel =
+            measure(input, &result, [&](ArrayView<u32> view) { parallelSort(&pool, view); });
+        ok = ok && (result == expected);
+        if (!ok) {
+            StdErr::text().format("Error: Incorrect result for {} input\n", kindNames[kind]);
+            return 1;
+        }
+        StdOut::text().format("{}: old quicksort {} ms, sort {} ms, stableSort {} ms, radixSort {} "
+                              "ms, parallelSort {} ms, std::sort {} ms\n",
+                              kindNames[kind], old, pdq, stable, radix, parallel, stdSort);
+    }
+    return 0;
+}
@@ -18,6 +18,7 @@
 #include <ply-runtime/algorithm/Find.h>
 #include <web-documentation/Contents.h>
 #include <ply-runtime/algorithm/Sort.h>
+#include <ply-runtime/thread/ThreadPool.h>
 
 namespace ply {
 namespace docs {
@@ -175,11 +176,16 @@ int main() {
     // Extract page metas
     Reference<cook::CookJob> contentsRoot = extractPageMetasFromFolder(&ctx, "/");
 
-    // Cook all pages
+    // Cook all pages. Pages only read from the WebCookerIndex, so they can be cooked in parallel.
+    ThreadPool pool;
+    Array<cook::CookJobID> pageIDs;
     visitPageMetas(contentsRoot, [&](const docs::CookResult_ExtractPageMeta* pageMetaResult) {
-        rootRefs.append(ctx.cook({&ply::docs::CookJobType_Page, pageMetaResult->job->id.desc}));
+        pageIDs.append({&ply::docs::CookJobType_Page, pageMetaResult->job->id.desc});
     });
+    rootRefs.moveExtend(ctx.cookInParallel(&pool, pageIDs));
 
+    // Deferred jobs include ExtractPageMeta jobs, which add to the WebCookerIndex while pages are
+    // reading it, so they're cooked serially
     ctx.cookDeferred();
 
     // Save contents (FIXME: Skip this step if dependencies haven't changed)
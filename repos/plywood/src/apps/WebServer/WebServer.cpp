@@ -9,6 +9,9 @@
 #include <web-common/SourceCode.h>
 #include <web-common/Echo.h>
 #include <web-common/OutPipe_HTTPChunked.h>
+#if PLY_TARGET_POSIX
+#include <sys/resource.h>
+#endif
 
 using namespace ply;
 using namespace web;
@@ -17,8 +20,39 @@ struct AllParams {
     DocServer docs;
     FetchFromFileSystem fileSys;
     SourceCode sourceCode;
+    // The diagnostic routes expose internal details, so they're only served when enabled on the
+    // command line
+    bool serveDiagnostics = false; // /stats and /trace.json. Enabled by -d
+    bool serveHeapProfile = false; // /heap and /heap.pb. Enabled by -m
 };
 
+// Serves the events recorded by EventTracer. Open the result in https://ui.perfetto.dev.
+void serveTrace(ResponseIface* responseIface) {
+    MemOutStream mout;
+    EventTracer::writeChromeTrace(&mout);
+    String json = mout.moveToString();
+    OutStream* outs = responseIface->beginResponseHeader(ResponseCode::OK, json.numBytes);
+    *outs << "Content-Type: application/json\r\nCache-Control: no-store\r\n\r\n";
+    responseIface->endResponseHeader();
+    outs->write(json);
+}
+
+// Serves the call sites recorded by HeapProfiler, either as text or in pprof's format
+void serveHeapProfile(ResponseIface* responseIface, bool asPprof) {
+    MemOutStream mout;
+    if (asPprof) {
+        HeapProfiler::writePprof(&mout);
+    } else {
+        HeapProfiler::writeReport(&mout);
+    }
+    String profile = mout.moveToString();
+    OutStream* outs = responseIface->beginResponseHeader(ResponseCode::OK, profile.numBytes);
+    outs->format("Content-Type: {}\r\nCache-Control: no-store\r\n\r\n",
+                 asPprof ? "application/octet-stream" : "text/plain");
+    responseIface->endResponseHeader();
+    outs->write(profile);
+}
+
 void myRequestHandler(AllParams* params, StringView requestPath, ResponseIface* responseIface) {
     if (requestPath.startsWith("/static/")) {
         FetchFromFileSystem::serve(&params->fileSys, requestPath, responseIface);
@@ -32,6 +66,14 @@ void myRequestHandler(AllParams* params, StringView requestPath, ResponseIface*
         params->docs.serveContentOnly(requestPath.subStr(20), responseIface);
     } else if (requestPath == "/") {
         params->docs.serve("", responseIface);
+    } else if (params->serveDiagnostics && requestPath == "/stats") {
+        params->docs.serveCacheStats(responseIface);
+    } else if (params->serveDiagnostics && requestPath == "/trace.json") {
+        serveTrace(responseIface);
+    } else if (params->serveHeapProfile && requestPath == "/heap") {
+        serveHeapProfile(responseIface, false);
+    } else if (params->serveHeapProfile && requestPath == "/heap.pb") {
+        serveHeapProfile(responseIface, true);
     } else if (requestPath == "/favicon.ico") {
         FetchFromFileSystem::serve(&params->fileSys, "/static/favicon@32x32.png", responseIface);
     } else {
@@ -68,6 +110,10 @@ int main(int argc, char* argv[]) {
     Socket::initialize(IPAddress::V6);
     String dataRoot;
     u16 port = 0;
+    ServerOptions serverOptions;
+    s32 pageCacheMB = -1;
+    bool serveDiagnostics = false;
+    u32 heapSampleInterval = 0;
     CommandLine cmdLine{argc, argv};
     while (StringView arg = cmdLine.readToken()) {
         if (arg.startsWith("-")) {
@@ -81,6 +127,43 @@ int main(int argc, char* argv[]) {
                     writeMsgAndExit(String::format("Invalid port number {}", portStr));
                 }
                 port = p;
+            } else if (arg == "-e") {
+                serverOptions.mode = ServerOptions::EventDriven;
+            } else if (arg == "-t") {
+                StringView numStr = cmdLine.readToken();
+                u32 n = numStr.to<u32>();
+                if (n == 0) {
+                    writeMsgAndExit(String::format("Expected number of I/O threads after {}", arg));
+                }
+                serverOptions.numIOThreads = n;
+            } else if (arg == "-w") {
+                StringView numStr = cmdLine.readToken();
+                u32 n = numStr.to<u32>();
+                if (n == 0) {
+                    writeMsgAndExit(String::format("Expected number of workers after {}", arg));
+                }
+                serverOptions.numWorkerThreads = n;
+            } else if (arg == "-q") {
+                StringView numStr = cmdLine.readToken();
+                if (!numStr) {
+                    writeMsgAndExit(String::format("Expected maximum queue depth after {}", arg));
+                }
+                serverOptions.maxQueuedRequests = numStr.to<u32>();
+            } else if (arg == "-m") {
+                StringView numStr = cmdLine.readToken();
+                u32 n = numStr.to<u32>();
+                if (n == 0) {
+                    writeMsgAndExit(String::format("Expected heap sample interval after {}", arg));
+                }
+                heapSampleInterval = n;
+            } else if (arg == "-d") {
+                serveDiagnostics = true;
+            } else if (arg == "-c") {
+                StringView numStr = cmdLine.readToken();
+                if (!numStr) {
+                    writeMsgAndExit(String::format("Expected page cache size in MB after {}", arg));
+                }
+                pageCacheMB = numStr.to<u32>();
             } else {
                 writeMsgAndExit(String::format("Unrecognized option {}", arg));
             }
@@ -104,6 +187,14 @@ int main(int argc, char* argv[]) {
             }
         }
     }
+    if (serverOptions.mode == ServerOptions::EventDriven) {
+        // Allow as many simultaneous connections as the hard limit permits
+        struct rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
     if (port == 0) {
         if (const char* dataRootCStr = getenv("WEBSERVER_DOC_DIR")) {
             dataRoot = dataRootCStr;
@@ -119,9 +210,18 @@ int main(int argc, char* argv[]) {
     StdOut::text().format("Serving from {} on port {}\n", dataRoot, port);
     AllParams allParams;
     allParams.fileSys.rootDir = dataRoot;
-    allParams.docs.init(dataRoot);
+    allParams.serveDiagnostics = serveDiagnostics;
+    if (heapSampleInterval > 0) {
+        HeapProfiler::start(heapSampleInterval);
+        allParams.serveHeapProfile = true;
+    }
+    // Watch the data root so that cached pages are invalidated as soon as anything is edited
+    allParams.docs.init(dataRoot, true);
+    if (pageCacheMB >= 0) {
+        allParams.docs.pageCache.setByteBudget(u64(pageCacheMB) * 1024 * 1024);
+    }
     allParams.sourceCode.rootDir = NativePath::normalize(PLY_WORKSPACE_FOLDER);
-    if (!runServer(port, {&allParams, myRequestHandler})) {
+    if (!runServer(port, {&allParams, myRequestHandler}, serverOptions)) {
         exit(1);
     }
     Socket::shutdown();
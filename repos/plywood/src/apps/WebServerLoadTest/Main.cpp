@@ -0,0 +1,249 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/algorithm/Sort.h>
+#include <ply-runtime/thread/Affinity.h>
+
+// Opens many concurrent keep-alive connections to a local web server, sends GET requests over all
+// of them as fast as the server responds, and reports throughput and latency percentiles. Start the
+// server with "WebServer -e" to measure the event-driven connection engine.
+
+#if PLY_KERNEL_LINUX
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <errno.h>
+
+using namespace ply;
+
+struct Options {
+    u16 port = 8080;
+    u32 numConnections = 10000;
+    u32 numThreads = 0;
+    float seconds = 10.f;
+    String path = "/";
+};
+
+struct Connection {
+    Owned<TCPConnection> tcpConn;
+    String recvBuf;
+    u32 recvBytes = 0;
+    CPUTimer::Point requestStart;
+};
+
+struct ThreadResults {
+    u64 numRequests = 0;
+    u64 numErrors = 0;
+    Array<u64> latencies; // In CPUTimer ticks
+};
+
+Atomic<bool> stopFlag = false;
+
+void writeMsgAndExit(StringView msg) {
+    StdErr::text() << "Error: " << msg << '\n';
+    exit(1);
+}
+
+// Returns the number of bytes up to and including the blank line that ends the response header, or
+// -1 if the header is incomplete.
+s32 findEndOfHeader(StringView buf) {
+    for (s32 nl = buf.findByte('\n'); nl >= 0; nl = buf.findByte('\n', nl + 1)) {
+        u32 j = nl + 1;
+        if (j < buf.numBytes && buf[j] == '\r')
+            j++;
+        if (j < buf.numBytes && buf[j] == '\n')
+            return j + 1;
+    }
+    return -1;
+}
+
+// Returns true if buf holds a complete HTTP response. Only one request is in flight per connection,
+// so the response always ends at the end of the buffer.
+bool isResponseComplete(StringView buf) {
+    s32 headerBytes = findEndOfHeader(buf);
+    if (headerBytes < 0)
+        return false;
+    StringView body = buf.subStr(headerBytes);
+    for (StringView line : buf.left(headerBytes).splitByte('\n')) {
+        String lower = line.trim(isWhite).lowerAsc();
+        if (lower.startsWith("transfer-encoding:"))
+            return body.endsWith("0\r\n\r\n");
+        if (lower.startsWith("content-length:"))
+            return body.numBytes >= lower.subStr(15).trim(isWhite).to<u32>();
+    }
+    return false; // Response ends when the server closes the connection
+}
+
+bool sendRequest(Connection* conn, StringView request) {
+    conn->requestStart = CPUTimer::get();
+    conn->recvBytes = 0;
+    // Requests are small enough to fit in the socket buffer of a fresh keep-alive connection
+    ssize_t rc = ::send(conn->tcpConn->getHandle(), request.bytes, request.numBytes, MSG_NOSIGNAL);
+    return rc == (ssize_t) request.numBytes;
+}
+
+void threadEntry(const Options& options, u32 numConnections, ThreadResults* results) {
+    String request = String::format("GET {} HTTP/1.1\r\nHost: localhost\r\n\r\n", options.path);
+    int epollFD = epoll_create1(EPOLL_CLOEXEC);
+
+    Array<Owned<Connection>> conns;
+    for (u32 i = 0; i < numConnections; i++) {
+        Owned<Connection> conn = new Connection;
+        conn->tcpConn = Socket::connectTCP(IPAddress::localHost(IPAddress::V4), options.port);
+        if (!conn->tcpConn) {
+            results->numErrors++;
+            continue;
+        }
+        conn->tcpConn->setBlocking(false);
+        conn->recvBuf = String::allocate(4096);
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.ptr = conn.get();
+        epoll_ctl(epollFD, EPOLL_CTL_ADD, conn->tcpConn->getHandle(), &ev);
+        conns.append(std::move(conn));
+    }
+
+    for (Connection* conn : conns) {
+        if (!sendRequest(conn, request)) {
+            results->numErrors++;
+        }
+    }
+
+    struct epoll_event events[256];
+    while (!stopFlag.load(Relaxed)) {
+        int numEvents = epoll_wait(epollFD, events, 256, 100);
+        for (int i = 0; i < numEvents; i++) {
+            Connection* conn = (Connection*) events[i].data.ptr;
+            int fd = conn->tcpConn->getHandle();
+            for (;;) {
+                if (conn->recvBytes == conn->recvBuf.numBytes) {
+                    conn->recvBuf.resize(conn->recvBuf.numBytes * 2);
+                }
+                ssize_t rc = ::recv(fd, conn->recvBuf.bytes + conn->recvBytes,
+                                    conn->recvBuf.numBytes - conn->recvBytes, 0);
+                if (rc > 0) {
+                    conn->recvBytes += (u32) rc;
+                    if (isResponseComplete({conn->recvBuf.bytes, conn->recvBytes})) {
+                        results->latencies.append(
+                            (u64) (CPUTimer::get() - conn->requestStart).ticks);
+                        results->numRequests++;
+                        if (!sendRequest(conn, request)) {
+                            results->numErrors++;
+                            break;
+                        }
+                    }
+                } else if (rc < 0 && errno == EINTR) {
+                    continue;
+                } else if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    break;
+                } else {
+                    // Server closed the connection
+                    results->numErrors++;
+                    epoll_ctl(epollFD, EPOLL_CTL_DEL, fd, nullptr);
+                    break;
+                }
+            }
+        }
+    }
+    ::close(epollFD);
+}
+
+int main(int argc, char* argv[]) {
+    Socket::initialize(IPAddress::V4);
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        StringView arg = argv[i];
+        StringView value = (i + 1 < argc) ? StringView{argv[i + 1]} : StringView{};
+        if (arg == "-p") {
+            options.port = value.to<u16>();
+            i++;
+        } else if (arg == "-c") {
+            options.numConnections = value.to<u32>();
+            i++;
+        } else if (arg == "-t") {
+            options.numThreads = value.to<u32>();
+            i++;
+        } else if (arg == "-d") {
+            options.seconds = value.to<float>();
+            i++;
+        } else if (arg.startsWith("/")) {
+            options.path = arg;
+        } else {
+            writeMsgAndExit(String::format(
+                "Unrecognized option {}\nUsage: WebServerLoadTest [-p port] [-c connections] "
+                "[-t threads] [-d seconds] [path]",
+                arg));
+        }
+    }
+    if (options.port == 0 || options.numConnections == 0 || options.seconds <= 0) {
+        writeMsgAndExit("Invalid arguments");
+    }
+    if (options.numThreads == 0) {
+        options.numThreads = max<u32>(Affinity{}.getNumHWThreads() / 2, 1);
+    }
+    options.numThreads = min(options.numThreads, options.numConnections);
+
+    // Each connection needs a file descriptor
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    StdOut::text().format("Opening {} connections to port {} on {} threads...\n",
+                          options.numConnections, options.port, options.numThreads);
+    Array<ThreadResults> results;
+    results.resize(options.numThreads);
+    Array<Thread> threads;
+    threads.resize(options.numThreads);
+    for (u32 t = 0; t < options.numThreads; t++) {
+        u32 numConns = options.numConnections / options.numThreads +
+                       (t < options.numConnections % options.numThreads ? 1 : 0);
+        threads[t].run([&options, numConns, r = &results[t]] { threadEntry(options, numConns, r); });
+    }
+    CPUTimer::Point start = CPUTimer::get();
+    Thread::sleepMillis((ureg)(options.seconds * 1000));
+    stopFlag.store(true, Relaxed);
+    for (Thread& thread : threads) {
+        thread.join();
+    }
+    float elapsed = CPUTimer::Converter{}.toSeconds(CPUTimer::get() - start);
+
+    // Merge results
+    u64 numRequests = 0;
+    u64 numErrors = 0;
+    Array<u64> latencies;
+    for (ThreadResults& r : results) {
+        numRequests += r.numRequests;
+        numErrors += r.numErrors;
+        latencies.extend(r.latencies.view());
+    }
+    sort(latencies);
+
+    OutStream outs = StdOut::text();
+    outs.format("Requests:      {}\n", numRequests);
+    outs.format("Errors:        {}\n", numErrors);
+    outs.format("Requests/sec:  {}\n", u64(numRequests / elapsed));
+    if (latencies.numItems() > 0) {
+        CPUTimer::Converter cvt;
+        auto percentile = [&](float p) {
+            u32 index = min(u32(latencies.numItems() * p), latencies.numItems() - 1);
+            return cvt.toSeconds({(s64) latencies[index]}) * 1000.f;
+        };
+        outs.format("Latency p50:   {} ms\n", percentile(0.5f));
+        outs.format("Latency p99:   {} ms\n", percentile(0.99f));
+        outs.format("Latency max:   {} ms\n", percentile(1.f));
+    }
+    Socket::shutdown();
+    return 0;
+}
+
+#else // PLY_KERNEL_LINUX
+
+int main() {
+    ply::StdErr::text() << "WebServerLoadTest requires epoll and only runs on Linux.\n";
+    return 1;
+}
+
+#endif // PLY_KERNEL_LINUX
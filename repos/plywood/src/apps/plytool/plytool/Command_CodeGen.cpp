@@ -233,9 +233,13 @@ void command_codegen(PlyToolCommandEnv* env) {
                          "DirectoryWatcher_Mac.h",
                          "DirectoryWatcher_Win32.h",
                          "Heap.cpp",
+                         "Heap_DL.cpp",
                          "HiddenArgFunctor.h",
                          "LambdaView.h",
                          "Pool.h",
+                         "ConcurrentMap.h",
+                         "XXH3.h",
+                         "XXH3.cpp",
                      }) {
                     if (file.name == exclude)
                         goto skipIt;
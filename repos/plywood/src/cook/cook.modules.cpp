@@ -10,3 +10,11 @@ void module_ply_cook(ModuleArgs* args) {
     args->addIncludeDir(Visibility::Public, ".");
     args->addTarget(Visibility::Public, "reflect");
 }
+
+// [ply module="cook-tests"]
+void module_cookTests(ModuleArgs* args) {
+    args->buildTarget->targetType = BuildTargetType::ObjectLib;
+    args->addSourceFiles("tests");
+    args->addTarget(Visibility::Private, "cook");
+    args->addTarget(Visibility::Private, "test");
+}
@@ -0,0 +1,250 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-cook/Core.h>
+#include <ply-cook/CookCache.h>
+#include <ply-cook/Persist.h>
+#include <ply-runtime/algorithm/Find.h>
+
+namespace ply {
+namespace cook {
+
+//------------------------------------
+// Cached format
+//------------------------------------
+struct CachedInputSet {
+    PLY_REFLECT()
+    Array<String> paths;
+    // ply reflect off
+};
+
+struct CachedJobInputs {
+    PLY_REFLECT()
+    Array<CachedInputSet> inputSets; // Most recently stored first
+    // ply reflect off
+};
+
+struct CachedCookResult {
+    PLY_REFLECT()
+    CookJobID id;
+    OwnTypedPtr result; // Null if the result type is CookResult itself
+    Array<Dependency_File> dependencies;
+    Array<CookJobID> references;
+    // ply reflect off
+};
+
+static String hashToString(const u128& hash) {
+    static const char* digits = "0123456789abcdef";
+    String str = String::allocate(32);
+    for (u32 i = 0; i < 16; i++) {
+        u64 half = (i < 8 ? hash.hi : hash.lo);
+        u32 shift = (7 - (i & 7)) * 8;
+        str[i * 2] = digits[(half >> (shift + 4)) & 15];
+        str[i * 2 + 1] = digits[(half >> shift) & 15];
+    }
+    return str;
+}
+
+static void appendToHash(Hash128* hasher, const u128& hash) {
+    hasher->append({(const char*) &hash.lo, sizeof(hash.lo)});
+    hasher->append({(const char*) &hash.hi, sizeof(hash.hi)});
+}
+
+static String getJobInputsPath(StringView rootPath, const CookJobID& id) {
+    return NativePath::join(rootPath, "jobs", hashToString(Hash128::compute(id.str())));
+}
+
+static String getResultPath(StringView rootPath, const u128& inputHash) {
+    return NativePath::join(rootPath, "results", hashToString(inputHash));
+}
+
+static OwnTypedPtr readCachedObject(StringView path, TypeDescriptor_Struct* rootType) {
+    Owned<InStream> ins = FileSystem::native()->openStreamForRead(path);
+    if (!ins)
+        return {};
+    CookTypeResolver resolver{rootType};
+    OwnTypedPtr obj = readAsset(ins, &resolver);
+    if (obj.type != rootType)
+        return {};
+    return obj;
+}
+
+static void writeCachedObject(StringView path, TypedPtr obj) {
+    MemOutStream mout;
+    writeAsset(&mout, obj);
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(path, mout.moveToString());
+}
+
+//------------------------------------
+// CookCache
+//------------------------------------
+bool CookCache::load(CookJob* job) {
+    CookContext* ctx = CookContext::current();
+    OwnTypedPtr inputsObj =
+        readCachedObject(getJobInputsPath(this->rootPath, job->id),
+                         TypeResolver<CachedJobInputs>::get());
+    if (inputsObj.ptr) {
+        CachedJobInputs* inputs = (CachedJobInputs*) inputsObj.ptr;
+        for (const CachedInputSet& inputSet : inputs->inputSets) {
+            // Hash the current contents of this set of input files
+            Array<FileStatus> statuses;
+            Hash128 hasher;
+            hasher.append(job->id.str());
+            bool canHash = true;
+            for (StringView cachedPath : inputSet.paths) {
+                String path = this->fromCachedPath(cachedPath);
+                FileStatus& status = statuses.append(FileSystem::native()->getFileStatus(path));
+                u128 contentHash;
+                if (status.result != FSResult::OK ||
+                    !ctx->getFileContentHash(&contentHash, path, status)) {
+                    canHash = false;
+                    break;
+                }
+                hasher.append(cachedPath);
+                appendToHash(&hasher, contentHash);
+            }
+            if (!canHash)
+                continue;
+
+            OwnTypedPtr cachedObj = readCachedObject(getResultPath(this->rootPath, hasher.get()),
+                                                     TypeResolver<CachedCookResult>::get());
+            if (!cachedObj.ptr)
+                continue;
+            CachedCookResult* cached = (CachedCookResult*) cachedObj.ptr;
+            TypeDescriptor* resultType = job->id.type->resultType;
+            if (!(cached->id == job->id) ||
+                cached->dependencies.numItems() != inputSet.paths.numItems() ||
+                cached->result.type !=
+                    (resultType != TypeResolver<CookResult>::get() ? resultType : nullptr))
+                continue;
+            bool isValid = true;
+            for (const CookJobID& refID : cached->references) {
+                if (!refID.type) {
+                    isValid = false;
+                }
+            }
+            if (!isValid)
+                continue;
+
+            // Hit
+            CookResult* result;
+            if (cached->result.ptr) {
+                result = (CookResult*) cached->result.ptr;
+                cached->result.ptr = nullptr;
+            } else {
+                result = (CookResult*) TypedPtr::create(resultType).ptr;
+            }
+            job->result = result;
+            result->job = job;
+            for (u32 i = 0; i < cached->dependencies.numItems(); i++) {
+                // The files were stored with modification times from wherever the result was
+                // cooked. Replace them with the times the contents were just hashed at.
+                Dependency_File* dep = new Dependency_File{std::move(cached->dependencies[i])};
+                dep->type = &DependencyType_File;
+                dep->path = this->fromCachedPath(dep->path);
+                dep->modificationTime = statuses[i].modificationTime;
+                dep->fileSize = statuses[i].fileSize;
+                result->dependencies.append(dep);
+            }
+            for (const CookJobID& refID : cached->references) {
+                result->references.append(ctx->depTracker->getOrCreateCookJob(refID));
+            }
+            this->numHits.fetchAdd(1, Relaxed);
+            return true;
+        }
+    }
+    this->numMisses.fetchAdd(1, Relaxed);
+    return false;
+}
+
+void CookCache::store(CookJob* job) {
+    CookResult* result = job->result;
+    if (!result->errors.isEmpty())
+        return;
+
+    // Compute the input hash from the contents the files had when the job was cooked
+    CachedCookResult cached;
+    CachedInputSet inputSet;
+    cached.id = job->id;
+    Hash128 hasher;
+    hasher.append(job->id.str());
+    for (Dependency* dep : result->dependencies) {
+        if (dep->type != &DependencyType_File)
+            return;
+        Dependency_File* depFile = static_cast<Dependency_File*>(dep);
+        if (!depFile->hasContentHash)
+            return;
+        String cachedPath = this->toCachedPath(depFile->path);
+        hasher.append(cachedPath);
+        appendToHash(&hasher, depFile->getContentHash());
+        inputSet.paths.append(cachedPath);
+        cached.dependencies.append(*depFile).path = std::move(cachedPath);
+    }
+    for (CookJob* refJob : result->references) {
+        cached.references.append(refJob->id);
+    }
+
+    // Write the result
+    TypeDescriptor* resultType = job->id.type->resultType;
+    if (resultType != TypeResolver<CookResult>::get()) {
+        cached.result = TypedPtr{result, resultType};
+    }
+    writeCachedObject(getResultPath(this->rootPath, hasher.get()), TypedPtr::bind(&cached));
+    cached.result.ptr = nullptr; // Only borrowed from the job
+
+    // Move this set of input paths to the front of the job's list
+    String inputsPath = getJobInputsPath(this->rootPath, job->id);
+    CachedJobInputs inputs;
+    OwnTypedPtr inputsObj = readCachedObject(inputsPath, TypeResolver<CachedJobInputs>::get());
+    if (inputsObj.ptr) {
+        inputs = std::move(*(CachedJobInputs*) inputsObj.ptr);
+    }
+    s32 index = find(inputs.inputSets, [&](const CachedInputSet& existing) {
+        if (existing.paths.numItems() != inputSet.paths.numItems())
+            return false;
+        for (u32 i = 0; i < existing.paths.numItems(); i++) {
+            if (existing.paths[i] != inputSet.paths[i])
+                return false;
+        }
+        return true;
+    });
+    if (index >= 0) {
+        inputs.inputSets.erase(index);
+    }
+    inputs.inputSets.insert(0) = std::move(inputSet);
+    if (inputs.inputSets.numItems() > MaxInputSetsPerJob) {
+        inputs.inputSets.resize(MaxInputSetsPerJob);
+    }
+    writeCachedObject(inputsPath, TypedPtr::bind(&inputs));
+    this->numStores.fetchAdd(1, Relaxed);
+}
+
+String CookCache::toCachedPath(StringView path) const {
+    if (!NativePath::isAbsolute(path) || !NativePath::isAbsolute(this->workspaceRoot))
+        return path;
+    String relPath = NativePath::makeRelative(this->workspaceRoot, path);
+    Array<StringView> components = NativePath::splitFull(relPath);
+    if (NativePath::isAbsolute(relPath) || (components.numItems() > 0 && components[0] == ".."))
+        return path; // Outside the workspace
+    return relPath;
+}
+
+String CookCache::fromCachedPath(StringView cachedPath) const {
+    if (NativePath::isAbsolute(cachedPath))
+        return cachedPath;
+    return NativePath::join(this->workspaceRoot, cachedPath);
+}
+
+CookCache::Stats CookCache::getStats() const {
+    Stats stats;
+    stats.numHits = this->numHits.load(Relaxed);
+    stats.numMisses = this->numMisses.load(Relaxed);
+    stats.numStores = this->numStores.load(Relaxed);
+    return stats;
+}
+
+} // namespace cook
+} // namespace ply
+
+#include "codegen/CookCache.inl" //%%
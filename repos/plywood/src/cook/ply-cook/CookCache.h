@@ -0,0 +1,64 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-cook/Core.h>
+#include <ply-cook/CookJob.h>
+#include <ply-runtime/thread/Atomic.h>
+
+namespace ply {
+namespace cook {
+
+//-----------------------------------------------------------------------
+// CookCache
+//
+// A content-addressed store of cook results. Each result is stored under a hash of its CookJobID
+// and the contents of every file it depends on, so a job whose input files have the same contents
+// as when some earlier cook stored its result can reuse that result, even if the result was cooked
+// on another branch or another machine sharing the same cache folder. Input paths are hashed and
+// stored relative to the workspace root, so checkouts at different locations share results. Paths
+// outside the workspace root are kept absolute.
+//
+// The cache folder contains:
+//     jobs/<hash of CookJobID>  The sets of input paths that recent results of the job depended on
+//     results/<input hash>      A result, its file dependencies and its references
+//
+// Only results that depend on nothing but files, and that have no errors, are stored. Every
+// CookJobType involved must be registered with registerCookJobTypes.
+//-----------------------------------------------------------------------
+struct CookCache {
+    static constexpr u32 MaxInputSetsPerJob = 8;
+
+    struct Stats {
+        u32 numHits = 0;
+        u32 numMisses = 0;
+        u32 numStores = 0;
+    };
+
+    String rootPath;
+    String workspaceRoot;
+    Atomic<u32> numHits = 0;
+    Atomic<u32> numMisses = 0;
+    Atomic<u32> numStores = 0;
+
+    PLY_INLINE CookCache(StringView rootPath, StringView workspaceRoot)
+        : rootPath{rootPath}, workspaceRoot{workspaceRoot} {
+    }
+
+    // Gives job a result from the cache if one was stored for the current contents of its input
+    // files. Called by CookContext when a job needs to be cooked, on the thread that cooks it.
+    bool load(CookJob* job);
+
+    // Stores the job's freshly cooked result, if it can be stored.
+    void store(CookJob* job);
+
+    Stats getStats() const;
+
+    // Converts between absolute paths and the paths that are hashed and stored in the cache
+    String toCachedPath(StringView path) const;
+    String fromCachedPath(StringView cachedPath) const;
+};
+
+} // namespace cook
+} // namespace ply
@@ -4,8 +4,10 @@
 ------------------------------------*/
 #include <ply-cook/Core.h>
 #include <ply-cook/CookJob.h>
+#include <ply-cook/CookCache.h>
 #include <ply-runtime/algorithm/Find.h>
 #include <ply-reflect/Asset.h>
+#include <ply-runtime/thread/ThreadPool.h>
 
 namespace ply {
 
@@ -37,33 +39,34 @@ DependencyTracker* DependencyTracker::current_ = nullptr;
 //------------------------------------
 // Dependency_File
 //------------------------------------
-extern DependencyType DependencyType_File;
-
-struct Dependency_File : Dependency {
-    PLY_REFLECT()
-    String path;
-    double modificationTime = 0;
-    // ply reflect off
-
-    Dependency_File() {
-        this->type = &DependencyType_File;
-    }
-};
-
 DependencyType DependencyType_File = {
     // hasChanged
     [](Dependency* dep_, CookResult* result, TypedPtr) -> bool { //
         // FIXME: Use a safe cast once reflection supports derived classes
         Dependency_File* depFile = static_cast<Dependency_File*>(dep_);
         FileStatus stat = FileSystem::native()->getFileStatus(depFile->path);
-        PLY_ASSERT(stat.result == FSResult::OK);
-        if (stat.modificationTime != depFile->modificationTime) {
-            SLOG(Cook, "Recooking \"{}\" because \"{}\" changed", result->job->id.str(),
-                 depFile->path);
-            return true;
+        // A file that no longer exists counts as changed. This can happen when the
+        // DependencyTracker was loaded from disk.
+        if (stat.result == FSResult::OK) {
+            if (stat.modificationTime == depFile->modificationTime &&
+                stat.fileSize == depFile->fileSize)
+                return false;
+            // The file was touched. If its contents are the same, remember the new modification
+            // time so that the next check is fast again.
+            u128 contentHash;
+            if (depFile->hasContentHash && stat.fileSize == depFile->fileSize &&
+                CookContext::current()->getFileContentHash(&contentHash, depFile->path, stat) &&
+                contentHash == depFile->getContentHash()) {
+                depFile->modificationTime = stat.modificationTime;
+                return false;
+            }
         }
-        return false;
+        SLOG(Cook, "Recooking \"{}\" because \"{}\" changed", result->job->id.str(),
+             depFile->path);
+        return true;
     },
+    // depType
+    TypeResolver<Dependency_File>::get(),
 };
 
 //------------------------------------
@@ -71,6 +74,10 @@ DependencyType DependencyType_File = {
 //------------------------------------
 void CookResult::FileDepScope::onSuccessfulFileOpen() {
     this->depFile->modificationTime = this->modificationTime;
+    this->depFile->fileSize = this->fileSize;
+    if (this->hasContentHash) {
+        this->depFile->setContentHash(this->contentHash);
+    }
 }
 
 CookResult::FileDepScope CookResult::createFileDependency(StringView path) {
@@ -82,6 +89,11 @@ CookResult::FileDepScope CookResult::createFileDependency(StringView path) {
     FileStatus status = FileSystem::native()->getFileStatus(path);
     if (status.result == FSResult::OK) {
         fds.modificationTime = status.modificationTime;
+        fds.fileSize = status.fileSize;
+        CookContext* ctx = CookContext::current();
+        if (ctx->isHashingFileContents()) {
+            fds.hasContentHash = ctx->getFileContentHash(&fds.contentHash, path, status);
+        }
     } else {
         this->errors.append(String::format("error opening {}\n", path));
     }
@@ -112,6 +124,7 @@ void CookResult::addReference(const CookJobID& jobID) {
     Reference<CookJob> refJob = ctx->depTracker->getOrCreateCookJob(jobID);
     PLY_ASSERT(find(this->references, refJob) < 0);
     this->references.append(refJob);
+    LockGuard<Mutex> guard{ctx->mutex};
     if (!ctx->checkedJobs.find(refJob).wasFound()) {
         ctx->deferredJobs.insertOrFind(refJob);
     }
@@ -126,11 +139,18 @@ void CookResult::addError(String&& error) {
 //------------------------------
 // CookJob
 //------------------------------
-CookJob::~CookJob() {
+void CookJob::onRefCountZero() {
     DependencyTracker* depTracker = DependencyTracker::current();
-    auto iter = depTracker->allCookJobs.findFirstGreaterOrEqualTo(&this->id);
-    PLY_ASSERT(iter.isValid() && iter.getItem()->id == this->id);
-    depTracker->allCookJobs.remove(iter);
+    {
+        LockGuard<Mutex> guard{depTracker->allCookJobsMutex};
+        auto iter = depTracker->allCookJobs.findFirstGreaterOrEqualTo(&this->id);
+        // If another thread looked up this job after its reference count dropped to zero,
+        // getOrCreateCookJob already replaced it with a new job.
+        if (iter.isValid() && iter.getItem() == this) {
+            depTracker->allCookJobs.remove(iter);
+        }
+    }
+    delete this;
 }
 
 //------------------------------
@@ -142,9 +162,18 @@ void DependencyTracker::setRootReferences(Array<Reference<CookJob>>&& rootRefs)
 }
 
 Reference<CookJob> DependencyTracker::getOrCreateCookJob(const CookJobID& id) {
+    LockGuard<Mutex> guard{this->allCookJobsMutex};
     auto iter = this->allCookJobs.findFirstGreaterOrEqualTo(&id);
     if (iter.isValid() && iter.getItem()->id == id) {
-        return iter.getItem();
+        CookJob* existing = iter.getItem();
+        if (existing->tryIncRef()) {
+            Reference<CookJob> cookJob = existing;
+            existing->decRef();
+            return cookJob;
+        }
+        // The job's reference count dropped to zero on another thread, which is about to delete
+        // it. Replace it with a new job.
+        this->allCookJobs.remove(iter);
     }
     // FIXME: Implement safe cast that recognizes base classes
     //    Reference<CookJob> cookJob = TypedPtr::create(id.type->resultType).cast<CookJob>();
@@ -154,6 +183,15 @@ Reference<CookJob> DependencyTracker::getOrCreateCookJob(const CookJobID& id) {
     return cookJob;
 }
 
+CookJob* DependencyTracker::findCookJob(const CookJobID& id) {
+    LockGuard<Mutex> guard{this->allCookJobsMutex};
+    auto iter = this->allCookJobs.findFirstGreaterOrEqualTo(&id);
+    if (iter.isValid() && iter.getItem()->id == id) {
+        return iter.getItem();
+    }
+    return nullptr;
+}
+
 DependencyTracker::~DependencyTracker() {
     PLY_ASSERT(DependencyTracker::current_ != this);
     PLY_SET_IN_SCOPE(current_, this);
@@ -186,24 +224,69 @@ void CookContext::endCook() {
     DependencyTracker::current_ = nullptr;
 }
 
-void CookContext::ensureCooked(CookJob* job, TypedPtr jobArg) {
-    PLY_ASSERT(CookContext::current());
-
-    {
-        // Don't keep cursor beyond this scope because this->alreadyChecked can change inside the
-        // body of this function.
+// Returns true if the caller should cook the job. Returns false if the job is already up-to-date,
+// or if another thread is cooking it and waitIfInProgress is false.
+bool CookContext::beginJob(CookJob* job, bool waitIfInProgress) {
+    TID::TID thisThread = TID::getCurrentThreadID();
+    LockGuard<Mutex> guard{this->mutex};
+    for (;;) {
+        // Don't keep cursor across the wait because this->checkedJobs can change in the meantime.
         auto cursor = this->checkedJobs.insertOrFind(job);
-        if (cursor.wasFound()) {
-            // If this assert gets hit, there's a dependency loop.
-            PLY_ASSERT(cursor->status == CookContext::UpToDate);
-            return; // Already cooked
+        if (!cursor.wasFound()) {
+            cursor->cookingThread = thisThread;
+            return true;
+        }
+        if (cursor->status == CookContext::UpToDate)
+            return false; // Already cooked
+        // If this assert gets hit, there's a dependency loop
+        PLY_ASSERT(cursor->cookingThread != thisThread);
+        if (!waitIfInProgress)
+            return false;
+        // If this assert gets hit, there's a dependency loop that spans multiple threads. Waiting
+        // would deadlock.
+        PLY_ASSERT(!this->isWaitingFor(cursor->cookingThread, thisThread));
+        this->waitingThreads.append({thisThread, job});
+        this->jobCookedCond.wait(guard);
+        for (u32 i = 0; i < this->waitingThreads.numItems(); i++) {
+            if (this->waitingThreads[i].thread == thisThread) {
+                this->waitingThreads.eraseQuick(i);
+                break;
+            }
+        }
+    }
+}
+
+// Returns true if thread is waiting, directly or through a chain of other waiting threads, for a
+// job that otherThread is cooking. Must be called while holding the mutex.
+bool CookContext::isWaitingFor(TID::TID thread, TID::TID otherThread) {
+    // A chain can't be longer than the number of waiting threads unless it loops back on itself
+    for (u32 steps = 0; steps <= this->waitingThreads.numItems(); steps++) {
+        if (thread == otherThread)
+            return true;
+        const WaitingThread* waiting = nullptr;
+        for (const WaitingThread& w : this->waitingThreads) {
+            if (w.thread == thread) {
+                waiting = &w;
+                break;
+            }
         }
-        cursor->status = CookContext::CookInProgress;
+        if (!waiting)
+            return false;
+        auto cursor = this->checkedJobs.find(waiting->job);
+        if (!cursor.wasFound() || cursor->status == CookContext::UpToDate)
+            return false; // The thread is about to wake up
+        thread = cursor->cookingThread;
     }
+    return false;
+}
+
+void CookContext::cookJob(CookJob* job, TypedPtr jobArg) {
+    PLY_TRACE_ZONE("Cook job");
 
     // Check if (re)cook is needed
     bool mustCook = true;
     if (job->result) {
+        PLY_TRACE_ZONE("Check cook dependencies");
         mustCook = false;
         for (Dependency* dep : job->result->dependencies) {
             if (dep->type->hasChanged(dep, job->result, jobArg)) {
@@ -213,20 +296,40 @@ void CookContext::ensureCooked(CookJob* job, TypedPtr jobArg) {
         }
     }
 
-    // Invoke the cook if needed
+    // Invoke the cook if needed. If there's a cache, look for a result that was cooked from the
+    // same inputs first.
+    bool loadedFromCache = false;
     if (mustCook) {
         if (job->result) {
             job->result->unlinkFromDatabase();
         }
         Owned<CookResult> oldResult = std::move(job->result);
-        job->result = (CookResult*) TypedPtr::create(job->id.type->resultType).ptr;
-        job->result->job = job;
-        job->id.type->cook(job->result, jobArg);
-    } else {
+        if (this->cache) {
+            PLY_TRACE_ZONE("Load cook result from cache");
+            loadedFromCache = this->cache->load(job);
+        }
+        if (!loadedFromCache) {
+            job->result = (CookResult*) TypedPtr::create(job->id.type->resultType).ptr;
+            job->result->job = job;
+            {
+                PLY_TRACE_ZONE("Cook");
+                job->id.type->cook(job->result, jobArg);
+            }
+            if (this->cache) {
+                PLY_TRACE_ZONE("Store cook result in cache");
+                this->cache->store(job);
+            }
+        }
+    }
+
+    LockGuard<Mutex> guard{this->mutex};
+    if (!mustCook || loadedFromCache) {
         // Make sure references are checked as deferred cook jobs
         PLY_ASSERT(job->result);
         for (cook::CookJob* deferredJob : job->result->references) {
-            this->deferredJobs.insertOrFind(deferredJob);
+            if (!this->checkedJobs.find(deferredJob).wasFound()) {
+                this->deferredJobs.insertOrFind(deferredJob);
+            }
         }
     }
 
@@ -234,17 +337,62 @@ void CookContext::ensureCooked(CookJob* job, TypedPtr jobArg) {
     auto cursor = this->checkedJobs.insertOrFind(job);
     PLY_ASSERT(cursor.wasFound() && cursor->status == CookContext::CookInProgress);
     cursor->status = CookContext::UpToDate;
+    this->jobCookedCond.wakeAll();
 }
 
-void CookContext::cookDeferred() {
+void CookContext::ensureCooked(CookJob* job, TypedPtr jobArg) {
     PLY_ASSERT(CookContext::current());
+    if (this->beginJob(job, true)) {
+        this->cookJob(job, jobArg);
+    }
+}
 
-    while (this->deferredJobs.numItems() > 0) {
-        Array<Reference<CookJob>> jobsToCook;
+// Moves every deferred job into a task on the pool. Each task submits the jobs it defers in turn,
+// so jobs start as soon as they're discovered.
+void CookContext::submitDeferredJobs(ThreadPool* pool) {
+    Array<Reference<CookJob>> jobsToCook;
+    {
+        LockGuard<Mutex> guard{this->mutex};
         for (CookJob* cookJob : this->deferredJobs) {
             jobsToCook.append(cookJob);
         }
         this->deferredJobs = {};
+    }
+
+    for (Reference<CookJob>& job : jobsToCook) {
+        pool->submit([this, pool, job] {
+            // Deferred jobs don't need to wait for a job that's being cooked by another thread
+            if (this->beginJob(job, false)) {
+                this->cookJob(job, {});
+            }
+            this->submitDeferredJobs(pool);
+        });
+    }
+}
+
+void CookContext::cookDeferred(ThreadPool* pool) {
+    PLY_ASSERT(CookContext::current());
+
+    if (pool) {
+        PLY_ASSERT(pool->getCurrentWorkerIndex() < 0);
+        this->submitDeferredJobs(pool);
+        pool->waitUntilIdle();
+        PLY_ASSERT(this->deferredJobs.numItems() == 0);
+        return;
+    }
+
+    for (;;) {
+        Array<Reference<CookJob>> jobsToCook;
+        {
+            LockGuard<Mutex> guard{this->mutex};
+            for (CookJob* cookJob : this->deferredJobs) {
+                jobsToCook.append(cookJob);
+            }
+            this->deferredJobs = {};
+        }
+        PLY_TRACE_COUNTER("Deferred cook jobs", jobsToCook.numItems());
+        if (jobsToCook.isEmpty())
+            break;
 
         for (CookJob* job : jobsToCook) {
             this->ensureCooked(job);
@@ -252,18 +400,65 @@ void CookContext::cookDeferred() {
     }
 }
 
+Array<Reference<CookJob>> CookContext::cookInParallel(ThreadPool* pool,
+                                                      ArrayView<const CookJobID> ids) {
+    PLY_ASSERT(CookContext::current() == this);
+    PLY_ASSERT(pool->getCurrentWorkerIndex() < 0);
+    Array<Reference<CookJob>> cookJobs;
+    cookJobs.reserve(ids.numItems);
+    for (const CookJobID& id : ids) {
+        cookJobs.append(this->depTracker->getOrCreateCookJob(id));
+    }
+    for (CookJob* job : cookJobs) {
+        pool->submit([this, job] { this->ensureCooked(job); });
+    }
+    pool->waitUntilIdle();
+    return cookJobs;
+}
+
 CookResult* CookContext::getAlreadyCookedResult(const CookJobID& id) {
-    auto iter = this->depTracker->allCookJobs.findFirstGreaterOrEqualTo(&id);
-    PLY_ASSERT(iter.isValid() && iter.getItem()->id == id);
-    PLY_ASSERT(iter.getItem()->result);
-    return iter.getItem()->result;
+    CookJob* cookJob = this->depTracker->findCookJob(id);
+    PLY_ASSERT(cookJob);
+    PLY_ASSERT(cookJob->result);
+    return cookJob->result;
 }
 
 bool CookContext::isCooked(CookJob* job) {
-    auto cursor = this->checkedJobs.insertOrFind(job);
+    LockGuard<Mutex> guard{this->mutex};
+    auto cursor = this->checkedJobs.find(job);
     return cursor.wasFound() && cursor->status == CookContext::UpToDate;
 }
 
+bool CookContext::getFileContentHash(u128* hash, StringView path, const FileStatus& status) {
+    {
+        LockGuard<Mutex> guard{this->mutex};
+        auto cursor = this->fileHashes.find(path);
+        if (cursor.wasFound() && cursor->modificationTime == status.modificationTime &&
+            cursor->fileSize == status.fileSize) {
+            *hash = cursor->contentHash;
+            return true;
+        }
+    }
+
+    // Hash the file without holding the lock
+    Owned<InStream> ins = FileSystem::native()->openStreamForRead(path);
+    if (!ins)
+        return false;
+    FastHash128 hasher;
+    while (ins->tryMakeBytesAvailable()) {
+        hasher.append(ins->viewAvailable());
+        ins->curByte = ins->endByte;
+    }
+    *hash = hasher.get();
+
+    LockGuard<Mutex> guard{this->mutex};
+    auto cursor = this->fileHashes.insertOrFind(path);
+    cursor->modificationTime = status.modificationTime;
+    cursor->fileSize = status.fileSize;
+    cursor->contentHash = *hash;
+    return true;
+}
+
 } // namespace cook
 } // namespace ply
 
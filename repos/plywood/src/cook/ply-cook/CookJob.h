@@ -7,9 +7,14 @@
 #include <ply-runtime/container/Hash128.h>
 #include <ply-reflect/StaticPtr.h>
 #include <ply-runtime/container/BTree.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/thread/ConditionVariable.h>
+#include <ply-runtime/thread/TID.h>
 
 namespace ply {
 
+class ThreadPool;
+
 // FIXME: Rename and move to runtime
 struct FileIOWrappers {
     static Tuple<Owned<InStream>, TextFormat>
@@ -20,6 +25,7 @@ struct FileIOWrappers {
 namespace cook {
 
 struct CookContext;
+struct CookCache;
 struct CookJobID;
 struct CookJob;
 struct CookResult;
@@ -59,6 +65,9 @@ struct Dependency;
 
 struct DependencyType {
     bool (*hasChanged)(Dependency* dep, CookResult* job, TypedPtr jobArg) = nullptr;
+    // The reflected subclass of Dependency. Results with dependencies that don't have a depType
+    // aren't saved by DependencyTracker::save, so those jobs are recooked after loading.
+    TypeDescriptor* depType = nullptr;
 };
 
 struct Dependency {
@@ -68,11 +77,42 @@ struct Dependency {
     StaticPtr<DependencyType> type = nullptr;
 };
 
-struct Dependency_File;
+extern DependencyType DependencyType_File;
+
+struct Dependency_File : Dependency {
+    PLY_REFLECT()
+    String path;
+    double modificationTime = 0;
+    u64 fileSize = 0;
+    // The contents hash is only recorded when CookContext::hashFileContents is set. It lets
+    // hasChanged() ignore files whose modification time changed but whose contents didn't.
+    bool hasContentHash = false;
+    u64 contentHashLo = 0;
+    u64 contentHashHi = 0;
+    // ply reflect off
+
+    Dependency_File() {
+        this->type = &DependencyType_File;
+    }
+    PLY_INLINE u128 getContentHash() const {
+        u128 hash;
+        hash.lo = this->contentHashLo;
+        hash.hi = this->contentHashHi;
+        return hash;
+    }
+    PLY_INLINE void setContentHash(const u128& hash) {
+        this->hasContentHash = true;
+        this->contentHashLo = hash.lo;
+        this->contentHashHi = hash.hi;
+    }
+};
 
 struct CookResult {
     struct FileDepScope {
         double modificationTime = 0;
+        u64 fileSize = 0;
+        bool hasContentHash = false;
+        u128 contentHash;
         Dependency_File* depFile;
 
         PLY_INLINE bool isValid() const {
@@ -105,10 +145,7 @@ struct CookJob : RefCounted<CookJob> {
     Owned<CookResult> result;
     // ply reflect off
 
-    ~CookJob();
-    PLY_INLINE void onRefCountZero() {
-        delete this;
-    }
+    void onRefCountZero();
     template <typename T>
     T* castResult() const {
         if (!TypeResolver<T>::get()->isEquivalentTo(this->id.type->resultType))
@@ -136,14 +173,25 @@ struct DependencyTracker {
     Array<Reference<CookJob>> rootReferences;
     // ply reflect off
 
-    // FIXME: Serialize allCookJobs
+    // allCookJobs holds no references. A CookJob removes itself when its reference count drops
+    // to zero. Protected by allCookJobsMutex so that jobs can be looked up from multiple threads.
     BTree<AllCookJobsTraits> allCookJobs;
+    Mutex allCookJobsMutex;
 
     // FIXME: Serialize userData
     OwnTypedPtr userData;
 
     void setRootReferences(Array<Reference<CookJob>>&& rootRefs);
     Reference<CookJob> getOrCreateCookJob(const CookJobID& id);
+    CookJob* findCookJob(const CookJobID& id);
+
+    // save() writes every job in allCookJobs, including its result, dependencies and references,
+    // along with rootReferences. load() reads them back into an empty DependencyTracker, so that a
+    // subsequent cook only recooks jobs whose dependencies changed. Every CookJobType and
+    // DependencyType involved must be registered first. Neither function may be called during a
+    // cook.
+    void save(OutStream* outs);
+    bool load(InStream* ins);
 
     static DependencyTracker* current_;
     static PLY_INLINE DependencyTracker* current() {
@@ -153,6 +201,11 @@ struct DependencyTracker {
     ~DependencyTracker();
 };
 
+// Makes CookJobTypes and DependencyTypes known to DependencyTracker::save and load. Registering a
+// CookJobType also lets CookJobIDs of that type be serialized through StaticPtr<CookJobType>.
+void registerCookJobTypes(ArrayView<CookJobType* const> jobTypes);
+void registerDependencyTypes(ArrayView<DependencyType* const> depTypes);
+
 struct CookContext {
     enum Status {
         CookInProgress,
@@ -164,6 +217,7 @@ struct CookContext {
         struct Item {
             CookJob* job;
             Status status;
+            TID::TID cookingThread = 0; // Only meaningful while status is CookInProgress
             PLY_INLINE Item(CookJob* job) : job{job}, status{CookInProgress} {
             }
         };
@@ -172,6 +226,21 @@ struct CookContext {
         }
     };
 
+    struct FileHashTraits {
+        using Key = StringView;
+        struct Item {
+            String path;
+            double modificationTime = 0;
+            u64 fileSize = 0;
+            u128 contentHash;
+            PLY_INLINE Item(StringView path) : path{path} {
+            }
+        };
+        static PLY_INLINE bool match(const Item& item, Key key) {
+            return item.path == key;
+        }
+    };
+
     struct DeferredTraits {
         using Key = CookJob*;
         using Item = CookJob*;
@@ -186,20 +255,69 @@ struct CookContext {
         return current_;
     }
 
+    // A thread that's waiting in beginJob() for a job that another thread is cooking
+    struct WaitingThread {
+        TID::TID thread;
+        CookJob* job;
+    };
+
     DependencyTracker* depTracker = nullptr;
+
+    // When hashFileContents is set, file dependencies also record a hash of the file's contents,
+    // so that a file is only considered changed if its contents changed. If cache is non-null,
+    // results are also looked up in and stored to the cache, which implies hashFileContents.
+    bool hashFileContents = false;
+    CookCache* cache = nullptr;
+
     // Alternatively, checkedTypes and checkedJobs *could* just be implemented as a status code in
     // every CookJob/CookJobType...
+    // checkedJobs and deferredJobs are protected by mutex. jobCookedCond is signaled whenever a
+    // job in checkedJobs becomes UpToDate.
+    Mutex mutex;
+    ConditionVariable jobCookedCond;
     HashMap<CheckedTraits> checkedJobs;
     HashMap<DeferredTraits> deferredJobs;
-
+    // Content hashes of files that were already hashed during this cook, along with the
+    // modification time and size they were hashed at. Protected by mutex.
+    HashMap<FileHashTraits> fileHashes;
+    // Used to detect dependency loops that span multiple threads. Protected by mutex.
+    Array<WaitingThread> waitingThreads;
+
+private:
+    bool beginJob(CookJob* job, bool waitIfInProgress);
+    bool isWaitingFor(TID::TID thread, TID::TID otherThread);
+    void cookJob(CookJob* job, TypedPtr jobArg);
+    void submitDeferredJobs(ThreadPool* pool);
+
+public:
     ~CookContext();
     void beginCook();
     void endCook();
+
+    // ensureCooked() may be called from multiple threads at once. If the job is already being
+    // cooked by another thread, it waits until that thread is finished.
     void ensureCooked(CookJob* job, TypedPtr jobArg = {});
-    void cookDeferred();
+
+    // Cooks every deferred job, including jobs that are deferred while cooking. If pool is
+    // non-null, independent jobs are cooked in parallel on the pool's worker threads. Must not be
+    // called from one of the pool's worker threads.
+    void cookDeferred(ThreadPool* pool = nullptr);
+
+    // Like cook(), but cooks a batch of jobs in parallel on the pool's worker threads. Returns the
+    // jobs in the same order as ids. Jobs that depend on each other through ensureCooked are still
+    // cooked in dependency order. Jobs deferred by these jobs are left for cookDeferred().
+    Array<Reference<CookJob>> cookInParallel(ThreadPool* pool, ArrayView<const CookJobID> ids);
     CookResult* getAlreadyCookedResult(const CookJobID& id);
     bool isCooked(CookJob* job);
 
+    PLY_INLINE bool isHashingFileContents() const {
+        return this->hashFileContents || this->cache;
+    }
+    // Returns the hash of a file's contents given its current status. The file is only read if it
+    // wasn't already hashed during this cook at the same modification time and size. Returns
+    // false if the file can't be read.
+    bool getFileContentHash(u128* hash, StringView path, const FileStatus& status);
+
     PLY_INLINE Reference<CookJob> cook(const CookJobID& id, TypedPtr jobArg = {}) {
         PLY_ASSERT(CookContext::current() == this);
         Reference<CookJob> cookJob = this->depTracker->getOrCreateCookJob(id);
@@ -0,0 +1,260 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-cook/Core.h>
+#include <ply-cook/CookJob.h>
+#include <ply-cook/Persist.h>
+#include <ply-reflect/TypeDescriptorOwner.h>
+#include <ply-runtime/algorithm/Find.h>
+
+namespace ply {
+namespace cook {
+
+//------------------------------------
+// Registered types
+//------------------------------------
+CookTypeRegistry::CookTypeRegistry() {
+    this->depTypes.append(&DependencyType_File);
+}
+
+CookTypeRegistry& CookTypeRegistry::get() {
+    static CookTypeRegistry registry;
+    return registry;
+}
+
+DependencyType* CookTypeRegistry::findDependencyType(TypeDescriptor* depType) const {
+    for (DependencyType* type : this->depTypes) {
+        if (type->depType == depType)
+            return type;
+    }
+    return nullptr;
+}
+
+void registerCookJobTypes(ArrayView<CookJobType* const> jobTypes) {
+    CookTypeRegistry& registry = CookTypeRegistry::get();
+    for (CookJobType* jobType : jobTypes) {
+        PLY_ASSERT(find(registry.jobTypes.ptrValues, (void*) jobType) < 0);
+        registry.jobTypes.enumeratorNames.append(jobType->name);
+        registry.jobTypes.ptrValues.append(jobType);
+    }
+    TypeDescriptor_StaticPtr* staticPtrType = TypeResolver<StaticPtr<CookJobType>>::get();
+    PLY_ASSERT(!staticPtrType->possibleValues || staticPtrType->possibleValues == &registry.jobTypes);
+    staticPtrType->possibleValues = &registry.jobTypes;
+}
+
+void registerDependencyTypes(ArrayView<DependencyType* const> depTypes) {
+    CookTypeRegistry& registry = CookTypeRegistry::get();
+    for (DependencyType* depType : depTypes) {
+        PLY_ASSERT(depType->depType);
+        PLY_ASSERT(find(registry.depTypes, depType) < 0);
+        registry.depTypes.append(depType);
+    }
+}
+
+//------------------------------------
+// Saved format
+//------------------------------------
+// CookResults and Dependencies are saved through OwnTypedPtr so that each one is written using
+// its own reflected subclass. Only the members of the subclass are written; the members of the
+// CookResult base class are stored alongside. References between jobs are saved as indices into
+// SavedDependencyTracker::jobs.
+struct SavedCookJob {
+    PLY_REFLECT()
+    CookJobID id;
+    bool hasResult = false;
+    OwnTypedPtr result; // Null if the result type is CookResult itself
+    Array<OwnTypedPtr> dependencies;
+    Array<u32> references;
+    Array<String> errors;
+    // ply reflect off
+};
+
+struct SavedDependencyTracker {
+    PLY_REFLECT()
+    Array<SavedCookJob> jobs;
+    Array<u32> rootReferences;
+    // ply reflect off
+
+    // The OwnTypedPtrs only borrow from the DependencyTracker while saving.
+    void releaseBorrowedPointers() {
+        for (SavedCookJob& savedJob : this->jobs) {
+            savedJob.result.ptr = nullptr;
+            for (OwnTypedPtr& dep : savedJob.dependencies) {
+                dep.ptr = nullptr;
+            }
+        }
+    }
+};
+
+TypeDescriptor* CookTypeResolver::getType(FormatDescriptor* formatDesc) {
+    if (formatDesc->formatKey != (u8) FormatKey::Struct)
+        return TypeResolver<EmptyType>::get();
+    StringView name = static_cast<FormatDescriptor_Struct*>(formatDesc)->name;
+    if (name == this->rootType->name)
+        return this->rootType;
+    const CookTypeRegistry& registry = CookTypeRegistry::get();
+    for (void* ptr : registry.jobTypes.ptrValues) {
+        TypeDescriptor* resultType = ((CookJobType*) ptr)->resultType;
+        if (name == resultType->cast<TypeDescriptor_Struct>()->name)
+            return resultType;
+    }
+    for (DependencyType* depType : registry.depTypes) {
+        if (name == depType->depType->cast<TypeDescriptor_Struct>()->name)
+            return depType->depType;
+    }
+    return TypeResolver<EmptyType>::get();
+}
+
+struct JobIndexTraits {
+    using Key = CookJob*;
+    struct Item {
+        CookJob* job;
+        u32 index;
+        PLY_INLINE Item(CookJob* job) : job{job}, index{0} {
+        }
+    };
+    static PLY_INLINE bool match(const Item& item, Key key) {
+        return item.job == key;
+    }
+};
+
+//------------------------------------
+// DependencyTracker
+//------------------------------------
+void DependencyTracker::save(OutStream* outs) {
+    LockGuard<Mutex> guard{this->allCookJobsMutex};
+    HashMap<JobIndexTraits> jobToIndex;
+    u32 numJobs = 0;
+    for (CookJob* job : this->allCookJobs) {
+        jobToIndex.insertOrFind(job)->index = numJobs++;
+    }
+    auto getIndex = [&](CookJob* job) {
+        auto cursor = jobToIndex.find(job);
+        PLY_ASSERT(cursor.wasFound());
+        return cursor->index;
+    };
+
+    SavedDependencyTracker saved;
+    saved.jobs.reserve(numJobs);
+    for (CookJob* job : this->allCookJobs) {
+        SavedCookJob& savedJob = saved.jobs.append();
+        savedJob.id = job->id;
+        CookResult* result = job->result;
+        if (!result)
+            continue;
+        bool canSave = true;
+        for (Dependency* dep : result->dependencies) {
+            if (!dep->type->depType) {
+                canSave = false;
+                break;
+            }
+        }
+        if (!canSave)
+            continue;
+
+        savedJob.hasResult = true;
+        TypeDescriptor* resultType = job->id.type->resultType;
+        if (resultType != TypeResolver<CookResult>::get()) {
+            savedJob.result = TypedPtr{result, resultType};
+        }
+        for (Dependency* dep : result->dependencies) {
+            savedJob.dependencies.append(TypedPtr{dep, dep->type->depType});
+        }
+        for (CookJob* refJob : result->references) {
+            savedJob.references.append(getIndex(refJob));
+        }
+        savedJob.errors = result->errors;
+    }
+    for (CookJob* rootJob : this->rootReferences) {
+        saved.rootReferences.append(getIndex(rootJob));
+    }
+
+    writeAsset(outs, TypedPtr::bind(&saved));
+    saved.releaseBorrowedPointers();
+}
+
+bool DependencyTracker::load(InStream* ins) {
+    PLY_ASSERT(this->allCookJobs.isEmpty());
+    // Loaded jobs that nothing refers to are destroyed, which requires a current DependencyTracker
+    PLY_SET_IN_SCOPE(current_, this);
+
+    CookTypeResolver resolver{TypeResolver<SavedDependencyTracker>::get()};
+    OwnTypedPtr obj = readAsset(ins, &resolver);
+    if (!obj.ptr || obj.type != TypeResolver<SavedDependencyTracker>::get())
+        return false;
+    SavedDependencyTracker* saved = (SavedDependencyTracker*) obj.ptr;
+    const CookTypeRegistry& registry = CookTypeRegistry::get();
+
+    // Create jobs and their results. Jobs whose type is no longer registered are dropped.
+    Array<Reference<CookJob>> jobs;
+    jobs.resize(saved->jobs.numItems());
+    for (u32 i = 0; i < saved->jobs.numItems(); i++) {
+        SavedCookJob& savedJob = saved->jobs[i];
+        if (!savedJob.id.type)
+            continue;
+        Reference<CookJob> job = this->getOrCreateCookJob(savedJob.id);
+        jobs[i] = job;
+        if (!savedJob.hasResult)
+            continue;
+
+        // If anything about the result can't be restored, leave the job without a result so
+        // that it's recooked.
+        TypeDescriptor* resultType = job->id.type->resultType;
+        bool isValid = (savedJob.result.type == (resultType != TypeResolver<CookResult>::get()
+                                                     ? resultType
+                                                     : nullptr));
+        for (const OwnTypedPtr& dep : savedJob.dependencies) {
+            if (!registry.findDependencyType(dep.type)) {
+                isValid = false;
+            }
+        }
+        if (!isValid)
+            continue;
+
+        CookResult* result;
+        if (savedJob.result.ptr) {
+            result = (CookResult*) savedJob.result.ptr;
+            savedJob.result.ptr = nullptr;
+        } else {
+            result = (CookResult*) TypedPtr::create(resultType).ptr;
+        }
+        job->result = result;
+        result->job = job;
+        for (OwnTypedPtr& dep : savedJob.dependencies) {
+            Dependency* loadedDep = (Dependency*) dep.ptr;
+            loadedDep->type = registry.findDependencyType(dep.type);
+            result->dependencies.append(loadedDep);
+            dep.ptr = nullptr;
+        }
+        result->errors = std::move(savedJob.errors);
+    }
+
+    // Link references. A job whose references can't all be restored is recooked.
+    for (u32 i = 0; i < saved->jobs.numItems(); i++) {
+        CookJob* job = jobs[i];
+        if (!job || !job->result)
+            continue;
+        for (u32 refIndex : saved->jobs[i].references) {
+            if (refIndex >= jobs.numItems() || !jobs[refIndex]) {
+                job->result = nullptr;
+                break;
+            }
+            job->result->references.append(jobs[refIndex]);
+        }
+    }
+
+    Array<Reference<CookJob>> rootRefs;
+    for (u32 refIndex : saved->rootReferences) {
+        if (refIndex < jobs.numItems() && jobs[refIndex]) {
+            rootRefs.append(jobs[refIndex]);
+        }
+    }
+    this->setRootReferences(std::move(rootRefs));
+    return true;
+}
+
+} // namespace cook
+} // namespace ply
+
+#include "codegen/Persist.inl" //%%
@@ -0,0 +1,35 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-cook/Core.h>
+#include <ply-cook/CookJob.h>
+#include <ply-reflect/Asset.h>
+
+namespace ply {
+namespace cook {
+
+// The CookJobTypes and DependencyTypes passed to registerCookJobTypes and registerDependencyTypes.
+struct CookTypeRegistry {
+    BaseStaticPtr::PossibleValues jobTypes;
+    Array<DependencyType*> depTypes;
+
+    CookTypeRegistry();
+    static CookTypeRegistry& get();
+    DependencyType* findDependencyType(TypeDescriptor* depType) const;
+};
+
+// Resolves saved struct names to rootType and to registered result types and dependency types.
+// Types that are no longer registered resolve to EmptyType, which causes their data to be skipped.
+class CookTypeResolver : public PersistentTypeResolver {
+public:
+    TypeDescriptor_Struct* rootType = nullptr;
+
+    PLY_INLINE CookTypeResolver(TypeDescriptor_Struct* rootType) : rootType{rootType} {
+    }
+    virtual TypeDescriptor* getType(FormatDescriptor* formatDesc) override;
+};
+
+} // namespace cook
+} // namespace ply
@@ -0,0 +1,181 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-cook/CookJob.h>
+#include <ply-cook/CookCache.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX CookCache_
+
+static constexpr u32 NumCachedFiles = 3;
+
+// Counts the lines in a file in cachedLineCountFolder
+struct CookResult_CachedLineCount : cook::CookResult {
+    PLY_REFLECT()
+    u32 numLines = 0;
+    // ply reflect off
+};
+
+PLY_STRUCT_BEGIN(CookResult_CachedLineCount)
+PLY_STRUCT_MEMBER(numLines)
+PLY_STRUCT_END()
+
+extern cook::CookJobType CookJobType_CachedLineCount;
+String cachedLineCountFolder;
+u32 numCachedLineCountJobsCooked = 0;
+
+void CachedLineCount_cook(cook::CookResult* cookResult_, TypedPtr) {
+    auto* result = static_cast<CookResult_CachedLineCount*>(cookResult_);
+    numCachedLineCountJobsCooked++;
+    Owned<InStream> ins = result->openFileAsDependency(
+        NativePath::join(cachedLineCountFolder, result->job->id.desc));
+    if (!ins)
+        return;
+    String contents = ins->readRemainingContents();
+    for (u32 i = 0; i < contents.numBytes; i++) {
+        if (contents[i] == '\n') {
+            result->numLines++;
+        }
+    }
+}
+
+cook::CookJobType CookJobType_CachedLineCount = {
+    "cachedLineCount",
+    TypeResolver<CookResult_CachedLineCount>::get(),
+    nullptr,
+    CachedLineCount_cook,
+};
+
+String getCacheTestFolder() {
+    return NativePath::join(PLY_WORKSPACE_FOLDER, "data/tests/cook/CookCache");
+}
+
+// Creates a workspace folder holding the source files. The first call also removes files left by
+// earlier runs and registers the job type.
+String initCacheTestWorkspace(StringView name) {
+    static bool registered = false;
+    if (!registered) {
+        cook::registerCookJobTypes({&CookJobType_CachedLineCount});
+        String testFolder = getCacheTestFolder();
+        if (FileSystem::native()->isDir(testFolder)) {
+            FileSystem::native()->removeDirTree(testFolder);
+        }
+        registered = true;
+    }
+    String workspace = NativePath::join(getCacheTestFolder(), name);
+    for (u32 i = 0; i < NumCachedFiles; i++) {
+        FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(
+            NativePath::join(workspace, String::format("file{}.txt", i)), StringView{"x\n"} * i);
+    }
+    return workspace;
+}
+
+// Cooks every job in the given workspace using a new DependencyTracker, and returns the number of
+// jobs cooked. Optionally returns each job's line count and the path of its file dependency.
+u32 cookWithCache(cook::CookCache* cache, StringView workspace, Array<u32>* lineCounts = nullptr,
+                  Array<String>* depPaths = nullptr) {
+    cachedLineCountFolder = workspace;
+    cook::DependencyTracker depTracker;
+    cook::CookContext ctx;
+    ctx.depTracker = &depTracker;
+    ctx.cache = cache;
+    ctx.beginCook();
+    numCachedLineCountJobsCooked = 0;
+    Array<Reference<cook::CookJob>> rootRefs;
+    for (u32 i = 0; i < NumCachedFiles; i++) {
+        rootRefs.append(
+            ctx.cook({&CookJobType_CachedLineCount, String::format("file{}.txt", i)}));
+    }
+    ctx.cookDeferred();
+    ctx.endCook();
+    depTracker.setRootReferences(std::move(rootRefs));
+
+    for (const cook::CookJob* job : depTracker.rootReferences) {
+        if (lineCounts) {
+            lineCounts->append(job->castResult<CookResult_CachedLineCount>()->numLines);
+        }
+        if (depPaths && job->result->dependencies.numItems() == 1) {
+            auto* depFile = static_cast<cook::Dependency_File*>(job->result->dependencies[0].get());
+            depPaths->append(depFile->path);
+        }
+    }
+    return numCachedLineCountJobsCooked;
+}
+
+PLY_TEST_CASE("CookCache hits when input files have the same contents") {
+    String workspace = initCacheTestWorkspace("hits");
+    cook::CookCache cache{NativePath::join(getCacheTestFolder(), "hitsCache"), workspace};
+    PLY_TEST_CHECK(cookWithCache(&cache, workspace) == NumCachedFiles);
+    PLY_TEST_CHECK(cache.getStats().numMisses == NumCachedFiles);
+    PLY_TEST_CHECK(cache.getStats().numStores == NumCachedFiles);
+
+    // Every job is loaded from the cache
+    Array<u32> lineCounts;
+    PLY_TEST_CHECK(cookWithCache(&cache, workspace, &lineCounts) == 0);
+    PLY_TEST_CHECK(lineCounts == ArrayView<const u32>{0, 1, 2});
+    PLY_TEST_CHECK(cache.getStats().numHits == NumCachedFiles);
+
+    // Change a file without changing its size. The job that depends on it misses.
+    String path = NativePath::join(workspace, "file1.txt");
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(path, "y\n");
+    PLY_TEST_CHECK(cookWithCache(&cache, workspace) == 1);
+    PLY_TEST_CHECK(cache.getStats().numHits == NumCachedFiles * 2 - 1);
+    PLY_TEST_CHECK(cache.getStats().numMisses == NumCachedFiles + 1);
+
+    // Restore the file. The earlier result is still in the cache.
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(path, "x\n");
+    PLY_TEST_CHECK(cookWithCache(&cache, workspace) == 0);
+    PLY_TEST_CHECK(cache.getStats().numHits == NumCachedFiles * 3 - 1);
+}
+
+PLY_TEST_CASE("CookCache results are shared between workspaces at different locations") {
+    String workspace = initCacheTestWorkspace("original");
+    String cachePath = NativePath::join(getCacheTestFolder(), "sharedCache");
+    {
+        cook::CookCache cache{cachePath, workspace};
+        PLY_TEST_CHECK(cookWithCache(&cache, workspace) == NumCachedFiles);
+    }
+
+    // A copy of the workspace hits, and the loaded dependencies refer to the copy
+    String copy = initCacheTestWorkspace("copy");
+    cook::CookCache cache{cachePath, copy};
+    Array<u32> lineCounts;
+    Array<String> depPaths;
+    PLY_TEST_CHECK(cookWithCache(&cache, copy, &lineCounts, &depPaths) == 0);
+    PLY_TEST_CHECK(cache.getStats().numHits == NumCachedFiles);
+    PLY_TEST_CHECK(lineCounts == ArrayView<const u32>{0, 1, 2});
+    PLY_TEST_CHECK(depPaths.numItems() == NumCachedFiles);
+    for (u32 i = 0; i < depPaths.numItems(); i++) {
+        PLY_TEST_CHECK(depPaths[i] == NativePath::join(copy, String::format("file{}.txt", i)));
+    }
+
+    // A copy whose contents differ misses
+    String modified = initCacheTestWorkspace("modified");
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(
+        NativePath::join(modified, "file2.txt"), "x\nx\nx\n");
+    cook::CookCache modifiedCache{cachePath, modified};
+    PLY_TEST_CHECK(cookWithCache(&modifiedCache, modified) == 1);
+    PLY_TEST_CHECK(modifiedCache.getStats().numHits == NumCachedFiles - 1);
+}
+
+PLY_TEST_CASE("CookCache stores paths relative to the workspace root") {
+    String workspace = NativePath::join(getCacheTestFolder(), "workspace");
+    cook::CookCache cache{NativePath::join(getCacheTestFolder(), "cache"), workspace};
+    String inside = NativePath::join(workspace, "sub/file.txt");
+    PLY_TEST_CHECK(cache.toCachedPath(inside) == NativePath::join("sub", "file.txt"));
+    PLY_TEST_CHECK(cache.fromCachedPath(cache.toCachedPath(inside)) == inside);
+
+    // Paths outside the workspace are kept absolute
+    String outside = NativePath::join(getCacheTestFolder(), "other/file.txt");
+    PLY_TEST_CHECK(cache.toCachedPath(outside) == outside);
+    PLY_TEST_CHECK(cache.fromCachedPath(outside) == outside);
+    String sibling = NativePath::join(getCacheTestFolder(), "workspace2/file.txt");
+    PLY_TEST_CHECK(cache.toCachedPath(sibling) == sibling);
+}
+
+} // namespace tests
+} // namespace ply
@@ -0,0 +1,147 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-cook/CookJob.h>
+#include <ply-runtime/algorithm/Find.h>
+#include <ply-runtime/thread/ThreadPool.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX CookContext_
+
+static constexpr u32 NumSumJobs = 200;
+
+// sum:N cooks sum:(N / 2) and sum:(N / 3) as dependencies, and references sum:(N + NumSumJobs)
+// without cooking it, so that job is deferred.
+struct CookResult_Sum : cook::CookResult {
+    PLY_REFLECT()
+    u64 value = 0;
+    u32 cookOrder = 0; // Position among all cooked jobs
+    // ply reflect off
+
+    // Keeps the dependencies alive
+    Array<Reference<cook::CookJob>> depJobs;
+};
+
+PLY_STRUCT_BEGIN(CookResult_Sum)
+PLY_STRUCT_MEMBER(value)
+PLY_STRUCT_MEMBER(cookOrder)
+PLY_STRUCT_END()
+
+extern cook::CookJobType CookJobType_Sum;
+Atomic<u32> numSumJobsCooked = 0;
+bool sumDepsWereCookedFirst = true;
+
+cook::CookJobID getSumJobID(u32 n) {
+    return {&CookJobType_Sum, String::from(n)};
+}
+
+void Sum_cook(cook::CookResult* cookResult_, TypedPtr) {
+    auto* result = static_cast<CookResult_Sum*>(cookResult_);
+    u32 n = result->job->id.desc.to<u32>();
+    result->value = n;
+    if (n < NumSumJobs) {
+        if (n > 0) {
+            for (u32 dep : {n / 2, n / 3}) {
+                Reference<cook::CookJob> depJob =
+                    cook::CookContext::current()->cook(getSumJobID(dep));
+                result->value += depJob->castResult<CookResult_Sum>()->value;
+                result->depJobs.append(std::move(depJob));
+            }
+        }
+        result->addReference(getSumJobID(n + NumSumJobs));
+    }
+    // Claim a position after the dependencies finished cooking
+    result->cookOrder = numSumJobsCooked.fetchAdd(1, Relaxed);
+}
+
+cook::CookJobType CookJobType_Sum = {
+    "sum",
+    TypeResolver<CookResult_Sum>::get(),
+    nullptr,
+    Sum_cook,
+};
+
+// Cooks every sum job, either serially or on a thread pool, and returns the resulting values
+Array<u64> cookSums(cook::DependencyTracker* depTracker, ThreadPool* pool) {
+    cook::CookContext ctx;
+    ctx.depTracker = depTracker;
+    ctx.beginCook();
+    Array<cook::CookJobID> ids;
+    for (u32 i = 0; i < NumSumJobs; i++) {
+        ids.append(getSumJobID(NumSumJobs - 1 - i));
+    }
+    Array<Reference<cook::CookJob>> rootRefs;
+    if (pool) {
+        rootRefs = ctx.cookInParallel(pool, ids);
+    } else {
+        for (const cook::CookJobID& id : ids) {
+            rootRefs.append(ctx.cook(id));
+        }
+    }
+    ctx.cookDeferred(pool);
+    ctx.endCook();
+    depTracker->setRootReferences(std::move(rootRefs));
+
+    // Check that every job was cooked after its dependencies
+    Array<u64> values;
+    for (u32 n = 0; n < NumSumJobs * 2; n++) {
+        cook::CookJob* job = depTracker->findCookJob(getSumJobID(n));
+        if (!job || !job->result) {
+            values.append(u64(-1));
+            continue;
+        }
+        const CookResult_Sum* result = job->castResult<CookResult_Sum>();
+        values.append(result->value);
+        if (n > 0 && n < NumSumJobs) {
+            for (u32 dep : {n / 2, n / 3}) {
+                const CookResult_Sum* depResult =
+                    depTracker->findCookJob(getSumJobID(dep))->castResult<CookResult_Sum>();
+                if (depResult->cookOrder >= result->cookOrder) {
+                    sumDepsWereCookedFirst = false;
+                }
+            }
+        }
+    }
+    return values;
+}
+
+PLY_TEST_CASE("Parallel and serial cooks produce the same results") {
+    Array<u64> serialValues;
+    {
+        cook::DependencyTracker depTracker;
+        numSumJobsCooked = 0;
+        serialValues = cookSums(&depTracker, nullptr);
+        PLY_TEST_CHECK(numSumJobsCooked.load(Relaxed) == NumSumJobs * 2);
+        PLY_TEST_CHECK(sumDepsWereCookedFirst);
+    }
+    PLY_TEST_CHECK(serialValues[0] == 0 && serialValues[1] == 1 && serialValues[6] == 14);
+    PLY_TEST_CHECK(serialValues[NumSumJobs] == NumSumJobs);
+    PLY_TEST_CHECK(find(serialValues, u64(-1)) < 0);
+
+    ThreadPool pool{8};
+    for (u32 i = 0; i < 10; i++) {
+        cook::DependencyTracker depTracker;
+        numSumJobsCooked = 0;
+        Array<u64> parallelValues = cookSums(&depTracker, &pool);
+        // Each job is cooked exactly once, even when several threads need it at the same time
+        PLY_TEST_CHECK(numSumJobsCooked.load(Relaxed) == NumSumJobs * 2);
+        PLY_TEST_CHECK(sumDepsWereCookedFirst);
+        PLY_TEST_CHECK(parallelValues == serialValues);
+    }
+}
+
+PLY_TEST_CASE("A parallel cook of up-to-date jobs cooks nothing") {
+    cook::DependencyTracker depTracker;
+    Array<u64> values = cookSums(&depTracker, nullptr);
+    ThreadPool pool{8};
+    numSumJobsCooked = 0;
+    PLY_TEST_CHECK(cookSums(&depTracker, &pool) == values);
+    PLY_TEST_CHECK(numSumJobsCooked.load(Relaxed) == 0);
+}
+
+} // namespace tests
+} // namespace ply
@@ -0,0 +1,167 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-cook/CookJob.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX DependencyTracker_
+
+static constexpr u32 NumLineCountFiles = 4;
+
+// Counts the lines in a file in lineCountFolder
+struct CookResult_TestLineCount : cook::CookResult {
+    PLY_REFLECT()
+    u32 numLines = 0;
+    // ply reflect off
+};
+
+PLY_STRUCT_BEGIN(CookResult_TestLineCount)
+PLY_STRUCT_MEMBER(numLines)
+PLY_STRUCT_END()
+
+extern cook::CookJobType CookJobType_TestLineCount;
+String lineCountFolder;
+u32 numLineCountJobsCooked = 0;
+
+void TestLineCount_cook(cook::CookResult* cookResult_, TypedPtr) {
+    auto* result = static_cast<CookResult_TestLineCount*>(cookResult_);
+    numLineCountJobsCooked++;
+    Owned<InStream> ins =
+        result->openFileAsDependency(NativePath::join(lineCountFolder, result->job->id.desc));
+    if (!ins)
+        return;
+    String contents = ins->readRemainingContents();
+    for (u32 i = 0; i < contents.numBytes; i++) {
+        if (contents[i] == '\n') {
+            result->numLines++;
+        }
+    }
+}
+
+cook::CookJobType CookJobType_TestLineCount = {
+    "testLineCount",
+    TypeResolver<CookResult_TestLineCount>::get(),
+    nullptr,
+    TestLineCount_cook,
+};
+
+String getLineCountFileName(u32 i) {
+    return String::format("file{}.txt", i);
+}
+
+// Creates the source files and registers the job type the first time it's called
+void initLineCountFiles() {
+    static bool registered = false;
+    if (!registered) {
+        cook::registerCookJobTypes({&CookJobType_TestLineCount});
+        registered = true;
+    }
+    lineCountFolder = NativePath::join(PLY_WORKSPACE_FOLDER, "data/tests/cook/DependencyTracker");
+    if (FileSystem::native()->isDir(lineCountFolder)) {
+        FileSystem::native()->removeDirTree(lineCountFolder);
+    }
+    for (u32 i = 0; i < NumLineCountFiles; i++) {
+        FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(
+            NativePath::join(lineCountFolder, getLineCountFileName(i)), StringView{"x\n"} * i);
+    }
+}
+
+// Cooks every job, plus one whose file is missing, and returns the number of jobs cooked
+u32 cookLineCounts(cook::DependencyTracker* depTracker) {
+    cook::CookContext ctx;
+    ctx.depTracker = depTracker;
+    ctx.beginCook();
+    Array<Reference<cook::CookJob>> rootRefs;
+    numLineCountJobsCooked = 0;
+    for (u32 i = 0; i <= NumLineCountFiles; i++) {
+        rootRefs.append(ctx.cook({&CookJobType_TestLineCount, getLineCountFileName(i)}));
+    }
+    ctx.cookDeferred();
+    ctx.endCook();
+    depTracker->setRootReferences(std::move(rootRefs));
+    return numLineCountJobsCooked;
+}
+
+// Returns the line count of every root job, or -1 if the job has no result
+Array<s32> getLineCounts(const cook::DependencyTracker* depTracker) {
+    Array<s32> lineCounts;
+    for (const cook::CookJob* job : depTracker->rootReferences) {
+        const CookResult_TestLineCount* result = job->castResult<CookResult_TestLineCount>();
+        lineCounts.append(result ? (s32) result->numLines : -1);
+    }
+    return lineCounts;
+}
+
+String saveToString(cook::DependencyTracker* depTracker) {
+    MemOutStream mout;
+    depTracker->save(&mout);
+    return mout.moveToString();
+}
+
+PLY_TEST_CASE("DependencyTracker save and load round trip") {
+    initLineCountFiles();
+    String saved;
+    {
+        cook::DependencyTracker depTracker;
+        PLY_TEST_CHECK(cookLineCounts(&depTracker) == NumLineCountFiles + 1);
+        PLY_TEST_CHECK(getLineCounts(&depTracker) == ArrayView<const s32>{0, 1, 2, 3, 0});
+        saved = saveToString(&depTracker);
+    }
+
+    cook::DependencyTracker depTracker;
+    ViewInStream vins{saved};
+    PLY_TEST_CHECK(depTracker.load(&vins));
+    PLY_TEST_CHECK(depTracker.rootReferences.numItems() == NumLineCountFiles + 1);
+    PLY_TEST_CHECK(getLineCounts(&depTracker) == ArrayView<const s32>{0, 1, 2, 3, 0});
+
+    // Dependencies and errors are restored
+    const cook::CookJob* job = depTracker.rootReferences[1];
+    PLY_TEST_CHECK(job->id.type == &CookJobType_TestLineCount);
+    PLY_TEST_CHECK(job->id.desc == "file1.txt");
+    PLY_TEST_CHECK(job->result->dependencies.numItems() == 1);
+    PLY_TEST_CHECK(job->result->errors.isEmpty());
+    const cook::CookJob* missingJob = depTracker.rootReferences[NumLineCountFiles];
+    PLY_TEST_CHECK(missingJob->result->errors.numItems() == 1);
+
+    // Saving the loaded DependencyTracker gives the same data
+    PLY_TEST_CHECK(saveToString(&depTracker) == saved);
+}
+
+PLY_TEST_CASE("A loaded DependencyTracker only recooks jobs whose files changed") {
+    initLineCountFiles();
+    String saved;
+    {
+        cook::DependencyTracker depTracker;
+        cookLineCounts(&depTracker);
+        saved = saveToString(&depTracker);
+    }
+
+    // Nothing changed. The job whose file is missing is recooked because its dependency is
+    // considered changed.
+    {
+        cook::DependencyTracker depTracker;
+        ViewInStream vins{saved};
+        PLY_TEST_CHECK(depTracker.load(&vins));
+        PLY_TEST_CHECK(cookLineCounts(&depTracker) == 1);
+        PLY_TEST_CHECK(getLineCounts(&depTracker) == ArrayView<const s32>{0, 1, 2, 3, 0});
+    }
+
+    // Change one file. Its size changes too, so the change is detected even if the modification
+    // time is the same.
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(
+        NativePath::join(lineCountFolder, getLineCountFileName(2)), "x\nx\nx\nx\nx\n");
+    {
+        cook::DependencyTracker depTracker;
+        ViewInStream vins{saved};
+        PLY_TEST_CHECK(depTracker.load(&vins));
+        PLY_TEST_CHECK(cookLineCounts(&depTracker) == 2);
+        PLY_TEST_CHECK(getLineCounts(&depTracker) == ArrayView<const s32>{0, 1, 5, 3, 0});
+    }
+}
+
+} // namespace tests
+} // namespace ply
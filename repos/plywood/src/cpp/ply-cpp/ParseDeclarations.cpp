@@ -323,6 +323,7 @@ void parseDeclarationList(Parser* parser, Token* outCloseCurly, StringView enclo
 }
 
 grammar::TranslationUnit parseTranslationUnit(Parser* parser) {
+    PLY_TRACE_ZONE("Parse C++ translation unit");
     grammar::TranslationUnit tu;
     parser->visor->doEnter(TypedPtr::bind(&tu));
     parseDeclarationList(parser, nullptr, {});
@@ -16,13 +16,18 @@ PLY_NO_INLINE void onGotInclude(ParseSupervisor* visor, StringView directive) {
 
 void parsePlywoodSrcFile(StringView absSrcPath, cpp::PPVisitedFiles* visitedFiles,
                          ParseSupervisor* visor) {
+    PLY_TRACE_ZONE("Parse Plywood source file");
     Preprocessor pp;
     pp.visitedFiles = visitedFiles;
 
     u32 sourceFileIdx = visitedFiles->sourceFiles.numItems();
     PPVisitedFiles::SourceFile& srcFile = visitedFiles->sourceFiles.append();
     srcFile.absPath = absSrcPath;
-    String src = FileSystem::native()->loadTextAutodetect(srcFile.absPath).first;
+    String src;
+    {
+        PLY_TRACE_ZONE("Load C++ source file");
+        src = FileSystem::native()->loadTextAutodetect(srcFile.absPath).first;
+    }
     if (FileSystem::native()->lastResult() != FSResult::OK) {
         struct ErrorWrapper : BaseError {
             String msg;
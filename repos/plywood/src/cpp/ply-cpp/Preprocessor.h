@@ -7,6 +7,7 @@
 #include <ply-cpp/Token.h>
 #include <ply-cpp/LinearLocation.h>
 #include <ply-cpp/Error.h>
+#include <ply-runtime/container/FlatHashMap.h>
 
 namespace ply {
 namespace cpp {
@@ -63,7 +64,7 @@ struct Preprocessor {
             return item.identifier == key;
         }
     };
-    HashMap<MacrosTraits> macros;
+    FlatHashMap<MacrosTraits> macros; // Looked up for every identifier token
 
     bool tokenizeCloseAnglesOnly = false;
     bool atStartOfLine = true;
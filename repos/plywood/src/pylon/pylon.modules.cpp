@@ -19,3 +19,11 @@ void module_pylonReflect(ModuleArgs* args) {
     args->addTarget(Visibility::Public, "pylon");
     args->addTarget(Visibility::Public, "reflect");
 }
+
+// [ply module="pylon-tests"]
+void module_pylonTests(ModuleArgs* args) {
+    args->buildTarget->targetType = BuildTargetType::ObjectLib;
+    args->addSourceFiles("tests");
+    args->addTarget(Visibility::Private, "pylon");
+    args->addTarget(Visibility::Private, "test");
+}
@@ -0,0 +1,158 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <pylon/Core.h>
+#include <pylon/Document.h>
+
+namespace pylon {
+
+//------------------------------------
+// DocArena
+//------------------------------------
+PLY_NO_INLINE DocArena::~DocArena() {
+    for (void* chunk : this->chunks) {
+        PLY_HEAP.free(chunk);
+    }
+}
+
+PLY_NO_INLINE void DocArena::operator=(DocArena&& other) {
+    this->~DocArena();
+    new (this) DocArena{std::move(other)};
+}
+
+PLY_NO_INLINE void* DocArena::allocSlow(u32 numBytes, u32 alignment) {
+    // Large blocks get a chunk of their own so that the rest of the current chunk isn't wasted
+    u32 chunkSize = numBytes + alignment;
+    if (chunkSize > this->nextChunkSize / 4) {
+        char* chunk = (char*) PLY_HEAP.alloc(chunkSize);
+        this->chunks.append(chunk);
+        return (void*) alignPowerOf2(uptr(chunk), alignment);
+    }
+    chunkSize = this->nextChunkSize;
+    this->nextChunkSize = min(this->nextChunkSize * 2, MaxChunkSize);
+    char* chunk = (char*) PLY_HEAP.alloc(chunkSize);
+    this->chunks.append(chunk);
+    this->curByte = chunk;
+    this->endByte = chunk + chunkSize;
+    return this->alloc(numBytes, alignment);
+}
+
+PLY_NO_INLINE StringView DocArena::copy(StringView view) {
+    char* bytes = (char*) this->alloc(view.numBytes, 1);
+    memcpy(bytes, view.bytes, view.numBytes);
+    return {bytes, view.numBytes};
+}
+
+//------------------------------------
+// DocNode
+//------------------------------------
+DocNode DocNode::InvalidNode;
+
+PLY_NO_INLINE Tuple<bool, double> DocNode::numeric() const {
+    if (this->type != (u64) Type::Text)
+        return {false, 0.0};
+
+    ViewInStream vins{this->text_};
+    double value = vins.parse<double>();
+    return {!vins.anyParseError(), value};
+}
+
+PLY_NO_INLINE const DocNode* DocNode::get(StringView key) const {
+    if (this->type != (u64) Type::Object)
+        return &InvalidNode;
+
+    if (!this->object_.index) {
+        for (u32 i = 0; i < this->object_.numItems; i++) {
+            if (this->object_.items[i].key == key)
+                return this->object_.items[i].value;
+        }
+        return &InvalidNode;
+    }
+
+    for (u32 slot = Hasher::hash(key);; slot++) {
+        u32 index = this->object_.index[slot & this->object_.indexMask];
+        if (index == InvalidIndex)
+            return &InvalidNode;
+        if (this->object_.items[index].key == key)
+            return this->object_.items[index].value;
+    }
+}
+
+PLY_NO_INLINE Owned<Node> DocNode::toNode() const {
+    switch ((Type) this->type) {
+        case Type::Text: {
+            return Node::createText(String{this->text_}, this->fileOfs);
+        }
+
+        case Type::Array: {
+            Owned<Node> dst = Node::createArray(this->fileOfs);
+            dst->array().reserve(this->array_.numItems);
+            for (const DocNode* item : this->arrayView()) {
+                dst->array().append(item->toNode());
+            }
+            return dst;
+        }
+
+        case Type::Object: {
+            Owned<Node> dst = Node::createObject(this->fileOfs);
+            for (const Item& item : this->object()) {
+                dst->set(String{item.key}, item.value->toNode());
+            }
+            return dst;
+        }
+
+        default: {
+            return Node::createInvalid();
+        }
+    }
+}
+
+//------------------------------------
+// Document
+//------------------------------------
+PLY_NO_INLINE DocNode* Document::createText(StringView text, u32 fileOfs) {
+    DocNode* node = this->arena.allocArray<DocNode>(1);
+    node->type = (u64) DocNode::Type::Text;
+    node->fileOfs = fileOfs;
+    node->text_ = text;
+    return node;
+}
+
+PLY_NO_INLINE DocNode* Document::createArray(ArrayView<DocNode* const> items, u32 fileOfs) {
+    DocNode* node = this->arena.allocArray<DocNode>(1);
+    node->type = (u64) DocNode::Type::Array;
+    node->fileOfs = fileOfs;
+    node->array_.items = this->arena.allocArray<DocNode*>(items.numItems);
+    memcpy(node->array_.items, items.items, sizeof(DocNode*) * items.numItems);
+    node->array_.numItems = items.numItems;
+    return node;
+}
+
+PLY_NO_INLINE DocNode* Document::createObject(ArrayView<const DocNode::Item> items, u32 fileOfs) {
+    DocNode* node = this->arena.allocArray<DocNode>(1);
+    node->type = (u64) DocNode::Type::Object;
+    node->fileOfs = fileOfs;
+    node->object_.items = this->arena.allocArray<DocNode::Item>(items.numItems);
+    memcpy(node->object_.items, items.items, sizeof(DocNode::Item) * items.numItems);
+    node->object_.numItems = items.numItems;
+    node->object_.indexMask = 0;
+    node->object_.index = nullptr;
+    if (items.numItems > DocNode::MaxLinearSearch) {
+        // Keep the index at most half full. Keys are already known to be unique.
+        u32 indexSize = roundUpPowerOf2(items.numItems * 2);
+        node->object_.indexMask = indexSize - 1;
+        node->object_.index = this->arena.allocArray<u32>(indexSize);
+        memset(node->object_.index, 0xff, indexSize * sizeof(u32));
+        for (u32 i = 0; i < items.numItems; i++) {
+            u32 slot = Hasher::hash(items[i].key);
+            while (node->object_.index[slot & node->object_.indexMask] != DocNode::InvalidIndex) {
+                slot++;
+            }
+            node->object_.index[slot & node->object_.indexMask] = i;
+        }
+    }
+    return node;
+}
+
+} // namespace pylon
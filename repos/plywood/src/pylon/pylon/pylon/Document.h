@@ -0,0 +1,182 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <pylon/Core.h>
+#include <pylon/Node.h>
+#include <ply-runtime/io/text/FileLocationMap.h>
+
+namespace pylon {
+
+//-----------------------------------------------------------------------
+// DocArena
+//
+// A bump allocator for the contents of a Document. Memory is allocated from chunks that are only
+// freed when the arena is destroyed.
+//-----------------------------------------------------------------------
+class DocArena {
+private:
+    static constexpr u32 MinChunkSize = 16384;
+    static constexpr u32 MaxChunkSize = 1048576;
+
+    Array<void*> chunks;
+    char* curByte = nullptr;
+    char* endByte = nullptr;
+    u32 nextChunkSize = MinChunkSize;
+
+    PYLON_ENTRY void* allocSlow(u32 numBytes, u32 alignment);
+
+public:
+    PLY_INLINE DocArena() = default;
+    PLY_INLINE DocArena(DocArena&& other)
+        : chunks{std::move(other.chunks)}, curByte{other.curByte}, endByte{other.endByte},
+          nextChunkSize{other.nextChunkSize} {
+        other.curByte = nullptr;
+        other.endByte = nullptr;
+    }
+    PYLON_ENTRY ~DocArena();
+    PYLON_ENTRY void operator=(DocArena&& other);
+
+    PLY_INLINE void* alloc(u32 numBytes, u32 alignment = PLY_PTR_SIZE) {
+        char* aligned = (char*) alignPowerOf2(uptr(this->curByte), alignment);
+        if (aligned + numBytes > this->endByte)
+            return this->allocSlow(numBytes, alignment);
+        this->curByte = aligned + numBytes;
+        return aligned;
+    }
+    template <typename T>
+    PLY_INLINE T* allocArray(u32 numItems) {
+        return (T*) this->alloc(sizeof(T) * numItems, alignof(T));
+    }
+    PYLON_ENTRY StringView copy(StringView view);
+};
+
+//-----------------------------------------------------------------------
+// DocNode
+//
+// A node in a Document. Nodes, along with their arrays and object items, are allocated from the
+// Document's arena and are never freed individually. Text and keys are views, either into the
+// source buffer or, if they contained escape sequences, into the arena.
+//-----------------------------------------------------------------------
+struct DocNode {
+    using Type = Node::Type;
+
+    struct Item {
+        StringView key;
+        DocNode* value;
+    };
+
+    u64 type : 4;
+    u64 fileOfs : 60;
+
+    union {
+        StringView text_;
+        struct {
+            DocNode** items;
+            u32 numItems;
+        } array_;
+        struct {
+            Item* items;
+            u32 numItems;
+            // Open-addressed table of indices into items, or null if the object is small enough to
+            // be searched linearly. Empty slots hold InvalidIndex.
+            u32 indexMask;
+            u32* index;
+        } object_;
+    };
+
+    static constexpr u32 InvalidIndex = u32(-1);
+    static constexpr u32 MaxLinearSearch = 8;
+    static DocNode InvalidNode;
+
+    // Nodes in a Document are created by Document's create functions, which don't call this.
+    PLY_INLINE DocNode() : type{(u64) Type::Invalid}, fileOfs{0}, text_{} {
+    }
+
+    PLY_INLINE bool isValid() const {
+        return this->type != (u64) Type::Invalid;
+    }
+
+    //-----------------------------------------------------------
+    // Text
+    //-----------------------------------------------------------
+    PLY_INLINE bool isText() const {
+        return this->type == (u64) Type::Text;
+    }
+    PLY_INLINE StringView text() const {
+        if (this->type == (u64) Type::Text) {
+            return this->text_;
+        } else {
+            return {};
+        }
+    }
+    PYLON_ENTRY Tuple<bool, double> numeric() const;
+
+    //-----------------------------------------------------------
+    // Array
+    //-----------------------------------------------------------
+    PLY_INLINE bool isArray() const {
+        return this->type == (u64) Type::Array;
+    }
+    PLY_INLINE const DocNode* get(u32 i) const {
+        if (this->type != (u64) Type::Array || i >= this->array_.numItems)
+            return &InvalidNode;
+        return this->array_.items[i];
+    }
+    PLY_INLINE ArrayView<const DocNode* const> arrayView() const {
+        if (this->type == (u64) Type::Array) {
+            return {this->array_.items, this->array_.numItems};
+        } else {
+            return {};
+        }
+    }
+
+    //-----------------------------------------------------------
+    // Object
+    //-----------------------------------------------------------
+    PLY_INLINE bool isObject() const {
+        return this->type == (u64) Type::Object;
+    }
+    PYLON_ENTRY const DocNode* get(StringView key) const;
+    PLY_INLINE ArrayView<const Item> object() const {
+        if (this->type == (u64) Type::Object) {
+            return {this->object_.items, this->object_.numItems};
+        } else {
+            return {};
+        }
+    }
+
+    // Makes an owned copy of this subtree.
+    PYLON_ENTRY Owned<Node> toNode() const;
+};
+
+//-----------------------------------------------------------------------
+// Document
+//
+// The result of Parser::parseDocument. All of the document's nodes live in its arena, so parsing
+// doesn't make a heap allocation per node, and destroying the document frees everything at once.
+// The document may refer to the source buffer, so the source must outlive the document unless
+// ownership of it was passed to parseDocument.
+//-----------------------------------------------------------------------
+struct Document {
+    DocArena arena;
+    HybridString src;
+    DocNode* root = &DocNode::InvalidNode;
+    FileLocationMap fileLocMap;
+
+    PLY_INLINE Document() = default;
+    PLY_INLINE Document(Document&&) = default;
+    PLY_INLINE Document& operator=(Document&&) = default;
+
+    PLY_INLINE bool isValid() const {
+        return this->root->isValid();
+    }
+
+    // Used by Parser::parseDocument.
+    PYLON_ENTRY DocNode* createText(StringView text, u32 fileOfs);
+    PYLON_ENTRY DocNode* createArray(ArrayView<DocNode* const> items, u32 fileOfs);
+    PYLON_ENTRY DocNode* createObject(ArrayView<const DocNode::Item> items, u32 fileOfs);
+};
+
+} // namespace pylon
@@ -51,12 +51,10 @@ void Parser::error(u32 fileOfs, HybridString&& message) {
 }
 
 void Parser::advanceChar() {
-    if (readOfs + 1 < srcView.numBytes) {
+    if (readOfs < srcView.numBytes) {
         readOfs++;
-        nextUnit = srcView.bytes[readOfs];
-    } else {
-        nextUnit = -1;
     }
+    nextUnit = readOfs < srcView.numBytes ? srcView.bytes[readOfs] : -1;
 }
 
 Parser::Token Parser::readPlainToken(Token::Type type) {
@@ -72,6 +70,25 @@ bool Parser::readEscapedHex(OutStream* outs, u32 escapeFileOfs) {
 
 Parser::Token Parser::readQuotedString() {
     PLY_ASSERT(nextUnit == '"' || nextUnit == '\'');
+
+    // Fast path: When parsing a Document, a single-line string without escape sequences becomes a
+    // view into the source. Empty and multiline strings take the slow path.
+    u32 ofs = this->readOfs + 1;
+    if (this->viewQuotedStrings && ofs < srcView.numBytes && srcView[ofs] != nextUnit) {
+        for (; ofs < srcView.numBytes; ofs++) {
+            char c = srcView[ofs];
+            if (c == nextUnit) {
+                Token token = {Token::Type::Text, this->readOfs,
+                               srcView.subStr(this->readOfs + 1, ofs - this->readOfs - 1)};
+                this->readOfs = ofs;
+                advanceChar();
+                return token;
+            }
+            if (c == '\\' || c == '\n' || c == '\r')
+                break;
+        }
+    }
+
     Token token = {Token::Type::Text, this->readOfs, {}};
     MemOutStream outs;
     NativeEndianWriter wr{&outs};
@@ -207,7 +224,7 @@ Parser::Token Parser::readLiteral() {
     Token token = {Token::Text, this->readOfs, {}};
     u32 startOfs = readOfs;
 
-    while (isAlnumUnit(nextUnit)) {
+    while (nextUnit != -1 && isAlnumUnit(nextUnit)) {
         advanceChar();
     }
 
@@ -302,24 +319,24 @@ HybridString Parser::toString(const Token& token) {
     }
 }
 
-HybridString Parser::toString(const Node* node) {
-    switch ((Node::Type) node->type) {
+HybridString Parser::toString(Node::Type type, StringView text) {
+    switch (type) {
         case Node::Type::Object:
             return "object";
         case Node::Type::Array:
             return "array";
         case Node::Type::Text:
-            return String::format("text \"{}\"", fmt::EscapedString{node->text(), 20});
+            return String::format("text \"{}\"", fmt::EscapedString{text, 20});
         default:
             PLY_ASSERT(0);
             return "???";
     }
 }
 
-Owned<Node> Parser::readObject(const Token& startToken) {
-    PLY_ASSERT(startToken.type == Token::OpenCurly);
-    ScopeHandler objectScope{*this, ParseError::Scope::object(startToken.fileOfs)};
-    Owned<Node> node = Node::createObject(startToken.fileOfs);
+//------------------------------------
+// NodeBuilder
+//------------------------------------
+struct Parser::NodeBuilder {
     struct PropLocationTraits {
         using Key = StringView;
         struct Item {
@@ -330,7 +347,241 @@ Owned<Node> Parser::readObject(const Token& startToken) {
             return item.name.view() == key;
         }
     };
+
+    using Value = Owned<Node>;
+    struct Object {
+        Owned<Node> node;
+        HashMap<PropLocationTraits> propLocations;
+    };
+    using Array = Owned<Node>;
+
+    static PLY_INLINE bool isValid(const Value& value) {
+        return value && value->isValid();
+    }
+    static PLY_INLINE HybridString toString(const Value& value) {
+        return Parser::toString((Node::Type) value->type, value->text());
+    }
+    PLY_INLINE Value createText(Token&& token) {
+        return Node::createText(std::move(token.text), token.fileOfs);
+    }
+
+    PLY_INLINE Object beginObject(u32 fileOfs) {
+        return {Node::createObject(fileOfs), {}};
+    }
+    // Called before the property's value is read. Returns the file offset of the existing property
+    // if key is a duplicate, otherwise -1.
+    PLY_INLINE s32 beginProperty(Object& obj, Token& key) {
+        auto cursor = obj.propLocations.insertOrFind(key.text);
+        if (cursor.wasFound())
+            return cursor->fileOfs;
+        cursor->name = key.text.view();
+        cursor->fileOfs = key.fileOfs;
+        return -1;
+    }
+    // Returns a view of the key that remains valid while the object exists.
+    PLY_INLINE StringView endProperty(Object& obj, Token&& key, Value&& value) {
+        obj.node->set(std::move(key.text), std::move(value));
+        return obj.node->object().items.back().key;
+    }
+    PLY_INLINE Value endObject(Object&& obj) {
+        return std::move(obj.node);
+    }
+
+    PLY_INLINE Array beginArray(u32 fileOfs) {
+        return Node::createArray(fileOfs);
+    }
+    PLY_INLINE void addItem(Array& arr, Value&& value) {
+        arr->array().append(std::move(value));
+    }
+    PLY_INLINE Value endArray(Array&& arr) {
+        return std::move(arr);
+    }
+};
+
+//------------------------------------
+// DocBuilder
+//------------------------------------
+// Items of the arrays and objects being read are accumulated on shared stacks, then copied into
+// the arena when the array or object ends.
+struct Parser::DocBuilder {
+    // Used to detect duplicate properties in large objects. Small objects are searched linearly.
+    struct PropLocationTraits {
+        struct Key {
+            u32 objectID;
+            StringView name;
+        };
+        struct Item {
+            u32 objectID;
+            StringView name;
+            u32 fileOfs;
+            PLY_INLINE Item(const Key& key) : objectID{key.objectID}, name{key.name} {
+            }
+        };
+        static PLY_INLINE u32 hash(const Key& key) {
+            Hasher h;
+            h << key.objectID << key.name;
+            return h.result();
+        }
+        static PLY_INLINE bool match(const Item& item, const Key& key) {
+            return item.objectID == key.objectID && item.name == key.name;
+        }
+    };
+
+    using Value = DocNode*;
+    struct Object {
+        u32 fileOfs;
+        u32 start;
+        u32 objectID;
+    };
+    struct Array {
+        u32 fileOfs;
+        u32 start;
+    };
+
+    Document* doc = nullptr;
+    ply::Array<DocNode*> itemStack;
+    ply::Array<DocNode::Item> propStack;
+    ply::Array<u32> propOfsStack; // File offset of each key in propStack
     HashMap<PropLocationTraits> propLocations;
+    u32 numObjects = 0;
+
+    static PLY_INLINE bool isValid(Value value) {
+        return value && value->isValid();
+    }
+    static PLY_INLINE HybridString toString(Value value) {
+        return Parser::toString((Node::Type) value->type, value->text());
+    }
+    // Views into the source are kept as-is. Strings that had to be unescaped are moved into the
+    // arena.
+    PLY_INLINE StringView keep(HybridString& text) {
+        return text.isOwner ? this->doc->arena.copy(text) : text.view();
+    }
+    PLY_INLINE Value createText(Token&& token) {
+        return this->doc->createText(this->keep(token.text), token.fileOfs);
+    }
+
+    PLY_INLINE Object beginObject(u32 fileOfs) {
+        return {fileOfs, this->propStack.numItems(), this->numObjects++};
+    }
+    // The key is moved into the arena first, so that the map never refers to a temporary buffer.
+    PLY_NO_INLINE s32 beginProperty(Object& obj, Token& key) {
+        key.text = this->keep(key.text);
+        u32 numProps = this->propStack.numItems() - obj.start;
+        if (numProps < DocNode::MaxLinearSearch) {
+            for (u32 i = obj.start; i < this->propStack.numItems(); i++) {
+                if (this->propStack[i].key == key.text)
+                    return this->propOfsStack[i];
+            }
+            return -1;
+        }
+        if (numProps == DocNode::MaxLinearSearch) {
+            // The object just got large. Move its existing properties to the map.
+            for (u32 i = obj.start; i < this->propStack.numItems(); i++) {
+                this->propLocations.insertOrFind({obj.objectID, this->propStack[i].key})->fileOfs =
+                    this->propOfsStack[i];
+            }
+        }
+        auto cursor = this->propLocations.insertOrFind({obj.objectID, key.text.view()});
+        if (cursor.wasFound())
+            return cursor->fileOfs;
+        cursor->fileOfs = key.fileOfs;
+        return -1;
+    }
+    PLY_INLINE StringView endProperty(Object&, Token&& key, Value&& value) {
+        StringView name = key.text.view(); // Already kept by beginProperty
+        this->propStack.append({name, value});
+        this->propOfsStack.append(key.fileOfs);
+        return name;
+    }
+    PLY_INLINE Value endObject(Object&& obj) {
+        if (this->propStack.numItems() - obj.start > DocNode::MaxLinearSearch) {
+            // Remove the object's properties from the map, so that it doesn't keep growing
+            for (u32 i = obj.start; i < this->propStack.numItems(); i++) {
+                auto cursor = this->propLocations.find({obj.objectID, this->propStack[i].key});
+                PLY_ASSERT(cursor.wasFound());
+                cursor.erase();
+            }
+        }
+        DocNode* node = this->doc->createObject(this->propStack.subView(obj.start), obj.fileOfs);
+        this->propStack.resize(obj.start);
+        this->propOfsStack.resize(obj.start);
+        return node;
+    }
+
+    PLY_INLINE Array beginArray(u32 fileOfs) {
+        return {fileOfs, this->itemStack.numItems()};
+    }
+    PLY_INLINE void addItem(Array&, Value&& value) {
+        this->itemStack.append(value);
+    }
+    PLY_INLINE Value endArray(Array&& arr) {
+        DocNode* node = this->doc->createArray(this->itemStack.subView(arr.start), arr.fileOfs);
+        this->itemStack.resize(arr.start);
+        return node;
+    }
+};
+
+//------------------------------------
+// EventBuilder
+//------------------------------------
+// Forwards everything to a ParseEventHandler. Values only carry their type.
+struct Parser::EventBuilder {
+    using Value = Node::Type;
+    struct Object {
+        HybridString lastKey; // Keeps the key returned by endProperty alive
+    };
+    using Array = Node::Type;
+
+    ParseEventHandler* handler = nullptr;
+
+    static PLY_INLINE bool isValid(Value value) {
+        return value != Node::Type::Invalid;
+    }
+    static PLY_INLINE HybridString toString(Value value) {
+        return Parser::toString(value, {});
+    }
+    PLY_INLINE Value createText(Token&& token) {
+        this->handler->text(token.text, token.fileOfs);
+        return Node::Type::Text;
+    }
+
+    PLY_INLINE Object beginObject(u32 fileOfs) {
+        this->handler->beginObject(fileOfs);
+        return {};
+    }
+    PLY_INLINE s32 beginProperty(Object&, Token& key) {
+        this->handler->key(key.text, key.fileOfs);
+        return -1;
+    }
+    PLY_INLINE StringView endProperty(Object& obj, Token&& key, Value&&) {
+        obj.lastKey = std::move(key.text);
+        return obj.lastKey;
+    }
+    PLY_INLINE Value endObject(Object&&) {
+        this->handler->endObject();
+        return Node::Type::Object;
+    }
+
+    PLY_INLINE Array beginArray(u32 fileOfs) {
+        this->handler->beginArray(fileOfs);
+        return Node::Type::Array;
+    }
+    PLY_INLINE void addItem(Array&, Value&&) {
+    }
+    PLY_INLINE Value endArray(Array&&) {
+        this->handler->endArray();
+        return Node::Type::Array;
+    }
+};
+
+//------------------------------------
+// Parser
+//------------------------------------
+template <typename Builder>
+typename Builder::Value Parser::readObject(Builder& builder, const Token& startToken) {
+    PLY_ASSERT(startToken.type == Token::OpenCurly);
+    ScopeHandler objectScope{*this, ParseError::Scope::object(startToken.fileOfs)};
+    typename Builder::Object obj = builder.beginObject(startToken.fileOfs);
     Token prevProperty = {};
     for (;;) {
         bool gotSeparator = false;
@@ -339,7 +590,7 @@ Owned<Node> Parser::readObject(const Token& startToken) {
             firstToken = readToken(true);
             switch (firstToken.type) {
                 case Token::CloseCurly:
-                    return node;
+                    return builder.endObject(std::move(obj));
 
                 case Token::Comma:
                 case Token::Semicolon:
@@ -373,10 +624,9 @@ Owned<Node> Parser::readObject(const Token& startToken) {
             return {};
         }
 
-        auto propLocationCursor = propLocations.insertOrFind(firstToken.text);
-        if (propLocationCursor.wasFound()) {
-            ScopeHandler duplicateScope{*this,
-                                        ParseError::Scope::duplicate(propLocationCursor->fileOfs)};
+        s32 existingOfs = builder.beginProperty(obj, firstToken);
+        if (existingOfs >= 0) {
+            ScopeHandler duplicateScope{*this, ParseError::Scope::duplicate((u32) existingOfs)};
             error(firstToken.fileOfs, String::format("Duplicate property \"{}\"",
                                                       fmt::EscapedString{firstToken.text, 20}));
             return {};
@@ -394,30 +644,29 @@ Owned<Node> Parser::readObject(const Token& startToken) {
             // Read value of property
             ScopeHandler propertyScope{
                 *this, ParseError::Scope::property(firstToken.fileOfs, firstToken.text)};
-            Owned<Node> value = readExpression(readToken(), &colon);
-            if (!value->isValid())
+            typename Builder::Value value = readExpression(builder, readToken(), &colon);
+            if (!builder.isValid(value))
                 return value;
-            propLocationCursor->name = firstToken.text.view();
-            propLocationCursor->fileOfs = firstToken.fileOfs;
-            node->set(std::move(firstToken.text), std::move(value));
+            u32 nameOfs = firstToken.fileOfs;
+            StringView name = builder.endProperty(obj, std::move(firstToken), std::move(value));
+            prevProperty = {Token::Text, nameOfs, name};
         }
-
-        prevProperty = std::move(firstToken);
     }
     return {};
 }
 
-Owned<Node> Parser::readArray(const Token& startToken) {
+template <typename Builder>
+typename Builder::Value Parser::readArray(Builder& builder, const Token& startToken) {
     PLY_ASSERT(startToken.type == Token::OpenSquare);
     ScopeHandler arrayScope{*this, ParseError::Scope::array(startToken.fileOfs, 0)};
-    Owned<Node> arrayNode = Node::createArray(startToken.fileOfs);
+    typename Builder::Array arr = builder.beginArray(startToken.fileOfs);
     Token sepTokenHolder;
     Token* sepToken = nullptr;
     for (;;) {
         Token token = readToken(true);
         switch (token.type) {
             case Token::CloseSquare:
-                return arrayNode;
+                return builder.endArray(std::move(arr));
 
             case Token::Comma:
             case Token::Semicolon:
@@ -427,10 +676,10 @@ Owned<Node> Parser::readArray(const Token& startToken) {
                 break;
 
             default: {
-                Owned<Node> value = readExpression(std::move(token), sepToken);
-                if (!value->isValid())
+                typename Builder::Value value = readExpression(builder, std::move(token), sepToken);
+                if (!builder.isValid(value))
                     return value;
-                arrayNode->array().append(std::move(value));
+                builder.addItem(arr, std::move(value));
                 arrayScope.get().index++;
                 sepToken = nullptr;
                 break;
@@ -439,16 +688,18 @@ Owned<Node> Parser::readArray(const Token& startToken) {
     }
 }
 
-Owned<Node> Parser::readExpression(Token&& firstToken, const Token* afterToken) {
+template <typename Builder>
+typename Builder::Value Parser::readExpression(Builder& builder, Token&& firstToken,
+                                               const Token* afterToken) {
     switch (firstToken.type) {
         case Token::OpenCurly:
-            return readObject(firstToken);
+            return readObject(builder, firstToken);
 
         case Token::OpenSquare:
-            return readArray(firstToken);
+            return readArray(builder, firstToken);
 
         case Token::Text:
-            return Node::createText(std::move(firstToken.text), firstToken.fileOfs);
+            return builder.createText(std::move(firstToken));
 
         case Token::Invalid:
             return {};
@@ -465,25 +716,55 @@ Owned<Node> Parser::readExpression(Token&& firstToken, const Token* afterToken)
     }
 }
 
-Parser::Result Parser::parse(StringView srcView_) {
+template <typename Builder>
+typename Builder::Value Parser::readRoot(Builder& builder, StringView srcView_) {
     srcView = srcView_;
+    readOfs = 0;
     nextUnit = srcView.numBytes > 0 ? srcView[0] : -1;
 
     this->fileLocMap = FileLocationMap::fromView(srcView_);
 
     Token rootToken = readToken();
-    Owned<Node> root = readExpression(std::move(rootToken));
-    if (!root->isValid())
+    typename Builder::Value root = readExpression(builder, std::move(rootToken));
+    if (!builder.isValid(root))
         return {};
 
     Token nextToken = readToken();
     if (nextToken.type != Token::EndOfFile) {
-        error(nextToken.fileOfs,
-              String::format("Unexpected {} after {}", toString(nextToken), toString(root)));
+        error(nextToken.fileOfs, String::format("Unexpected {} after {}", toString(nextToken),
+                                                builder.toString(root)));
         return {};
     }
+    return root;
+}
 
+Parser::Result Parser::parse(StringView srcView_) {
+    NodeBuilder builder;
+    Owned<Node> root = readRoot(builder, srcView_);
+    if (!root)
+        return {};
     return {std::move(root), std::move(this->fileLocMap)};
 }
 
+Document Parser::parseDocument(HybridString&& src) {
+    Document doc;
+    doc.src = std::move(src);
+    DocBuilder builder;
+    builder.doc = &doc;
+    PLY_SET_IN_SCOPE(this->viewQuotedStrings, true);
+    DocNode* root = readRoot(builder, doc.src);
+    if (root) {
+        doc.root = root;
+        doc.fileLocMap = std::move(this->fileLocMap);
+    }
+    return doc;
+}
+
+bool Parser::parseEvents(StringView srcView_, ParseEventHandler* handler) {
+    EventBuilder builder;
+    builder.handler = handler;
+    PLY_SET_IN_SCOPE(this->viewQuotedStrings, true);
+    return builder.isValid(readRoot(builder, srcView_));
+}
+
 } // namespace pylon
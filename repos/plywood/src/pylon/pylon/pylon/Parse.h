@@ -5,6 +5,7 @@
 #pragma once
 #include <pylon/Core.h>
 #include <pylon/Node.h>
+#include <pylon/Document.h>
 #include <ply-runtime/io/OutStream.h>
 #include <ply-runtime/io/text/FileLocationMap.h>
 
@@ -37,6 +38,24 @@ struct ParseError {
     const Array<Scope>& context;
 };
 
+//-----------------------------------------------------------------------
+// ParseEventHandler
+//
+// Receives events from Parser::parseEvents as the source is tokenized. A property's key event is
+// followed by the events for its value. Views passed to the handler are only valid for the duration
+// of the call.
+//-----------------------------------------------------------------------
+struct ParseEventHandler {
+    virtual ~ParseEventHandler() {
+    }
+    virtual void beginObject(u32 fileOfs) = 0;
+    virtual void key(StringView key, u32 fileOfs) = 0;
+    virtual void endObject() = 0;
+    virtual void beginArray(u32 fileOfs) = 0;
+    virtual void endArray() = 0;
+    virtual void text(StringView text, u32 fileOfs) = 0;
+};
+
 class Parser {
 private:
     struct Token {
@@ -71,6 +90,9 @@ private:
     u32 readOfs = 0;
     s32 nextUnit = 0;
     u32 tabSize = 4;
+    // Set by parseDocument and parseEvents. Node trees can outlive the source, so parse() copies
+    // quoted strings.
+    bool viewQuotedStrings = false;
     Token pushBackToken;
     Array<ParseError::Scope> context;
 
@@ -106,10 +128,22 @@ private:
     Token readLiteral();
     Token readToken(bool tokenizeNewLine = false);
     static HybridString toString(const Token& token);
-    static HybridString toString(const Node* node);
-    Owned<Node> readObject(const Token& startToken);
-    Owned<Node> readArray(const Token& startToken);
-    Owned<Node> readExpression(Token&& firstToken, const Token* afterToken = nullptr);
+    static HybridString toString(Node::Type type, StringView text);
+
+    // readObject, readArray and readExpression are shared by parse(), parseDocument() and
+    // parseEvents(). The Builder creates the nodes, or in the case of EventBuilder, sends events.
+    struct NodeBuilder;
+    struct DocBuilder;
+    struct EventBuilder;
+    template <typename Builder>
+    typename Builder::Value readObject(Builder& builder, const Token& startToken);
+    template <typename Builder>
+    typename Builder::Value readArray(Builder& builder, const Token& startToken);
+    template <typename Builder>
+    typename Builder::Value readExpression(Builder& builder, Token&& firstToken,
+                                           const Token* afterToken = nullptr);
+    template <typename Builder>
+    typename Builder::Value readRoot(Builder& builder, StringView srcView_);
 
 public:
     PLY_INLINE void setTabSize(int tabSize_) {
@@ -130,6 +164,16 @@ public:
     void dumpError(const ParseError& error, OutStream& outs) const;
 
     Result parse(StringView srcView_);
+
+    // Parses into a Document, whose nodes are allocated from an arena instead of the heap. Text
+    // and keys that don't contain escape sequences are views into src. If src is passed as a
+    // view, it must outlive the Document.
+    Document parseDocument(HybridString&& src);
+
+    // Sends events to handler without building a tree. Returns false if there was a parse error, in
+    // which case the events received so far don't form a complete value. Duplicate properties are
+    // not detected.
+    bool parseEvents(StringView srcView_, ParseEventHandler* handler);
 };
 
 } // namespace pylon
@@ -99,6 +99,57 @@ PLY_NO_INLINE TypeDescriptorOwner* convertTypeFrom(const Node* aNode,
     return importer.typeOwner;
 }
 
+// Handles the types that are imported from text. Returns false if obj isn't one of those types.
+PLY_NO_INLINE bool convertFromText(TypedPtr obj, StringView text) {
+    auto numeric = [&] {
+        ViewInStream vins{text};
+        double value = vins.parse<double>();
+        PLY_ASSERT(!vins.anyParseError());
+        return value;
+    };
+
+    if (obj.type->typeKey == &TypeKey_Float) {
+        *(float*) obj.ptr = (float) numeric();
+    } else if (obj.type->typeKey == &TypeKey_U8) {
+        *(u8*) obj.ptr = (u8) numeric();
+    } else if (obj.type->typeKey == &TypeKey_U16) {
+        *(u16*) obj.ptr = (u16) numeric();
+    } else if (obj.type->typeKey == &TypeKey_Bool) {
+        *(bool*) obj.ptr = text == "true";
+    } else if (obj.type->typeKey == &TypeKey_U32) {
+        *(u32*) obj.ptr = (u32) numeric();
+    } else if (obj.type->typeKey == &TypeKey_S32) {
+        *(s32*) obj.ptr = (s32) numeric();
+    } else if (obj.type->typeKey == &TypeKey_String) {
+        *(String*) obj.ptr = text;
+    } else if (obj.type->typeKey == &TypeKey_Enum) {
+        auto* enumDesc = obj.type->cast<TypeDescriptor_Enum>();
+        bool found = false;
+        for (const auto& identifier : enumDesc->identifiers) {
+            if (identifier.name == text) {
+                if (enumDesc->fixedSize == 1) {
+                    PLY_ASSERT(identifier.value <= UINT8_MAX);
+                    *(u8*) obj.ptr = (u8) identifier.value;
+                } else if (enumDesc->fixedSize == 2) {
+                    PLY_ASSERT(identifier.value <= UINT16_MAX);
+                    *(u16*) obj.ptr = (u16) identifier.value;
+                } else if (enumDesc->fixedSize == 4) {
+                    *(u32*) obj.ptr = identifier.value;
+                } else {
+                    PLY_ASSERT(0);
+                }
+                found = true;
+                break;
+            }
+        }
+        PLY_ASSERT(found);
+        PLY_UNUSED(found);
+    } else {
+        return false;
+    }
+    return true;
+}
+
 PLY_NO_INLINE void convertFrom(TypedPtr obj, const Node* aNode,
                                const Functor<TypeFromName>& typeFromName) {
     auto error = [&] {}; // FIXME: Decide where these go
@@ -106,6 +157,9 @@ PLY_NO_INLINE void convertFrom(TypedPtr obj, const Node* aNode,
     PLY_ASSERT(aNode->isValid());
     // FIXME: Handle errors gracefully by logging a message, returning false and marking the
     // cook as failed (instead of asserting).
+    if (aNode->isText() && convertFromText(obj, aNode->text()))
+        return;
+
     if (obj.type->typeKey == &TypeKey_Struct) {
         PLY_ASSERT(aNode->isObject());
         auto* structDesc = obj.type->cast<TypeDescriptor_Struct>();
@@ -116,28 +170,6 @@ PLY_NO_INLINE void convertFrom(TypedPtr obj, const Node* aNode,
                 convertFrom(m, aMember, typeFromName);
             }
         }
-    } else if (obj.type->typeKey == &TypeKey_Float) {
-        Tuple<bool, double> pair = aNode->numeric();
-        PLY_ASSERT(pair.first);
-        *(float*) obj.ptr = (float) pair.second;
-    } else if (obj.type->typeKey == &TypeKey_U8) {
-        Tuple<bool, double> pair = aNode->numeric();
-        PLY_ASSERT(pair.first);
-        *(u8*) obj.ptr = (u8) pair.second;
-    } else if (obj.type->typeKey == &TypeKey_U16) {
-        Tuple<bool, double> pair = aNode->numeric();
-        PLY_ASSERT(pair.first);
-        *(u16*) obj.ptr = (u16) pair.second;
-    } else if (obj.type->typeKey == &TypeKey_Bool) {
-        *(bool*) obj.ptr = aNode->text() == "true";
-    } else if (obj.type->typeKey == &TypeKey_U32) {
-        Tuple<bool, double> pair = aNode->numeric();
-        PLY_ASSERT(pair.first);
-        *(u32*) obj.ptr = (u32) pair.second;
-    } else if (obj.type->typeKey == &TypeKey_S32) {
-        Tuple<bool, double> pair = aNode->numeric();
-        PLY_ASSERT(pair.first);
-        *(s32*) obj.ptr = (s32) pair.second;
     } else if (obj.type->typeKey == &TypeKey_FixedArray) {
         PLY_ASSERT(aNode->isArray());
         auto* fixedArrType = obj.type->cast<TypeDescriptor_FixedArray>();
@@ -147,11 +179,7 @@ PLY_NO_INLINE void convertFrom(TypedPtr obj, const Node* aNode,
             convertFrom(elem, aNode->get(i), typeFromName);
         }
     } else if (obj.type->typeKey == &TypeKey_String) {
-        if (aNode->isText()) {
-            *(String*) obj.ptr = aNode->text();
-        } else {
-            error();
-        }
+        error(); // Not text
     } else if (obj.type->typeKey == &TypeKey_Array) {
         PLY_ASSERT(aNode->isArray());
         ArrayView<const Node* const> aNodeArr = aNode->arrayView();
@@ -183,29 +211,6 @@ PLY_NO_INLINE void convertFrom(TypedPtr obj, const Node* aNode,
                 convertFrom(m, aMember, typeFromName);
             }
         }
-    } else if (obj.type->typeKey == &TypeKey_Enum) {
-        PLY_ASSERT(aNode->isText());
-        auto* enumDesc = obj.type->cast<TypeDescriptor_Enum>();
-        bool found = false;
-        for (const auto& identifier : enumDesc->identifiers) {
-            if (identifier.name == aNode->text()) {
-                if (enumDesc->fixedSize == 1) {
-                    PLY_ASSERT(identifier.value <= UINT8_MAX);
-                    *(u8*) obj.ptr = (u8) identifier.value;
-                } else if (enumDesc->fixedSize == 2) {
-                    PLY_ASSERT(identifier.value <= UINT16_MAX);
-                    *(u16*) obj.ptr = (u16) identifier.value;
-                } else if (enumDesc->fixedSize == 4) {
-                    *(u32*) obj.ptr = identifier.value;
-                } else {
-                    PLY_ASSERT(0);
-                }
-                found = true;
-                break;
-            }
-        }
-        PLY_ASSERT(found);
-        PLY_UNUSED(found);
     } else if (obj.type->typeKey == &TypeKey_SavedTypedPtr) {
         PLY_ASSERT(aNode->isObject());
         TypeDescriptorOwner* targetTypeOwner = convertTypeFrom(aNode->get("type"), typeFromName);
@@ -266,4 +271,233 @@ PLY_NO_INLINE void importInto(TypedPtr obj, const Node* aRoot,
     convertFrom(obj, aRoot, typeFromName);
 }
 
+//-----------------------------------------------------------------------
+// StreamingImporter
+//-----------------------------------------------------------------------
+// Writes parse events directly into the target object. Values that don't correspond to a member of
+// the target are skipped. SavedTypedPtr and TypedArray values need their "type" property before
+// they can be imported, and it might come last, so they're captured as a Node and passed to
+// convertFrom.
+struct StreamingImporter : ParseEventHandler {
+    enum class Kind { Struct, EnumIndexedArray, Switch, Array, FixedArray, Capture };
+    struct Frame {
+        Kind kind;
+        TypedPtr obj;
+        u32 index = 0;    // Next item of an array, or the member after the last one found
+        Owned<Node> node; // Capture only
+        HybridString key; // Capture only: key of the next property
+    };
+
+    const Functor<TypeFromName>& typeFromName;
+    Array<Frame> stack;
+    TypedPtr nextValue; // Destination of the next value, or null if it should be skipped
+    u32 skipDepth = 0;  // Nesting depth within a skipped object or array
+
+    PLY_INLINE StreamingImporter(TypedPtr root, const Functor<TypeFromName>& typeFromName)
+        : typeFromName{typeFromName}, nextValue{root} {
+    }
+
+    PLY_INLINE bool isCapturing() const {
+        return !this->stack.isEmpty() && this->stack.back().kind == Kind::Capture;
+    }
+
+    // Returns the destination of a value that's about to be read.
+    PLY_NO_INLINE TypedPtr takeTarget() {
+        TypedPtr target;
+        if (this->stack.isEmpty() || this->stack.back().kind < Kind::Array) {
+            target = this->nextValue;
+            this->nextValue = {};
+        } else {
+            Frame& frame = this->stack.back();
+            u32 i = frame.index++;
+            if (frame.kind == Kind::Array) {
+                auto* arrType = static_cast<TypeDescriptor_Array*>(frame.obj.type);
+                details::BaseArray* arr = (details::BaseArray*) frame.obj.ptr;
+                u32 itemSize = arrType->itemType->fixedSize;
+                if (i >= arr->m_numItems) {
+                    arr->reserveIncrement(itemSize);
+                    TypedPtr{PLY_PTR_OFFSET(arr->m_items, itemSize * i), arrType->itemType}
+                        .construct();
+                    arr->m_numItems++;
+                }
+                target = {PLY_PTR_OFFSET(arr->m_items, itemSize * i), arrType->itemType};
+            } else {
+                auto* fixedArrType = frame.obj.type->cast<TypeDescriptor_FixedArray>();
+                if (i < fixedArrType->numItems) {
+                    target = {PLY_PTR_OFFSET(frame.obj.ptr, fixedArrType->itemType->fixedSize * i),
+                              fixedArrType->itemType};
+                }
+            }
+        }
+        while (target.ptr && target.type->typeKey == &TypeKey_Owned) {
+            auto* ownedDesc = target.type->cast<TypeDescriptor_Owned>();
+            TypedPtr created = TypedPtr::create(ownedDesc->targetType);
+            *(void**) target.ptr = created.ptr;
+            target = created;
+        }
+        return target;
+    }
+
+    PLY_NO_INLINE TypedPtr findMember(Frame& frame, StringView key) {
+        if (frame.kind == Kind::Struct) {
+            // Members are usually written in order, so start after the last one found.
+            auto* structDesc = frame.obj.type->cast<TypeDescriptor_Struct>();
+            u32 numMembers = structDesc->members.numItems();
+            for (u32 j = 0; j < numMembers; j++) {
+                u32 i = (frame.index + j) % numMembers;
+                const TypeDescriptor_Struct::Member& member = structDesc->members[i];
+                if (member.name == key) {
+                    frame.index = i + 1;
+                    return {PLY_PTR_OFFSET(frame.obj.ptr, member.offset), member.type};
+                }
+            }
+        } else if (frame.kind == Kind::EnumIndexedArray) {
+            auto* arrayDesc = frame.obj.type->cast<TypeDescriptor_EnumIndexedArray>();
+            for (const TypeDescriptor_Enum::Identifier& identifier :
+                 arrayDesc->enumType->identifiers) {
+                if (identifier.name == key) {
+                    return {PLY_PTR_OFFSET(frame.obj.ptr,
+                                           arrayDesc->itemType->fixedSize * identifier.value),
+                            arrayDesc->itemType};
+                }
+            }
+        } else {
+            PLY_ASSERT(frame.kind == Kind::Switch);
+            PLY_ASSERT(frame.index++ == 0); // Must have exactly one property
+            auto* switchDesc = frame.obj.type->cast<TypeDescriptor_Switch>();
+            for (u32 i = 0; i < switchDesc->states.numItems(); i++) {
+                const TypeDescriptor_Switch::State& state = switchDesc->states[i];
+                if (state.name == key) {
+                    switchDesc->ensureStateIs(frame.obj, (u16) i);
+                    return {PLY_PTR_OFFSET(frame.obj.ptr, switchDesc->storageOffset),
+                            state.structType};
+                }
+            }
+            PLY_ASSERT(0); // Unrecognized state
+        }
+        return {};
+    }
+
+    PLY_NO_INLINE void addToCapture(Owned<Node>&& node) {
+        Frame& frame = this->stack.back();
+        if (frame.node->isArray()) {
+            frame.node->array().append(std::move(node));
+        } else {
+            frame.node->set(std::move(frame.key), std::move(node));
+        }
+    }
+
+    static PLY_INLINE Owned<Node> createNode(bool isObject, u32 fileOfs) {
+        return isObject ? Node::createObject(fileOfs) : Node::createArray(fileOfs);
+    }
+
+    PLY_NO_INLINE void beginContainer(bool isObject, u32 fileOfs) {
+        if (this->skipDepth > 0) {
+            this->skipDepth++;
+            return;
+        }
+        if (this->isCapturing()) {
+            this->stack.append({Kind::Capture, {}, 0, createNode(isObject, fileOfs), {}});
+            return;
+        }
+        TypedPtr target = this->takeTarget();
+        if (!target.ptr) {
+            this->skipDepth = 1;
+            return;
+        }
+        TypeKey* typeKey = target.type->typeKey;
+        if (isObject) {
+            if (typeKey == &TypeKey_Struct) {
+                this->stack.append({Kind::Struct, target, 0, nullptr, {}});
+            } else if (typeKey == &TypeKey_EnumIndexedArray) {
+                this->stack.append({Kind::EnumIndexedArray, target, 0, nullptr, {}});
+            } else if (typeKey == &TypeKey_Switch) {
+                this->stack.append({Kind::Switch, target, 0, nullptr, {}});
+            } else if (typeKey == &TypeKey_SavedTypedPtr || typeKey == &TypeKey_TypedArray) {
+                this->stack.append({Kind::Capture, target, 0, createNode(isObject, fileOfs), {}});
+            } else {
+                PLY_ASSERT(0); // Can't import an object into this type
+                this->skipDepth = 1;
+            }
+        } else {
+            if (typeKey == &TypeKey_Array) {
+                this->stack.append({Kind::Array, target, 0, nullptr, {}});
+            } else if (typeKey == &TypeKey_FixedArray) {
+                this->stack.append({Kind::FixedArray, target, 0, nullptr, {}});
+            } else {
+                PLY_ASSERT(0); // Can't import an array into this type
+                this->skipDepth = 1;
+            }
+        }
+    }
+
+    PLY_NO_INLINE void endContainer() {
+        if (this->skipDepth > 0) {
+            this->skipDepth--;
+            return;
+        }
+        Frame frame = std::move(this->stack.back());
+        this->stack.pop();
+        if (frame.kind == Kind::Array) {
+            // Remove any items that were there before the import
+            auto* arrType = static_cast<TypeDescriptor_Array*>(frame.obj.type);
+            details::BaseArray* arr = (details::BaseArray*) frame.obj.ptr;
+            u32 itemSize = arrType->itemType->fixedSize;
+            for (u32 i = frame.index; i < arr->m_numItems; i++) {
+                TypedPtr{PLY_PTR_OFFSET(arr->m_items, itemSize * i), arrType->itemType}.destruct();
+            }
+            arr->realloc(frame.index, itemSize);
+        } else if (frame.kind == Kind::Capture) {
+            if (this->isCapturing()) {
+                this->addToCapture(std::move(frame.node));
+            } else {
+                convertFrom(frame.obj, frame.node, this->typeFromName);
+            }
+        }
+    }
+
+    virtual void beginObject(u32 fileOfs) override {
+        this->beginContainer(true, fileOfs);
+    }
+    virtual void key(StringView key, u32) override {
+        if (this->skipDepth > 0)
+            return;
+        Frame& frame = this->stack.back();
+        if (frame.kind == Kind::Capture) {
+            frame.key = String{key};
+        } else {
+            this->nextValue = this->findMember(frame, key);
+        }
+    }
+    virtual void endObject() override {
+        this->endContainer();
+    }
+    virtual void beginArray(u32 fileOfs) override {
+        this->beginContainer(false, fileOfs);
+    }
+    virtual void endArray() override {
+        this->endContainer();
+    }
+    virtual void text(StringView text, u32 fileOfs) override {
+        if (this->skipDepth > 0)
+            return;
+        if (this->isCapturing()) {
+            this->addToCapture(Node::createText(String{text}, fileOfs));
+            return;
+        }
+        TypedPtr target = this->takeTarget();
+        if (target.ptr) {
+            bool converted = convertFromText(target, text);
+            PLY_ASSERT(converted); // Can't import text into this type
+            PLY_UNUSED(converted);
+        }
+    }
+};
+
+PLY_NO_INLINE bool importInto(Parser& parser, TypedPtr obj, StringView src,
+                              const Functor<TypeFromName>& typeFromName) {
+    StreamingImporter importer{obj, typeFromName};
+    return parser.parseEvents(src, &importer);
+}
+
 } // namespace pylon
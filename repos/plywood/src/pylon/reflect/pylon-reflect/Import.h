@@ -5,6 +5,7 @@
 #pragma once
 #include <pylon-reflect/Core.h>
 #include <pylon/Node.h>
+#include <pylon/Parse.h>
 #include <ply-reflect/TypeDescriptor.h>
 #include <ply-reflect/TypeKey.h>
 #include <ply-runtime/container/Owned.h>
@@ -17,6 +18,11 @@ OwnTypedPtr import(TypeDescriptor* typeDesc, const pylon::Node* aRoot,
 void importInto(TypedPtr obj, const pylon::Node* aRoot,
                 const Functor<TypeFromName>& typeFromName = {});
 
+// Parses src and writes it directly into obj, without building a Node tree first. Errors are
+// reported to parser's error callback; if there's an error, obj may be partially imported.
+bool importInto(Parser& parser, TypedPtr obj, StringView src,
+                const Functor<TypeFromName>& typeFromName = {});
+
 template <typename T>
 PLY_INLINE Owned<T> import(const pylon::Node* aRoot,
                            const Functor<TypeFromName>& typeFromName = {}) {
@@ -0,0 +1,65 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <pylon/Parse.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX Document_
+
+// Returns a large object whose keys all contain escape sequences, so that they're unescaped into
+// temporary buffers by the tokenizer
+String makeEscapedObject(u32 numProps, StringView extra = {}) {
+    MemOutStream mout;
+    mout << "{\n";
+    for (u32 i = 0; i < numProps; i++) {
+        mout.format("  \"key\\t{}\": {}\n", i, i);
+    }
+    mout << extra << "}\n";
+    return mout.moveToString();
+}
+
+PLY_TEST_CASE("parseDocument finds escaped keys in a large object") {
+    pylon::Parser parser;
+    pylon::Document doc = parser.parseDocument(makeEscapedObject(20));
+    PLY_TEST_CHECK(!parser.anyError());
+    PLY_TEST_CHECK(doc.root->object().numItems == 20);
+    PLY_TEST_CHECK(doc.root->get("key\t0")->text() == "0");
+    PLY_TEST_CHECK(doc.root->get("key\t19")->text() == "19");
+}
+
+PLY_TEST_CASE("parseDocument detects duplicate escaped keys") {
+    for (u32 numProps : {16, 20}) {
+        pylon::Parser parser;
+        String message;
+        parser.setErrorCallback([&](const pylon::ParseError& err) {
+            if (message.isEmpty()) {
+                message = err.message;
+            }
+        });
+        String src = makeEscapedObject(numProps, "  \"key\\t15\": 0\n");
+        pylon::Document doc = parser.parseDocument(std::move(src));
+        PLY_TEST_CHECK(parser.anyError());
+        PLY_TEST_CHECK(message == "Duplicate property \"key\\t15\"");
+    }
+}
+
+PLY_TEST_CASE("parseDocument allows the same keys in sibling objects") {
+    MemOutStream mout;
+    mout << "[\n";
+    for (u32 i = 0; i < 10; i++) {
+        mout << makeEscapedObject(20) << "\n";
+    }
+    mout << "]\n";
+    pylon::Parser parser;
+    pylon::Document doc = parser.parseDocument(mout.moveToString());
+    PLY_TEST_CHECK(!parser.anyError());
+    PLY_TEST_CHECK(doc.root->arrayView().numItems == 10);
+    PLY_TEST_CHECK(doc.root->get(9)->get("key\t5")->text() == "5");
+}
+
+} // namespace tests
+} // namespace ply
@@ -62,11 +62,68 @@ struct LoadPtrResolver {
     u32 objDataOffset = 0;
 };
 
+//--------------------------------------------------------------------
+// ReadPlan
+//
+// A flat list of operations that reads a struct saved with a given FormatDescriptor_Struct into a
+// given TypeDescriptor_Struct. Members are matched by name once, when the plan is compiled, instead
+// of every time a struct is read. Nested structs are inlined, and neighbouring members that are
+// saved exactly as they're laid out in memory are merged into a single Copy.
+//
+struct ReadPlan {
+    enum class OpCode : u8 {
+        Copy,          // Read size bytes directly into the destination
+        Convert,       // Read size numbers, stride bytes apart, and convert them with readNumeric()
+        Skip,          // Skip a saved member that has no match in the destination struct
+        Read,          // Read a member with its TypeKey
+        PostSerialize, // Call the onPostSerialize() hook of a struct
+    };
+
+    struct Op {
+        OpCode opCode;
+        u32 dstOffset;
+        u32 size;
+        u32 stride;
+        TypeDescriptor* type;
+        FormatDescriptor* formatDesc;
+    };
+
+    FormatDescriptor_Struct* structFormat;
+    TypeDescriptor_Struct* structType;
+    Array<Op> ops;
+
+    PLY_INLINE ReadPlan(FormatDescriptor_Struct* structFormat, TypeDescriptor_Struct* structType)
+        : structFormat{structFormat}, structType{structType} {
+    }
+};
+
 struct ReadObjectContext {
+    // Plans are compiled the first time each FormatDescriptor_Struct is read into each
+    // TypeDescriptor_Struct
+    struct ReadPlanTraits {
+        struct Key {
+            FormatDescriptor_Struct* structFormat;
+            TypeDescriptor_Struct* structType;
+        };
+        using Item = Owned<ReadPlan>;
+        static PLY_INLINE u32 hash(const Key& key) {
+            Hasher hasher;
+            hasher << key.structFormat << key.structType;
+            return hasher.result();
+        }
+        static PLY_INLINE bool match(const Item& item, const Key& key) {
+            return item->structFormat == key.structFormat && item->structType == key.structType;
+        }
+        static PLY_INLINE void construct(Item* item, const Key& key) {
+            new (item) Item{new ReadPlan{key.structFormat, key.structType}};
+        }
+    };
+
     const Schema* schema;
     NativeEndianReader in;
     PersistentTypeResolver* typeResolver;
     LoadPtrResolver ptrResolver;
+    HashMap<ReadPlanTraits> readPlans;
 
     ReadObjectContext(const Schema* schema, InStream* in, PersistentTypeResolver* typeResolver)
         : schema(schema), in(in), typeResolver(typeResolver) {
@@ -68,6 +68,9 @@ WriteFormatContext::WriteFormatContext(OutStream* out) : m_out{out} {
             m_typeToFormatID[builtin.type] = (u32) builtin.key;
         }
     }
+    // OwnTypedPtr is written using the same built-in format as SavedTypedPtr. It must not be
+    // assigned a user formatID, since readSchema doesn't create one for built-in formats.
+    m_typeToFormatID[TypeResolver<OwnTypedPtr>::get()] = (u32) FormatKey::Typed;
 }
 
 u32 WriteFormatContext::addOrGetFormatID(TypeDescriptor* typeDesc) {
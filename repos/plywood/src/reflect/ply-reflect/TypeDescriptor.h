@@ -419,14 +419,18 @@ struct TypeDescriptor_Struct : TypeDescriptor {
     Array<TemplateParam> templateParams;
     Array<Member> members;
 
-    // Use expression SFINAE to invoke the object's onPostSerialize() function, if present:
+    // Use expression SFINAE to invoke the object's onPostSerialize() function, if present.
+    // Structs without one keep noPostSerialize, so that callers can skip them.
+    static void noPostSerialize(void*) {
+    }
     template <class T>
-    static auto invokePostSerialize(T* obj) -> decltype(obj->onPostSerialize()) {
-        return obj->onPostSerialize();
+    static auto getPostSerialize(T* obj) -> decltype(obj->onPostSerialize(), &noPostSerialize) {
+        return [](void* ptr) { ((T*) ptr)->onPostSerialize(); };
     }
-    inline static void invokePostSerialize(...) {
+    static auto getPostSerialize(...) -> decltype(&noPostSerialize) {
+        return noPostSerialize;
     }
-    void (*onPostSerialize)(void* ptr) = [](void*) {};
+    void (*onPostSerialize)(void* ptr) = noPostSerialize;
 
     // Constructor for synthesized TypeDescriptor_Struct:
     TypeDescriptor_Struct(u32 fixedSize, StringView name)
@@ -438,7 +442,7 @@ struct TypeDescriptor_Struct : TypeDescriptor {
     TypeDescriptor_Struct(T*, StringView name, std::initializer_list<Member> members = {})
         : TypeDescriptor{&TypeKey_Struct, sizeof(T), NativeBindings::make<T>()}, name{name},
           members{members} {
-        onPostSerialize = [](void* ptr) { invokePostSerialize((T*) ptr); };
+        onPostSerialize = getPostSerialize((T*) nullptr);
     }
 
     void appendMember(StringView name, TypeDescriptor* type) {
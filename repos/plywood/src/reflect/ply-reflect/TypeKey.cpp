@@ -174,6 +174,258 @@ TypeKey TypeKey_String{[](TypedPtr obj, WriteObjectContext* context) {
                        },
                        TypeKey::hashEmptyDescriptor, TypeKey::alwaysEqualDescriptors};
 
+//-----------------------------------------------------------------
+// Bulk copying
+//
+// Arrays whose items are saved exactly as they're laid out in memory are written and read with a
+// single copy instead of one TypeKey call per item. This covers numeric types, and fixed arrays
+// and structs made only of numeric types with no padding. The format is native-endian, so the
+// bytes never need to be swapped.
+//
+// Bool is excluded because readNumeric() normalizes its value.
+//
+static FormatKey getBulkFormatKey(const TypeKey* typeKey) {
+    static const TypeKey* const typeKeys[] = {&TypeKey_S8,  &TypeKey_S16,   &TypeKey_S32,
+                                              &TypeKey_S64, &TypeKey_U8,    &TypeKey_U16,
+                                              &TypeKey_U32, &TypeKey_U64,   &TypeKey_Float,
+                                              &TypeKey_Double};
+    static const FormatKey formatKeys[] = {FormatKey::S8,  FormatKey::S16,   FormatKey::S32,
+                                           FormatKey::S64, FormatKey::U8,    FormatKey::U16,
+                                           FormatKey::U32, FormatKey::U64,   FormatKey::Float,
+                                           FormatKey::Double};
+    for (u32 i = 0; i < PLY_STATIC_ARRAY_SIZE(typeKeys); i++) {
+        if (typeKey == typeKeys[i])
+            return formatKeys[i];
+    }
+    return FormatKey::None;
+}
+
+// Returns the size of an item of the given type if write() saves its memory as-is, or 0 otherwise.
+static u32 getBulkItemSize(const TypeDescriptor* type) {
+    if (getBulkFormatKey(type->typeKey) != FormatKey::None)
+        return type->fixedSize;
+    if (type->typeKey == &TypeKey_FixedArray) {
+        const auto* fixedArrayType = type->cast<const TypeDescriptor_FixedArray>();
+        u32 itemSize = getBulkItemSize(fixedArrayType->itemType);
+        if (itemSize == 0 || fixedArrayType->stride != itemSize)
+            return 0;
+        return itemSize * fixedArrayType->numItems;
+    }
+    if (type->typeKey == &TypeKey_Struct) {
+        const auto* structType = type->cast<const TypeDescriptor_Struct>();
+        u32 offset = 0;
+        for (const TypeDescriptor_Struct::Member& member : structType->members) {
+            u32 memberSize = getBulkItemSize(member.type);
+            if (memberSize == 0 || member.offset != offset)
+                return 0;
+            offset += memberSize;
+        }
+        return offset == type->fixedSize ? offset : 0;
+    }
+    return 0;
+}
+
+// Returns the size of an item of the given type if items saved with the given format can be read
+// into its memory as-is, or 0 otherwise.
+static u32 getBulkItemSize(const TypeDescriptor* type, const FormatDescriptor* format) {
+    FormatKey formatKey = getBulkFormatKey(type->typeKey);
+    if (formatKey != FormatKey::None)
+        return (FormatKey) format->formatKey == formatKey ? type->fixedSize : 0;
+    if (type->typeKey == &TypeKey_FixedArray) {
+        if ((FormatKey) format->formatKey != FormatKey::FixedArray)
+            return 0;
+        const auto* fixedArrayType = type->cast<const TypeDescriptor_FixedArray>();
+        const auto* fixedFormat = (const FormatDescriptor_FixedArray*) format;
+        u32 itemSize = getBulkItemSize(fixedArrayType->itemType, fixedFormat->itemFormat);
+        if (itemSize == 0 || fixedArrayType->stride != itemSize ||
+            fixedFormat->numItems != fixedArrayType->numItems)
+            return 0;
+        return itemSize * fixedArrayType->numItems;
+    }
+    if (type->typeKey == &TypeKey_Struct) {
+        if ((FormatKey) format->formatKey != FormatKey::Struct)
+            return 0;
+        const auto* structType = type->cast<const TypeDescriptor_Struct>();
+        const auto* structFormat = (const FormatDescriptor_Struct*) format;
+        if (structFormat->members.numItems() != structType->members.numItems())
+            return 0;
+        u32 offset = 0;
+        for (u32 i = 0; i < structType->members.numItems(); i++) {
+            const TypeDescriptor_Struct::Member& member = structType->members[i];
+            const FormatDescriptor_Struct::Member& memberFormat = structFormat->members[i];
+            if (memberFormat.name != member.name)
+                return 0;
+            u32 memberSize = getBulkItemSize(member.type, memberFormat.formatDesc);
+            if (memberSize == 0 || member.offset != offset)
+                return 0;
+            offset += memberSize;
+        }
+        return offset == type->fixedSize ? offset : 0;
+    }
+    return 0;
+}
+
+// Returns true if any struct in an item of the given type has an onPostSerialize() hook
+static bool needsPostSerialize(const TypeDescriptor* type) {
+    if (type->typeKey == &TypeKey_FixedArray)
+        return needsPostSerialize(type->cast<const TypeDescriptor_FixedArray>()->itemType);
+    if (type->typeKey == &TypeKey_Struct) {
+        const auto* structType = type->cast<const TypeDescriptor_Struct>();
+        if (structType->onPostSerialize != TypeDescriptor_Struct::noPostSerialize)
+            return true;
+        for (const TypeDescriptor_Struct::Member& member : structType->members) {
+            if (needsPostSerialize(member.type))
+                return true;
+        }
+    }
+    return false;
+}
+
+// After a bulk read, calls the onPostSerialize() hook of every struct in the item, as the struct's
+// read() would have.
+static void postSerializeBulkItem(TypeDescriptor* type, void* item) {
+    if (type->typeKey == &TypeKey_FixedArray) {
+        TypeDescriptor_FixedArray* fixedArrayType = type->cast<TypeDescriptor_FixedArray>();
+        if (getBulkFormatKey(fixedArrayType->itemType->typeKey) != FormatKey::None)
+            return;
+        for (u32 i = 0; i < fixedArrayType->numItems; i++) {
+            postSerializeBulkItem(fixedArrayType->itemType,
+                                  PLY_PTR_OFFSET(item, fixedArrayType->stride * i));
+        }
+    } else if (type->typeKey == &TypeKey_Struct) {
+        TypeDescriptor_Struct* structType = type->cast<TypeDescriptor_Struct>();
+        for (const TypeDescriptor_Struct::Member& member : structType->members) {
+            postSerializeBulkItem(member.type, PLY_PTR_OFFSET(item, member.offset));
+        }
+        structType->onPostSerialize(item);
+    }
+}
+
+// Reads numItems items with a single copy. The caller must have checked getBulkItemSize().
+static void readBulk(void* items, u32 numItems, TypeDescriptor* itemType,
+                     ReadObjectContext* context) {
+    u32 itemSize = itemType->fixedSize;
+    context->in.ins->read({(char*) items, numItems * itemSize});
+    if (needsPostSerialize(itemType)) {
+        for (u32 i = 0; i < numItems; i++) {
+            postSerializeBulkItem(itemType, PLY_PTR_OFFSET(items, itemSize * i));
+        }
+    }
+}
+
+//-----------------------------------------------------------------
+// Read plans
+//
+static bool isNumeric(const TypeDescriptor* type) {
+    return type->typeKey == &TypeKey_Bool || getBulkFormatKey(type->typeKey) != FormatKey::None;
+}
+
+static bool isNumeric(const FormatDescriptor* format) {
+    FormatKey formatKey = (FormatKey) format->formatKey;
+    return formatKey >= FormatKey::Bool && formatKey <= FormatKey::Double;
+}
+
+static void appendCopy(ReadPlan* plan, u32 dstOffset, u32 size) {
+    if (plan->ops.numItems() > 0) {
+        ReadPlan::Op& prev = plan->ops.back();
+        if (prev.opCode == ReadPlan::OpCode::Copy && prev.dstOffset + prev.size == dstOffset) {
+            prev.size += size;
+            return;
+        }
+    }
+    plan->ops.append({ReadPlan::OpCode::Copy, dstOffset, size, 0, nullptr, nullptr});
+}
+
+static void compileStruct(ReadPlan* plan, u32 dstOffset, TypeDescriptor_Struct* structType,
+                          FormatDescriptor_Struct* structFormat);
+
+static void compileMember(ReadPlan* plan, u32 dstOffset, TypeDescriptor* type,
+                          FormatDescriptor* format) {
+    if (getBulkItemSize(type, format) == type->fixedSize && !needsPostSerialize(type)) {
+        appendCopy(plan, dstOffset, type->fixedSize);
+    } else if (isNumeric(type) && isNumeric(format)) {
+        plan->ops.append({ReadPlan::OpCode::Convert, dstOffset, 1, 0, type, format});
+    } else if (type->typeKey == &TypeKey_Struct &&
+               (FormatKey) format->formatKey == FormatKey::Struct) {
+        compileStruct(plan, dstOffset, type->cast<TypeDescriptor_Struct>(),
+                      (FormatDescriptor_Struct*) format);
+    } else {
+        if (type->typeKey == &TypeKey_FixedArray &&
+            (FormatKey) format->formatKey == FormatKey::FixedArray) {
+            TypeDescriptor_FixedArray* fixedArrayType = type->cast<TypeDescriptor_FixedArray>();
+            FormatDescriptor_FixedArray* fixedFormat = (FormatDescriptor_FixedArray*) format;
+            if (fixedFormat->numItems == fixedArrayType->numItems &&
+                isNumeric(fixedArrayType->itemType) && isNumeric(fixedFormat->itemFormat)) {
+                plan->ops.append({ReadPlan::OpCode::Convert, dstOffset, fixedArrayType->numItems,
+                                  fixedArrayType->stride, fixedArrayType->itemType,
+                                  fixedFormat->itemFormat});
+                return;
+            }
+        }
+        // Arrays, strings, pointers, mismatched types and so on are read by the TypeKey
+        plan->ops.append({ReadPlan::OpCode::Read, dstOffset, 0, 0, type, format});
+    }
+}
+
+static void compileStruct(ReadPlan* plan, u32 dstOffset, TypeDescriptor_Struct* structType,
+                          FormatDescriptor_Struct* structFormat) {
+    for (const FormatDescriptor_Struct::Member& member : structFormat->members) {
+        const TypeDescriptor_Struct::Member* dstMember = structType->findMember(member.name);
+        if (!dstMember) {
+            SLOG(Load, "Can't find member \"{}\"", member.name);
+            plan->ops.append({ReadPlan::OpCode::Skip, 0, 0, 0, nullptr, member.formatDesc});
+            continue;
+        }
+        compileMember(plan, dstOffset + dstMember->offset, dstMember->type, member.formatDesc);
+    }
+    // FIXME: Identify any members of the structType that *weren't* serialized.
+    if (structType->onPostSerialize != TypeDescriptor_Struct::noPostSerialize) {
+        plan->ops.append({ReadPlan::OpCode::PostSerialize, dstOffset, 0, 0, structType, nullptr});
+    }
+}
+
+// Returns the cached plan for the given pair, compiling it the first time
+static ReadPlan* getReadPlan(ReadObjectContext* context, FormatDescriptor_Struct* structFormat,
+                             TypeDescriptor_Struct* structType) {
+    auto cursor = context->readPlans.insertOrFind({structFormat, structType});
+    ReadPlan* plan = *cursor;
+    if (!cursor.wasFound()) {
+        compileStruct(plan, 0, structType, structFormat);
+    }
+    return plan;
+}
+
+static void executeReadPlan(const ReadPlan* plan, void* obj, ReadObjectContext* context) {
+    for (const ReadPlan::Op& op : plan->ops) {
+        void* dst = PLY_PTR_OFFSET(obj, op.dstOffset);
+        switch (op.opCode) {
+            case ReadPlan::OpCode::Copy: {
+                context->in.ins->read({(char*) dst, op.size});
+                break;
+            }
+            case ReadPlan::OpCode::Convert: {
+                for (u32 i = 0; i < op.size; i++) {
+                    readNumeric(TypedPtr{dst, op.type}, context, op.formatDesc);
+                    dst = PLY_PTR_OFFSET(dst, op.stride);
+                }
+                break;
+            }
+            case ReadPlan::OpCode::Skip: {
+                skip(context, op.formatDesc);
+                break;
+            }
+            case ReadPlan::OpCode::Read: {
+                op.type->typeKey->read(TypedPtr{dst, op.type}, context, op.formatDesc);
+                break;
+            }
+            case ReadPlan::OpCode::PostSerialize: {
+                op.type->cast<TypeDescriptor_Struct>()->onPostSerialize(dst);
+                break;
+            }
+        }
+    }
+}
+
 //-----------------------------------------------------------------
 // TypeKey_FixedArray
 //
@@ -183,6 +435,10 @@ TypeKey TypeKey_FixedArray{
         TypeDescriptor_FixedArray* fixedArrayType = obj.type->cast<TypeDescriptor_FixedArray>();
         TypeDescriptor* itemType = fixedArrayType->itemType;
         u32 itemSize = itemType->fixedSize;
+        if (getBulkItemSize(itemType) == itemSize) {
+            context->out.outs->write({(const char*) obj.ptr, fixedArrayType->numItems * itemSize});
+            return;
+        }
         void* item = obj.ptr;
         for (u32 i : range(fixedArrayType->numItems)) {
             PLY_UNUSED(i);
@@ -214,6 +470,10 @@ TypeKey TypeKey_FixedArray{
         FormatDescriptor* itemFormat = fixedFormat->itemFormat;
         TypeDescriptor* itemType = fixedArrayType->itemType;
         u32 itemSize = itemType->fixedSize;
+        if (getBulkItemSize(itemType, itemFormat) == itemSize) {
+            readBulk(obj.ptr, fixedArrayType->numItems, itemType, context);
+            return;
+        }
         void* item = obj.ptr;
         for (u32 i : range(fixedArrayType->numItems)) {
             PLY_UNUSED(i);
@@ -253,6 +513,11 @@ TypeKey TypeKey_Array{
         void* item = arr->m_items;
         PLY_ASSERT(arr->m_numItems <= UINT32_MAX);
         context->out.write<u32>((u32) arr->m_numItems);
+        if (getBulkItemSize(itemType) == itemSize &&
+            u64(arr->m_numItems) * itemSize <= UINT32_MAX) {
+            context->out.outs->write({(const char*) item, arr->m_numItems * itemSize});
+            return;
+        }
         for (u32 i : range(arr->m_numItems)) {
             PLY_UNUSED(i);
             itemType->typeKey->write(TypedPtr{item, itemType}, context);
@@ -283,12 +548,29 @@ TypeKey TypeKey_Array{
         details::BaseArray* arr = (details::BaseArray*) obj.ptr;
         // FIXME: Destruct existing elements if array not empty
         arr->realloc(arrSize, itemSize);
+        // Every byte of a bulk item is overwritten, so there's no need to construct it first
+        if (getBulkItemSize(itemType, itemFormat) == itemSize &&
+            u64(arrSize) * itemSize <= UINT32_MAX) {
+            readBulk(arr->m_items, arrSize, itemType, context);
+            return;
+        }
+        // Look up the plan for an array of structs once, instead of once per item
+        ReadPlan* plan = nullptr;
+        if (itemType->typeKey == &TypeKey_Struct &&
+            (FormatKey) itemFormat->formatKey == FormatKey::Struct) {
+            plan = getReadPlan(context, (FormatDescriptor_Struct*) itemFormat,
+                               itemType->cast<TypeDescriptor_Struct>());
+        }
         void* item = arr->m_items;
         for (u32 i : range((u32) arrSize)) {
             PLY_UNUSED(i);
             TypedPtr typedItem{item, itemType};
             itemType->bindings.construct(typedItem);
-            itemType->typeKey->read(typedItem, context, itemFormat);
+            if (plan) {
+                executeReadPlan(plan, item, context);
+            } else {
+                itemType->typeKey->read(typedItem, context, itemFormat);
+            }
             item = PLY_PTR_OFFSET(item, itemSize);
         }
     },
@@ -452,16 +734,6 @@ TypeKey* TypeDescriptor_Reference::typeKey = &TypeKey_Reference;
 //-----------------------------------------------------------------
 // TypeKey_Struct
 //
-TypeDescriptor_Struct::Member* findMember(TypeDescriptor_Struct* structType, const String& name) {
-    // FIXME: Improve TypeDescriptor_Struct with lookup table
-    for (TypeDescriptor_Struct::Member& member : structType->members) {
-        // FIXME: Avoid implicit conversion of member.name (char *) to String
-        if (name == member.name)
-            return &member;
-    }
-    return nullptr;
-}
-
 TypeKey TypeKey_Struct{
     // write
     [](TypedPtr obj, WriteObjectContext* context) {
@@ -492,22 +764,9 @@ TypeKey TypeKey_Struct{
             skip(context, formatDesc);
             return;
         }
-        FormatDescriptor_Struct* structFormat = (FormatDescriptor_Struct*) formatDesc;
-        TypeDescriptor_Struct* structType = obj.type->cast<TypeDescriptor_Struct>();
-        for (const FormatDescriptor_Struct::Member& member : structFormat->members) {
-            // FIXME: Improve this by finding all the matching struct members ahead of time,
-            // and caching them, in a separate pass
-            TypeDescriptor_Struct::Member* dstMember = findMember(structType, member.name);
-            if (!dstMember) {
-                SLOG(Load, "Can't find member \"{}\"", member.name);
-                skip(context, member.formatDesc);
-                continue;
-            }
-            TypedPtr typedMember{PLY_PTR_OFFSET(obj.ptr, dstMember->offset), dstMember->type};
-            dstMember->type->typeKey->read(typedMember, context, member.formatDesc);
-        }
-        // FIXME: Identify any members of the structType that *weren't* serialized.
-        structType->onPostSerialize(obj.ptr);
+        ReadPlan* plan = getReadPlan(context, (FormatDescriptor_Struct*) formatDesc,
+                                     obj.type->cast<TypeDescriptor_Struct>());
+        executeReadPlan(plan, obj.ptr, context);
     },
     // hashDescriptor
     [](Hasher& hasher, const TypeDescriptor* typeDesc) {
@@ -13,3 +13,11 @@ void module_plyReflect(ModuleArgs* args) {
     args->addTarget(Visibility::Public, "runtime");
 }
 
+
+// [ply module="reflect-tests"]
+void module_reflectTests(ModuleArgs* args) {
+    args->buildTarget->targetType = BuildTargetType::ObjectLib;
+    args->addSourceFiles("tests");
+    args->addTarget(Visibility::Private, "reflect");
+    args->addTarget(Visibility::Private, "test");
+}
@@ -0,0 +1,275 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-reflect/Asset.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX Persist_
+
+// Saves obj with writeAsset
+template <typename T>
+String save(T& obj) {
+    MemOutStream mout;
+    writeAsset(&mout, TypedPtr::bind(&obj));
+    return mout.moveToString();
+}
+
+// Loads an asset saved by save() as a T
+template <typename T>
+OwnTypedPtr load(StringView saved) {
+    ViewInStream vins{saved};
+    OwnTypedPtr loaded = readExpectedAsset(&vins, TypeResolver<T>::get());
+    PLY_ASSERT(loaded.type == TypeResolver<T>::get());
+    return loaded;
+}
+
+//-----------------------------------------------------------------------
+// Numeric structs are saved and loaded in bulk
+//-----------------------------------------------------------------------
+struct Vec3 {
+    float x;
+    float y;
+    float z;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, Vec3)
+PLY_STRUCT_BEGIN_PRIM(Vec3)
+PLY_STRUCT_MEMBER(x)
+PLY_STRUCT_MEMBER(y)
+PLY_STRUCT_MEMBER(z)
+PLY_STRUCT_END_PRIM()
+
+struct Mesh {
+    Array<Vec3> points;
+    FixedArray<Vec3, 4> corners;
+    Array<u16> indices;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, Mesh)
+PLY_STRUCT_BEGIN_PRIM(Mesh)
+PLY_STRUCT_MEMBER(points)
+PLY_STRUCT_MEMBER(corners)
+PLY_STRUCT_MEMBER(indices)
+PLY_STRUCT_END_PRIM()
+
+bool operator==(const Vec3& a, const Vec3& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+PLY_TEST_CASE("Round trip of Array and FixedArray of numeric structs") {
+    Mesh mesh;
+    for (u32 i = 0; i < 100; i++) {
+        mesh.points.append({float(i), i * 0.5f, -float(i)});
+        mesh.indices.append(u16(i * 3));
+    }
+    for (u32 i = 0; i < 4; i++) {
+        mesh.corners[i] = {float(i), 1.f, 2.f};
+    }
+    OwnTypedPtr loaded = load<Mesh>(save(mesh));
+    const Mesh* result = (const Mesh*) loaded.ptr;
+    PLY_TEST_CHECK(result->points == mesh.points);
+    PLY_TEST_CHECK(result->indices == mesh.indices);
+    for (u32 i = 0; i < 4; i++) {
+        PLY_TEST_CHECK(result->corners[i] == mesh.corners[i]);
+    }
+}
+
+//-----------------------------------------------------------------------
+// Structs with padding are saved one member at a time
+//-----------------------------------------------------------------------
+struct PaddedVertex {
+    float pos[3];
+    u8 flags;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, PaddedVertex)
+PLY_STRUCT_BEGIN_PRIM(PaddedVertex)
+PLY_STRUCT_MEMBER(pos)
+PLY_STRUCT_MEMBER(flags)
+PLY_STRUCT_END_PRIM()
+
+struct PaddedMesh {
+    Array<PaddedVertex> vertices;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, PaddedMesh)
+PLY_STRUCT_BEGIN_PRIM(PaddedMesh)
+PLY_STRUCT_MEMBER(vertices)
+PLY_STRUCT_END_PRIM()
+
+PLY_TEST_CASE("Round trip of Array of structs with padding") {
+    PLY_STATIC_ASSERT(sizeof(PaddedVertex) == 16);
+    PaddedMesh mesh;
+    for (u32 i = 0; i < 20; i++) {
+        mesh.vertices.append({{float(i), 1.f, 2.f}, u8(i + 100)});
+    }
+    String saved = save(mesh);
+
+    // The padding isn't saved, so each item takes 13 bytes instead of 16
+    mesh.vertices.resize(10);
+    PLY_TEST_CHECK(saved.numBytes - save(mesh).numBytes == 10 * 13);
+
+    OwnTypedPtr loaded = load<PaddedMesh>(saved);
+    const PaddedMesh* result = (const PaddedMesh*) loaded.ptr;
+    PLY_TEST_CHECK(result->vertices.numItems() == 20);
+    for (u32 i = 0; i < result->vertices.numItems(); i++) {
+        const PaddedVertex& v = result->vertices[i];
+        PLY_TEST_CHECK(v.pos[0] == float(i) && v.pos[1] == 1.f && v.pos[2] == 2.f);
+        PLY_TEST_CHECK(v.flags == u8(i + 100));
+    }
+}
+
+//-----------------------------------------------------------------------
+// Loading an older version of a struct
+//-----------------------------------------------------------------------
+struct OldPoint {
+    s32 x;
+    u32 id;
+    s32 y;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, OldPoint)
+PLY_STRUCT_BEGIN_PRIM(OldPoint)
+PLY_STRUCT_MEMBER(x)
+PLY_STRUCT_MEMBER(id)
+PLY_STRUCT_MEMBER(y)
+PLY_STRUCT_END_PRIM()
+
+struct OldShape {
+    Array<OldPoint> points;
+    OldPoint origin;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, OldShape)
+PLY_STRUCT_BEGIN_PRIM(OldShape)
+PLY_STRUCT_MEMBER(points)
+PLY_STRUCT_MEMBER(origin)
+PLY_STRUCT_END_PRIM()
+
+// x and y were changed from s32 to float, id was removed and tag was added
+struct Point {
+    float x = 0;
+    float y = 0;
+    u32 tag = 7;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, Point)
+PLY_STRUCT_BEGIN_PRIM(Point)
+PLY_STRUCT_MEMBER(x)
+PLY_STRUCT_MEMBER(y)
+PLY_STRUCT_MEMBER(tag)
+PLY_STRUCT_END_PRIM()
+
+struct Shape {
+    Array<Point> points;
+    Point origin;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, Shape)
+PLY_STRUCT_BEGIN_PRIM(Shape)
+PLY_STRUCT_MEMBER(points)
+PLY_STRUCT_MEMBER(origin)
+PLY_STRUCT_END_PRIM()
+
+PLY_TEST_CASE("Load structs with converted, removed and added members") {
+    OldShape oldShape;
+    for (s32 i = 0; i < 10; i++) {
+        oldShape.points.append({i, u32(1000 + i), -i});
+    }
+    oldShape.origin = {-5, 99, 5};
+    OwnTypedPtr loaded = load<Shape>(save(oldShape));
+    const Shape* shape = (const Shape*) loaded.ptr;
+    PLY_TEST_CHECK(shape->points.numItems() == 10);
+    for (u32 i = 0; i < shape->points.numItems(); i++) {
+        const Point& pt = shape->points[i];
+        PLY_TEST_CHECK(pt.x == float(i) && pt.y == -float(i) && pt.tag == 7);
+    }
+    PLY_TEST_CHECK(shape->origin.x == -5.f && shape->origin.y == 5.f && shape->origin.tag == 7);
+}
+
+//-----------------------------------------------------------------------
+// onPostSerialize
+//-----------------------------------------------------------------------
+Array<u32> postSerializeLog;
+
+struct HookInner {
+    u32 value;
+    void onPostSerialize() {
+        postSerializeLog.append(this->value);
+    }
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, HookInner)
+PLY_STRUCT_BEGIN_PRIM(HookInner)
+PLY_STRUCT_MEMBER(value)
+PLY_STRUCT_END_PRIM()
+
+struct HookOuter {
+    HookInner a;
+    HookInner b;
+    u32 value;
+    void onPostSerialize() {
+        postSerializeLog.append(this->value);
+    }
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, HookOuter)
+PLY_STRUCT_BEGIN_PRIM(HookOuter)
+PLY_STRUCT_MEMBER(a)
+PLY_STRUCT_MEMBER(b)
+PLY_STRUCT_MEMBER(value)
+PLY_STRUCT_END_PRIM()
+
+// Has an extra member, so loading it as a HookOuter needs a ReadPlan
+struct OldHookOuter {
+    HookInner a;
+    u32 removed;
+    HookInner b;
+    u32 value;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, OldHookOuter)
+PLY_STRUCT_BEGIN_PRIM(OldHookOuter)
+PLY_STRUCT_MEMBER(a)
+PLY_STRUCT_MEMBER(removed)
+PLY_STRUCT_MEMBER(b)
+PLY_STRUCT_MEMBER(value)
+PLY_STRUCT_END_PRIM()
+
+struct HookList {
+    Array<HookOuter> items;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, HookList)
+PLY_STRUCT_BEGIN_PRIM(HookList)
+PLY_STRUCT_MEMBER(items)
+PLY_STRUCT_END_PRIM()
+
+struct OldHookList {
+    Array<OldHookOuter> items;
+};
+PLY_DECLARE_TYPE_DESCRIPTOR(, _Struct, OldHookList)
+PLY_STRUCT_BEGIN_PRIM(OldHookList)
+PLY_STRUCT_MEMBER(items)
+PLY_STRUCT_END_PRIM()
+
+PLY_TEST_CASE("onPostSerialize order in a bulk read") {
+    HookList list;
+    list.items.append({{1}, {2}, 3});
+    list.items.append({{4}, {5}, 6});
+    String saved = save(list);
+    postSerializeLog.clear();
+    OwnTypedPtr loaded = load<HookList>(saved);
+    // Members are post-serialized before the struct that contains them, and items in order
+    PLY_TEST_CHECK(postSerializeLog == Array<u32>{1, 2, 3, 4, 5, 6});
+}
+
+PLY_TEST_CASE("onPostSerialize order in a ReadPlan") {
+    OldHookList list;
+    list.items.append({{1}, 100, {2}, 3});
+    list.items.append({{4}, 100, {5}, 6});
+    String saved = save(list);
+    postSerializeLog.clear();
+    OwnTypedPtr loaded = load<HookList>(saved);
+    // Members are post-serialized before the struct that contains them, and items in order
+    PLY_TEST_CHECK(postSerializeLog == Array<u32>{1, 2, 3, 4, 5, 6});
+    const HookList* result = (const HookList*) loaded.ptr;
+    PLY_TEST_CHECK(result->items.numItems() == 2);
+    PLY_TEST_CHECK(result->items[1].a.value == 4 && result->items[1].b.value == 5 &&
+                   result->items[1].value == 6);
+}
+
+} // namespace tests
+} // namespace ply
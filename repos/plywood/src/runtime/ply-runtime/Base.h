@@ -27,11 +27,14 @@
 #include <ply-runtime/io/StdIO.h>
 #include <ply-runtime/log/Log.h>
 #include <ply-runtime/memory/Heap.h>
+#include <ply-runtime/memory/Arena.h>
+#include <ply-runtime/memory/HeapProfiler.h>
 #include <ply-runtime/network/Socket.h>
 #include <ply-runtime/process/Subprocess.h>
 #include <ply-runtime/string/String.h>
 #include <ply-runtime/thread/Atomic.h>
 #include <ply-runtime/thread/ConditionVariable.h>
+#include <ply-runtime/thread/EventTracer.h>
 #include <ply-runtime/thread/Mutex.h>
 #include <ply-runtime/thread/RWLock.h>
 #include <ply-runtime/thread/Semaphore.h>
@@ -0,0 +1,145 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/algorithm/Sort.h>
+#include <ply-runtime/thread/ThreadPool.h>
+
+namespace ply {
+
+namespace details {
+
+// Ranges smaller than this are sorted by a single thread
+static constexpr u32 ParallelSortMinTaskSize = 8192;
+
+//-----------------------------------------------------------------------
+// ParallelSortJob
+//
+// Partitions the input the same way as sort(). After each partition, the smaller side is submitted
+// to the thread pool as a separate task and the current thread continues with the larger side.
+// Once a range is small enough, it's sorted on the current thread. numUnsorted counts the items
+// that aren't in their final position yet; the caller waits for it to reach zero.
+//
+// numUnsorted is only changed while holding the mutex. Otherwise, the caller could see zero, return
+// and destroy the job before the last thread to call markSorted() is done with the mutex.
+//-----------------------------------------------------------------------
+template <typename T, typename IsLess>
+struct ParallelSortJob {
+    ThreadPool* pool = nullptr;
+    const IsLess* isLess = nullptr;
+    u32 minTaskSize = 0;
+    u32 numUnsorted = 0; // Protected by mutex
+    Mutex mutex;
+    ConditionVariable doneCond;
+
+    PLY_NO_INLINE void markSorted(u32 numItems) {
+        if (numItems == 0)
+            return;
+        LockGuard<Mutex> guard{this->mutex};
+        PLY_ASSERT(this->numUnsorted >= numItems);
+        this->numUnsorted -= numItems;
+        if (this->numUnsorted == 0) {
+            this->doneCond.wakeAll();
+        }
+    }
+
+    PLY_NO_INLINE void run(T* begin, T* end, u32 badAllowed, bool leftmost) {
+        while (u32(end - begin) > this->minTaskSize) {
+            choosePivot(begin, end, *this->isLess);
+            if (!leftmost && !(*this->isLess)(begin[-1], *begin)) {
+                T* newBegin = partitionLeft(begin, end, *this->isLess) + 1;
+                this->markSorted(u32(newBegin - begin));
+                begin = newBegin;
+                continue;
+            }
+
+            uptr size = end - begin;
+            bool alreadyPartitioned = false;
+            T* pivotPos = partitionRight(begin, end, *this->isLess, &alreadyPartitioned);
+            uptr leftSize = pivotPos - begin;
+            uptr rightSize = end - (pivotPos + 1);
+            if (leftSize < size / 8 || rightSize < size / 8) {
+                if (--badAllowed == 0) {
+                    heapSort(begin, end, *this->isLess);
+                    this->markSorted(u32(size));
+                    return;
+                }
+                breakPatterns(begin, pivotPos, end);
+            }
+            this->markSorted(1); // The pivot
+
+            if (leftSize < rightSize) {
+                this->pool->submit([this, begin, pivotPos, badAllowed, leftmost] {
+                    this->run(begin, pivotPos, badAllowed, leftmost);
+                });
+                begin = pivotPos + 1;
+                leftmost = false;
+            } else {
+                T* rightBegin = pivotPos + 1;
+                this->pool->submit([this, rightBegin, end, badAllowed] {
+                    this->run(rightBegin, end, badAllowed, false);
+                });
+                end = pivotPos;
+            }
+        }
+        pdqsortLoop(begin, end, *this->isLess, badAllowed, leftmost);
+        this->markSorted(u32(end - begin));
+    }
+};
+
+} // namespace details
+
+/*!
+Sorts the items in `view` using the worker threads of `pool` as well as the calling thread. The
+result is the same as `sort()`; the sort is not stable. Small inputs are sorted on the calling
+thread only. Must not be called from one of the pool's own worker threads.
+*/
+template <typename T, typename IsLess = decltype(details::defaultLess<T>)>
+PLY_NO_INLINE void parallelSort(ThreadPool* pool, ArrayView<T> view,
+                                const IsLess& isLess = details::defaultLess<T>) {
+    PLY_ASSERT(pool->getCurrentWorkerIndex() < 0);
+    u32 minTaskSize =
+        max(view.numItems / (pool->getNumWorkers() * 8 + 1), u32{details::ParallelSortMinTaskSize});
+    if (view.numItems <= minTaskSize) {
+        sort(view, isLess);
+        return;
+    }
+
+    details::ParallelSortJob<T, IsLess> job;
+    job.pool = pool;
+    job.isLess = &isLess;
+    job.minTaskSize = minTaskSize;
+    job.numUnsorted = view.numItems;
+    job.run(view.begin(), view.end(), details::getBadPartitionLimit(view.numItems), true);
+    LockGuard<Mutex> guard{job.mutex};
+    while (job.numUnsorted > 0) {
+        job.doneCond.wait(guard);
+    }
+}
+
+/*!
+Sorts the items in `view` using a temporary thread pool with one worker per hardware thread. If
+you sort often, it's cheaper to create a `ThreadPool` once and pass it to the other overload.
+*/
+template <typename T, typename IsLess = decltype(details::defaultLess<T>)>
+PLY_NO_INLINE void parallelSort(ArrayView<T> view, const IsLess& isLess = details::defaultLess<T>) {
+    if (view.numItems <= details::ParallelSortMinTaskSize) {
+        sort(view, isLess);
+        return;
+    }
+    ThreadPool pool;
+    parallelSort(&pool, view, isLess);
+}
+
+template <typename Arr,
+          typename IsLess = decltype(details::defaultLess<details::ArrayViewType<Arr>>)>
+PLY_INLINE void parallelSort(Arr& arr,
+                             const IsLess& isLess =
+                                 details::defaultLess<details::ArrayViewType<Arr>>) {
+    using T = details::ArrayViewType<Arr>;
+    parallelSort(ArrayView<T>{arr}, isLess);
+}
+
+} // namespace ply
@@ -5,6 +5,8 @@
 #pragma once
 #include <ply-runtime/Core.h>
 #include <ply-runtime/container/ArrayView.h>
+#include <ply-runtime/container/Subst.h>
+#include <ply-runtime/memory/Heap.h>
 
 namespace ply {
 
@@ -13,60 +15,356 @@ template <typename T>
 PLY_INLINE bool defaultLess(const T& a, const T& b) {
     return a < b;
 }
-} // namespace details
 
-template <typename T, typename IsLess = decltype(details::defaultLess<T>)>
-PLY_NO_INLINE void sort(ArrayView<T> view, const IsLess& isLess = details::defaultLess<T>) {
-    if (view.numItems <= 1)
+//-----------------------------------------------------------------------
+// Building blocks shared by sort(), stableSort() and parallelSort()
+//-----------------------------------------------------------------------
+static constexpr uptr InsertionSortThreshold = 24;
+static constexpr uptr NintherThreshold = 128;
+static constexpr uptr PartialInsertionSortLimit = 8;
+
+template <typename T, typename IsLess>
+void insertionSort(T* begin, T* end, const IsLess& isLess) {
+    if (begin == end)
         return;
-    u32 lo = 0;
-    u32 hi = view.numItems - 1;
-    u32 pivot = view.numItems / 2;
-    for (;;) {
-        while (lo < hi && isLess(view[lo], view[pivot])) {
-            lo++;
+    for (T* cur = begin + 1; cur != end; cur++) {
+        T* sift = cur;
+        T* sift1 = cur - 1;
+        if (isLess(*sift, *sift1)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (sift != begin && isLess(tmp, *--sift1));
+            *sift = std::move(tmp);
         }
-        while (lo < hi && isLess(view[pivot], view[hi])) {
-            hi--;
+    }
+}
+
+// Same as insertionSort(), but assumes that the item before begin is not greater than any item in
+// the range, so it doesn't need to check for the start of the range.
+template <typename T, typename IsLess>
+void unguardedInsertionSort(T* begin, T* end, const IsLess& isLess) {
+    if (begin == end)
+        return;
+    for (T* cur = begin + 1; cur != end; cur++) {
+        T* sift = cur;
+        T* sift1 = cur - 1;
+        if (isLess(*sift, *sift1)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (isLess(tmp, *--sift1));
+            *sift = std::move(tmp);
         }
-        if (lo >= hi)
+    }
+}
+
+// Insertion sort that gives up after moving a small number of items. Returns true if the range
+// ended up sorted.
+template <typename T, typename IsLess>
+bool partialInsertionSort(T* begin, T* end, const IsLess& isLess) {
+    if (begin == end)
+        return true;
+    uptr numMoves = 0;
+    for (T* cur = begin + 1; cur != end; cur++) {
+        T* sift = cur;
+        T* sift1 = cur - 1;
+        if (isLess(*sift, *sift1)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (sift != begin && isLess(tmp, *--sift1));
+            *sift = std::move(tmp);
+            numMoves += cur - sift;
+        }
+        if (numMoves > PartialInsertionSortLimit)
+            return false;
+    }
+    return true;
+}
+
+template <typename T, typename IsLess>
+PLY_INLINE void sort2(T* a, T* b, const IsLess& isLess) {
+    if (isLess(*b, *a)) {
+        std::swap(*a, *b);
+    }
+}
+
+template <typename T, typename IsLess>
+PLY_INLINE void sort3(T* a, T* b, T* c, const IsLess& isLess) {
+    sort2(a, b, isLess);
+    sort2(b, c, isLess);
+    sort2(a, b, isLess);
+}
+
+template <typename T, typename IsLess>
+void siftDown(T* heap, uptr root, uptr numItems, const IsLess& isLess) {
+    T tmp = std::move(heap[root]);
+    for (;;) {
+        uptr child = root * 2 + 1;
+        if (child >= numItems)
             break;
-        // view[lo] is >= pivot
-        // All slots to left of lo are < pivot
-        // view[hi] <= pivot
-        // All slots to the right of hi are > pivot
-        PLY_ASSERT(!isLess(view[lo], view[pivot]));
-        PLY_ASSERT(!isLess(view[pivot], view[hi]));
-        PLY_ASSERT(lo < hi);
-        std::swap(view[lo], view[hi]);
-        if (lo == pivot) {
-            pivot = hi;
-        } else if (hi == pivot) {
-            pivot = lo;
-        }
-        lo++;
-    }
-    PLY_ASSERT((s32) hi >= 0);
-    // Now, everything to left of lo is <= pivot, and everything from hi onwards is >= pivot.
-    PLY_ASSERT(hi <= lo);
-    while (lo > 1) {
-        if (!isLess(view[lo - 1], view[pivot])) {
-            lo--;
-        } else {
-            sort(view.subView(0, lo), isLess);
+        if (child + 1 < numItems && isLess(heap[child], heap[child + 1])) {
+            child++;
+        }
+        if (!isLess(tmp, heap[child]))
             break;
+        heap[root] = std::move(heap[child]);
+        root = child;
+    }
+    heap[root] = std::move(tmp);
+}
+
+template <typename T, typename IsLess>
+void heapSort(T* begin, T* end, const IsLess& isLess) {
+    uptr numItems = end - begin;
+    for (uptr i = numItems / 2; i-- > 0;) {
+        siftDown(begin, i, numItems, isLess);
+    }
+    for (uptr i = numItems; i > 1;) {
+        i--;
+        std::swap(begin[0], begin[i]);
+        siftDown(begin, 0, i, isLess);
+    }
+}
+
+// Moves the median of a few samples to *begin. Uses the median of 3 for small ranges and Tukey's
+// ninther for large ones.
+template <typename T, typename IsLess>
+PLY_INLINE void choosePivot(T* begin, T* end, const IsLess& isLess) {
+    uptr size = end - begin;
+    uptr half = size / 2;
+    if (size > NintherThreshold) {
+        sort3(begin, begin + half, end - 1, isLess);
+        sort3(begin + 1, begin + (half - 1), end - 2, isLess);
+        sort3(begin + 2, begin + (half + 1), end - 3, isLess);
+        sort3(begin + (half - 1), begin + half, begin + (half + 1), isLess);
+        std::swap(*begin, begin[half]);
+    } else {
+        sort3(begin + half, begin, end - 1, isLess);
+    }
+}
+
+// Partitions the range around the pivot at *begin. Items equal to the pivot go to the right. The
+// range must contain an item that is not less than the pivot after *begin, which choosePivot()
+// guarantees. Returns the final position of the pivot.
+template <typename T, typename IsLess>
+T* partitionRight(T* begin, T* end, const IsLess& isLess, bool* alreadyPartitioned) {
+    T pivot = std::move(*begin);
+    T* first = begin;
+    T* last = end;
+    while (isLess(*++first, pivot)) {
+    }
+    if (first - 1 == begin) {
+        while (first < last && !isLess(*--last, pivot)) {
+        }
+    } else {
+        while (!isLess(*--last, pivot)) {
+        }
+    }
+    *alreadyPartitioned = (first >= last);
+    while (first < last) {
+        std::swap(*first, *last);
+        while (isLess(*++first, pivot)) {
+        }
+        while (!isLess(*--last, pivot)) {
+        }
+    }
+    T* pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return pivotPos;
+}
+
+// Partitions the range around the pivot at *begin. Items equal to the pivot go to the left. Used
+// when the pivot equals the item before the range, in which case every item equal to the pivot is
+// already in its final position.
+template <typename T, typename IsLess>
+T* partitionLeft(T* begin, T* end, const IsLess& isLess) {
+    T pivot = std::move(*begin);
+    T* first = begin;
+    T* last = end;
+    while (isLess(pivot, *--last)) {
+    }
+    if (last + 1 == end) {
+        while (first < last && !isLess(pivot, *++first)) {
         }
+    } else {
+        while (!isLess(pivot, *++first)) {
+        }
+    }
+    while (first < last) {
+        std::swap(*first, *last);
+        while (isLess(pivot, *--last)) {
+        }
+        while (!isLess(pivot, *++first)) {
+        }
+    }
+    T* pivotPos = last;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return pivotPos;
+}
+
+// Swaps a few items around after a highly unbalanced partition, so that inputs with a pattern that
+// defeats the pivot selection don't keep producing bad partitions.
+template <typename T>
+void breakPatterns(T* begin, T* pivotPos, T* end) {
+    uptr leftSize = pivotPos - begin;
+    uptr rightSize = end - (pivotPos + 1);
+    if (leftSize >= InsertionSortThreshold) {
+        std::swap(begin[0], begin[leftSize / 4]);
+        std::swap(pivotPos[-1], pivotPos[-(sptr) (leftSize / 4)]);
+        if (leftSize > NintherThreshold) {
+            std::swap(begin[1], begin[leftSize / 4 + 1]);
+            std::swap(begin[2], begin[leftSize / 4 + 2]);
+            std::swap(pivotPos[-2], pivotPos[-(sptr) (leftSize / 4 + 1)]);
+            std::swap(pivotPos[-3], pivotPos[-(sptr) (leftSize / 4 + 2)]);
+        }
+    }
+    if (rightSize >= InsertionSortThreshold) {
+        std::swap(pivotPos[1], pivotPos[1 + rightSize / 4]);
+        std::swap(end[-1], end[-(sptr) (rightSize / 4)]);
+        if (rightSize > NintherThreshold) {
+            std::swap(pivotPos[2], pivotPos[2 + rightSize / 4]);
+            std::swap(pivotPos[3], pivotPos[3 + rightSize / 4]);
+            std::swap(end[-2], end[-(sptr) (1 + rightSize / 4)]);
+            std::swap(end[-3], end[-(sptr) (2 + rightSize / 4)]);
+        }
+    }
+}
+
+// Number of highly unbalanced partitions allowed before falling back to heapsort
+PLY_INLINE u32 getBadPartitionLimit(uptr numItems) {
+    u32 log2 = 0;
+    while (numItems > 1) {
+        numItems >>= 1;
+        log2++;
     }
-    while (hi + 1 < view.numItems) {
-        if (!isLess(view[pivot], view[hi])) {
-            hi++;
+    return log2;
+}
+
+// Pattern-defeating quicksort, after Orson Peters' pdqsort (https://github.com/orlp/pdqsort, zlib
+// License). leftmost is true when there's no item before begin that can act as a sentinel.
+template <typename T, typename IsLess>
+void pdqsortLoop(T* begin, T* end, const IsLess& isLess, u32 badAllowed, bool leftmost) {
+    for (;;) {
+        uptr size = end - begin;
+        if (size < InsertionSortThreshold) {
+            if (leftmost) {
+                insertionSort(begin, end, isLess);
+            } else {
+                unguardedInsertionSort(begin, end, isLess);
+            }
+            return;
+        }
+
+        choosePivot(begin, end, isLess);
+        // If the pivot is equal to the item before the range, there's nothing less than it in the
+        // range. Put all the items equal to it on the left; they don't need any more sorting.
+        if (!leftmost && !isLess(begin[-1], *begin)) {
+            begin = partitionLeft(begin, end, isLess) + 1;
+            continue;
+        }
+
+        bool alreadyPartitioned = false;
+        T* pivotPos = partitionRight(begin, end, isLess, &alreadyPartitioned);
+        uptr leftSize = pivotPos - begin;
+        uptr rightSize = end - (pivotPos + 1);
+        if (leftSize < size / 8 || rightSize < size / 8) {
+            if (--badAllowed == 0) {
+                heapSort(begin, end, isLess);
+                return;
+            }
+            breakPatterns(begin, pivotPos, end);
+        } else if (alreadyPartitioned && partialInsertionSort(begin, pivotPos, isLess) &&
+                   partialInsertionSort(pivotPos + 1, end, isLess)) {
+            // The input was probably sorted already
+            return;
+        }
+
+        // Recurse into the smaller side and loop on the larger one to bound the stack depth
+        if (leftSize < rightSize) {
+            pdqsortLoop(begin, pivotPos, isLess, badAllowed, leftmost);
+            begin = pivotPos + 1;
+            leftmost = false;
         } else {
-            sort(view.subView(hi), isLess);
-            break;
+            pdqsortLoop(pivotPos + 1, end, isLess, badAllowed, false);
+            end = pivotPos;
         }
     }
 }
 
+// Sorts [items, items + numItems) using a scratch buffer with room for numItems / 2 items. The
+// scratch buffer is uninitialized memory.
+template <typename T, typename IsLess>
+void mergeSort(T* items, uptr numItems, T* scratch, const IsLess& isLess) {
+    if (numItems < InsertionSortThreshold) {
+        insertionSort(items, items + numItems, isLess);
+        return;
+    }
+    uptr mid = numItems / 2;
+    mergeSort(items, mid, scratch, isLess);
+    mergeSort(items + mid, numItems - mid, scratch, isLess);
+    if (!isLess(items[mid], items[mid - 1]))
+        return; // Halves are already in order
+
+    // Move the left half out of the way, then merge it with the right half. The write position
+    // never passes the read position in the right half.
+    subst::moveConstructArray(scratch, items, mid);
+    T* a = scratch;
+    T* aEnd = scratch + mid;
+    T* b = items + mid;
+    T* bEnd = items + numItems;
+    T* dst = items;
+    while (a < aEnd && b < bEnd) {
+        if (isLess(*b, *a)) {
+            *dst++ = std::move(*b++);
+        } else {
+            *dst++ = std::move(*a++);
+        }
+    }
+    while (a < aEnd) {
+        *dst++ = std::move(*a++);
+    }
+    subst::destructArray(scratch, mid);
+}
+
+//-----------------------------------------------------------------------
+// Radix keys
+//-----------------------------------------------------------------------
+// Converts an integer to an unsigned key with the same ordering
+template <typename K, std::enable_if_t<std::is_unsigned<K>::value, int> = 0>
+PLY_INLINE K toRadixKey(K key) {
+    return key;
+}
+template <typename K,
+          std::enable_if_t<std::is_integral<K>::value && std::is_signed<K>::value, int> = 0>
+PLY_INLINE std::make_unsigned_t<K> toRadixKey(K key) {
+    using U = std::make_unsigned_t<K>;
+    return U(key) ^ (U(1) << (sizeof(K) * 8 - 1));
+}
+
+template <typename T>
+PLY_INLINE T identityKey(const T& item) {
+    return item;
+}
+
+} // namespace details
+
+/*!
+Sorts the items in `view` using a pattern-defeating quicksort. The sort is not stable. It runs in
+O(n log n) time in the worst case, and in linear time on inputs that are already sorted, sorted in
+reverse, or contain only a few distinct values.
+*/
+template <typename T, typename IsLess = decltype(details::defaultLess<T>)>
+PLY_NO_INLINE void sort(ArrayView<T> view, const IsLess& isLess = details::defaultLess<T>) {
+    if (view.numItems <= 1)
+        return;
+    details::pdqsortLoop(view.begin(), view.end(), isLess,
+                         details::getBadPartitionLimit(view.numItems), true);
+}
+
 template <typename Arr,
           typename IsLess = decltype(details::defaultLess<details::ArrayViewType<Arr>>)>
 PLY_INLINE void sort(Arr& arr,
@@ -75,4 +373,95 @@ PLY_INLINE void sort(Arr& arr,
     sort(ArrayView<T>{arr}, isLess);
 }
 
+/*!
+Sorts the items in `view` using a merge sort. Items that compare equal keep their relative order.
+Allocates a temporary buffer for half of the items.
+*/
+template <typename T, typename IsLess = decltype(details::defaultLess<T>)>
+PLY_NO_INLINE void stableSort(ArrayView<T> view, const IsLess& isLess = details::defaultLess<T>) {
+    if (view.numItems < details::InsertionSortThreshold) {
+        details::insertionSort(view.begin(), view.end(), isLess);
+        return;
+    }
+    T* scratch = (T*) PLY_HEAP.alloc(sizeof(T) * (view.numItems / 2));
+    details::mergeSort(view.items, view.numItems, scratch, isLess);
+    PLY_HEAP.free(scratch);
+}
+
+template <typename Arr,
+          typename IsLess = decltype(details::defaultLess<details::ArrayViewType<Arr>>)>
+PLY_INLINE void stableSort(Arr& arr,
+                           const IsLess& isLess =
+                               details::defaultLess<details::ArrayViewType<Arr>>) {
+    using T = details::ArrayViewType<Arr>;
+    stableSort(ArrayView<T>{arr}, isLess);
+}
+
+/*!
+Sorts the items in `view` by an integer key using a least-significant-digit radix sort. `getKey`
+returns the key of an item; it can be any integer type. If omitted, the items themselves must be
+integers and are used as keys. The sort is stable. It makes one pass over the items per byte of
+the key, skipping bytes that are the same in every key, and allocates a temporary buffer as large
+as the input. Items are copied with `memcpy`, so they must be trivially copyable.
+*/
+template <typename T, typename GetKey = decltype(details::identityKey<T>)>
+PLY_NO_INLINE void radixSort(ArrayView<T> view,
+                             const GetKey& getKey = details::identityKey<T>) {
+    PLY_STATIC_ASSERT(std::is_trivially_copyable<T>::value);
+    using Key = decltype(details::toRadixKey(getKey(view[0])));
+    auto isLess = [&](const T& a, const T& b) {
+        return details::toRadixKey(getKey(a)) < details::toRadixKey(getKey(b));
+    };
+    if (view.numItems < details::InsertionSortThreshold * 4) {
+        details::insertionSort(view.begin(), view.end(), isLess);
+        return;
+    }
+
+    // Count the occurrences of every byte value at every byte position in a single pass
+    static constexpr u32 NumPasses = sizeof(Key);
+    u32 counts[NumPasses][256];
+    memset(counts, 0, sizeof(counts));
+    for (const T& item : view) {
+        Key key = details::toRadixKey(getKey(item));
+        for (u32 p = 0; p < NumPasses; p++) {
+            counts[p][(key >> (p * 8)) & 255]++;
+        }
+    }
+
+    T* src = view.items;
+    T* dst = (T*) PLY_HEAP.alloc(sizeof(T) * view.numItems);
+    T* buffer = dst;
+    for (u32 p = 0; p < NumPasses; p++) {
+        u32 shift = p * 8;
+        // Skip this pass if every key has the same byte
+        if (counts[p][(details::toRadixKey(getKey(src[0])) >> shift) & 255] == view.numItems)
+            continue;
+        u32 offsets[256];
+        u32 sum = 0;
+        for (u32 b = 0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += counts[p][b];
+        }
+        for (u32 i = 0; i < view.numItems; i++) {
+            Key key = details::toRadixKey(getKey(src[i]));
+            memcpy(static_cast<void*>(dst + offsets[(key >> shift) & 255]++), &src[i], sizeof(T));
+        }
+        std::swap(src, dst);
+    }
+    if (src != view.items) {
+        memcpy(static_cast<void*>(view.items), src, sizeof(T) * view.numItems);
+    }
+    PLY_HEAP.free(buffer);
+}
+
+template <typename Arr, typename GetKey = decltype(
+                            details::identityKey<std::remove_const_t<details::ArrayViewType<Arr>>>)>
+PLY_INLINE void
+radixSort(Arr& arr,
+          const GetKey& getKey =
+              details::identityKey<std::remove_const_t<details::ArrayViewType<Arr>>>) {
+    using T = details::ArrayViewType<Arr>;
+    radixSort(ArrayView<T>{arr}, getKey);
+}
+
 } // namespace ply
@@ -0,0 +1,407 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/container/Array.h>
+#include <ply-runtime/container/Hash.h>
+#include <ply-runtime/thread/Atomic.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/thread/QSBR.h>
+
+namespace ply {
+
+namespace details {
+
+template <typename Key>
+struct ConcurrentMapKey;
+
+template <>
+struct ConcurrentMapKey<u32> {
+    // Invertible, so distinct keys never share a hash. Maps 0 to 0.
+    static PLY_INLINE u32 hash(u32 key) {
+        return Hasher::finalize(key);
+    }
+};
+
+template <>
+struct ConcurrentMapKey<u64> {
+    static PLY_INLINE u64 hash(u64 key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ull;
+        key ^= key >> 33;
+        return key;
+    }
+};
+
+template <typename Value>
+struct ConcurrentMapValue {
+    static PLY_INLINE Value null() {
+        return Value(0);
+    }
+    static PLY_INLINE Value redirect() {
+        return Value(1);
+    }
+};
+
+template <typename T>
+struct ConcurrentMapValue<T*> {
+    static PLY_INLINE T* null() {
+        return nullptr;
+    }
+    static PLY_INLINE T* redirect() {
+        return (T*) uptr(1);
+    }
+};
+
+} // namespace details
+
+//-----------------------------------------------------------------------
+// ConcurrentMap
+//
+// A hash map that can be read and modified by several threads at once. It uses the same leapfrog
+// layout as HashMap: cells are kept in groups of four, and each group holds the deltas that link
+// every bucket's cells into a probe chain.
+//
+// Key must be u32 or u64, and 0 is reserved. Value must be an integer or pointer type; 0 (or null)
+// means "no value", and 1 is reserved. Since the map stores an invertible hash of each key instead
+// of the key itself, and only stores values that fit in a machine word, every operation is a
+// handful of atomic loads and compare-and-swaps:
+//
+// - get() never blocks and never writes to shared memory, except while the table is being
+//   migrated, when readers that reach a cell that's already been moved wait for the migration to
+//   finish.
+// - assign(), insertIfAbsent() and erase() are lock-free until the table fills up. The thread
+//   that overflows the table migrates it to a new one under a mutex.
+//
+// Old tables are freed through QSBR. Every thread that uses the map must own a QSBR context and
+// call onQuiescentState() regularly at points where it isn't inside a map operation. Values that
+// are pointers aren't owned by the map; callers that replace or erase them can use the same QSBR
+// object to free them safely.
+//-----------------------------------------------------------------------
+template <typename Key, typename Value>
+class ConcurrentMap {
+private:
+    using KeyTraits = details::ConcurrentMapKey<Key>;
+    using ValueTraits = details::ConcurrentMapValue<Value>;
+
+    static constexpr u32 InitialSize = 8;
+    static constexpr u32 LinearSearchLimit = 128;
+
+    struct Cell {
+        Atomic<Key> hash;
+        Atomic<Value> value;
+    };
+
+    struct CellGroup {
+        Atomic<u8> nextDelta[4];
+        Atomic<u8> firstDelta[4];
+        Cell cells[4];
+    };
+
+    // Aligned so that the cell groups that follow it are aligned too. Otherwise, atomic operations
+    // on cells could straddle cache lines, which is very slow.
+    struct alignas(CellGroup) Table {
+        u32 sizeMask;
+
+        PLY_INLINE CellGroup* getCellGroups() const {
+            return (CellGroup*) (this + 1);
+        }
+
+        static PLY_NO_INLINE Table* create(u32 tableSize) {
+            PLY_ASSERT(isPowerOf2(tableSize) && tableSize >= 4);
+            u32 numGroups = tableSize >> 2;
+            Table* table =
+                (Table*) PLY_HEAP.alloc(sizeof(Table) + sizeof(CellGroup) * numGroups);
+            new (table) Table;
+            table->sizeMask = tableSize - 1;
+            CellGroup* groups = table->getCellGroups();
+            for (u32 i = 0; i < numGroups; i++) {
+                CellGroup* group = new (groups + i) CellGroup;
+                for (u32 j = 0; j < 4; j++) {
+                    group->nextDelta[j].storeNonatomic(0);
+                    group->firstDelta[j].storeNonatomic(0);
+                    group->cells[j].hash.storeNonatomic(Key(0));
+                    group->cells[j].value.storeNonatomic(ValueTraits::null());
+                }
+            }
+            return table;
+        }
+
+        static PLY_INLINE void destroy(Table* table) {
+            PLY_HEAP.free(table);
+        }
+    };
+
+    enum class InsertResult {
+        AlreadyFound,
+        InsertedNew,
+        Overflow,
+    };
+
+    Atomic<Table*> root;
+    Mutex migrationMutex;
+    QSBR* qsbr;
+
+    PLY_INLINE static Cell* getCell(Table* table, u32 idx) {
+        CellGroup* group = table->getCellGroups() + ((idx & table->sizeMask) >> 2);
+        return group->cells + (idx & 3);
+    }
+
+    static PLY_INLINE Cell* find(Key hash, Table* table) {
+        u32 sizeMask = table->sizeMask;
+        u32 idx = u32(hash);
+        CellGroup* group = table->getCellGroups() + ((idx & sizeMask) >> 2);
+        Cell* cell = group->cells + (idx & 3);
+        Key probeHash = cell->hash.load(Relaxed);
+        if (probeHash == hash)
+            return cell;
+        if (probeHash == Key(0))
+            return nullptr;
+        // Follow the probe chain for this bucket
+        u8 delta = group->firstDelta[idx & 3].load(Relaxed);
+        while (delta) {
+            idx += delta;
+            group = table->getCellGroups() + ((idx & sizeMask) >> 2);
+            cell = group->cells + (idx & 3);
+            probeHash = cell->hash.load(Relaxed);
+            if (probeHash == hash)
+                return cell;
+            delta = group->nextDelta[idx & 3].load(Relaxed);
+        }
+        return nullptr;
+    }
+
+    // Finds the cell for the given hash, or reserves a new one by storing the hash in an empty
+    // cell and linking it into the bucket's probe chain.
+    static PLY_NO_INLINE InsertResult insertOrFind(Key hash, Table* table, Cell** outCell) {
+        u32 sizeMask = table->sizeMask;
+        u32 idx = u32(hash);
+        CellGroup* group = table->getCellGroups() + ((idx & sizeMask) >> 2);
+        Cell* cell = group->cells + (idx & 3);
+        Key probeHash = cell->hash.load(Relaxed);
+        if (probeHash == Key(0)) {
+            if (cell->hash.compareExchangeStrong(probeHash, hash, Relaxed)) {
+                *outCell = cell;
+                return InsertResult::InsertedNew;
+            }
+            // Otherwise, probeHash now holds the hash stored by another thread
+        }
+        if (probeHash == hash) {
+            *outCell = cell;
+            return InsertResult::AlreadyFound;
+        }
+
+        u32 maxIdx = idx + sizeMask;
+        Atomic<u8>* prevLink = group->firstDelta + (idx & 3);
+        for (;;) {
+            u8 probeDelta = prevLink->load(Relaxed);
+            if (probeDelta) {
+                idx += probeDelta;
+                group = table->getCellGroups() + ((idx & sizeMask) >> 2);
+                cell = group->cells + (idx & 3);
+                probeHash = cell->hash.load(Relaxed);
+                while (probeHash == Key(0)) {
+                    // The cell was linked by another thread whose hash isn't visible yet
+                    probeHash = cell->hash.load(Acquire);
+                }
+                PLY_ASSERT(((u32(probeHash) ^ u32(hash)) & sizeMask) == 0);
+                if (probeHash == hash) {
+                    *outCell = cell;
+                    return InsertResult::AlreadyFound;
+                }
+                prevLink = group->nextDelta + (idx & 3);
+            } else {
+                // Reached the end of the probe chain. Switch to linear probing until we reserve a
+                // new cell or find a late-arriving cell in the same bucket.
+                u32 prevLinkIdx = idx;
+                u32 linearProbesRemaining = min(maxIdx - idx, u32{LinearSearchLimit});
+                bool followLink = false;
+                while (linearProbesRemaining-- > 0) {
+                    idx++;
+                    group = table->getCellGroups() + ((idx & sizeMask) >> 2);
+                    cell = group->cells + (idx & 3);
+                    probeHash = cell->hash.load(Relaxed);
+                    if (probeHash == Key(0)) {
+                        if (cell->hash.compareExchangeStrong(probeHash, hash, Relaxed)) {
+                            // Reserved the cell. Link it to the previous cell in the bucket.
+                            prevLink->store(u8(idx - prevLinkIdx), Relaxed);
+                            *outCell = cell;
+                            return InsertResult::InsertedNew;
+                        }
+                    }
+                    if (probeHash == hash) {
+                        *outCell = cell;
+                        return InsertResult::AlreadyFound;
+                    }
+                    if (((u32(probeHash) ^ u32(hash)) & sizeMask) == 0) {
+                        // Another thread reserved a cell in the same bucket but hasn't linked it
+                        // yet. Link it ourselves and keep following the chain.
+                        prevLink->store(u8(idx - prevLinkIdx), Relaxed);
+                        idx = prevLinkIdx;
+                        followLink = true;
+                        break;
+                    }
+                }
+                if (!followLink)
+                    return InsertResult::Overflow;
+            }
+        }
+    }
+
+    // Moves every value into a new table. Values in the old table are replaced with Redirect so
+    // that other threads know to wait for the new table.
+    PLY_NO_INLINE void migrate(Table* table) {
+        LockGuard<Mutex> guard{this->migrationMutex};
+        if (this->root.load(Relaxed) != table)
+            return; // Another thread already migrated it
+
+        struct Entry {
+            Key hash;
+            Value value;
+        };
+        Array<Entry> entries;
+        u32 tableSize = table->sizeMask + 1;
+        for (u32 idx = 0; idx < tableSize; idx++) {
+            Cell* cell = getCell(table, idx);
+            Value value = cell->value.load(Relaxed);
+            for (;;) {
+                PLY_ASSERT(value != ValueTraits::redirect());
+                if (cell->value.compareExchangeStrong(value, ValueTraits::redirect(), Acquire))
+                    break;
+            }
+            if (value != ValueTraits::null()) {
+                Key hash = cell->hash.load(Relaxed);
+                PLY_ASSERT(hash != Key(0));
+                entries.append({hash, value});
+            }
+        }
+
+        // Keep the new table at most half full. Erased cells aren't carried over.
+        u32 newSize = max(u32{InitialSize}, roundUpPowerOf2(entries.numItems() * 2));
+        Table* newTable = nullptr;
+        for (;;) {
+            newTable = Table::create(newSize);
+            bool overflowed = false;
+            for (const Entry& entry : entries) {
+                Cell* cell = nullptr;
+                if (insertOrFind(entry.hash, newTable, &cell) == InsertResult::Overflow) {
+                    overflowed = true;
+                    break;
+                }
+                cell->value.storeNonatomic(entry.value);
+            }
+            if (!overflowed)
+                break;
+            Table::destroy(newTable);
+            newSize *= 2;
+        }
+
+        this->root.store(newTable, Release);
+        this->qsbr->enqueue([table] { Table::destroy(table); });
+    }
+
+    // Called when a thread finds a Redirect marker. Returns once the migration is complete.
+    PLY_NO_INLINE void waitForMigration() {
+        LockGuard<Mutex> guard{this->migrationMutex};
+    }
+
+public:
+    PLY_INLINE ConcurrentMap(QSBR* qsbr, u32 initialSize = InitialSize) : qsbr{qsbr} {
+        this->root.storeNonatomic(Table::create(roundUpPowerOf2(max(initialSize, 4u))));
+    }
+    // The caller must make sure no other thread is still using the map.
+    PLY_INLINE ~ConcurrentMap() {
+        Table::destroy(this->root.loadNonatomic());
+    }
+
+    // Returns the value associated with key, or 0 (null) if there's none.
+    PLY_INLINE Value get(Key key) {
+        Key hash = KeyTraits::hash(key);
+        PLY_ASSERT(hash != Key(0));
+        for (;;) {
+            Table* table = this->root.load(Acquire);
+            Cell* cell = find(hash, table);
+            if (!cell)
+                return ValueTraits::null();
+            Value value = cell->value.load(Acquire);
+            if (value != ValueTraits::redirect())
+                return value;
+            this->waitForMigration();
+        }
+    }
+
+    // Associates desired with key and returns the previous value, or 0 (null) if there was none.
+    PLY_NO_INLINE Value assign(Key key, Value desired) {
+        Key hash = KeyTraits::hash(key);
+        PLY_ASSERT(hash != Key(0));
+        PLY_ASSERT(desired != ValueTraits::null() && desired != ValueTraits::redirect());
+        for (;;) {
+            Table* table = this->root.load(Acquire);
+            Cell* cell = nullptr;
+            if (insertOrFind(hash, table, &cell) == InsertResult::Overflow) {
+                this->migrate(table);
+                continue;
+            }
+            Value oldValue = cell->value.load(Relaxed);
+            for (;;) {
+                if (oldValue == ValueTraits::redirect())
+                    break;
+                if (cell->value.compareExchangeWeak(oldValue, desired, Release, Relaxed))
+                    return oldValue;
+            }
+            this->waitForMigration();
+        }
+    }
+
+    // Associates desired with key only if key has no value. Returns the existing value, or 0 (null)
+    // if desired was stored.
+    PLY_NO_INLINE Value insertIfAbsent(Key key, Value desired) {
+        Key hash = KeyTraits::hash(key);
+        PLY_ASSERT(hash != Key(0));
+        PLY_ASSERT(desired != ValueTraits::null() && desired != ValueTraits::redirect());
+        for (;;) {
+            Table* table = this->root.load(Acquire);
+            Cell* cell = nullptr;
+            if (insertOrFind(hash, table, &cell) == InsertResult::Overflow) {
+                this->migrate(table);
+                continue;
+            }
+            Value oldValue = ValueTraits::null();
+            if (cell->value.compareExchangeStrong(oldValue, desired, AcquireRelease))
+                return ValueTraits::null();
+            if (oldValue != ValueTraits::redirect())
+                return oldValue;
+            this->waitForMigration();
+        }
+    }
+
+    // Removes key's value and returns it, or returns 0 (null) if there was none. The cell keeps its
+    // hash until the next migration.
+    PLY_NO_INLINE Value erase(Key key) {
+        Key hash = KeyTraits::hash(key);
+        PLY_ASSERT(hash != Key(0));
+        for (;;) {
+            Table* table = this->root.load(Acquire);
+            Cell* cell = find(hash, table);
+            if (!cell)
+                return ValueTraits::null();
+            Value oldValue = cell->value.load(Relaxed);
+            for (;;) {
+                if (oldValue == ValueTraits::null())
+                    return oldValue;
+                if (oldValue == ValueTraits::redirect())
+                    break;
+                if (cell->value.compareExchangeWeak(oldValue, ValueTraits::null(), Acquire,
+                                                    Relaxed))
+                    return oldValue;
+            }
+            this->waitForMigration();
+        }
+    }
+};
+
+} // namespace ply
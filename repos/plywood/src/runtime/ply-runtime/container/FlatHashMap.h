@@ -0,0 +1,540 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/container/HashMap.h>
+#if PLY_CPU_X86 || PLY_CPU_X64
+#include <emmintrin.h>
+#elif PLY_CPU_ARM64
+#include <arm_neon.h>
+#endif
+#if PLY_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace ply {
+namespace details {
+
+struct FlatHashMap {
+    static constexpr u32 GroupSize = 16;
+    static constexpr u32 MinSize = 16;
+    static constexpr u8 EmptySlot = 0x80;
+
+    // Flags passed to the Cursor constructor
+    static constexpr u32 AllowFind = 1;
+    static constexpr u32 AllowInsert = 2;
+
+    // Returns a mask with bit i set if ctrl[i] == value, for 16 consecutive control bytes.
+    static PLY_INLINE u32 matchGroup(const u8* ctrl, u8 value) {
+#if PLY_CPU_X86 || PLY_CPU_X64
+        __m128i group = _mm_loadu_si128((const __m128i*) ctrl);
+        return (u32) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) value)));
+#elif PLY_CPU_ARM64
+        static const u8 weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                       1, 2, 4, 8, 16, 32, 64, 128};
+        uint8x16_t eq = vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(value));
+        uint8x16_t bits = vandq_u8(eq, vld1q_u8(weights));
+        return (u32) vaddv_u8(vget_low_u8(bits)) | ((u32) vaddv_u8(vget_high_u8(bits)) << 8);
+#else
+        u32 mask = 0;
+        for (u32 i = 0; i < GroupSize; i++) {
+            mask |= u32(ctrl[i] == value) << i;
+        }
+        return mask;
+#endif
+    }
+
+    static PLY_INLINE u32 lowestBit(u32 mask) {
+        PLY_ASSERT(mask != 0);
+#if PLY_COMPILER_MSVC
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    static PLY_INLINE void prefetch(const void* ptr) {
+#if PLY_CPU_X86 || PLY_CPU_X64
+        _mm_prefetch((const char*) ptr, _MM_HINT_T0);
+#elif PLY_COMPILER_GCC
+        __builtin_prefetch(ptr);
+#endif
+    }
+
+    PLY_SFINAE_EXPR_1(HasConstruct, &T0::construct);
+    PLY_SFINAE_EXPR_1(HasHash, &T0::hash);
+    PLY_SFINAE_EXPR_1(HasContext, (typename T0::Context*) nullptr);
+};
+
+} // namespace details
+
+//------------------------------------------------------------------------------------------------
+/*!
+A hash map with the same Traits and interface as `HashMap`, but with a different implementation
+that's faster for most workloads.
+
+Items are stored in a flat array with a separate array of one-byte control values, one per slot.
+Each control value holds 7 bits of the item's hash, so a lookup can compare 16 slots at a time
+using SSE2 or NEON, and only calls `Traits::match` on slots whose hash bits agree. Slots are probed
+linearly, which lets `erase` shift later items back instead of leaving tombstones.
+
+Everything is inlined: there's no table of callbacks, as there is in `HashMap`. Because items move
+when others are erased, a `Cursor` or iterator is invalidated by any change to the map.
+*/
+template <class Traits>
+class FlatHashMap {
+private:
+    using Key = typename Traits::Key;
+    using Item = typename Traits::Item;
+    using Context = typename details::HashMap::Context<Traits>::Type;
+    using Impl = details::FlatHashMap;
+
+    // Slots are never constructed as a whole; only their items are. The full hash is kept next to
+    // the item so that the table can grow and items can be shifted back without rehashing.
+    struct Slot {
+        u32 hash;
+        Item item;
+    };
+
+    // m_ctrl has m_sizeMask + 1 + GroupSize - 1 entries. The last GroupSize - 1 entries mirror the
+    // first ones so that groups can be loaded at any position without wrapping around.
+    u8* m_ctrl = nullptr;
+    Slot* m_slots = nullptr;
+    u32 m_sizeMask = 0;
+    u32 m_population = 0;
+
+    template <typename U = Traits, std::enable_if_t<Impl::HasHash<U>, int> = 0>
+    static PLY_INLINE u32 hashKey(const Key& key) {
+        return Traits::hash(key);
+    }
+    template <typename U = Traits, std::enable_if_t<!Impl::HasHash<U>, int> = 0>
+    static PLY_INLINE u32 hashKey(const Key& key) {
+        return Hasher::hash(key);
+    }
+
+    template <typename U = Traits, std::enable_if_t<Impl::HasContext<U>, int> = 0>
+    static PLY_INLINE bool matchKey(const Item& item, const Key& key, const Context* context) {
+        return Traits::match(item, key, *context);
+    }
+    template <typename U = Traits, std::enable_if_t<!Impl::HasContext<U>, int> = 0>
+    static PLY_INLINE bool matchKey(const Item& item, const Key& key, const Context*) {
+        return Traits::match(item, key);
+    }
+
+    template <typename U = Traits, std::enable_if_t<Impl::HasConstruct<U>, int> = 0>
+    static PLY_INLINE void constructItem(Item* item, const Key& key) {
+        Traits::construct(item, key);
+    }
+    template <typename U = Traits,
+              std::enable_if_t<!Impl::HasConstruct<U> &&
+                                   std::is_constructible<typename U::Item, typename U::Key>::value,
+                               int> = 0>
+    static PLY_INLINE void constructItem(Item* item, const Key& key) {
+        new (item) Item{key};
+    }
+    template <typename U = Traits,
+              std::enable_if_t<!Impl::HasConstruct<U> &&
+                                   !std::is_constructible<typename U::Item, typename U::Key>::value,
+                               int> = 0>
+    static PLY_INLINE void constructItem(Item* item, const Key&) {
+        new (item) Item{};
+    }
+
+    static PLY_INLINE u8 ctrlFromHash(u32 hash) {
+        return u8(hash >> 25);
+    }
+
+    PLY_INLINE void setCtrl(u32 idx, u8 value) {
+        m_ctrl[idx] = value;
+        if (idx < Impl::GroupSize - 1) {
+            m_ctrl[m_sizeMask + 1 + idx] = value;
+        }
+    }
+
+    PLY_NO_INLINE void allocTable(u32 size) {
+        PLY_ASSERT(isPowerOf2(size) && size >= Impl::MinSize);
+        m_ctrl = (u8*) PLY_HEAP.alloc(size + Impl::GroupSize - 1);
+        memset(m_ctrl, Impl::EmptySlot, size + Impl::GroupSize - 1);
+        m_slots = (Slot*) PLY_HEAP.alloc(sizeof(Slot) * size);
+        m_sizeMask = size - 1;
+    }
+
+    PLY_NO_INLINE void destroyTable() {
+        if (!std::is_trivially_destructible<Item>::value) {
+            for (u32 i = 0; i <= m_sizeMask; i++) {
+                if (m_ctrl[i] != Impl::EmptySlot) {
+                    m_slots[i].item.~Item();
+                }
+            }
+        }
+        PLY_HEAP.free(m_ctrl);
+        PLY_HEAP.free(m_slots);
+    }
+
+    // Returns the index of the first empty slot in the probe sequence for hash.
+    PLY_INLINE u32 findEmptySlot(u32 hash) const {
+        for (u32 pos = hash & m_sizeMask;; pos = (pos + Impl::GroupSize) & m_sizeMask) {
+            u32 emptyMask = Impl::matchGroup(m_ctrl + pos, Impl::EmptySlot);
+            if (emptyMask != 0)
+                return (pos + Impl::lowestBit(emptyMask)) & m_sizeMask;
+        }
+    }
+
+    PLY_NO_INLINE void migrateToNewTable() {
+        u8* oldCtrl = m_ctrl;
+        Slot* oldSlots = m_slots;
+        u32 oldSize = m_sizeMask + 1;
+        this->allocTable(oldSize * 2);
+        for (u32 i = 0; i < oldSize; i++) {
+            if (oldCtrl[i] != Impl::EmptySlot) {
+                u32 hash = oldSlots[i].hash;
+                u32 idx = this->findEmptySlot(hash);
+                this->setCtrl(idx, oldCtrl[i]);
+                m_slots[idx].hash = hash;
+                new (&m_slots[idx].item) Item{std::move(oldSlots[i].item)};
+                oldSlots[i].item.~Item();
+            }
+        }
+        PLY_HEAP.free(oldCtrl);
+        PLY_HEAP.free(oldSlots);
+    }
+
+    // Returns the index of the first matching item at or after start, or the index where it should
+    // be inserted with wasFound set to false. start must be in the probe sequence for hash, and not
+    // past the first empty slot.
+    PLY_INLINE u32 findSlot(const Key& key, u32 hash, u32 start, const Context* context,
+                            bool& wasFound) const {
+        u8 ctrl = ctrlFromHash(hash);
+        // Load the first slot while the control bytes are being compared
+        Impl::prefetch(&m_slots[start]);
+        for (u32 pos = start;; pos = (pos + Impl::GroupSize) & m_sizeMask) {
+            u32 emptyMask = Impl::matchGroup(m_ctrl + pos, Impl::EmptySlot);
+            // Items are never stored past an empty slot in their probe sequence
+            u32 candidates = Impl::matchGroup(m_ctrl + pos, ctrl);
+            if (emptyMask != 0) {
+                candidates &= (emptyMask & (0 - emptyMask)) - 1;
+            }
+            while (candidates != 0) {
+                u32 idx = (pos + Impl::lowestBit(candidates)) & m_sizeMask;
+                if (matchKey(m_slots[idx].item, key, context)) {
+                    wasFound = true;
+                    return idx;
+                }
+                candidates &= candidates - 1;
+            }
+            if (emptyMask != 0) {
+                wasFound = false;
+                return (pos + Impl::lowestBit(emptyMask)) & m_sizeMask;
+            }
+        }
+    }
+
+    PLY_INLINE u32 findSlot(const Key& key, u32 hash, const Context* context,
+                            bool& wasFound) const {
+        return this->findSlot(key, hash, hash & m_sizeMask, context, wasFound);
+    }
+
+    PLY_NO_INLINE void eraseAt(u32 idx) {
+        PLY_ASSERT(m_ctrl[idx] != Impl::EmptySlot);
+        m_slots[idx].item.~Item();
+        // Shift back any following items that would no longer be reachable from their home slot
+        u32 hole = idx;
+        for (u32 next = (idx + 1) & m_sizeMask; m_ctrl[next] != Impl::EmptySlot;
+             next = (next + 1) & m_sizeMask) {
+            u32 home = m_slots[next].hash & m_sizeMask;
+            if (((next - home) & m_sizeMask) >= ((next - hole) & m_sizeMask)) {
+                this->setCtrl(hole, m_ctrl[next]);
+                m_slots[hole].hash = m_slots[next].hash;
+                new (&m_slots[hole].item) Item{std::move(m_slots[next].item)};
+                m_slots[next].item.~Item();
+                hole = next;
+            }
+        }
+        this->setCtrl(hole, Impl::EmptySlot);
+        m_population--;
+    }
+
+public:
+    /*!
+    Constructs an empty `FlatHashMap`.
+    */
+    PLY_INLINE FlatHashMap(u32 initialSize = Impl::MinSize) {
+        this->allocTable(max(roundUpPowerOf2(initialSize), Impl::MinSize));
+    }
+
+    /*!
+    Move constructor. `other` is set to an invalid state. After this call, it's not legal to insert
+    or find items in `other` unless it is set back to a valid state using move assignment.
+    */
+    PLY_INLINE FlatHashMap(FlatHashMap&& other)
+        : m_ctrl{other.m_ctrl}, m_slots{other.m_slots}, m_sizeMask{other.m_sizeMask},
+          m_population{other.m_population} {
+        other.m_ctrl = nullptr;
+    }
+
+    PLY_INLINE ~FlatHashMap() {
+        if (m_ctrl) {
+            this->destroyTable();
+        }
+    }
+
+    /*!
+    Move assignment operator. `other` is set to an invalid state, as with the move constructor.
+    */
+    PLY_INLINE void operator=(FlatHashMap&& other) {
+        this->~FlatHashMap();
+        new (this) FlatHashMap{std::move(other)};
+    }
+
+    /*!
+    Destructs all `Item`s in the map, leaving it empty.
+    */
+    PLY_INLINE void clear() {
+        this->destroyTable();
+        this->allocTable(Impl::MinSize);
+        m_population = 0;
+    }
+
+    //------------------------------------------------------------------
+    // Cursor
+    //------------------------------------------------------------------
+    class Cursor : public CursorMixin<Cursor, Item> {
+    private:
+        friend class FlatHashMap;
+        template <class, typename, bool>
+        friend class CursorMixin;
+
+        struct FindInfo {
+            Item* itemSlot; // null means not found
+        };
+
+        FlatHashMap* m_map;
+        FindInfo m_findInfo;
+        u32 m_idx;
+        bool m_wasFound;
+
+        PLY_INLINE Cursor(FlatHashMap* map, const Key& key, const Context* context, u32 flags)
+            : m_map{map} {
+            u32 hash = hashKey(key);
+            if (flags & Impl::AllowFind) {
+                m_idx = map->findSlot(key, hash, context, m_wasFound);
+            } else {
+                m_idx = map->findEmptySlot(hash);
+                m_wasFound = false;
+            }
+            if (m_wasFound) {
+                m_findInfo.itemSlot = &map->m_slots[m_idx].item;
+            } else if (flags & Impl::AllowInsert) {
+                // Keep the load factor at or below 7/8
+                if ((map->m_population + 1) * 8 > (map->m_sizeMask + 1) * 7) {
+                    map->migrateToNewTable();
+                    m_idx = map->findEmptySlot(hash);
+                }
+                map->setCtrl(m_idx, ctrlFromHash(hash));
+                map->m_slots[m_idx].hash = hash;
+                constructItem(&map->m_slots[m_idx].item, key);
+                map->m_population++;
+                m_findInfo.itemSlot = &map->m_slots[m_idx].item;
+            } else {
+                m_findInfo.itemSlot = nullptr;
+            }
+        }
+
+    public:
+        PLY_INLINE bool isValid() const {
+            return m_findInfo.itemSlot != nullptr;
+        }
+        PLY_INLINE bool wasFound() const {
+            return m_wasFound;
+        }
+        // Moves to the next item that matches key, if any. key must match the current item.
+        PLY_INLINE void next(const Key& key, const Context* context = nullptr) {
+            PLY_ASSERT(m_findInfo.itemSlot);
+            m_idx = m_map->findSlot(key, hashKey(key), (m_idx + 1) & m_map->m_sizeMask, context,
+                                    m_wasFound);
+            m_findInfo.itemSlot = m_wasFound ? &m_map->m_slots[m_idx].item : nullptr;
+        }
+        PLY_INLINE Item& operator*() {
+            PLY_ASSERT(m_findInfo.itemSlot);
+            return *m_findInfo.itemSlot;
+        }
+        PLY_INLINE const Item& operator*() const {
+            PLY_ASSERT(m_findInfo.itemSlot);
+            return *m_findInfo.itemSlot;
+        }
+        PLY_INLINE void erase() {
+            PLY_ASSERT(m_findInfo.itemSlot);
+            m_map->eraseAt(m_idx);
+            m_findInfo.itemSlot = nullptr;
+            m_wasFound = false;
+        }
+        // Erases the current item and moves to the next item that matches key, if any
+        PLY_INLINE void eraseAndAdvance(const Key& key, const Context* context = nullptr) {
+            PLY_ASSERT(m_findInfo.itemSlot);
+            m_map->eraseAt(m_idx);
+            // Later items were shifted back, so the next match can be at the same index
+            m_idx = m_map->findSlot(key, hashKey(key), m_idx, context, m_wasFound);
+            m_findInfo.itemSlot = m_wasFound ? &m_map->m_slots[m_idx].item : nullptr;
+        }
+    };
+
+    //------------------------------------------------------------------
+    // ConstCursor
+    //------------------------------------------------------------------
+    class ConstCursor : public CursorMixin<ConstCursor, const Item> {
+    private:
+        friend class FlatHashMap;
+        template <class, typename, bool>
+        friend class CursorMixin;
+
+        struct FindInfo {
+            const Item* itemSlot; // null means not found
+        };
+
+        const FlatHashMap* m_map;
+        FindInfo m_findInfo;
+        u32 m_idx;
+
+        PLY_INLINE ConstCursor(const FlatHashMap* map, const Key& key, const Context* context)
+            : m_map{map} {
+            bool wasFound;
+            m_idx = map->findSlot(key, hashKey(key), context, wasFound);
+            m_findInfo.itemSlot = wasFound ? &map->m_slots[m_idx].item : nullptr;
+        }
+
+    public:
+        PLY_INLINE bool isValid() const {
+            return m_findInfo.itemSlot != nullptr;
+        }
+        PLY_INLINE bool wasFound() const {
+            return m_findInfo.itemSlot != nullptr;
+        }
+        // Moves to the next item that matches key, if any. key must match the current item.
+        PLY_INLINE void next(const Key& key, const Context* context = nullptr) {
+            PLY_ASSERT(m_findInfo.itemSlot);
+            bool wasFound;
+            m_idx = m_map->findSlot(key, hashKey(key), (m_idx + 1) & m_map->m_sizeMask, context,
+                                    wasFound);
+            m_findInfo.itemSlot = wasFound ? &m_map->m_slots[m_idx].item : nullptr;
+        }
+        PLY_INLINE const Item& operator*() const {
+            PLY_ASSERT(m_findInfo.itemSlot);
+            return *m_findInfo.itemSlot;
+        }
+    };
+
+    /*!
+    Returns `true` if the map is empty.
+    */
+    PLY_INLINE bool isEmpty() const {
+        return m_population == 0;
+    }
+
+    /*!
+    Returns the number of items in the map.
+    */
+    PLY_INLINE u32 numItems() const {
+        return m_population;
+    }
+
+    /*!
+    Find `Key` in the map. If no matching `Item` exists, a new item is inserted. Call
+    `Cursor::wasFound()` on the return value to determine whether the item was found or inserted.
+    */
+    PLY_INLINE Cursor insertOrFind(const Key& key, const Context* context = nullptr) {
+        return {this, key, context, Impl::AllowFind | Impl::AllowInsert};
+    }
+
+    /*!
+    Inserts a new `Item` even if a matching item already exists. Use `Cursor::next()` to visit every
+    item that matches a key.
+    */
+    PLY_INLINE Cursor insertMulti(const Key& key, const Context* context = nullptr) {
+        return {this, key, context, Impl::AllowInsert};
+    }
+
+    /*!
+    \beginGroup
+    Attempts to find `Key` in the map. Call `Cursor::wasFound()` on the return value to determine
+    whether a matching `Item` was found.
+    */
+    PLY_INLINE Cursor find(const Key& key, const Context* context = nullptr) {
+        return {this, key, context, Impl::AllowFind};
+    }
+    PLY_INLINE ConstCursor find(const Key& key, const Context* context = nullptr) const {
+        return {this, key, context};
+    }
+    /*!
+    \endGroup
+    */
+
+    //------------------------------------------------------------------
+    // Iterator
+    //------------------------------------------------------------------
+    template <typename M, typename I>
+    class IteratorBase {
+    private:
+        friend class FlatHashMap;
+        M& m_map;
+        u32 m_idx;
+
+        IteratorBase(M& map, u32 idx) : m_map{map}, m_idx{idx} {
+        }
+
+    public:
+        bool isValid() const {
+            return m_idx <= m_map.m_sizeMask;
+        }
+        void next() {
+            do {
+                m_idx++;
+            } while (m_idx <= m_map.m_sizeMask && m_map.m_ctrl[m_idx] == Impl::EmptySlot);
+        }
+        bool operator!=(const IteratorBase& other) const {
+            PLY_ASSERT(&m_map == &other.m_map);
+            return m_idx != other.m_idx;
+        }
+        void operator++() {
+            next();
+        }
+        I& operator*() const {
+            PLY_ASSERT(m_idx <= m_map.m_sizeMask && m_map.m_ctrl[m_idx] != Impl::EmptySlot);
+            return m_map.m_slots[m_idx].item;
+        }
+        I* operator->() const {
+            return &(**this);
+        }
+    };
+    using Iterator = IteratorBase<FlatHashMap, Item>;
+    using ConstIterator = IteratorBase<const FlatHashMap, const Item>;
+
+    /*!
+    \beginGroup
+    Required functions to support range-for syntax.
+    */
+    Iterator begin() {
+        Iterator iter{*this, (u32) -1};
+        iter.next();
+        return iter;
+    }
+    ConstIterator begin() const {
+        ConstIterator iter{*this, (u32) -1};
+        iter.next();
+        return iter;
+    }
+    Iterator end() {
+        return {*this, m_sizeMask + 1};
+    }
+    ConstIterator end() const {
+        return {*this, m_sizeMask + 1};
+    }
+    /*!
+    \endGroup
+    */
+};
+
+} // namespace ply
@@ -4,6 +4,7 @@
 ------------------------------------*/
 #include <ply-runtime/Precomp.h>
 #include <ply-runtime/container/Hash.h>
+#include <ply-runtime/container/XXH3.h>
 
 namespace ply {
 
@@ -22,6 +23,10 @@ PLY_NO_INLINE Hasher& operator<<(Hasher& hasher, u32 value) {
 }
 
 PLY_NO_INLINE Hasher& operator<<(Hasher& hasher, StringView buf) {
+#if PLY_HASHER_STRING_MODE == 1
+    hasher << XXH3::hash64(buf);
+    return hasher;
+#else
     // FIXME: More work is needed for platforms that don't support unaligned reads
 
     while (buf.numBytes >= 4) {
@@ -40,6 +45,7 @@ PLY_NO_INLINE Hasher& operator<<(Hasher& hasher, StringView buf) {
         hasher << v;
     }
     return hasher;
+#endif
 }
 
 } // namespace ply
@@ -6,6 +6,13 @@
 #include <ply-runtime/Core.h>
 #include <ply-runtime/string/StringView.h>
 
+// Choose how strings are hashed, if not already configured by ply_userconfig.h:
+// 0 = four bytes at a time through the murmur3 mixer
+// 1 = XXH3, whose 64-bit result is then mixed in like a u64
+#if !defined(PLY_HASHER_STRING_MODE)
+#define PLY_HASHER_STRING_MODE 1
+#endif
+
 namespace ply {
 
 // Adapted from https://github.com/aappleby/smhasher
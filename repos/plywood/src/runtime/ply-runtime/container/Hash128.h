@@ -35,6 +35,7 @@
 #include <ply-runtime/Core.h>
 #include <ply-runtime/string/StringView.h>
 #include <ply-runtime/container/Int128.h>
+#include <ply-runtime/container/XXH3.h>
 
 namespace ply {
 
@@ -285,4 +286,20 @@ struct Hash128 {
     static u128 compute(StringView view);
 };
 
+// Same interface as Hash128, but uses XXH3, which is several times faster on long inputs. The two
+// give different results, so hashes that were saved by one can't be checked using the other.
+struct FastHash128 {
+    XXH3 state;
+
+    PLY_INLINE void append(StringView view) {
+        this->state.append(view);
+    }
+    PLY_INLINE u128 get() const {
+        return this->state.get128();
+    }
+    static PLY_INLINE u128 compute(StringView view) {
+        return XXH3::hash128(view);
+    }
+};
+
 } // namespace ply
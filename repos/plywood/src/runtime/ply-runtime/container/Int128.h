@@ -4,6 +4,9 @@
 ------------------------------------*/
 #pragma once
 #include <ply-runtime/Core.h>
+#if PLY_COMPILER_MSVC
+#include <intrin.h>
+#endif
 
 namespace ply {
 
@@ -32,4 +35,25 @@ struct u128 {
     }
 };
 
+// Full 128-bit product of two 64-bit integers
+PLY_INLINE u128 mul64to128(u64 lhs, u64 rhs) {
+    u128 r;
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128) lhs * rhs;
+    r.lo = u64(product);
+    r.hi = u64(product >> 64);
+#elif PLY_COMPILER_MSVC && PLY_CPU_X64
+    r.lo = _umul128(lhs, rhs, &r.hi);
+#else
+    u64 loLo = (lhs & 0xffffffff) * (rhs & 0xffffffff);
+    u64 hiLo = (lhs >> 32) * (rhs & 0xffffffff);
+    u64 loHi = (lhs & 0xffffffff) * (rhs >> 32);
+    u64 hiHi = (lhs >> 32) * (rhs >> 32);
+    u64 cross = (loLo >> 32) + (hiLo & 0xffffffff) + loHi;
+    r.hi = (hiLo >> 32) + (cross >> 32) + hiHi;
+    r.lo = (cross << 32) | (loLo & 0xffffffff);
+#endif
+    return r;
+}
+
 } // namespace ply
@@ -46,6 +46,19 @@ public:
         }
     }
 
+    // Increments the reference count unless it already dropped to zero, which means another
+    // thread is about to call onRefCountZero. Used when looking up objects in a shared table that
+    // onRefCountZero removes them from.
+    bool tryIncRef() {
+        s32 oldCount = m_refCount.load(Relaxed);
+        while (oldCount > 0) {
+            PLY_ASSERT(oldCount < UINT16_MAX);
+            if (m_refCount.compareExchangeWeak(oldCount, oldCount + 1, Relaxed, Relaxed))
+                return true;
+        }
+        return false;
+    }
+
     s32 getRefCount() const {
         return m_refCount.load(Relaxed);
     }
@@ -0,0 +1,602 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+
+// XXH3, ported from xxhash.h version 0.8.2
+// Copyright (C) 2012-2023 Yann Collet
+// BSD 2-Clause License (https://www.opensource.org/licenses/bsd-license.php)
+
+#include <ply-runtime/Precomp.h>
+#include <ply-runtime/container/XXH3.h>
+#include <string.h>
+#if PLY_CPU_X86 || PLY_CPU_X64
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#elif PLY_CPU_ARM64
+#include <arm_neon.h>
+#endif
+
+namespace ply {
+
+namespace {
+
+constexpr u32 Prime32_1 = 0x9e3779b1u;
+constexpr u32 Prime32_2 = 0x85ebca77u;
+constexpr u32 Prime32_3 = 0xc2b2ae3du;
+constexpr u64 Prime64_1 = 0x9e3779b185ebca87ull;
+constexpr u64 Prime64_2 = 0xc2b2ae3d27d4eb4full;
+constexpr u64 Prime64_3 = 0x165667b19e3779f9ull;
+constexpr u64 Prime64_4 = 0x85ebca77c2b2ae63ull;
+constexpr u64 Prime64_5 = 0x27d4eb2f165667c5ull;
+constexpr u64 PrimeMx1 = 0x165667919e3779f9ull;
+constexpr u64 PrimeMx2 = 0x9fb21c651e98df25ull;
+
+constexpr u32 StripeLen = XXH3::StripeLen;
+constexpr u32 SecretSize = 192;
+constexpr u32 SecretSizeMin = 136;
+constexpr u32 SecretConsumeRate = 8;
+constexpr u32 SecretLimit = SecretSize - StripeLen;
+constexpr u32 StripesPerBlock = SecretLimit / SecretConsumeRate;
+constexpr u32 MidSizeMax = 240;
+constexpr u32 MidSizeStartOffset = 3;
+constexpr u32 MidSizeLastOffset = 17;
+constexpr u32 SecretLastAccStart = 7;
+constexpr u32 SecretMergeAccsStart = 11;
+
+// Pseudorandom secret taken directly from FARSH
+alignas(64) const u8 Secret[SecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+//------------------------------------
+// Primitives
+//------------------------------------
+PLY_INLINE u32 read32(const u8* p) {
+    u32 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+PLY_INLINE u64 read64(const u8* p) {
+    u64 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+PLY_INLINE u32 swap32(u32 x) {
+    return ((x << 24) & 0xff000000u) | ((x << 8) & 0x00ff0000u) | ((x >> 8) & 0x0000ff00u) |
+           ((x >> 24) & 0x000000ffu);
+}
+
+PLY_INLINE u64 swap64(u64 x) {
+    return (u64(swap32(u32(x))) << 32) | swap32(u32(x >> 32));
+}
+
+PLY_INLINE u32 rotl32(u32 x, u32 r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+PLY_INLINE u64 rotl64(u64 x, u32 r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+PLY_INLINE u64 xorShift64(u64 v, u32 shift) {
+    return v ^ (v >> shift);
+}
+
+PLY_INLINE u64 mul128Fold64(u64 lhs, u64 rhs) {
+    u128 product = mul64to128(lhs, rhs);
+    return product.lo ^ product.hi;
+}
+
+PLY_INLINE u64 avalanche64(u64 h) {
+    h ^= h >> 33;
+    h *= Prime64_2;
+    h ^= h >> 29;
+    h *= Prime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+PLY_INLINE u64 avalanche(u64 h) {
+    h = xorShift64(h, 37);
+    h *= PrimeMx1;
+    return xorShift64(h, 32);
+}
+
+PLY_INLINE u64 rrmxmx(u64 h, u64 len) {
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= PrimeMx2;
+    h ^= (h >> 35) + len;
+    h *= PrimeMx2;
+    return xorShift64(h, 28);
+}
+
+PLY_INLINE u64 mix16B(const u8* input, const u8* secret) {
+    return mul128Fold64(read64(input) ^ read64(secret), read64(input + 8) ^ read64(secret + 8));
+}
+
+PLY_INLINE u128 mix32B(u128 acc, const u8* input1, const u8* input2, const u8* secret) {
+    acc.lo += mix16B(input1, secret);
+    acc.lo ^= read64(input2) + read64(input2 + 8);
+    acc.hi += mix16B(input2, secret + 16);
+    acc.hi ^= read64(input1) + read64(input1 + 8);
+    return acc;
+}
+
+//------------------------------------
+// Long inputs
+//------------------------------------
+#if defined(__AVX2__)
+// The accumulators are kept in registers while a run of stripes is consumed
+PLY_INLINE void accumulate(u64* acc, const u8* input, const u8* secret, u32 numStripes) {
+    __m256i accVec[2];
+    for (u32 i = 0; i < 2; i++) {
+        accVec[i] = _mm256_loadu_si256((const __m256i*) acc + i);
+    }
+    for (u32 n = 0; n < numStripes; n++) {
+        const u8* stripe = input + n * StripeLen;
+        const u8* key = secret + n * SecretConsumeRate;
+        for (u32 i = 0; i < 2; i++) {
+            __m256i dataVec = _mm256_loadu_si256((const __m256i*) stripe + i);
+            __m256i keyVec = _mm256_loadu_si256((const __m256i*) key + i);
+            __m256i dataKey = _mm256_xor_si256(dataVec, keyVec);
+            __m256i dataKeyLo = _mm256_srli_epi64(dataKey, 32);
+            __m256i product = _mm256_mul_epu32(dataKey, dataKeyLo);
+            __m256i dataSwap = _mm256_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+            accVec[i] = _mm256_add_epi64(product, _mm256_add_epi64(accVec[i], dataSwap));
+        }
+    }
+    for (u32 i = 0; i < 2; i++) {
+        _mm256_storeu_si256((__m256i*) acc + i, accVec[i]);
+    }
+}
+
+PLY_INLINE void scrambleAcc(u64* acc, const u8* secret) {
+    __m256i prime32 = _mm256_set1_epi32((int) Prime32_1);
+    for (u32 i = 0; i < 2; i++) {
+        __m256i accVec = _mm256_loadu_si256((const __m256i*) acc + i);
+        __m256i dataVec = _mm256_xor_si256(accVec, _mm256_srli_epi64(accVec, 47));
+        __m256i keyVec = _mm256_loadu_si256((const __m256i*) secret + i);
+        __m256i dataKey = _mm256_xor_si256(dataVec, keyVec);
+        __m256i dataKeyHi = _mm256_srli_epi64(dataKey, 32);
+        __m256i prodLo = _mm256_mul_epu32(dataKey, prime32);
+        __m256i prodHi = _mm256_mul_epu32(dataKeyHi, prime32);
+        accVec = _mm256_add_epi64(prodLo, _mm256_slli_epi64(prodHi, 32));
+        _mm256_storeu_si256((__m256i*) acc + i, accVec);
+    }
+}
+#elif PLY_CPU_X86 || PLY_CPU_X64
+PLY_INLINE void accumulate(u64* acc, const u8* input, const u8* secret, u32 numStripes) {
+    __m128i accVec[4];
+    for (u32 i = 0; i < 4; i++) {
+        accVec[i] = _mm_loadu_si128((const __m128i*) acc + i);
+    }
+    for (u32 n = 0; n < numStripes; n++) {
+        const u8* stripe = input + n * StripeLen;
+        const u8* key = secret + n * SecretConsumeRate;
+        for (u32 i = 0; i < 4; i++) {
+            __m128i dataVec = _mm_loadu_si128((const __m128i*) stripe + i);
+            __m128i keyVec = _mm_loadu_si128((const __m128i*) key + i);
+            __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+            __m128i dataKeyLo = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i product = _mm_mul_epu32(dataKey, dataKeyLo);
+            __m128i dataSwap = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+            accVec[i] = _mm_add_epi64(product, _mm_add_epi64(accVec[i], dataSwap));
+        }
+    }
+    for (u32 i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i*) acc + i, accVec[i]);
+    }
+}
+
+PLY_INLINE void scrambleAcc(u64* acc, const u8* secret) {
+    __m128i prime32 = _mm_set1_epi32((int) Prime32_1);
+    for (u32 i = 0; i < 4; i++) {
+        __m128i accVec = _mm_loadu_si128((const __m128i*) acc + i);
+        __m128i dataVec = _mm_xor_si128(accVec, _mm_srli_epi64(accVec, 47));
+        __m128i keyVec = _mm_loadu_si128((const __m128i*) secret + i);
+        __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+        __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i prodLo = _mm_mul_epu32(dataKey, prime32);
+        __m128i prodHi = _mm_mul_epu32(dataKeyHi, prime32);
+        accVec = _mm_add_epi64(prodLo, _mm_slli_epi64(prodHi, 32));
+        _mm_storeu_si128((__m128i*) acc + i, accVec);
+    }
+}
+#elif PLY_CPU_ARM64
+PLY_INLINE void accumulate(u64* acc, const u8* input, const u8* secret, u32 numStripes) {
+    uint64x2_t accVec[4];
+    for (u32 i = 0; i < 4; i++) {
+        accVec[i] = vld1q_u64(acc + i * 2);
+    }
+    for (u32 n = 0; n < numStripes; n++) {
+        const u8* stripe = input + n * StripeLen;
+        const u8* key = secret + n * SecretConsumeRate;
+        for (u32 i = 0; i < 4; i++) {
+            uint64x2_t dataVec = vreinterpretq_u64_u8(vld1q_u8(stripe + i * 16));
+            uint64x2_t keyVec = vreinterpretq_u64_u8(vld1q_u8(key + i * 16));
+            uint64x2_t dataKey = veorq_u64(dataVec, keyVec);
+            uint64x2_t product = vmull_u32(vmovn_u64(dataKey), vshrn_n_u64(dataKey, 32));
+            uint64x2_t dataSwap = vextq_u64(dataVec, dataVec, 1);
+            accVec[i] = vaddq_u64(accVec[i], vaddq_u64(product, dataSwap));
+        }
+    }
+    for (u32 i = 0; i < 4; i++) {
+        vst1q_u64(acc + i * 2, accVec[i]);
+    }
+}
+
+PLY_INLINE void scrambleAcc(u64* acc, const u8* secret) {
+    uint32x2_t prime32 = vdup_n_u32(Prime32_1);
+    for (u32 i = 0; i < 4; i++) {
+        uint64x2_t accVec = vld1q_u64(acc + i * 2);
+        uint64x2_t dataVec = veorq_u64(accVec, vshrq_n_u64(accVec, 47));
+        uint64x2_t keyVec = vreinterpretq_u64_u8(vld1q_u8(secret + i * 16));
+        uint64x2_t dataKey = veorq_u64(dataVec, keyVec);
+        uint64x2_t prodLo = vmull_u32(vmovn_u64(dataKey), prime32);
+        uint64x2_t prodHi = vmull_u32(vshrn_n_u64(dataKey, 32), prime32);
+        vst1q_u64(acc + i * 2, vaddq_u64(prodLo, vshlq_n_u64(prodHi, 32)));
+    }
+}
+#else
+PLY_INLINE void accumulate(u64* acc, const u8* input, const u8* secret, u32 numStripes) {
+    for (u32 n = 0; n < numStripes; n++) {
+        const u8* stripe = input + n * StripeLen;
+        const u8* key = secret + n * SecretConsumeRate;
+        for (u32 i = 0; i < 8; i++) {
+            u64 dataVal = read64(stripe + i * 8);
+            u64 dataKey = dataVal ^ read64(key + i * 8);
+            acc[i ^ 1] += dataVal; // Swap adjacent lanes
+            acc[i] += u64(u32(dataKey)) * u64(u32(dataKey >> 32));
+        }
+    }
+}
+
+PLY_INLINE void scrambleAcc(u64* acc, const u8* secret) {
+    for (u32 i = 0; i < 8; i++) {
+        u64 a = xorShift64(acc[i], 47);
+        a ^= read64(secret + i * 8);
+        acc[i] = a * Prime32_1;
+    }
+}
+#endif
+
+PLY_INLINE void accumulate512(u64* acc, const u8* input, const u8* secret) {
+    accumulate(acc, input, secret, 1);
+}
+
+PLY_INLINE void initAcc(u64* acc) {
+    acc[0] = Prime32_3;
+    acc[1] = Prime64_1;
+    acc[2] = Prime64_2;
+    acc[3] = Prime64_3;
+    acc[4] = Prime64_4;
+    acc[5] = Prime32_2;
+    acc[6] = Prime64_5;
+    acc[7] = Prime32_1;
+}
+
+PLY_NO_INLINE void hashLongLoop(u64* acc, const u8* input, u64 len) {
+    constexpr u32 BlockLen = StripeLen * StripesPerBlock;
+    u64 numBlocks = (len - 1) / BlockLen;
+    for (u64 n = 0; n < numBlocks; n++) {
+        accumulate(acc, input + n * BlockLen, Secret, StripesPerBlock);
+        scrambleAcc(acc, Secret + SecretLimit);
+    }
+    // Last partial block
+    u32 numStripes = u32(((len - 1) - (BlockLen * numBlocks)) / StripeLen);
+    accumulate(acc, input + numBlocks * BlockLen, Secret, numStripes);
+    // Last stripe
+    accumulate512(acc, input + len - StripeLen, Secret + SecretLimit - SecretLastAccStart);
+}
+
+PLY_INLINE u64 mergeAccs(const u64* acc, const u8* secret, u64 start) {
+    u64 result = start;
+    for (u32 i = 0; i < 4; i++) {
+        result += mul128Fold64(acc[2 * i] ^ read64(secret + 16 * i),
+                               acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+    }
+    return avalanche(result);
+}
+
+PLY_INLINE u64 mergeAccs64(const u64* acc, u64 len) {
+    return mergeAccs(acc, Secret + SecretMergeAccsStart, len * Prime64_1);
+}
+
+PLY_INLINE u128 mergeAccs128(const u64* acc, u64 len) {
+    u128 h;
+    h.lo = mergeAccs(acc, Secret + SecretMergeAccsStart, len * Prime64_1);
+    h.hi = mergeAccs(acc, Secret + SecretSize - 64 - SecretMergeAccsStart, ~(len * Prime64_2));
+    return h;
+}
+
+// Used by the incremental interface. Advances numStripesSoFar, scrambling at block boundaries.
+PLY_INLINE const u8* consumeStripes(u64* acc, u32* numStripesSoFar, const u8* input,
+                                    u64 numStripes) {
+    const u8* initialSecret = Secret + *numStripesSoFar * SecretConsumeRate;
+    if (numStripes >= StripesPerBlock - *numStripesSoFar) {
+        u32 numStripesThisIter = StripesPerBlock - *numStripesSoFar;
+        do {
+            accumulate(acc, input, initialSecret, numStripesThisIter);
+            scrambleAcc(acc, Secret + SecretLimit);
+            input += numStripesThisIter * StripeLen;
+            numStripes -= numStripesThisIter;
+            numStripesThisIter = StripesPerBlock;
+            initialSecret = Secret;
+        } while (numStripes >= StripesPerBlock);
+        *numStripesSoFar = 0;
+    }
+    if (numStripes > 0) {
+        accumulate(acc, input, initialSecret, u32(numStripes));
+        input += numStripes * StripeLen;
+        *numStripesSoFar += u32(numStripes);
+    }
+    return input;
+}
+
+//------------------------------------
+// 64-bit short inputs
+//------------------------------------
+PLY_INLINE u64 len0to16_64(const u8* input, u32 len) {
+    if (len > 8) {
+        u64 bitflip1 = read64(Secret + 24) ^ read64(Secret + 32);
+        u64 bitflip2 = read64(Secret + 40) ^ read64(Secret + 48);
+        u64 inputLo = read64(input) ^ bitflip1;
+        u64 inputHi = read64(input + len - 8) ^ bitflip2;
+        u64 acc = len + swap64(inputLo) + inputHi + mul128Fold64(inputLo, inputHi);
+        return avalanche(acc);
+    } else if (len >= 4) {
+        u32 input1 = read32(input);
+        u32 input2 = read32(input + len - 4);
+        u64 bitflip = read64(Secret + 8) ^ read64(Secret + 16);
+        u64 input64 = input2 + (u64(input1) << 32);
+        return rrmxmx(input64 ^ bitflip, len);
+    } else if (len > 0) {
+        u8 c1 = input[0];
+        u8 c2 = input[len >> 1];
+        u8 c3 = input[len - 1];
+        u32 combined = (u32(c1) << 16) | (u32(c2) << 24) | u32(c3) | (len << 8);
+        u64 bitflip = read32(Secret) ^ read32(Secret + 4);
+        return avalanche64(u64(combined) ^ bitflip);
+    }
+    return avalanche64(read64(Secret + 56) ^ read64(Secret + 64));
+}
+
+PLY_INLINE u64 len17to128_64(const u8* input, u32 len) {
+    u64 acc = len * Prime64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += mix16B(input + 48, Secret + 96);
+                acc += mix16B(input + len - 64, Secret + 112);
+            }
+            acc += mix16B(input + 32, Secret + 64);
+            acc += mix16B(input + len - 48, Secret + 80);
+        }
+        acc += mix16B(input + 16, Secret + 32);
+        acc += mix16B(input + len - 32, Secret + 48);
+    }
+    acc += mix16B(input, Secret);
+    acc += mix16B(input + len - 16, Secret + 16);
+    return avalanche(acc);
+}
+
+PLY_NO_INLINE u64 len129to240_64(const u8* input, u32 len) {
+    u64 acc = len * Prime64_1;
+    u32 numRounds = len / 16;
+    for (u32 i = 0; i < 8; i++) {
+        acc += mix16B(input + 16 * i, Secret + 16 * i);
+    }
+    u64 accEnd = mix16B(input + len - 16, Secret + SecretSizeMin - MidSizeLastOffset);
+    acc = avalanche(acc);
+    for (u32 i = 8; i < numRounds; i++) {
+        accEnd += mix16B(input + 16 * i, Secret + 16 * (i - 8) + MidSizeStartOffset);
+    }
+    return avalanche(acc + accEnd);
+}
+
+//------------------------------------
+// 128-bit short inputs
+//------------------------------------
+PLY_INLINE u128 len0to16_128(const u8* input, u32 len) {
+    u128 h;
+    if (len > 8) {
+        u64 bitflipLo = read64(Secret + 32) ^ read64(Secret + 40);
+        u64 bitflipHi = read64(Secret + 48) ^ read64(Secret + 56);
+        u64 inputLo = read64(input);
+        u64 inputHi = read64(input + len - 8);
+        u128 m = mul64to128(inputLo ^ inputHi ^ bitflipLo, Prime64_1);
+        m.lo += u64(len - 1) << 54;
+        inputHi ^= bitflipHi;
+        m.hi += inputHi + u64(u32(inputHi)) * (Prime32_2 - 1);
+        m.lo ^= swap64(m.hi);
+        h = mul64to128(m.lo, Prime64_2);
+        h.hi += m.hi * Prime64_2;
+        h.lo = avalanche(h.lo);
+        h.hi = avalanche(h.hi);
+    } else if (len >= 4) {
+        u32 inputLo = read32(input);
+        u32 inputHi = read32(input + len - 4);
+        u64 input64 = inputLo + (u64(inputHi) << 32);
+        u64 bitflip = read64(Secret + 16) ^ read64(Secret + 24);
+        h = mul64to128(input64 ^ bitflip, Prime64_1 + (len << 2));
+        h.hi += h.lo << 1;
+        h.lo ^= h.hi >> 3;
+        h.lo = xorShift64(h.lo, 35);
+        h.lo *= PrimeMx2;
+        h.lo = xorShift64(h.lo, 28);
+        h.hi = avalanche(h.hi);
+    } else if (len > 0) {
+        u8 c1 = input[0];
+        u8 c2 = input[len >> 1];
+        u8 c3 = input[len - 1];
+        u32 combinedLo = (u32(c1) << 16) | (u32(c2) << 24) | u32(c3) | (len << 8);
+        u32 combinedHi = rotl32(swap32(combinedLo), 13);
+        u64 bitflipLo = read32(Secret) ^ read32(Secret + 4);
+        u64 bitflipHi = read32(Secret + 8) ^ read32(Secret + 12);
+        h.lo = avalanche64(u64(combinedLo) ^ bitflipLo);
+        h.hi = avalanche64(u64(combinedHi) ^ bitflipHi);
+    } else {
+        h.lo = avalanche64(read64(Secret + 64) ^ read64(Secret + 72));
+        h.hi = avalanche64(read64(Secret + 80) ^ read64(Secret + 88));
+    }
+    return h;
+}
+
+PLY_INLINE u128 finish128(u128 acc, u32 len) {
+    u128 h;
+    h.lo = avalanche(acc.lo + acc.hi);
+    h.hi = 0 - avalanche((acc.lo * Prime64_1) + (acc.hi * Prime64_4) + (len * Prime64_2));
+    return h;
+}
+
+PLY_INLINE u128 len17to128_128(const u8* input, u32 len) {
+    u128 acc{len * Prime64_1};
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc = mix32B(acc, input + 48, input + len - 64, Secret + 96);
+            }
+            acc = mix32B(acc, input + 32, input + len - 48, Secret + 64);
+        }
+        acc = mix32B(acc, input + 16, input + len - 32, Secret + 32);
+    }
+    acc = mix32B(acc, input, input + len - 16, Secret);
+    return finish128(acc, len);
+}
+
+PLY_NO_INLINE u128 len129to240_128(const u8* input, u32 len) {
+    u128 acc{len * Prime64_1};
+    for (u32 i = 32; i < 160; i += 32) {
+        acc = mix32B(acc, input + i - 32, input + i - 16, Secret + i - 32);
+    }
+    acc.lo = avalanche(acc.lo);
+    acc.hi = avalanche(acc.hi);
+    for (u32 i = 160; i <= len; i += 32) {
+        acc = mix32B(acc, input + i - 32, input + i - 16, Secret + MidSizeStartOffset + i - 160);
+    }
+    acc = mix32B(acc, input + len - 16, input + len - 32,
+                 Secret + SecretSizeMin - MidSizeLastOffset - 16);
+    return finish128(acc, len);
+}
+
+} // namespace
+
+//------------------------------------
+// XXH3
+//------------------------------------
+PLY_NO_INLINE XXH3::XXH3() {
+    initAcc(this->acc);
+}
+
+PLY_NO_INLINE void XXH3::append(StringView view) {
+    const u8* input = (const u8*) view.bytes;
+    const u8* end = input + view.numBytes;
+    this->totalLen += view.numBytes;
+    if (view.numBytes <= BufferSize - this->bufferedSize) {
+        memcpy(this->buffer + this->bufferedSize, input, view.numBytes);
+        this->bufferedSize += view.numBytes;
+        return;
+    }
+
+    // The buffer is never consumed completely, since the last stripe has to be treated specially
+    // once the total length is known.
+    if (this->bufferedSize) {
+        u32 loadSize = BufferSize - this->bufferedSize;
+        memcpy(this->buffer + this->bufferedSize, input, loadSize);
+        input += loadSize;
+        consumeStripes(this->acc, &this->numStripesSoFar, this->buffer, BufferSize / StripeLen);
+        this->bufferedSize = 0;
+    }
+    if (end - input > BufferSize) {
+        u64 numStripes = u64(end - 1 - input) / StripeLen;
+        input = consumeStripes(this->acc, &this->numStripesSoFar, input, numStripes);
+        // Keep the last stripe consumed, in case it's needed by digestLong
+        memcpy(this->buffer + BufferSize - StripeLen, input - StripeLen, StripeLen);
+    }
+    memcpy(this->buffer, input, end - input);
+    this->bufferedSize = u32(end - input);
+}
+
+PLY_NO_INLINE void XXH3::digestLong(u64* dstAcc) const {
+    memcpy(dstAcc, this->acc, sizeof(this->acc));
+    u8 lastStripe[StripeLen];
+    const u8* lastStripePtr;
+    if (this->bufferedSize >= StripeLen) {
+        u32 numStripes = (this->bufferedSize - 1) / StripeLen;
+        u32 numStripesSoFar = this->numStripesSoFar;
+        consumeStripes(dstAcc, &numStripesSoFar, this->buffer, numStripes);
+        lastStripePtr = this->buffer + this->bufferedSize - StripeLen;
+    } else {
+        u32 catchupSize = StripeLen - this->bufferedSize;
+        memcpy(lastStripe, this->buffer + BufferSize - catchupSize, catchupSize);
+        memcpy(lastStripe + catchupSize, this->buffer, this->bufferedSize);
+        lastStripePtr = lastStripe;
+    }
+    accumulate512(dstAcc, lastStripePtr, Secret + SecretLimit - SecretLastAccStart);
+}
+
+PLY_NO_INLINE u64 XXH3::get64() const {
+    if (this->totalLen > MidSizeMax) {
+        alignas(64) u64 dstAcc[8];
+        this->digestLong(dstAcc);
+        return mergeAccs64(dstAcc, this->totalLen);
+    }
+    return hash64({(const char*) this->buffer, u32(this->totalLen)});
+}
+
+PLY_NO_INLINE u128 XXH3::get128() const {
+    if (this->totalLen > MidSizeMax) {
+        alignas(64) u64 dstAcc[8];
+        this->digestLong(dstAcc);
+        return mergeAccs128(dstAcc, this->totalLen);
+    }
+    return hash128({(const char*) this->buffer, u32(this->totalLen)});
+}
+
+PLY_NO_INLINE u64 XXH3::hash64(StringView view) {
+    const u8* input = (const u8*) view.bytes;
+    u32 len = view.numBytes;
+    if (len <= 16)
+        return len0to16_64(input, len);
+    if (len <= 128)
+        return len17to128_64(input, len);
+    if (len <= MidSizeMax)
+        return len129to240_64(input, len);
+    alignas(64) u64 acc[8];
+    initAcc(acc);
+    hashLongLoop(acc, input, len);
+    return mergeAccs64(acc, len);
+}
+
+PLY_NO_INLINE u128 XXH3::hash128(StringView view) {
+    const u8* input = (const u8*) view.bytes;
+    u32 len = view.numBytes;
+    if (len <= 16)
+        return len0to16_128(input, len);
+    if (len <= 128)
+        return len17to128_128(input, len);
+    if (len <= MidSizeMax)
+        return len129to240_128(input, len);
+    alignas(64) u64 acc[8];
+    initAcc(acc);
+    hashLongLoop(acc, input, len);
+    return mergeAccs128(acc, len);
+}
+
+} // namespace ply
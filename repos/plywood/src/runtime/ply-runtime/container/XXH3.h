@@ -0,0 +1,49 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+
+// XXH3: a 64- and 128-bit noncryptographic hash
+// By Yann Collet, https://github.com/Cyan4973/xxHash, BSD 2-Clause License
+//
+// This is a port of XXH3_64bits and XXH3_128bits using the default secret and no seed. Results
+// are identical to the reference implementation. Short inputs are hashed with a few 64-bit
+// multiplies; long inputs are consumed 64 bytes at a time by eight accumulators, using AVX2, SSE2
+// or NEON when available. It assumes the processor is little-endian.
+
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/string/StringView.h>
+#include <ply-runtime/container/Int128.h>
+
+namespace ply {
+
+class XXH3 {
+public:
+    static constexpr u32 StripeLen = 64;
+    static constexpr u32 BufferSize = 256;
+
+private:
+    alignas(64) u64 acc[8];
+    alignas(64) u8 buffer[BufferSize];
+    u32 bufferedSize = 0;
+    u32 numStripesSoFar = 0;
+    u64 totalLen = 0;
+
+    void digestLong(u64* dstAcc) const;
+
+public:
+    PLY_DLL_ENTRY XXH3();
+
+    // Incremental interface. Hashing a message in several pieces gives the same result as hashing
+    // it in one call.
+    PLY_DLL_ENTRY void append(StringView view);
+    PLY_DLL_ENTRY u64 get64() const;
+    PLY_DLL_ENTRY u128 get128() const;
+
+    // One-shot interface
+    static PLY_DLL_ENTRY u64 hash64(StringView view);
+    static PLY_DLL_ENTRY u128 hash128(StringView view);
+};
+
+} // namespace ply
@@ -0,0 +1,205 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Precomp.h>
+
+#if PLY_KERNEL_LINUX
+
+#include <ply-runtime/filesystem/impl/DirectoryWatcher_Linux.h>
+#include <ply-runtime/filesystem/FileSystem.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace ply {
+
+static constexpr u32 WatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE |
+                                 IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                                 IN_ONLYDIR | IN_DONT_FOLLOW;
+
+// Changes collected during a burst of events. Each path appears once, in the order it was first
+// seen.
+struct PendingChanges {
+    struct Change {
+        String path;
+        bool mustRecurse;
+    };
+    struct Traits {
+        using Key = StringView;
+        using Item = u32; // Index into changes
+        using Context = Array<Change>;
+        static PLY_INLINE bool match(Item item, Key key, const Context& ctx) {
+            return ctx[item].path == key;
+        }
+    };
+
+    Array<Change> changes;
+    HashMap<Traits> pathToIndex;
+
+    PLY_NO_INLINE void add(StringView path, bool mustRecurse) {
+        auto cursor = this->pathToIndex.insertOrFind(path, &this->changes);
+        if (cursor.wasFound()) {
+            this->changes[*cursor].mustRecurse |= mustRecurse;
+        } else {
+            *cursor = this->changes.numItems();
+            this->changes.append({path, mustRecurse});
+        }
+    }
+};
+
+PLY_NO_INLINE void DirectoryWatcher_Linux::addWatches(StringView path) {
+    String absPath = path ? PosixPath::join(m_root, path) : String{m_root};
+    int wd = inotify_add_watch(m_inotifyFD, absPath.withNullTerminator().bytes, WatchMask);
+    if (wd < 0) {
+        // The directory may have been removed already
+        SLOG(m_log, "Can't watch \"{}\": errno {}", absPath, errno);
+        return;
+    }
+    m_watches.insertOrFind((u32) wd)->path = path;
+    for (const DirectoryEntry& entry : FileSystem::native()->listDir(absPath, 0)) {
+        if (entry.isDir) {
+            this->addWatches(path ? PosixPath::join(path, entry.name) : entry.name);
+        }
+    }
+}
+
+PLY_NO_INLINE void DirectoryWatcher_Linux::removeWatches(StringView path) {
+    Array<u32> toRemove;
+    for (const WatchTraits::Item& item : m_watches) {
+        if (item.path == path ||
+            (item.path.startsWith(path) && item.path.numBytes > path.numBytes &&
+             item.path[path.numBytes] == '/')) {
+            toRemove.append(item.wd);
+        }
+    }
+    for (u32 wd : toRemove) {
+        inotify_rm_watch(m_inotifyFD, (int) wd);
+        m_watches.find(wd).erase();
+    }
+}
+
+PLY_NO_INLINE void DirectoryWatcher_Linux::runWatcher() {
+    this->addWatches({});
+
+    static const u32 bufferSize = 65536;
+    char* buffer = (char*) PLY_HEAP.alloc(bufferSize);
+    PendingChanges pending;
+    auto flushPending = [&] {
+        for (const PendingChanges::Change& change : pending.changes) {
+            SLOG(m_log, "\"{}\" changed{}", change.path,
+                 change.mustRecurse ? StringView{" (recursive)"} : StringView{});
+            m_callback(change.path, change.mustRecurse);
+        }
+        pending = {};
+    };
+    bool rootWasRemoved = false;
+    while (!rootWasRemoved) {
+        // Block until something happens, then keep reading until no events arrive for
+        // CoalesceMilliseconds.
+        struct pollfd fds[2] = {{m_endFD, POLLIN, 0}, {m_inotifyFD, POLLIN, 0}};
+        int timeout = pending.changes.isEmpty() ? -1 : (int) CoalesceMilliseconds;
+        int rc = poll(fds, 2, timeout);
+        if (rc < 0) {
+            PLY_ASSERT(errno == EINTR);
+            continue;
+        }
+        if (fds[0].revents != 0)
+            break;
+        if (rc == 0) {
+            flushPending();
+            continue;
+        }
+
+        ssize_t numBytes = read(m_inotifyFD, buffer, bufferSize);
+        if (numBytes <= 0) {
+            PLY_ASSERT(numBytes < 0 && (errno == EINTR || errno == EAGAIN));
+            continue;
+        }
+        for (ssize_t ofs = 0; ofs < numBytes;) {
+            const struct inotify_event* event = (const struct inotify_event*) (buffer + ofs);
+            ofs += sizeof(struct inotify_event) + event->len;
+
+            if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                // Events were dropped
+                pending.add({}, true);
+                continue;
+            }
+            auto cursor = m_watches.find((u32) event->wd);
+            if (!cursor.wasFound())
+                continue;
+            if ((event->mask & IN_IGNORED) != 0) {
+                // The watched directory was removed
+                cursor.erase();
+                continue;
+            }
+            if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0) {
+                // Subdirectories are handled by the event on their parent. If the root itself was
+                // deleted or moved away, there's nothing left to watch.
+                if (cursor->path.isEmpty()) {
+                    pending.add({}, true);
+                    rootWasRemoved = true;
+                }
+                continue;
+            }
+            String path = cursor->path;
+            if (event->len > 0) {
+                StringView name = event->name; // Null-terminated, possibly with extra padding
+                path = path ? PosixPath::join(path, name) : String{name};
+            }
+            if ((event->mask & IN_ISDIR) != 0) {
+                if ((event->mask & IN_MOVED_FROM) != 0) {
+                    this->removeWatches(path);
+                } else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+                    // Files might have been added to the new directory before it was watched, so
+                    // the callback has to recurse anyway.
+                    this->addWatches(path);
+                }
+                if ((event->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) != 0) {
+                    pending.add(path, true);
+                }
+            } else {
+                pending.add(path, false);
+            }
+        }
+    }
+    if (rootWasRemoved) {
+        SLOG(m_log, "\"{}\" was deleted or moved; no longer watching", m_root);
+        flushPending();
+    }
+    PLY_HEAP.free(buffer);
+}
+
+PLY_NO_INLINE DirectoryWatcher_Linux::DirectoryWatcher_Linux() {
+}
+
+PLY_NO_INLINE void DirectoryWatcher_Linux::start(StringView root, Functor<Callback>&& callback) {
+    PLY_ASSERT(m_root.isEmpty());
+    PLY_ASSERT(!m_callback.isValid());
+    PLY_ASSERT(m_inotifyFD < 0);
+    PLY_ASSERT(!m_watcherThread.isValid());
+    m_root = root;
+    m_callback = std::move(callback);
+    m_inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    PLY_ASSERT(m_inotifyFD >= 0);
+    m_endFD = eventfd(0, EFD_CLOEXEC);
+    PLY_ASSERT(m_endFD >= 0);
+    m_watcherThread.run([this]() { runWatcher(); });
+}
+
+DirectoryWatcher_Linux::~DirectoryWatcher_Linux() {
+    if (m_watcherThread.isValid()) {
+        u64 value = 1;
+        ssize_t rc = write(m_endFD, &value, sizeof(value));
+        PLY_ASSERT(rc == sizeof(value));
+        PLY_UNUSED(rc);
+        m_watcherThread.join();
+        close(m_endFD);
+        close(m_inotifyFD);
+    }
+}
+
+} // namespace ply
+
+#endif // PLY_KERNEL_LINUX
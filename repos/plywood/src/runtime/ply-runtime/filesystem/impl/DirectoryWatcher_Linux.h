@@ -0,0 +1,64 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/log/Log.h>
+#include <ply-runtime/string/String.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-runtime/container/Functor.h>
+#include <ply-runtime/container/HashMap.h>
+
+namespace ply {
+
+// Watches a directory tree using inotify. Since inotify watches are not recursive, every
+// subdirectory is watched separately, and subdirectories are watched as they're created. Events
+// that arrive within a short time of each other are coalesced, so the callback is called at most
+// once per path for each burst. If the root directory is deleted or moved, the callback is called
+// for the root with mustRecurse set, and the watcher stops.
+class DirectoryWatcher_Linux {
+public:
+    using Callback = void(StringView path, bool mustRecurse);
+
+private:
+    struct WatchTraits {
+        using Key = u32; // Watch descriptor
+        struct Item {
+            u32 wd;
+            String path; // Relative to m_root
+            PLY_INLINE Item(u32 wd) : wd{wd} {
+            }
+        };
+        static PLY_INLINE bool match(const Item& item, Key key) {
+            return item.wd == key;
+        }
+    };
+
+    SLOG_CHANNEL(m_log, "DirectoryWatcher_Linux")
+
+    Thread m_watcherThread;
+    String m_root;
+    Functor<Callback> m_callback;
+    int m_inotifyFD = -1;
+    int m_endFD = -1; // eventfd that's signaled to stop the watcher thread
+    HashMap<WatchTraits> m_watches; // Only accessed by the watcher thread
+
+    void addWatches(StringView path);
+    void removeWatches(StringView path);
+    void runWatcher();
+
+public:
+    // How long to wait for more events before calling the callback
+    static constexpr u32 CoalesceMilliseconds = 50;
+
+    PLY_DLL_ENTRY DirectoryWatcher_Linux();
+    PLY_DLL_ENTRY void start(StringView root, Functor<Callback>&& callback);
+    PLY_INLINE DirectoryWatcher_Linux(StringView root, Functor<Callback>&& callback)
+        : DirectoryWatcher_Linux{} {
+        start(root, std::move(callback));
+    }
+    PLY_DLL_ENTRY ~DirectoryWatcher_Linux();
+};
+
+} // namespace ply
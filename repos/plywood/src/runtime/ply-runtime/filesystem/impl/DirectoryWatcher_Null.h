@@ -4,15 +4,21 @@
 ------------------------------------*/
 #pragma once
 #include <ply-runtime/Core.h>
-#include <ply-runtime/filesystem/Path.h>
+#include <ply-runtime/container/Functor.h>
 
 namespace ply {
 
+// Never invokes the callback. Has the same interface as the other DirectoryWatcher
+// implementations.
 class DirectoryWatcher_Null {
 public:
-    typedef void Callback(const Path& path, bool mustRecurse);
+    using Callback = void(StringView path, bool mustRecurse);
 
-    DirectoryWatcher_Null(const Path&, const std::function<Callback>&) {
+    PLY_INLINE DirectoryWatcher_Null() {
+    }
+    PLY_INLINE void start(StringView, Functor<Callback>&&) {
+    }
+    PLY_INLINE DirectoryWatcher_Null(StringView, Functor<Callback>&&) {
     }
 };
 
@@ -290,6 +290,25 @@ PLY_NO_INLINE FSResult FileSystem_POSIX::removeDirTree(FileSystem* fs, StringVie
     return FileSystem::setLastResult(FSResult::OK);
 }
 
+static void copyFileStatus(FileStatus& status, const struct stat& buf) {
+    status.result = FileSystem::setLastResult(FSResult::OK);
+    status.fileSize = buf.st_size;
+    status.creationTime = buf.st_ctime;
+    status.accessTime = buf.st_atime;
+    status.modificationTime = buf.st_mtime;
+}
+
+PLY_NO_INLINE void FileSystem_POSIX::getFileStatus(int fd, FileStatus& status) {
+    struct stat buf;
+    int rc = fstat(fd, &buf);
+    if (rc != 0) {
+        PLY_ASSERT(PLY_FSPOSIX_ALLOW_UNKNOWN_ERRORS);
+        status.result = FileSystem::setLastResult(FSResult::Unknown);
+    } else {
+        copyFileStatus(status, buf);
+    }
+}
+
 PLY_NO_INLINE FileStatus FileSystem_POSIX::getFileStatus(FileSystem*, StringView path) {
     FileStatus status;
     struct stat buf;
@@ -307,11 +326,7 @@ PLY_NO_INLINE FileStatus FileSystem_POSIX::getFileStatus(FileSystem*, StringView
             }
         }
     } else {
-        status.result = FileSystem::setLastResult(FSResult::OK);
-        status.fileSize = buf.st_size;
-        status.creationTime = buf.st_ctime;
-        status.accessTime = buf.st_atime;
-        status.modificationTime = buf.st_mtime;
+        copyFileStatus(status, buf);
     }
     return status;
 }
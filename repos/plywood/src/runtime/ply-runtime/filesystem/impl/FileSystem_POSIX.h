@@ -28,6 +28,7 @@ struct FileSystem_POSIX : FileSystem {
     // More direct access:
     static int openFDForRead(StringView path);
     static int openFDForWrite(StringView path);
+    static void getFileStatus(int fd, FileStatus& status);
 
     // FileSystem::Funcs implementations:
     static Directory listDir(FileSystem*, StringView path, u32 flags);
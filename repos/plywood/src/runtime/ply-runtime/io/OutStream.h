@@ -15,6 +15,8 @@ namespace ply {
 namespace fmt {
 template <typename T>
 struct TypePrinter;
+template <typename Str>
+struct CompiledFormat;
 } // namespace fmt
 
 //------------------------------------------------------------------------------------------------
@@ -272,6 +274,9 @@ public:
         mout.format("The answer is {}.\n", 42);
         return mout.moveToString();
 
+    Placeholders can also specify a minimum width, as in `{:8}`, `{:<8}` or `{:08}`. See
+    `fmt::FormatSpec`.
+
     For more information, see [Converting Values to Text](ConvertingValuesToText).
     */
     template <typename... Args>
@@ -281,6 +286,18 @@ public:
         this->formatInternal(fmt, argList);
     }
 
+    /*!
+    Same as above, but takes a format string that was parsed at compile time by the `PLY_FMT`
+    macro. The number of arguments is checked at compile time, and no format string is parsed at
+    runtime.
+
+        mout.format(PLY_FMT("{}:{:02}\n"), minutes, seconds);
+    */
+    template <typename Str, typename... Args>
+    PLY_INLINE void format(fmt::CompiledFormat<Str>, const Args&... args) {
+        fmt::CompiledFormat<Str>::write(this, args...);
+    }
+
     /*!
     Template function that writes the the default text representation of `value` to the output
     stream.
@@ -0,0 +1,44 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+
+namespace ply {
+namespace fmt {
+
+//-----------------------------------------------------------------------
+// Conversions between binary and decimal numbers
+//
+// printShortest() writes the shortest decimal string that parses back to exactly the same float or
+// double, using the Ryu algorithm by Ulf Adams (https://github.com/ulfjack/ryu, Apache License 2.0
+// or Boost Software License). Numbers between 1e-4 and 1e16 are written in fixed notation, such as
+// "0.1" or "100.0"; others are written in scientific notation, such as "1.5e-7".
+//
+// decimalToDouble() converts a decimal mantissa and exponent to the nearest double. It uses
+// Clinger's fast path when the result is exact, and the Eisel-Lemire algorithm otherwise. In the
+// rare cases where Eisel-Lemire can't determine the correctly rounded result, or the result is
+// subnormal, it falls back to strtod().
+//-----------------------------------------------------------------------
+
+// Maximum number of bytes written by printShortest()
+static constexpr u32 MaxShortestFloatBytes = 32;
+// Maximum number of bytes written by printDecimal()
+static constexpr u32 MaxDecimalBytes = 20;
+// Digits past this many can only affect the result of decimalToDouble() by breaking a tie
+static constexpr u32 MaxSignificantDigits = 768;
+
+// "00", "01", ... "99"
+extern const char DigitPairs[200];
+
+PLY_DLL_ENTRY u32 printShortest(char* dst, double value);
+PLY_DLL_ENTRY u32 printShortest(char* dst, float value);
+PLY_DLL_ENTRY u32 printDecimal(char* dst, u64 value);
+
+// Returns the double nearest to digits * 10^exp10. digits must contain only the characters '0' to
+// '9', and there must be at most MaxSignificantDigits + 1 of them.
+PLY_DLL_ENTRY double decimalToDouble(const char* digits, u32 numDigits, s32 exp10);
+
+} // namespace fmt
+} // namespace ply
@@ -5,7 +5,13 @@
 #include <ply-runtime/Precomp.h>
 #include <ply-runtime/io/OutStream.h>
 #include <ply-runtime/string/TextEncoding.h>
+#include <ply-runtime/io/impl/FloatConversion.h>
 #include <math.h>
+#if PLY_CPU_X86 || PLY_CPU_X64
+#include <emmintrin.h>
+#elif PLY_CPU_ARM64
+#include <arm_neon.h>
+#endif
 
 namespace ply {
 
@@ -20,6 +26,16 @@ PLY_INLINE char toDigit(u32 d, bool capitalize = false) {
 
 PLY_NO_INLINE void printString(OutStream* outs, u64 value, u32 radix, bool capitalize) {
     PLY_ASSERT(radix >= 2);
+    if (radix == 10) {
+        // Write directly to the output buffer when there's room
+        if (outs->numBytesAvailable() >= fmt::MaxDecimalBytes) {
+            outs->curByte += fmt::printDecimal(outs->curByte, value);
+        } else {
+            char digitBuffer[fmt::MaxDecimalBytes];
+            outs->write({digitBuffer, fmt::printDecimal(digitBuffer, value)});
+        }
+        return;
+    }
     char digitBuffer[64];
     s32 digitIndex = PLY_STATIC_ARRAY_SIZE(digitBuffer);
 
@@ -43,7 +59,7 @@ PLY_NO_INLINE void printString(OutStream* outs, s64 value, u32 radix, bool capit
         printString(outs, (u64) value, radix, capitalize);
     } else {
         outs->writeByte('-');
-        printString(outs, (u64) -value, radix, capitalize);
+        printString(outs, 0 - (u64) value, radix, capitalize);
     }
 }
 
@@ -108,42 +124,72 @@ PLY_NO_INLINE void printString(OutStream* outs, double value, u32 radix, bool ca
 //----------------------------------------------------------------
 PLY_NO_INLINE void OutStream::formatInternal(StringView fmt, ArrayView<const OutStream::Arg> args) {
     u32 argIndex = 0;
-    while (fmt.numBytes > 0) {
-        if (fmt[0] == '{') {
-            fmt.offsetHead(1);
-            if (fmt.numBytes == 0) {
+    for (u32 i = 0; i < fmt.numBytes; i++) {
+        char c = fmt[i];
+        if (i + 1 < fmt.numBytes && (c == '{' || c == '}') && fmt[i + 1] == c) {
+            // Escaped brace
+            this->writeByte(c);
+            i++;
+        } else if (c == '{') {
+            i++;
+            fmt::FormatSpec spec;
+            if (!fmt::parsePlaceholder(fmt.bytes, fmt.numBytes, i, spec)) {
                 PLY_ASSERT(0); // Invalid format string!
                 break;
             }
-            if (fmt[0] == '{') {
-                this->writeByte('{');
-            } else if (fmt[0] == '}') {
-                PLY_ASSERT(argIndex <
-                           args.numItems); // Not enough arguments provided for format string!
-                args[argIndex].formatter(this, args[argIndex].pvalue);
-                argIndex++;
-            } else {
-                PLY_ASSERT(0); // Invalid format string!
-            }
-        } else if (fmt[0] == '}') {
-            fmt.offsetHead(1);
-            if (fmt.numBytes == 0) {
-                PLY_ASSERT(0); // Invalid format string!
+            if (argIndex >= args.numItems) {
+                PLY_ASSERT(0); // Not enough arguments provided for format string!
                 break;
             }
-            if (fmt[0] == '}') {
-                this->writeByte('}');
+            if (spec.width == 0) {
+                args[argIndex].formatter(this, args[argIndex].pvalue);
             } else {
-                PLY_ASSERT(0); // Invalid format string!
+                fmt::printPadded(this, spec, args[argIndex].formatter, args[argIndex].pvalue);
             }
+            argIndex++;
+        } else if (c == '}') {
+            PLY_ASSERT(0); // Invalid format string!
+            break;
         } else {
-            this->writeByte(fmt[0]);
+            this->writeByte(c);
         }
-        fmt.offsetHead(1);
     }
     PLY_ASSERT(argIndex == args.numItems); // Too many arguments provided for format string!
 }
 
+PLY_NO_INLINE void fmt::printPadded(OutStream* outs, const FormatSpec& spec,
+                                    void (*print)(OutStream*, const void*), const void* value) {
+    // Print to a buffer on the stack first, unless the result is too long
+    char buffer[128];
+    ViewOutStream vout{{buffer, sizeof(buffer)}};
+    print(&vout, value);
+    String longResult;
+    StringView printed = {buffer, u32(vout.curByte - buffer)};
+    if (vout.atEOF()) {
+        MemOutStream mout;
+        print(&mout, value);
+        longResult = mout.moveToString();
+        printed = longResult;
+    }
+
+    u32 numPadding = spec.width > printed.numBytes ? spec.width - printed.numBytes : 0;
+    if (spec.leftAlign) {
+        outs->write(printed);
+        for (u32 i = 0; i < numPadding; i++) {
+            outs->writeByte(' ');
+        }
+    } else {
+        if (spec.zeroPad && printed.numBytes > 0 && printed[0] == '-') {
+            outs->writeByte('-');
+            printed.offsetHead(1);
+        }
+        for (u32 i = 0; i < numPadding; i++) {
+            outs->writeByte(spec.zeroPad ? '0' : ' ');
+        }
+        outs->write(printed);
+    }
+}
+
 //----------------------------------------------------
 // fmt::TypePrinters
 //----------------------------------------------------
@@ -182,8 +228,22 @@ PLY_NO_INLINE void fmt::TypePrinter<s64>::print(OutStream* outs, s64 value) {
     printString(outs, value, 10, false);
 }
 
+template <typename T>
+PLY_INLINE void writeShortest(OutStream* outs, T value) {
+    if (outs->numBytesAvailable() >= fmt::MaxShortestFloatBytes) {
+        outs->curByte += fmt::printShortest(outs->curByte, value);
+    } else {
+        char buffer[fmt::MaxShortestFloatBytes];
+        outs->write({buffer, fmt::printShortest(buffer, value)});
+    }
+}
+
 PLY_NO_INLINE void fmt::TypePrinter<double>::print(OutStream* outs, double value) {
-    printString(outs, value, 10, false);
+    writeShortest(outs, value);
+}
+
+PLY_NO_INLINE void fmt::TypePrinter<float>::print(OutStream* outs, float value) {
+    writeShortest(outs, value);
 }
 
 PLY_NO_INLINE void fmt::TypePrinter<bool>::print(OutStream* outs, bool value) {
@@ -198,11 +258,48 @@ PLY_NO_INLINE void fmt::TypePrinter<CPUTimer::Duration>::print(OutStream* outs,
     u64 us = u64((seconds - s) * 1000000);
     u64 m = s / 60;
     s = s % 60;
+    outs->format(PLY_FMT("{}:{:02}.{:06}"), m, s, us);
+}
 
-    // FIXME: Optimize this, too much intermediate stuff
-    // FIXME: Support zero-padding in format string
-    outs->format("{}:{}.{}", m, (StringView{"0"} + String::from(s)).right(2),
-               (StringView{"00000"} + String::from(us)).right(6));
+// Returns the number of leading bytes that are ASCII, no less than minByte, and different from each
+// of the special characters. Used to copy runs of characters that don't need escaping. Checks 16
+// bytes at a time.
+template <u32 N>
+PLY_INLINE u32 numPlainBytes(StringView view, char minByte, const char (&specials)[N]) {
+    const char* bytes = view.bytes;
+    u32 i = 0;
+#if PLY_CPU_X86 || PLY_CPU_X64
+    for (; i + 16 <= view.numBytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (bytes + i));
+        // Signed comparison, so bytes >= 0x80 are less than minByte too
+        __m128i hits = _mm_cmplt_epi8(v, _mm_set1_epi8(minByte));
+        for (u32 j = 0; j < N - 1; j++) {
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, _mm_set1_epi8(specials[j])));
+        }
+        if (_mm_movemask_epi8(hits) != 0)
+            break;
+    }
+#elif PLY_CPU_ARM64
+    for (; i + 16 <= view.numBytes; i += 16) {
+        int8x16_t v = vld1q_s8((const s8*) bytes + i);
+        uint8x16_t hits = vcltq_s8(v, vdupq_n_s8(minByte));
+        for (u32 j = 0; j < N - 1; j++) {
+            hits = vorrq_u8(hits, vceqq_s8(v, vdupq_n_s8(specials[j])));
+        }
+        if (vmaxvq_u8(hits) != 0)
+            break;
+    }
+#endif
+    for (; i < view.numBytes; i++) {
+        s8 c = (s8) bytes[i];
+        if (c < minByte)
+            return i;
+        for (u32 j = 0; j < N - 1; j++) {
+            if (c == specials[j])
+                return i;
+        }
+    }
+    return i;
 }
 
 PLY_NO_INLINE void fmt::TypePrinter<fmt::EscapedString>::print(OutStream* outs,
@@ -214,6 +311,19 @@ PLY_NO_INLINE void fmt::TypePrinter<fmt::EscapedString>::print(OutStream* outs,
             *outs << "...";
             break;
         }
+
+        // Copy runs of ASCII characters that don't need escaping as-is
+        u32 numBytes = numPlainBytes(srcUnits, 32, "\"\\");
+        if (value.maxPoints > 0) {
+            numBytes = min(numBytes, value.maxPoints - points);
+        }
+        if (numBytes > 0) {
+            outs->write(srcUnits.left(numBytes));
+            points += numBytes;
+            srcUnits.offsetHead(numBytes);
+            continue;
+        }
+
         DecodeResult decoded = UTF8::decodePoint(srcUnits);
         switch (decoded.point) {
             case '"': {
@@ -262,6 +372,19 @@ PLY_NO_INLINE void fmt::TypePrinter<fmt::XMLEscape>::print(OutStream* outs, cons
             *outs << "...";
             break;
         }
+
+        // Copy runs of ASCII characters that don't need escaping as-is
+        u32 numBytes = numPlainBytes(srcUnits, 0, "<>\"&");
+        if (value.maxPoints > 0) {
+            numBytes = min(numBytes, value.maxPoints - points);
+        }
+        if (numBytes > 0) {
+            outs->write(srcUnits.left(numBytes));
+            points += numBytes;
+            srcUnits.offsetHead(numBytes);
+            continue;
+        }
+
         DecodeResult decoded = UTF8::decodePoint(srcUnits);
         switch (decoded.point) {
             case '<': {
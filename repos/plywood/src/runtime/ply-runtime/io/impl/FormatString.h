@@ -5,10 +5,176 @@
 #pragma once
 #include <ply-runtime/Core.h>
 #include <ply-runtime/time/CPUTimer.h>
+#include <utility>
 
 namespace ply {
 namespace fmt {
 
+//----------------------------------------------------
+// fmt::FormatSpec
+//----------------------------------------------------
+// A placeholder in a format string is either {} or {:spec}, where spec is an optional < or >
+// followed by a width, such as {:8}, {:<8} or {:08}. The printed value is padded with spaces to at
+// least that many bytes, on the left by default or on the right if < is given. If the width
+// starts with 0, the value is padded with zeros after any minus sign instead.
+struct FormatSpec {
+    u32 width = 0;
+    bool zeroPad = false;
+    bool leftAlign = false;
+};
+
+// Parses a placeholder, starting at the byte after the opening '{'. On success, returns true and
+// leaves i at the closing '}'.
+constexpr bool parsePlaceholder(const char* str, u32 numBytes, u32& i, FormatSpec& spec) {
+    if (i < numBytes && str[i] == ':') {
+        i++;
+        if (i < numBytes && (str[i] == '<' || str[i] == '>')) {
+            spec.leftAlign = (str[i] == '<');
+            i++;
+        }
+        if (i < numBytes && str[i] == '0') {
+            spec.zeroPad = true;
+            i++;
+        }
+        while (i < numBytes && str[i] >= '0' && str[i] <= '9') {
+            spec.width = spec.width * 10 + u32(str[i] - '0');
+            i++;
+        }
+    }
+    return i < numBytes && str[i] == '}';
+}
+
+// Prints the value using the given function, padded according to spec
+PLY_DLL_ENTRY void printPadded(OutStream* outs, const FormatSpec& spec,
+                               void (*print)(OutStream*, const void*), const void* value);
+
+template <typename T>
+PLY_NO_INLINE void printErased(OutStream* outs, const void* value) {
+    TypePrinter<T>::print(outs, *(const T*) value);
+}
+
+//----------------------------------------------------
+// fmt::CompiledFormat
+//----------------------------------------------------
+// A format string that was validated and split into pieces at compile time. Create one using the
+// PLY_FMT macro and pass it to OutStream::format() in place of a regular format string:
+//
+//     outs->format(PLY_FMT("Content-Length: {}\r\n"), contentLength);
+//
+// An invalid format string, or the wrong number of arguments, is a compile error. Text between
+// placeholders is written with memcpy() calls of constant size, and each argument is printed by
+// calling its TypePrinter directly.
+constexpr u32 countPlaceholders(const char* str, u32 numBytes) {
+    u32 count = 0;
+    for (u32 i = 0; i < numBytes; i++) {
+        if (i + 1 < numBytes && (str[i] == '{' || str[i] == '}') && str[i + 1] == str[i]) {
+            i++; // Escaped brace
+        } else if (str[i] == '{') {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Text that comes before a placeholder, or after the last one
+struct FormatSegment {
+    u32 start = 0;
+    u32 numBytes = 0;
+    FormatSpec spec;
+};
+
+template <u32 NumBytes, u32 NumArgs>
+struct ParsedFormat {
+    // Text outside placeholders, with escaped braces replaced by single braces
+    char text[NumBytes + 1] = {};
+    FormatSegment segments[NumArgs + 1] = {};
+    bool isValid = true;
+};
+
+template <u32 NumBytes, u32 NumArgs>
+constexpr ParsedFormat<NumBytes, NumArgs> parseFormat(const char* str) {
+    ParsedFormat<NumBytes, NumArgs> result;
+    u32 numTextBytes = 0;
+    u32 segmentIndex = 0;
+    for (u32 i = 0; i < NumBytes; i++) {
+        char c = str[i];
+        if (i + 1 < NumBytes && (c == '{' || c == '}') && str[i + 1] == c) {
+            result.text[numTextBytes++] = c;
+            i++;
+        } else if (c == '{') {
+            FormatSegment& segment = result.segments[segmentIndex];
+            segment.numBytes = numTextBytes - segment.start;
+            i++;
+            if (!parsePlaceholder(str, NumBytes, i, segment.spec)) {
+                result.isValid = false;
+                break;
+            }
+            segmentIndex++;
+            result.segments[segmentIndex].start = numTextBytes;
+        } else if (c == '}') {
+            result.isValid = false;
+            break;
+        } else {
+            result.text[numTextBytes++] = c;
+        }
+    }
+    FormatSegment& last = result.segments[segmentIndex];
+    last.numBytes = numTextBytes - last.start;
+    return result;
+}
+
+template <typename Str>
+struct CompiledFormat {
+    static constexpr u32 NumBytes = Str::numBytes();
+    static constexpr u32 NumArgs = countPlaceholders(Str::get(), NumBytes);
+    static constexpr ParsedFormat<NumBytes, NumArgs> Parsed =
+        parseFormat<NumBytes, NumArgs>(Str::get());
+    static_assert(Parsed.isValid, "Invalid format string");
+
+    template <u32 I>
+    static PLY_INLINE void writeText(OutStream* outs) {
+        constexpr FormatSegment segment = Parsed.segments[I];
+        if (segment.numBytes > 0) {
+            outs->write({Parsed.text + segment.start, segment.numBytes});
+        }
+    }
+
+    template <u32 I, typename T>
+    static PLY_INLINE void writeArg(OutStream* outs, const T& arg) {
+        writeText<I>(outs);
+        constexpr FormatSpec spec = Parsed.segments[I].spec;
+        if (spec.width == 0) {
+            TypePrinter<T>::print(outs, arg);
+        } else {
+            printPadded(outs, spec, printErased<T>, &arg);
+        }
+    }
+
+    template <std::size_t... I, typename... Args>
+    static PLY_INLINE void writeAll(OutStream* outs, std::index_sequence<I...>,
+                                    const Args&... args) {
+        // Braced initializers are evaluated from left to right
+        int dummy[] = {0, (writeArg<u32(I)>(outs, args), 0)...};
+        PLY_UNUSED(dummy);
+        writeText<NumArgs>(outs);
+    }
+
+    template <typename... Args>
+    static PLY_INLINE void write(OutStream* outs, const Args&... args) {
+        static_assert(sizeof...(Args) == NumArgs,
+                      "Number of arguments doesn't match the format string");
+        writeAll(outs, std::make_index_sequence<NumArgs>{}, args...);
+    }
+};
+
+template <typename Str>
+constexpr u32 CompiledFormat<Str>::NumBytes;
+template <typename Str>
+constexpr u32 CompiledFormat<Str>::NumArgs;
+template <typename Str>
+constexpr ParsedFormat<CompiledFormat<Str>::NumBytes, CompiledFormat<Str>::NumArgs>
+    CompiledFormat<Str>::Parsed;
+
 //----------------------------------------------------
 // fmt::WithRadix, fmt::Hex
 //----------------------------------------------------
@@ -112,8 +278,6 @@ struct TypePrinter<s16> : TypePrinter_Cast<s64, s16> {};
 template <>
 struct TypePrinter<s8> : TypePrinter_Cast<s64, s8> {};
 template <>
-struct TypePrinter<float> : TypePrinter_Cast<double, float> {};
-template <>
 struct TypePrinter<String> : TypePrinter_Cast<StringView, String> {};
 template <>
 struct TypePrinter<HybridString> : TypePrinter_Cast<StringView, HybridString> {};
@@ -170,6 +334,10 @@ struct TypePrinter<double> {
     static PLY_DLL_ENTRY void print(OutStream* outs, double value);
 };
 template <>
+struct TypePrinter<float> {
+    static PLY_DLL_ENTRY void print(OutStream* outs, float value);
+};
+template <>
 struct TypePrinter<bool> {
     static PLY_DLL_ENTRY void print(OutStream* outs, bool value);
 };
@@ -192,3 +360,17 @@ struct TypePrinter<CmdLineArg_WinCrt> {
 
 } // namespace fmt
 } // namespace ply
+
+// Turns a string literal into a fmt::CompiledFormat
+#define PLY_FMT(str) \
+    [] { \
+        struct Str { \
+            static constexpr const char* get() { \
+                return str; \
+            } \
+            static constexpr ply::u32 numBytes() { \
+                return sizeof(str) - 1; \
+            } \
+        }; \
+        return ply::fmt::CompiledFormat<Str>{}; \
+    }()
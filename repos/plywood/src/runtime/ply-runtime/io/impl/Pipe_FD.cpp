@@ -27,7 +27,9 @@ PLY_NO_INLINE u32 InPipe_FD_readSome(InPipe* inPipe_, MutableStringView buf) {
     do {
         rc = (s32)::read(inPipe->fd, buf.bytes, buf.numBytes);
     } while (rc == -1 && errno == EINTR);
-    PLY_ASSERT(rc >= 0); // Note: Will probably need to detect closed pipes here
+    // Sockets can fail with ECONNRESET, or with EAGAIN when a receive timeout expires. Treat those
+    // the same as a closed pipe.
+    PLY_ASSERT(rc >= 0 || errno == ECONNRESET || errno == EAGAIN || errno == EWOULDBLOCK);
     if (rc < 0)
         return 0;
     return rc;
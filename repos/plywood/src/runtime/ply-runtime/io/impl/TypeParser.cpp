@@ -5,6 +5,7 @@
 #include <ply-runtime/Precomp.h>
 #include <ply-runtime/io/InStream.h>
 #include <ply-runtime/io/OutStream.h>
+#include <ply-runtime/io/impl/FloatConversion.h>
 #include <math.h> // for pow
 
 namespace ply {
@@ -159,7 +160,8 @@ PLY_NO_INLINE void readDoubleComponent(DoubleComponentOut* compOut, InStream* in
     compOut->result = value;
 }
 
-PLY_NO_INLINE double fmt::TypeParser<double>::parse(InStream* ins, Radix radix) {
+// Used for radixes other than 10. Not correctly rounded.
+PLY_NO_INLINE double parseDoubleWithRadix(InStream* ins, fmt::Radix radix) {
     PLY_ASSERT(radix.base > 0 && radix.base <= 36);
     DoubleComponentOut comp;
 
@@ -227,6 +229,89 @@ PLY_NO_INLINE double fmt::TypeParser<double>::parse(InStream* ins, Radix radix)
     return negate ? -value : value;
 }
 
+PLY_NO_INLINE double fmt::TypeParser<double>::parse(InStream* ins, Radix radix) {
+    if (radix.base != 10)
+        return parseDoubleWithRadix(ins, radix);
+
+    // Parse the optional minus sign
+    bool negate = false;
+    if (ins->tryMakeBytesAvailable() && ins->peekByte() == '-') {
+        ins->advanceByte();
+        negate = true;
+    }
+
+    // Collect the significant digits. The value is digits * 10^exp10. Past MaxSignificantDigits,
+    // only whether any remaining digit is nonzero matters, so that's recorded as one extra digit.
+    char digits[fmt::MaxSignificantDigits + 1];
+    u32 numDigits = 0;
+    s64 exp10 = 0;
+    bool anyDigits = false;
+    bool anyDropped = false;
+    bool inFraction = false;
+    for (;;) {
+        if (!ins->tryMakeBytesAvailable())
+            break;
+        u8 c = ins->peekByte();
+        if (c == '.' && !inFraction) {
+            inFraction = true;
+        } else if (u8(c - '0') <= 9) {
+            anyDigits = true;
+            if (numDigits == 0 && c == '0') {
+                // Leading zero
+                exp10 -= inFraction;
+            } else if (numDigits < fmt::MaxSignificantDigits) {
+                digits[numDigits++] = c;
+                exp10 -= inFraction;
+            } else {
+                exp10 += !inFraction;
+                anyDropped |= (c != '0');
+            }
+        } else {
+            break;
+        }
+        ins->advanceByte();
+    }
+    if (anyDropped) {
+        digits[numDigits++] = '1';
+        exp10--;
+    }
+
+    // Parse optional exponent suffix
+    if (anyDigits && ins->tryMakeBytesAvailable() && (ins->peekByte() | 0x20) == 'e') {
+        ins->advanceByte();
+        bool negateExp = false;
+        if (ins->tryMakeBytesAvailable()) {
+            if (ins->peekByte() == '+') {
+                ins->advanceByte();
+            } else if (ins->peekByte() == '-') {
+                ins->advanceByte();
+                negateExp = true;
+            }
+        }
+        anyDigits = false;
+        s64 exponent = 0;
+        for (;;) {
+            if (!ins->tryMakeBytesAvailable())
+                break;
+            u8 digit = u8(ins->peekByte() - '0');
+            if (digit > 9)
+                break;
+            ins->advanceByte();
+            // Saturate; anything this large overflows or underflows anyway
+            exponent = min<s64>(exponent * 10 + digit, 100000);
+            anyDigits = true;
+        }
+        exp10 += negateExp ? -exponent : exponent;
+    }
+
+    if (!anyDigits) {
+        ins->status.parseError = true;
+        return 0;
+    }
+    double value = fmt::decimalToDouble(digits, numDigits, s32(clamp<s64>(exp10, -200000, 200000)));
+    return negate ? -value : value;
+}
+
 //----------------------------------------------------------
 // Built-in fmt::FormatParsers
 //----------------------------------------------------------
@@ -16,6 +16,38 @@ PLY_NO_INLINE TextConverter::TextConverter(const TextEncoding* dstEncoding,
     : dstEncoding{dstEncoding}, srcEncoding{srcEncoding} {
 }
 
+// Returns a function that converts a run of characters in bulk, or nullptr if there isn't one for
+// this pair of encodings. The function stops at the first character it doesn't handle.
+using BulkConvertFunc = void (*)(MutableStringView* dstBuf, StringView* srcBuf);
+
+static PLY_NO_INLINE BulkConvertFunc getBulkConvertFunc(const TextEncoding* dstEncoding,
+                                                        const TextEncoding* srcEncoding) {
+    const TextEncoding* utf8 = TextEncoding::get<UTF8>();
+    if (srcEncoding == utf8) {
+        if (dstEncoding == utf8) {
+            // Well-formed UTF-8 is unchanged by decoding and reencoding it
+            return [](MutableStringView* dstBuf, StringView* srcBuf) {
+                u32 numBytes =
+                    UTF8::numValidBytes(srcBuf->left(min(srcBuf->numBytes, dstBuf->numBytes)));
+                memcpy(dstBuf->bytes, srcBuf->bytes, numBytes);
+                dstBuf->offsetHead(numBytes);
+                srcBuf->offsetHead(numBytes);
+            };
+        } else if (dstEncoding == TextEncoding::get<UTF16_LE>()) {
+            return UTF16_LE::convertASCIIFromUTF8;
+        } else if (dstEncoding == TextEncoding::get<UTF16_BE>()) {
+            return UTF16_BE::convertASCIIFromUTF8;
+        }
+    } else if (dstEncoding == utf8) {
+        if (srcEncoding == TextEncoding::get<UTF16_LE>()) {
+            return UTF16_LE::convertASCIIToUTF8;
+        } else if (srcEncoding == TextEncoding::get<UTF16_BE>()) {
+            return UTF16_BE::convertASCIIToUTF8;
+        }
+    }
+    return nullptr;
+}
+
 PLY_NO_INLINE bool TextConverter::convert(MutableStringView* dstBuf, StringView* srcBuf,
                                           bool flush) {
     bool wroteAnything = false;
@@ -95,7 +127,21 @@ PLY_NO_INLINE bool TextConverter::convert(MutableStringView* dstBuf, StringView*
     PLY_ASSERT(this->dstSmallBuf.numBytes == 0);
     PLY_ASSERT(this->srcSmallBuf.numBytes == 0);
 
+    BulkConvertFunc bulkConvert = getBulkConvertFunc(this->dstEncoding, this->srcEncoding);
     while (srcBuf->numBytes > 0) {
+        if (bulkConvert) {
+            // Convert as many characters as possible without decoding them one at a time.
+            char* dstBefore = dstBuf->bytes;
+            bulkConvert(dstBuf, srcBuf);
+            if (dstBuf->bytes != dstBefore) {
+                wroteAnything = true;
+                if (dstBuf->numBytes == 0)
+                    return wroteAnything; // dstBuf has been filled.
+                if (srcBuf->numBytes == 0)
+                    break;
+            }
+        }
+
         // Decode one point from the input.
         DecodeResult decoded = this->srcEncoding->decodePoint(*srcBuf);
         if (decoded.status == DecodeResult::Status::Truncated) {
@@ -0,0 +1,409 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Precomp.h>
+#include <ply-runtime/log/AsyncLogger.h>
+#include <ply-runtime/log/Log.h>
+#include <ply-runtime/memory/Arena.h>
+#include <ply-runtime/thread/ConditionVariable.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/thread/TID.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-runtime/thread/impl/Mutex_LazyInit.h>
+#if PLY_TARGET_POSIX
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace ply {
+
+// Records are aligned to this many bytes. The writer always leaves this many bytes free, so that a
+// full ring can be told apart from an empty one.
+static constexpr u32 RecordAlignment = 8;
+
+// flushOnCrash() formats each line into a buffer of this size, allocated by start()
+static constexpr u32 CrashLineBytes = 4096;
+
+struct AsyncLogger::Ring {
+    char* buffer = nullptr;
+    u32 size = 0;
+    Atomic<u32> head = 0; // Next record to read. Only modified by the thread that drains.
+    Atomic<u32> tail = 0; // End of the last committed record. Only modified by the owning thread.
+    Atomic<u32> numDropped = 0;
+    Atomic<u32> isRetired = 0; // Set when the owning thread exits
+    u64 tid = 0;
+    Ring* next = nullptr;
+};
+
+struct AsyncLogger::State {
+    Options options;
+    u32 generation = 0;
+    Atomic<Ring*> rings = nullptr; // New rings are pushed without a lock
+    Mutex drainMutex;              // Held by whichever thread is draining the rings
+    Mutex wakeMutex;
+    ConditionVariable wakeCond;
+    bool isStopping = false;
+    Thread thread;
+    char* crashLine = nullptr; // CrashLineBytes
+};
+
+Atomic<AsyncLogger::State*> AsyncLogger::state_ = nullptr;
+static u32 nextGeneration = 1;
+// Held by stop() while it frees the State and its rings, and by exiting threads while they retire
+// their ring. Zero-init, since threads can exit during static destruction.
+static Mutex_LazyInit lifetimeMutex;
+
+// The calling thread's ring. A ring belongs to the State with the same generation; rings from a
+// previous start() are freed by stop().
+struct ThreadRing {
+    AsyncLogger::Ring* ring = nullptr;
+    u32 generation = 0;
+
+    ~ThreadRing() {
+        if (!this->ring)
+            return;
+        LockGuard<Mutex_LazyInit> guard{lifetimeMutex};
+        AsyncLogger::State* state = AsyncLogger::state_.load(Acquire);
+        if (state && state->generation == this->generation) {
+            // The thread that drains will free it
+            this->ring->isRetired.store(1, Release);
+        }
+    }
+};
+static thread_local ThreadRing threadRing;
+
+static PLY_NO_INLINE AsyncLogger::Ring* createRing(AsyncLogger::State* state) {
+    // Rings outlive any ScopedArena
+    ScopedArena heapOnly{nullptr};
+    AsyncLogger::Ring* ring = new AsyncLogger::Ring;
+    ring->size = alignPowerOf2(max<u32>(state->options.bufferBytesPerThread, 256), RecordAlignment);
+    ring->buffer = (char*) PLY_HEAP.alloc(ring->size);
+    ring->tid = (u64) TID::getCurrentThreadID();
+    AsyncLogger::Ring* head = state->rings.load(Relaxed);
+    do {
+        ring->next = head;
+    } while (!state->rings.compareExchangeWeak(head, ring, Release, Relaxed));
+    threadRing.ring = ring;
+    threadRing.generation = state->generation;
+    return ring;
+}
+
+static PLY_NO_INLINE void destroyRing(AsyncLogger::Ring* ring) {
+    PLY_HEAP.free(ring->buffer);
+    delete ring;
+}
+
+//-----------------------------------------------------------------------
+// Writing records
+//-----------------------------------------------------------------------
+// Returns the size of the record, or 0 if it doesn't fit
+static PLY_INLINE u32 tryEncode(char* dst, u32 numBytesAvailable,
+                                const AsyncLogger::RecordHeader& header,
+                                void (*encode)(OutStream* outs, const void* const* ptrs),
+                                const void* const* ptrs) {
+    ViewOutStream vout{{dst, numBytesAvailable}};
+    vout.write({(const char*) &header, sizeof(header)});
+    encode(&vout, ptrs);
+    if (vout.atEOF())
+        return 0;
+    u32 numBytes = alignPowerOf2(u32(vout.curByte - dst), RecordAlignment);
+    PLY_ASSERT(numBytes <= numBytesAvailable);
+    memcpy(dst, &numBytes, sizeof(u32));
+    return numBytes;
+}
+
+PLY_NO_INLINE bool
+AsyncLogger::writeRecord(StringView channelName, void (*decode)(OutStream* outs, const char* data),
+                         void (*encode)(OutStream* outs, const void* const* ptrs),
+                         const void* const* ptrs) {
+    State* state = state_.load(Acquire);
+    if (!state)
+        return false;
+    Ring* ring = threadRing.ring;
+    if (!ring || threadRing.generation != state->generation) {
+        ring = createRing(state);
+    }
+    RecordHeader header = {0, 0, CPUTimer::get(), channelName, decode};
+
+    for (;;) {
+        u32 tail = ring->tail.loadNonatomic();
+        u32 head = ring->head.load(Acquire);
+        u32 numBytes = 0;
+        u32 newTail = 0;
+        if (tail < head) {
+            numBytes = tryEncode(ring->buffer + tail, head - tail - RecordAlignment, header,
+                                 encode, ptrs);
+            newTail = tail + numBytes;
+        } else {
+            // Try the end of the ring first, then the start
+            u32 end = (head == 0 ? ring->size - RecordAlignment : ring->size);
+            numBytes = tryEncode(ring->buffer + tail, end - tail, header, encode, ptrs);
+            newTail = tail + numBytes;
+            if (numBytes == 0 && head > 0) {
+                numBytes = tryEncode(ring->buffer, head - RecordAlignment, header, encode, ptrs);
+                if (numBytes > 0) {
+                    // Mark the rest of the ring as unused
+                    u32 marker = 0;
+                    memcpy(ring->buffer + tail, &marker, sizeof(u32));
+                    newTail = numBytes;
+                }
+            }
+        }
+
+        if (numBytes > 0) {
+            if (newTail == ring->size) {
+                newTail = 0;
+            }
+            ring->tail.store(newTail, Release);
+            // Wake the background thread early if the ring is more than half full. A missed
+            // wakeup only delays the lines until the next flush interval.
+            u32 numBytesUsed = (newTail >= head ? 0 : ring->size) + newTail - head;
+            if (numBytesUsed > ring->size / 2) {
+                state->wakeCond.wakeOne();
+            }
+            return true;
+        }
+
+        // The record doesn't fit. If the ring is empty, it never will.
+        if (state->options.onFull == OnFull::Drop || head == tail) {
+            ring->numDropped.fetchAdd(1, Relaxed);
+            return false;
+        }
+        state->wakeCond.wakeOne();
+        Thread::sleepMillis(1);
+    }
+}
+
+//-----------------------------------------------------------------------
+// Draining records
+//-----------------------------------------------------------------------
+// For each pending line, passes writeLine a function that writes the line to an OutStream
+template <typename WriteLine>
+static PLY_INLINE void drainRing(AsyncLogger::Ring* ring, const WriteLine& writeLine) {
+    u32 head = ring->head.loadNonatomic();
+    u32 tail = ring->tail.load(Acquire);
+    while (head != tail) {
+        const AsyncLogger::RecordHeader* header =
+            (const AsyncLogger::RecordHeader*) (ring->buffer + head);
+        if (header->numBytes == 0) {
+            head = 0;
+            continue;
+        }
+        writeLine([&](OutStream* outs) {
+            LogChannel::writeLinePrefix(outs, header->time, ring->tid, header->channelName);
+            header->decode(outs, (const char*) (header + 1));
+            *outs << '\n';
+        });
+        head += header->numBytes;
+        if (head == ring->size) {
+            head = 0;
+        }
+    }
+    ring->head.store(head, Release);
+
+    u32 numDropped = ring->numDropped.exchange(0, Relaxed);
+    if (numDropped > 0) {
+        writeLine([&](OutStream* outs) {
+            LogChannel::writeLinePrefix(outs, CPUTimer::get(), ring->tid, "AsyncLogger");
+            outs->format("{} lines dropped\n", numDropped);
+        });
+    }
+}
+
+// The caller must hold drainMutex
+static PLY_NO_INLINE void drainAll(AsyncLogger::State* state) {
+    MemOutStream mout;
+    auto writeLine = [&](const auto& write) { write(&mout); };
+    AsyncLogger::Ring* prev = nullptr;
+    AsyncLogger::Ring* ring = state->rings.load(Acquire);
+    while (ring) {
+        // Check isRetired first, so that the owning thread's last record gets drained
+        bool isRetired = ring->isRetired.load(Acquire) != 0;
+        drainRing(ring, writeLine);
+        AsyncLogger::Ring* next = ring->next;
+        if (!isRetired) {
+            prev = ring;
+        } else if (prev) {
+            prev->next = next;
+            destroyRing(ring);
+        } else {
+            AsyncLogger::Ring* expected = ring;
+            if (state->rings.compareExchangeStrong(expected, next, Relaxed)) {
+                destroyRing(ring);
+            } else {
+                // New rings were pushed in front of it
+                for (prev = expected; prev->next != ring; prev = prev->next) {
+                }
+                prev->next = next;
+                destroyRing(ring);
+            }
+        }
+        ring = next;
+    }
+
+    String lines = mout.moveToString();
+    if (lines.numBytes > 0) {
+        if (state->options.sink) {
+            state->options.sink(lines);
+        } else {
+            Logger::log(lines);
+        }
+    }
+}
+
+// Used by flushOnCrash(). Doesn't allocate memory, free retired rings or call the sink. Each line
+// is formatted into state->crashLine and written straight to stderr; longer lines are truncated.
+static PLY_NO_INLINE void drainAllOnCrash(AsyncLogger::State* state) {
+    auto writeLine = [&](const auto& write) {
+        ViewOutStream vout{{state->crashLine, CrashLineBytes}};
+        write(&vout);
+        u32 numBytes = u32(vout.curByte - state->crashLine);
+#if PLY_TARGET_WIN32
+        DWORD numWritten;
+        WriteFile(GetStdHandle(STD_ERROR_HANDLE), state->crashLine, numBytes, &numWritten, NULL);
+#else
+        ssize_t rc = ::write(STDERR_FILENO, state->crashLine, numBytes);
+        PLY_UNUSED(rc);
+#endif
+    };
+    for (AsyncLogger::Ring* ring = state->rings.load(Acquire); ring; ring = ring->next) {
+        drainRing(ring, writeLine);
+    }
+}
+
+//-----------------------------------------------------------------------
+// Crash handler
+//-----------------------------------------------------------------------
+#if PLY_TARGET_WIN32
+static LPTOP_LEVEL_EXCEPTION_FILTER prevExceptionFilter = nullptr;
+
+static LONG WINAPI crashExceptionFilter(EXCEPTION_POINTERS* info) {
+    AsyncLogger::flushOnCrash();
+    return prevExceptionFilter ? prevExceptionFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+static void installCrashHandler() {
+    prevExceptionFilter = SetUnhandledExceptionFilter(crashExceptionFilter);
+}
+
+static void uninstallCrashHandler() {
+    SetUnhandledExceptionFilter(prevExceptionFilter);
+}
+#elif PLY_TARGET_POSIX
+static const int crashSignals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+static struct sigaction prevSignalActions[PLY_STATIC_ARRAY_SIZE(crashSignals)];
+
+static void crashSignalHandler(int sig) {
+    AsyncLogger::flushOnCrash();
+    // Restore the previous handler and raise the signal again
+    for (u32 i = 0; i < PLY_STATIC_ARRAY_SIZE(crashSignals); i++) {
+        if (crashSignals[i] == sig) {
+            sigaction(sig, &prevSignalActions[i], nullptr);
+        }
+    }
+    raise(sig);
+}
+
+static void installCrashHandler() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = crashSignalHandler;
+    sigemptyset(&action.sa_mask);
+    for (u32 i = 0; i < PLY_STATIC_ARRAY_SIZE(crashSignals); i++) {
+        sigaction(crashSignals[i], &action, &prevSignalActions[i]);
+    }
+}
+
+static void uninstallCrashHandler() {
+    for (u32 i = 0; i < PLY_STATIC_ARRAY_SIZE(crashSignals); i++) {
+        sigaction(crashSignals[i], &prevSignalActions[i], nullptr);
+    }
+}
+#else
+static void installCrashHandler() {
+}
+
+static void uninstallCrashHandler() {
+}
+#endif
+
+//-----------------------------------------------------------------------
+// AsyncLogger
+//-----------------------------------------------------------------------
+PLY_NO_INLINE void AsyncLogger::start(Options&& options) {
+    PLY_ASSERT(!state_.load(Relaxed)); // Already running
+    State* state = new State;
+    state->options = std::move(options);
+    state->generation = nextGeneration++;
+    state->crashLine = (char*) PLY_HEAP.alloc(CrashLineBytes);
+    if (state->options.installCrashHandler) {
+        installCrashHandler();
+    }
+    state->thread.run([state] {
+        for (;;) {
+            {
+                LockGuard<Mutex> guard{state->wakeMutex};
+                if (state->isStopping)
+                    break;
+                state->wakeCond.timedWait(guard, state->options.flushIntervalMillis);
+            }
+            LockGuard<Mutex> guard{state->drainMutex};
+            drainAll(state);
+        }
+    });
+    state_.store(state, Release);
+}
+
+PLY_NO_INLINE void AsyncLogger::stop() {
+    State* state = state_.load(Relaxed);
+    PLY_ASSERT(state); // Not running
+    {
+        LockGuard<Mutex> guard{state->wakeMutex};
+        state->isStopping = true;
+        state->wakeCond.wakeAll();
+    }
+    state->thread.join();
+    if (state->options.installCrashHandler) {
+        uninstallCrashHandler();
+    }
+    {
+        // Exiting threads mustn't touch the State or their ring after this
+        LockGuard<Mutex_LazyInit> guard{lifetimeMutex};
+        state_.store(nullptr, Release);
+    }
+    drainAll(state);
+    AsyncLogger::Ring* ring = state->rings.loadNonatomic();
+    while (ring) {
+        AsyncLogger::Ring* next = ring->next;
+        destroyRing(ring);
+        ring = next;
+    }
+    PLY_HEAP.free(state->crashLine);
+    delete state;
+}
+
+PLY_NO_INLINE void AsyncLogger::flush() {
+    State* state = state_.load(Acquire);
+    if (!state)
+        return;
+    LockGuard<Mutex> guard{state->drainMutex};
+    drainAll(state);
+}
+
+PLY_NO_INLINE void AsyncLogger::flushOnCrash() {
+    State* state = state_.load(Acquire);
+    if (!state)
+        return;
+    // The thread holding drainMutex might be the one that crashed, so don't wait forever
+    for (u32 i = 0; i < 100; i++) {
+        if (state->drainMutex.tryLock()) {
+            drainAllOnCrash(state);
+            state->drainMutex.unlock();
+            return;
+        }
+        Thread::sleepMillis(1);
+    }
+}
+
+} // namespace ply
@@ -0,0 +1,229 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/container/Functor.h>
+#include <ply-runtime/io/OutStream.h>
+#include <ply-runtime/thread/Atomic.h>
+#include <ply-runtime/time/CPUTimer.h>
+#include <utility>
+
+namespace ply {
+
+//-----------------------------------------------------------------------
+// AsyncLogger
+//
+// When started, LogChannel::log() no longer formats the line on the calling thread. Instead, it
+// appends a compact binary record to a ring buffer owned by the calling thread. The record holds
+// the timestamp, the channel name, the format string (or nothing, for a PLY_FMT format string) and
+// a copy of each argument. A background thread drains every ring buffer periodically, formats the
+// lines in batches and passes each batch to the sink, which writes to Logger by default.
+//
+// Arithmetic arguments and strings are copied into the record as-is. Arguments of other types are
+// printed to text when logged, since they might not outlive the record.
+//
+// Each thread's ring buffer has a fixed size. When a record doesn't fit, it's either dropped, and
+// the number of dropped lines is logged later, or the calling thread waits for the background
+// thread to make room. Lines from a single thread are written in order; lines from different
+// threads can be interleaved out of order within a batch.
+//-----------------------------------------------------------------------
+struct AsyncLogger {
+    enum class OnFull {
+        Drop,
+        Block,
+    };
+
+    struct Options {
+        u32 bufferBytesPerThread = 64 * 1024;
+        OnFull onFull = OnFull::Drop;
+        u32 flushIntervalMillis = 10;
+        // Receives each batch of formatted lines. If empty, batches are written to Logger.
+        Functor<void(StringView)> sink;
+        // Calls flushOnCrash() from SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT handlers, or from
+        // an unhandled exception filter on Windows. Off by default, since it replaces any handlers
+        // the application installs for those signals.
+        bool installCrashHandler = false;
+    };
+
+    struct State;
+    struct Ring;
+
+    struct RecordHeader {
+        u32 numBytes; // Including the header and padding. 0 means the rest of the ring is unused.
+        u32 reserved;
+        CPUTimer::Point time;
+        StringView channelName;
+        void (*decode)(OutStream* outs, const char* data);
+    };
+
+    // Non-null while the logger is running
+    static PLY_DLL_ENTRY Atomic<State*> state_;
+
+    PLY_INLINE static bool isRunning() {
+        return state_.load(Relaxed) != nullptr;
+    }
+
+    // Starts the background thread. Must not be called while already running.
+    static PLY_DLL_ENTRY void start(Options&& options);
+    static PLY_INLINE void start() {
+        start(Options{});
+    }
+    // Writes every pending line and stops the background thread. Other threads must not log
+    // concurrently with stop().
+    static PLY_DLL_ENTRY void stop();
+    // Writes every line logged so far by any thread before returning.
+    static PLY_DLL_ENTRY void flush();
+    // Best-effort flush for crash handlers. Pending lines are written directly to stderr instead of
+    // the sink, without allocating memory. Doesn't wait if another thread is in the middle of
+    // flushing.
+    static PLY_DLL_ENTRY void flushOnCrash();
+
+    // Reserves space for a record in the calling thread's ring buffer, calls encode() to write
+    // its payload, and commits it. Returns false if the record was dropped.
+    static PLY_DLL_ENTRY bool writeRecord(StringView channelName,
+                                          void (*decode)(OutStream* outs, const char* data),
+                                          void (*encode)(OutStream* outs, const void* const* ptrs),
+                                          const void* const* ptrs);
+
+    template <typename Fmt, typename... Args>
+    static PLY_INLINE bool log(StringView channelName, const Fmt& fmt, const Args&... args);
+};
+
+namespace details {
+
+//-----------------------------------------------------------------------
+// How arguments are stored in an AsyncLogger record
+//-----------------------------------------------------------------------
+template <typename T>
+PLY_INLINE T readRaw(const char*& data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+PLY_INLINE void writeString(OutStream* outs, StringView str) {
+    outs->write({(const char*) &str.numBytes, sizeof(u32)});
+    outs->write(str);
+}
+
+PLY_INLINE StringView readString(const char*& data) {
+    u32 numBytes = readRaw<u32>(data);
+    StringView str = {data, numBytes};
+    data += numBytes;
+    return str;
+}
+
+template <typename T, typename = void>
+struct LogArg {
+    // Print other types to text now
+    using Stored = StringView;
+    static PLY_NO_INLINE void write(OutStream* outs, const T& value) {
+        u32 numBytes = 0;
+        outs->write({(const char*) &numBytes, sizeof(u32)});
+        // The length is patched once the text is printed
+        char* lengthPos = outs->curByte - sizeof(u32);
+        fmt::TypePrinter<T>::print(outs, value);
+        if (!outs->atEOF()) {
+            numBytes = u32(outs->curByte - lengthPos) - sizeof(u32);
+            memcpy(lengthPos, &numBytes, sizeof(u32));
+        }
+    }
+    static PLY_INLINE StringView read(const char*& data) {
+        return readString(data);
+    }
+};
+
+template <typename T>
+struct LogArg<T, std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>> {
+    using Stored = T;
+    static PLY_INLINE void write(OutStream* outs, const T& value) {
+        outs->write({(const char*) &value, sizeof(T)});
+    }
+    static PLY_INLINE T read(const char*& data) {
+        return readRaw<T>(data);
+    }
+};
+
+template <typename T>
+struct LogArg<T, std::enable_if_t<!std::is_arithmetic<T>::value &&
+                                   std::is_convertible<const T&, StringView>::value>> {
+    using Stored = StringView;
+    static PLY_INLINE void write(OutStream* outs, const T& value) {
+        writeString(outs, value);
+    }
+    static PLY_INLINE StringView read(const char*& data) {
+        return readString(data);
+    }
+};
+
+// The format string is copied into the record, since it might not be a literal
+template <typename Fmt>
+struct LogFormat {
+    static PLY_INLINE void write(OutStream* outs, const Fmt& fmt) {
+        writeString(outs, fmt);
+    }
+    static PLY_INLINE StringView read(const char*& data) {
+        return readString(data);
+    }
+};
+
+// A PLY_FMT format string is part of the decode function, so nothing is stored
+template <typename Str>
+struct LogFormat<fmt::CompiledFormat<Str>> {
+    static PLY_INLINE void write(OutStream*, const fmt::CompiledFormat<Str>&) {
+    }
+    static PLY_INLINE fmt::CompiledFormat<Str> read(const char*&) {
+        return {};
+    }
+};
+
+template <typename...>
+struct TypeList {};
+
+template <typename Fmt, typename... Args>
+struct LogRecord {
+    template <std::size_t... I>
+    static PLY_INLINE void encodeArgs(OutStream* outs, const void* const* ptrs,
+                                      std::index_sequence<I...>) {
+        int dummy[] = {0, (LogArg<Args>::write(outs, *(const Args*) ptrs[I]), 0)...};
+        PLY_UNUSED(dummy);
+    }
+
+    static PLY_NO_INLINE void encode(OutStream* outs, const void* const* ptrs) {
+        LogFormat<Fmt>::write(outs, *(const Fmt*) ptrs[0]);
+        encodeArgs(outs, ptrs + 1, std::index_sequence_for<Args...>{});
+    }
+
+    // Reads one argument at a time, then formats them all
+    template <typename StoredFmt, typename... Decoded>
+    static PLY_INLINE void decodeArgs(OutStream* outs, const StoredFmt& fmt, const char*,
+                                      TypeList<>, const Decoded&... decoded) {
+        outs->format(fmt, decoded...);
+    }
+
+    template <typename StoredFmt, typename First, typename... Rest, typename... Decoded>
+    static PLY_INLINE void decodeArgs(OutStream* outs, const StoredFmt& fmt, const char* data,
+                                      TypeList<First, Rest...>, const Decoded&... decoded) {
+        typename LogArg<First>::Stored value = LogArg<First>::read(data);
+        decodeArgs(outs, fmt, data, TypeList<Rest...>{}, decoded..., value);
+    }
+
+    static PLY_NO_INLINE void decode(OutStream* outs, const char* data) {
+        auto fmt = LogFormat<Fmt>::read(data);
+        decodeArgs(outs, fmt, data, TypeList<Args...>{});
+    }
+};
+
+} // namespace details
+
+template <typename Fmt, typename... Args>
+PLY_INLINE bool AsyncLogger::log(StringView channelName, const Fmt& fmt, const Args&... args) {
+    using Record = details::LogRecord<Fmt, Args...>;
+    const void* ptrs[] = {&fmt, &args...};
+    return writeRecord(channelName, Record::decode, Record::encode, ptrs);
+}
+
+} // namespace ply
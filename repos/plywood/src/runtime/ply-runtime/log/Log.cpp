@@ -11,11 +11,14 @@ namespace ply {
 CPUTimer::Point LogChannel::startTime = CPUTimer::get();
 CPUTimer::Converter LogChannel::converter;
 
+PLY_NO_INLINE void LogChannel::writeLinePrefix(OutStream* outs, CPUTimer::Point time, u64 tid,
+                                               StringView channelName) {
+    *outs << (time - startTime); // Timestamp
+    outs->format(PLY_FMT(" 0x{}[{}] "), fmt::Hex(tid), channelName);
+}
+
 PLY_NO_INLINE LogChannel::LineHandler::LineHandler(StringView channelName) {
-    CPUTimer::Point now = CPUTimer::get();
-    TID::TID tid = TID::getCurrentThreadID();
-    this->mout << (now - startTime); // Timestamp
-    this->mout.format(" 0x{}[{}] ", String::from(fmt::Hex(tid)), channelName);
+    writeLinePrefix(&this->mout, CPUTimer::get(), (u64) TID::getCurrentThreadID(), channelName);
 }
 
 PLY_NO_INLINE LogChannel::LineHandler::~LineHandler() {
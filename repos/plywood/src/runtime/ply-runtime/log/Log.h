@@ -4,6 +4,7 @@
 ------------------------------------*/
 #pragma once
 #include <ply-runtime/Core.h>
+#include <ply-runtime/log/AsyncLogger.h>
 #include <ply-runtime/log/Logger.h>
 #include <ply-runtime/io/OutStream.h>
 #include <ply-runtime/time/CPUTimer.h>
@@ -24,8 +25,18 @@ struct LogChannel {
         PLY_DLL_ENTRY ~LineHandler();
     };
 
-    template <typename... Args>
-    PLY_INLINE void log(const char* fmt, const Args&... args) {
+    // Writes the timestamp, thread ID and channel name that begin each line
+    static PLY_DLL_ENTRY void writeLinePrefix(OutStream* outs, CPUTimer::Point time, u64 tid,
+                                              StringView channelName);
+
+    // fmt can be a regular format string or a PLY_FMT. If AsyncLogger is running, the line is
+    // formatted and written by its background thread.
+    template <typename Fmt, typename... Args>
+    PLY_INLINE void log(const Fmt& fmt, const Args&... args) {
+        if (AsyncLogger::isRunning()) {
+            AsyncLogger::log(channelName, fmt, args...);
+            return;
+        }
         LineHandler lh{channelName};
         lh.mout.format(fmt, args...);
     }
@@ -33,8 +44,8 @@ struct LogChannel {
 
 struct LogChannel_Null {
 public:
-    template <typename... Args>
-    void log(const char*, const Args&...) {
+    template <typename Fmt, typename... Args>
+    void log(const Fmt&, const Args&...) {
     }
 };
 
@@ -0,0 +1,133 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Precomp.h>
+#include <ply-runtime/memory/Arena.h>
+#include <ply-runtime/memory/MemPage.h>
+#include <ply-runtime/thread/impl/Mutex_LazyInit.h>
+#include <string.h>
+
+namespace ply {
+
+PLY_STATIC_ASSERT((PLY_ARENA_MAX_BYTES & (PLY_ARENA_MAX_BYTES - 1)) == 0);
+
+// Pages are committed in steps of at least this many bytes
+static constexpr ureg MinCommitBytes = 64 * 1024;
+
+Atomic<uptr> Arena::regionBase_ = 0;
+Atomic<u32> Arena::numScopes_ = 0;
+// Zero-init, so that Arenas can be created during static initialization
+static Mutex_LazyInit slotMutex;
+static Arena* slots[PLY_MAX_ARENAS];
+static thread_local Arena* currentArena = nullptr;
+
+PLY_NO_INLINE Arena::Arena() {
+    LockGuard<Mutex_LazyInit> guard{slotMutex};
+    char* regionBase = (char*) regionBase_.load(Relaxed);
+    if (!regionBase) {
+        MemPage::reserve(regionBase, PLY_ARENA_MAX_BYTES * PLY_MAX_ARENAS);
+        regionBase_.store(uptr(regionBase), Relaxed);
+    }
+    m_slot = 0;
+    while (slots[m_slot]) {
+        m_slot++;
+        // Increase PLY_MAX_ARENAS if this fails
+        PLY_ASSERT(m_slot < PLY_MAX_ARENAS);
+    }
+    slots[m_slot] = this;
+    m_base = regionBase + PLY_ARENA_MAX_BYTES * m_slot;
+    m_cur = m_base;
+    m_committed = m_base;
+    m_last = nullptr;
+    m_scopeMark = m_base;
+}
+
+PLY_NO_INLINE Arena::~Arena() {
+    if (m_committed > m_base) {
+        MemPage::decommit(m_base, m_committed - m_base);
+    }
+    LockGuard<Mutex_LazyInit> guard{slotMutex};
+    slots[m_slot] = nullptr;
+}
+
+// Commits pages so that there are at least end - m_cur bytes available. Returns false if the
+// arena is full.
+static PLY_NO_INLINE bool commitUpTo(char* base, char*& committed, uptr end) {
+    uptr limit = uptr(base) + PLY_ARENA_MAX_BYTES;
+    if (end > limit)
+        return false;
+    // Grow geometrically to keep the number of system calls low
+    uptr newCommitted = max(end, uptr(committed) + max(MinCommitBytes, ureg(committed - base) / 2));
+    newCommitted = min(alignPowerOf2(newCommitted, MemPage::getInfo().pageSize), limit);
+    MemPage::commit(committed, newCommitted - uptr(committed));
+    committed = (char*) newCommitted;
+    return true;
+}
+
+PLY_NO_INLINE void* Arena::allocSlow(ureg size, ureg alignment) {
+    uptr start = alignPowerOf2(uptr(m_cur), alignment);
+    uptr end = start + size;
+    if (end < start || !commitUpTo(m_base, m_committed, end))
+        return nullptr;
+    m_cur = (char*) end;
+    m_last = (char*) start;
+    return m_last;
+}
+
+PLY_NO_INLINE void* Arena::realloc(void* ptr, ureg newSize) {
+    if (!ptr)
+        return alloc(newSize);
+    PLY_ASSERT((char*) ptr >= m_base && (char*) ptr < m_cur);
+    if (ptr == m_last) {
+        uptr end = uptr(ptr) + newSize;
+        if (end < uptr(ptr))
+            return nullptr;
+        if (end > uptr(m_committed) && !commitUpTo(m_base, m_committed, end))
+            return nullptr;
+        m_cur = (char*) end;
+        return ptr;
+    }
+    // The size of the old block isn't stored, but every byte up to m_cur is committed, so copying
+    // past its end is safe.
+    ureg numBytesToCopy = min<ureg>(newSize, m_cur - (char*) ptr);
+    void* newPtr = alloc(newSize);
+    if (newPtr) {
+        memcpy(newPtr, ptr, numBytesToCopy);
+    }
+    return newPtr;
+}
+
+PLY_NO_INLINE Arena* Arena::fromPtr(const void* ptr) {
+    PLY_ASSERT(contains(ptr));
+    Arena* arena = slots[(uptr(ptr) - regionBase_.load(Relaxed)) / PLY_ARENA_MAX_BYTES];
+    PLY_ASSERT(arena);
+    return arena;
+}
+
+PLY_NO_INLINE Arena* Arena::getCurrent() {
+    return currentArena;
+}
+
+PLY_NO_INLINE ScopedArena::ScopedArena(Arena* arena)
+    : m_arena{arena}, m_prevArena{currentArena}, m_mark{nullptr}, m_prevScopeMark{nullptr} {
+    if (arena) {
+        m_mark = arena->getMark();
+        m_prevScopeMark = arena->m_scopeMark;
+        arena->m_scopeMark = m_mark;
+    }
+    currentArena = arena;
+    Arena::numScopes_.fetchAdd(1, Relaxed);
+}
+
+PLY_NO_INLINE ScopedArena::~ScopedArena() {
+    PLY_ASSERT(currentArena == m_arena);
+    currentArena = m_prevArena;
+    Arena::numScopes_.fetchSub(1, Relaxed);
+    if (m_arena) {
+        m_arena->rewind(m_mark);
+        m_arena->m_scopeMark = m_prevScopeMark;
+    }
+}
+
+} // namespace ply
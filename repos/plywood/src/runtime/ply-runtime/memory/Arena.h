@@ -0,0 +1,187 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-platform/Util.h>
+#include <ply-runtime/thread/Atomic.h>
+
+// Set PLY_WITH_ARENA to 0 to compile out the arena checks in PLY_HEAP
+#if !defined(PLY_WITH_ARENA)
+#define PLY_WITH_ARENA 1
+#endif
+
+// PLY_ARENA_MAX_BYTES is the most memory a single Arena can hold, and PLY_MAX_ARENAS is the number
+// of Arenas that can exist at once. Address space for all of them is reserved, but not committed,
+// when the first Arena is created. By default, that's 64 GB on 64-bit platforms and 128 MB on
+// 32-bit platforms. Define smaller values where address space is limited, for example by
+// ulimit -v. PLY_ARENA_MAX_BYTES must be a power of 2.
+#if !defined(PLY_ARENA_MAX_BYTES)
+#if PLY_PTR_SIZE == 8
+#define PLY_ARENA_MAX_BYTES (ureg(1) << 30)
+#else
+#define PLY_ARENA_MAX_BYTES (ureg(1) << 24)
+#endif
+#endif
+
+#if !defined(PLY_MAX_ARENAS)
+#if PLY_PTR_SIZE == 8
+#define PLY_MAX_ARENAS 64
+#else
+#define PLY_MAX_ARENAS 8
+#endif
+#endif
+
+namespace ply {
+
+//-----------------------------------------------------------------------
+// Arena
+//
+// A monotonic allocator. Blocks are carved from a contiguous range of pages that is committed as
+// the arena grows. Individual blocks are not freed; instead, rewind() or reset() releases every
+// block allocated after a given point in O(1), and keeps the pages committed for reuse.
+//
+// An Arena is meant to be used by one thread at a time. PLY_HEAP only frees or resizes a block in
+// place if the innermost ScopedArena on the calling thread uses the block's Arena. Otherwise, a
+// freed block stays allocated until the Arena is rewound, and a resized block is moved to the
+// heap. This makes it safe to free blocks from other threads, and after their Arena is destroyed.
+// A block must not be resized after its Arena is destroyed.
+//-----------------------------------------------------------------------
+class Arena {
+private:
+    char* m_base;
+    char* m_cur;       // Next free byte
+    char* m_committed; // End of committed pages
+    char* m_last;      // Most recent block, which can grow or shrink in place
+    char* m_scopeMark; // Mark of the innermost ScopedArena that uses this arena
+    u32 m_slot;
+
+    friend class ScopedArena;
+
+    PLY_DLL_ENTRY void* allocSlow(ureg size, ureg alignment);
+
+public:
+    static constexpr ureg DefaultAlignment = 2 * PLY_PTR_SIZE; // Same as Heap_DL
+
+    // Start of the address space reserved for all Arenas, or 0 before the first Arena is created
+    static PLY_DLL_ENTRY Atomic<uptr> regionBase_;
+    // Number of ScopedArenas that exist on all threads
+    static PLY_DLL_ENTRY Atomic<u32> numScopes_;
+
+    PLY_DLL_ENTRY Arena();
+    PLY_DLL_ENTRY ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    PLY_INLINE void* alloc(ureg size, ureg alignment = DefaultAlignment) {
+        uptr start = alignPowerOf2(uptr(m_cur), alignment);
+        uptr end = start + size;
+        if (end > uptr(m_committed) || end < start)
+            return allocSlow(size, alignment);
+        m_cur = (char*) end;
+        m_last = (char*) start;
+        return m_last;
+    }
+
+    // The most recent block is resized in place. Any other block is copied to a new block.
+    PLY_DLL_ENTRY void* realloc(void* ptr, ureg newSize);
+
+    // Only the most recent block is actually freed
+    PLY_INLINE void free(void* ptr) {
+        if (ptr && ptr == m_last) {
+            m_cur = m_last;
+            m_last = nullptr;
+        }
+    }
+
+    // Pass the value of getMark() to rewind() to free every block allocated since then. Blocks
+    // allocated before the mark can no longer grow or be freed in place, since that would move
+    // m_cur across the mark.
+    PLY_INLINE char* getMark() {
+        m_last = nullptr;
+        return m_cur;
+    }
+    PLY_INLINE void rewind(char* mark) {
+        PLY_ASSERT(mark >= m_base && mark <= m_cur);
+        m_cur = mark;
+        m_last = nullptr;
+    }
+    PLY_INLINE void reset() {
+        rewind(m_base);
+    }
+
+    PLY_INLINE ureg getUsedBytes() const {
+        return m_cur - m_base;
+    }
+    PLY_INLINE ureg getCommittedBytes() const {
+        return m_committed - m_base;
+    }
+
+    // Returns true if ptr was allocated before the innermost ScopedArena that uses this arena
+    // began. The scope would release a copy made in the arena, so PLY_HEAP moves such blocks to the
+    // heap when they grow.
+    PLY_INLINE bool isBeforeScope(const void* ptr) const {
+        return (const char*) ptr < m_scopeMark;
+    }
+    // Returns the most bytes that can be copied from a block that starts at ptr
+    PLY_INLINE ureg getBytesAfter(const void* ptr) const {
+        return m_cur - (const char*) ptr;
+    }
+
+    //-------------------------------------
+    // Used by PLY_HEAP
+    //-------------------------------------
+    // Returns true if ptr was allocated from any Arena
+    static PLY_INLINE bool contains(const void* ptr) {
+        uptr base = regionBase_.load(Relaxed);
+        return uptr(ptr) - base < PLY_ARENA_MAX_BYTES * PLY_MAX_ARENAS && base != 0;
+    }
+    // Returns the Arena that ptr was allocated from. The Arena must still exist.
+    static PLY_DLL_ENTRY Arena* fromPtr(const void* ptr);
+    // Returns the Arena selected by the innermost ScopedArena on this thread
+    static PLY_DLL_ENTRY Arena* getCurrent();
+    static PLY_INLINE Arena* current() {
+        return numScopes_.load(Relaxed) != 0 ? getCurrent() : nullptr;
+    }
+    // Returns the Arena that can free or resize ptr in place on this thread, or nullptr if the
+    // block must be left alone. That's the current Arena, if ptr was allocated from it since the
+    // innermost ScopedArena began.
+    static PLY_INLINE Arena* getInPlaceArena(const void* ptr) {
+        Arena* arena = current();
+        if (arena && uptr(ptr) - uptr(arena->m_base) < PLY_ARENA_MAX_BYTES &&
+            !arena->isBeforeScope(ptr))
+            return arena;
+        return nullptr;
+    }
+};
+
+//-----------------------------------------------------------------------
+// ScopedArena
+//
+// Makes PLY_HEAP allocate from an Arena on the current thread until the ScopedArena is destroyed.
+// This includes the memory of every Array, String, HashMap, BTree and object created with new.
+// When the scope ends, every block allocated from the arena since the scope began is released at
+// once, so objects that own such memory must not outlive the scope. Pass nullptr to allocate from
+// the heap again within a nested scope.
+//
+// Blocks allocated from the heap before the scope began are still freed and reallocated on the
+// heap, and blocks allocated from the arena are never passed to the heap, even after the scope
+// ends. When scopes that use the same arena are nested, a block allocated before the inner scope
+// began is moved to the heap if it grows within the inner scope.
+//-----------------------------------------------------------------------
+class ScopedArena {
+private:
+    Arena* m_arena;
+    Arena* m_prevArena;
+    char* m_mark;
+    char* m_prevScopeMark;
+
+public:
+    PLY_DLL_ENTRY ScopedArena(Arena* arena);
+    PLY_DLL_ENTRY ~ScopedArena();
+    ScopedArena(const ScopedArena&) = delete;
+    ScopedArena& operator=(const ScopedArena&) = delete;
+};
+
+} // namespace ply
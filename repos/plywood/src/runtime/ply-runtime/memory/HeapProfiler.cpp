@@ -0,0 +1,338 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Precomp.h>
+#include <ply-runtime/memory/HeapProfiler.h>
+#include <ply-runtime/memory/Arena.h>
+#include <ply-runtime/algorithm/Sort.h>
+#include <ply-runtime/container/Array.h>
+#include <ply-runtime/container/HashMap.h>
+#include <ply-runtime/container/SetInScope.h>
+#include <ply-runtime/io/InStream.h>
+#include <ply-runtime/io/OutStream.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/time/CPUTimer.h>
+#include <math.h>
+
+namespace ply {
+
+struct SiteStats {
+    const char* site;
+    double allocBytes = 0;
+    double allocCount = 0;
+    double liveBytes = 0;
+    double liveCount = 0;
+};
+
+struct SiteTraits {
+    using Key = const char*;
+    struct Item : SiteStats {
+        PLY_INLINE Item(const char* site) {
+            this->site = site;
+        }
+    };
+    static PLY_INLINE u32 hash(const char* site) {
+        return Hasher::hash(uptr(site));
+    }
+    static PLY_INLINE bool match(const Item& item, const char* site) {
+        return item.site == site;
+    }
+};
+
+struct SampledBlock {
+    void* ptr;
+    const char* site = nullptr;
+    double bytes = 0;
+    double count = 0;
+};
+
+struct SampledBlockTraits {
+    using Key = void*;
+    struct Item : SampledBlock {
+        PLY_INLINE Item(void* ptr) {
+            this->ptr = ptr;
+        }
+    };
+    static PLY_INLINE bool match(const Item& item, void* ptr) {
+        return item.ptr == ptr;
+    }
+};
+
+struct ProfilerState {
+    Mutex mutex;
+    HashMap<SiteTraits> sites;
+    HashMap<SampledBlockTraits> blocks;
+};
+
+struct ProfilerThreadState {
+    u64 bytesUntilSample; // 0 before the thread's first allocation
+    u64 random;
+    bool isInProfiler; // The profiler doesn't record its own allocations
+};
+
+Atomic<u32> HeapProfiler::sampleInterval_ = 0;
+// Created by the first call to start() and never destroyed
+static ProfilerState* state = nullptr;
+static thread_local ProfilerThreadState threadState;
+
+// Returns the number of bytes to allocate before the next sample. Intervals are exponentially
+// distributed, so that every byte allocated has the same chance of being sampled.
+static PLY_NO_INLINE u64 nextSampleDistance(ProfilerThreadState* ts, u32 sampleInterval) {
+    if (ts->random == 0) {
+        s64 ticks = CPUTimer::get() - CPUTimer::Point{};
+        ts->random = u64(uptr(ts)) ^ u64(ticks) ^ 0x9e3779b97f4a7c15ull;
+    }
+    // xorshift64*
+    ts->random ^= ts->random >> 12;
+    ts->random ^= ts->random << 25;
+    ts->random ^= ts->random >> 27;
+    double u = double((ts->random * 0x2545f4914f6cdd1dull) >> 11) * (1.0 / 9007199254740992.0);
+    return u64(-log(1.0 - u) * sampleInterval) + 1;
+}
+
+PLY_NO_INLINE void HeapProfiler::start(u32 sampleInterval) {
+    PLY_ASSERT(sampleInterval > 0);
+    if (!state) {
+        PLY_SET_IN_SCOPE(threadState.isInProfiler, true);
+        ScopedArena heapOnly{nullptr};
+        state = new ProfilerState;
+    }
+    sampleInterval_.store(sampleInterval, Relaxed);
+}
+
+PLY_NO_INLINE void HeapProfiler::stop() {
+    sampleInterval_.store(0, Relaxed);
+    if (state) {
+        PLY_SET_IN_SCOPE(threadState.isInProfiler, true);
+        LockGuard<Mutex> guard{state->mutex};
+        state->blocks.clear();
+        state->sites.clear();
+    }
+}
+
+PLY_NO_INLINE bool HeapProfiler::shouldSample(ureg size) {
+    ProfilerThreadState* ts = &threadState;
+    if (ts->isInProfiler)
+        return false;
+    u32 sampleInterval = sampleInterval_.load(Relaxed);
+    if (sampleInterval <= 1)
+        return sampleInterval == 1;
+    if (ts->bytesUntilSample == 0) {
+        ts->bytesUntilSample = nextSampleDistance(ts, sampleInterval);
+    }
+    if (size < ts->bytesUntilSample) {
+        ts->bytesUntilSample -= size;
+        return false;
+    }
+    ts->bytesUntilSample = nextSampleDistance(ts, sampleInterval);
+    return true;
+}
+
+PLY_NO_INLINE void HeapProfiler::recordAlloc(void* ptr, ureg size, const char* site) {
+    u32 sampleInterval = sampleInterval_.load(Relaxed);
+    if (!state || sampleInterval == 0)
+        return;
+    // A sampled block stands for 1 / (probability that a block of this size is sampled) blocks
+    double count = 1;
+    if (sampleInterval > 1) {
+        count = 1 / (1 - exp(-double(size) / sampleInterval));
+    }
+    double bytes = double(size) * count;
+
+    PLY_SET_IN_SCOPE(threadState.isInProfiler, true);
+    // The tables outlive any ScopedArena
+    ScopedArena heapOnly{nullptr};
+    LockGuard<Mutex> guard{state->mutex};
+    if (!site) {
+        site = "(unknown)";
+    }
+    SiteStats* stats = &*state->sites.insertOrFind(site);
+    stats->allocBytes += bytes;
+    stats->allocCount += count;
+    stats->liveBytes += bytes;
+    stats->liveCount += count;
+    SampledBlock* block = &*state->blocks.insertOrFind(ptr);
+    block->site = site;
+    block->bytes = bytes;
+    block->count = count;
+}
+
+PLY_NO_INLINE void HeapProfiler::recordFree(void* ptr) {
+    if (!state)
+        return;
+    PLY_SET_IN_SCOPE(threadState.isInProfiler, true);
+    LockGuard<Mutex> guard{state->mutex};
+    // The block won't be found if it was sampled before the last call to stop()
+    auto cursor = state->blocks.find(ptr);
+    if (cursor.wasFound()) {
+        SiteStats* stats = &*state->sites.find(cursor->site);
+        stats->liveBytes -= cursor->bytes;
+        stats->liveCount -= cursor->count;
+        cursor.erase();
+    }
+}
+
+// Returns the stats of every call site, sorted by live bytes. Sites with the same file and line are
+// combined.
+static PLY_NO_INLINE Array<SiteStats> getSiteStats() {
+    Array<SiteStats> result;
+    if (!state)
+        return result;
+    {
+        PLY_SET_IN_SCOPE(threadState.isInProfiler, true);
+        LockGuard<Mutex> guard{state->mutex};
+        for (const SiteStats& stats : state->sites) {
+            result.append(stats);
+        }
+    }
+    // The same site can be passed from different string literals
+    sort(result, [](const SiteStats& a, const SiteStats& b) {
+        return StringView{a.site} < StringView{b.site};
+    });
+    u32 numSites = 0;
+    for (const SiteStats& stats : result) {
+        if (numSites > 0 && StringView{result[numSites - 1].site} == StringView{stats.site}) {
+            SiteStats& prev = result[numSites - 1];
+            prev.allocBytes += stats.allocBytes;
+            prev.allocCount += stats.allocCount;
+            prev.liveBytes += stats.liveBytes;
+            prev.liveCount += stats.liveCount;
+        } else {
+            result[numSites++] = stats;
+        }
+    }
+    result.resize(numSites);
+    sort(result, [](const SiteStats& a, const SiteStats& b) {
+        return a.liveBytes > b.liveBytes ||
+               (a.liveBytes == b.liveBytes && a.allocBytes > b.allocBytes);
+    });
+    return result;
+}
+
+static PLY_INLINE u64 roundCount(double value) {
+    return value > 0 ? u64(value + 0.5) : 0;
+}
+
+PLY_NO_INLINE void HeapProfiler::writeReport(OutStream* outs) {
+    Array<SiteStats> sites = getSiteStats();
+    outs->format("Heap profile, sampling every {} bytes\n", sampleInterval_.load(Relaxed));
+    *outs << "  Live bytes  Live count Total bytes Total count  Site\n";
+    for (const SiteStats& stats : sites) {
+        outs->format(PLY_FMT("{:12}{:12}{:12}{:12}  {}\n"), roundCount(stats.liveBytes),
+                     roundCount(stats.liveCount), roundCount(stats.allocBytes),
+                     roundCount(stats.allocCount), stats.site);
+    }
+}
+
+//-----------------------------------------------------------------------
+// pprof protobuf format
+// https://github.com/google/pprof/blob/main/proto/profile.proto
+//-----------------------------------------------------------------------
+static PLY_NO_INLINE void writeVarint(OutStream* outs, u64 value) {
+    while (value >= 0x80) {
+        *outs << char(value | 0x80);
+        value >>= 7;
+    }
+    *outs << char(value);
+}
+
+static PLY_INLINE void writeInt(OutStream* outs, u32 field, u64 value) {
+    writeVarint(outs, field << 3);
+    writeVarint(outs, value);
+}
+
+static PLY_INLINE void writeBytes(OutStream* outs, u32 field, StringView bytes) {
+    writeVarint(outs, (field << 3) | 2);
+    writeVarint(outs, bytes.numBytes);
+    outs->write(bytes);
+}
+
+static PLY_NO_INLINE void writeInts(OutStream* outs, u32 field, ArrayView<const u64> values) {
+    MemOutStream packed;
+    for (u64 value : values) {
+        writeVarint(&packed, value);
+    }
+    writeBytes(outs, field, packed.moveToString());
+}
+
+struct StringTable {
+    Array<StringView> strings;
+
+    PLY_INLINE StringTable() {
+        this->strings.append(""); // Index 0 must be the empty string
+    }
+    PLY_INLINE u64 add(StringView str) {
+        this->strings.append(str);
+        return this->strings.numItems() - 1;
+    }
+};
+
+// Writes a ValueType message
+static PLY_NO_INLINE void writeValueType(OutStream* outs, u32 field, u64 type, u64 unit) {
+    MemOutStream msg;
+    writeInt(&msg, 1, type);
+    writeInt(&msg, 2, unit);
+    writeBytes(outs, field, msg.moveToString());
+}
+
+PLY_NO_INLINE void HeapProfiler::writePprof(OutStream* outs) {
+    Array<SiteStats> sites = getSiteStats();
+    StringTable strings;
+    u64 count = strings.add("count");
+    u64 bytes = strings.add("bytes");
+    writeValueType(outs, 1, strings.add("alloc_objects"), count);
+    writeValueType(outs, 1, strings.add("alloc_space"), bytes);
+    writeValueType(outs, 1, strings.add("inuse_objects"), count);
+    u64 inuseSpace = strings.add("inuse_space");
+    writeValueType(outs, 1, inuseSpace, bytes);
+
+    writeValueType(outs, 11, strings.add("space"), bytes);
+    writeInt(outs, 12, sampleInterval_.load(Relaxed));
+    writeInt(outs, 14, inuseSpace);
+
+    for (u32 i = 0; i < sites.numItems(); i++) {
+        // Sites look like "path/File.cpp(123)"
+        StringView site = sites[i].site;
+        StringView file = site;
+        u64 line = 0;
+        for (u32 j = site.numBytes; j > 0; j--) {
+            if (site[j - 1] == '(') {
+                file = site.left(j - 1);
+                line = site.subStr(j).to<u32>();
+                break;
+            }
+        }
+        u64 id = i + 1;
+
+        MemOutStream sample;
+        writeInts(&sample, 1, {id});
+        writeInts(&sample, 2,
+                  {roundCount(sites[i].allocCount), roundCount(sites[i].allocBytes),
+                   roundCount(sites[i].liveCount), roundCount(sites[i].liveBytes)});
+        writeBytes(outs, 2, sample.moveToString());
+
+        MemOutStream lineMsg;
+        writeInt(&lineMsg, 1, id);
+        writeInt(&lineMsg, 2, line);
+        MemOutStream location;
+        writeInt(&location, 1, id);
+        writeBytes(&location, 4, lineMsg.moveToString());
+        writeBytes(outs, 4, location.moveToString());
+
+        MemOutStream function;
+        u64 name = strings.add(site);
+        writeInt(&function, 1, id);
+        writeInt(&function, 2, name);
+        writeInt(&function, 3, name);
+        writeInt(&function, 4, strings.add(file));
+        writeInt(&function, 5, line);
+        writeBytes(outs, 5, function.moveToString());
+    }
+
+    for (StringView str : strings.strings) {
+        writeBytes(outs, 6, str);
+    }
+}
+
+} // namespace ply
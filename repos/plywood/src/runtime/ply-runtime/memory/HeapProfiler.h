@@ -0,0 +1,55 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/thread/Atomic.h>
+
+// Set PLY_WITH_HEAP_PROFILER to 0 to compile out the profiler's checks in Heap_DL
+#if !defined(PLY_WITH_HEAP_PROFILER)
+#define PLY_WITH_HEAP_PROFILER 1
+#endif
+
+namespace ply {
+
+class OutStream;
+
+//-----------------------------------------------------------------------
+// HeapProfiler
+//
+// Records which call sites allocate memory from Heap_DL, using the file and line that PLY_HEAP
+// passes to Heap_DL::operate(). Does nothing when PLY_USE_DLMALLOC is disabled.
+//
+// While running, each thread records about one allocation per sampleInterval bytes allocated,
+// chosen at random. Each sample is weighted by the number of allocations it stands for, so the
+// totals per call site estimate the true number of bytes and allocations. Sampled blocks are marked
+// in their chunk header, so that freeing one removes it from the live totals without having to
+// look up every freed block.
+//
+// writeReport() writes a table of call sites sorted by live bytes. writePprof() writes a profile in
+// pprof's protobuf format, with one location per call site; open it with `pprof -http=: <file>`.
+//-----------------------------------------------------------------------
+struct HeapProfiler {
+    // 0 while not running
+    static PLY_DLL_ENTRY Atomic<u32> sampleInterval_;
+
+    static PLY_INLINE bool isRunning() {
+        return sampleInterval_.load(Relaxed) != 0;
+    }
+
+    // Starts recording. A sampleInterval of 1 records every allocation.
+    static PLY_DLL_ENTRY void start(u32 sampleInterval = 512 * 1024);
+    // Stops recording and discards everything recorded so far
+    static PLY_DLL_ENTRY void stop();
+
+    static PLY_DLL_ENTRY void writeReport(OutStream* outs);
+    static PLY_DLL_ENTRY void writePprof(OutStream* outs);
+
+    // Called by Heap_DL while running. shouldSample() decides whether to record an allocation.
+    static PLY_DLL_ENTRY bool shouldSample(ureg size);
+    static PLY_DLL_ENTRY void recordAlloc(void* ptr, ureg size, const char* site);
+    static PLY_DLL_ENTRY void recordFree(void* ptr);
+};
+
+} // namespace ply
@@ -5,6 +5,8 @@
 #pragma once
 #include <ply-runtime/Core.h>
 #include <ply-platform/Util.h>
+#include <ply-runtime/memory/Arena.h>
+#include <string.h>
 #if PLY_TARGET_WIN32
 #include <malloc.h>
 #else
@@ -18,19 +20,56 @@ public:
     class Operator {
     public:
         void* alloc(ureg size) {
+#if PLY_WITH_ARENA
+            if (Arena* arena = Arena::current()) {
+                return arena->alloc(size);
+            }
+#endif
             return ::malloc((size_t) size);
         }
 
         void* realloc(void* ptr, ureg newSize) {
+#if PLY_WITH_ARENA
+            if (Arena::contains(ptr)) {
+                if (Arena* arena = Arena::getInPlaceArena(ptr))
+                    return arena->realloc(ptr, newSize);
+                Arena* arena = Arena::fromPtr(ptr);
+                void* newPtr;
+                {
+                    ScopedArena heapOnly{nullptr};
+                    newPtr = alloc(newSize);
+                }
+                if (newPtr) {
+                    memcpy(newPtr, ptr, min(newSize, arena->getBytesAfter(ptr)));
+                }
+                return newPtr;
+            }
+            if (!ptr) {
+                return alloc(newSize);
+            }
+#endif
             return ::realloc(ptr, newSize);
         }
 
         void free(void* ptr) {
+#if PLY_WITH_ARENA
+            if (Arena::contains(ptr)) {
+                if (Arena* arena = Arena::getInPlaceArena(ptr)) {
+                    arena->free(ptr);
+                }
+                return;
+            }
+#endif
             ::free(ptr);
         }
 
         void* allocAligned(ureg size, ureg alignment) {
             PLY_ASSERT(isPowerOf2(alignment));
+#if PLY_WITH_ARENA
+            if (Arena* arena = Arena::current()) {
+                return arena->alloc(size, alignment);
+            }
+#endif
 #if PLY_TARGET_WIN32
             return ::_aligned_malloc((size_t) size, (size_t) alignment);
 #else
@@ -43,6 +82,14 @@ public:
         }
 
         void freeAligned(void* ptr) {
+#if PLY_WITH_ARENA
+            if (Arena::contains(ptr)) {
+                if (Arena* arena = Arena::getInPlaceArena(ptr)) {
+                    arena->free(ptr);
+                }
+                return;
+            }
+#endif
 #if PLY_TARGET_WIN32
             ::_aligned_free(ptr);
 #else
@@ -3390,6 +3390,168 @@ size_t dlmalloc_usable_size(void* mem) {
 }
 
 } // namespace memory_dl
+
+using namespace memory_dl;
+
+#if PLY_DLMALLOC_THREAD_CACHE
+//-----------------------------------------------------
+// Thread cache
+//-----------------------------------------------------
+/* Chunks up to MAX_CACHED_CHUNK bytes are cached, in one bin per chunk size */
+#define MAX_CACHED_CHUNK    ((size_t)512U)
+#define NUM_CACHE_BINS      ((MAX_CACHED_CHUNK - MIN_CHUNK_SIZE) / MALLOC_ALIGNMENT + 1)
+#define cache_bin_index(S)  (((S) - MIN_CHUNK_SIZE) / MALLOC_ALIGNMENT)
+#define cache_bin_size(I)   (MIN_CHUNK_SIZE + (I) * MALLOC_ALIGNMENT)
+
+/* Each bin holds up to about 8 KB of blocks, and at least 8 blocks */
+#define MAX_CACHE_BIN_BYTES ((size_t)8192U)
+#define cache_bin_limit(S)  ((unsigned)(MAX_CACHE_BIN_BYTES / (S) < 8 ? 8 : \
+                                        MAX_CACHE_BIN_BYTES / (S) > 128 ? 128 : \
+                                        MAX_CACHE_BIN_BYTES / (S)))
+
+struct CacheBin {
+  void* head;     /* Free blocks, linked through their first word */
+  unsigned count;
+};
+
+/* Zero-initialized, so it needs no constructor */
+struct ThreadCache {
+  Heap_DL* heap;     /* The heap whose blocks are cached, or 0 before first use */
+  bool is_destroyed; /* Set at thread exit; later calls lock the heap */
+  CacheBin bins[NUM_CACHE_BINS];
+};
+
+static thread_local ThreadCache thread_cache;
+
+/* Returns every cached block to the heap at thread exit */
+struct ThreadCacheFlusher {
+  bool is_registered;
+  ~ThreadCacheFlusher();
+};
+
+static thread_local ThreadCacheFlusher thread_cache_flusher;
+
+static void release_blocks(CacheBin* bin, unsigned count, mstate m) {
+  while (count-- > 0) {
+    void* mem = bin->head;
+    bin->head = *(void**) mem;
+    bin->count--;
+    dlfree(mem, m);
+  }
+}
+
+ThreadCacheFlusher::~ThreadCacheFlusher() {
+  ThreadCache* tc = &thread_cache;
+  if (tc->heap != 0) {
+    LockGuard<Mutex_LazyInit> guard(tc->heap->m_mutex);
+    for (size_t i = 0; i < NUM_CACHE_BINS; i++) {
+      release_blocks(&tc->bins[i], tc->bins[i].count, &tc->heap->m_mstate);
+    }
+  }
+  tc->heap = 0;
+  tc->is_destroyed = true;
+}
+
+/* Returns the calling thread's cache if it holds blocks for this heap */
+static PLY_INLINE ThreadCache* get_thread_cache(Heap_DL* heap, bool disabled) {
+  ThreadCache* tc = &thread_cache;
+  if (tc->heap == heap)
+    return tc;
+  if (tc->heap == 0 && !tc->is_destroyed && !disabled) {
+    tc->heap = heap;
+    thread_cache_flusher.is_registered = true; /* Constructs it, so its destructor runs */
+    return tc;
+  }
+  return 0;
+}
+
+PLY_NO_INLINE void* Heap_DL::cachedAlloc(ureg size) {
+  if (size <= MAX_CACHED_CHUNK - CHUNK_OVERHEAD) {
+    ThreadCache* tc = get_thread_cache(this, m_threadCacheDisabled);
+    if (tc != 0) {
+      size_t nb = request2size((size_t) size);
+      CacheBin* bin = &tc->bins[cache_bin_index(nb)];
+      if (bin->head == 0) {
+        /* Refill half the bin at once */
+        unsigned batch = cache_bin_limit(nb) / 2;
+        LockGuard<Mutex_LazyInit> guard(m_mutex);
+        while (bin->count < batch) {
+          void* mem = dlmalloc(nb - CHUNK_OVERHEAD, &m_mstate);
+          if (mem == 0)
+            break;
+          *(void**) mem = bin->head;
+          bin->head = mem;
+          bin->count++;
+        }
+        if (bin->head == 0)
+          return 0;
+      }
+      void* mem = bin->head;
+      bin->head = *(void**) mem;
+      bin->count--;
+      return mem;
+    }
+  }
+  LockGuard<Mutex_LazyInit> guard(m_mutex);
+  return dlmalloc((size_t) size, &m_mstate);
+}
+
+PLY_NO_INLINE void Heap_DL::cachedFree(void* mem) {
+  if (mem == 0)
+    return;
+  /* Reading the size doesn't need the lock. Other threads only change the
+     PINUSE bit of an in-use chunk. */
+  mchunkptr p = mem2chunk(mem);
+  size_t psize = chunksize(p);
+  if (!is_mmapped(p) && psize <= MAX_CACHED_CHUNK) {
+    ThreadCache* tc = get_thread_cache(this, m_threadCacheDisabled);
+    if (tc != 0) {
+      CacheBin* bin = &tc->bins[cache_bin_index(psize)];
+      *(void**) mem = bin->head;
+      bin->head = mem;
+      bin->count++;
+      unsigned limit = cache_bin_limit(psize);
+      if (bin->count > limit) {
+        /* Return half the bin at once */
+        LockGuard<Mutex_LazyInit> guard(m_mutex);
+        release_blocks(bin, bin->count - limit / 2, &m_mstate);
+      }
+      return;
+    }
+  }
+  LockGuard<Mutex_LazyInit> guard(m_mutex);
+  dlfree(mem, &m_mstate);
+}
+#endif // PLY_DLMALLOC_THREAD_CACHE
+
+#if PLY_WITH_HEAP_PROFILER
+//-----------------------------------------------------
+// HeapProfiler hooks
+//-----------------------------------------------------
+/* Sampled chunks are marked with FLAG4_BIT, so that only those are looked
+   up when freed. The head is only modified while holding the lock. */
+PLY_NO_INLINE void Heap_DL::sampleAlloc(void* mem, ureg size, const char* site) {
+  if (HeapProfiler::shouldSample(size)) {
+    {
+      LockGuard<Mutex_LazyInit> guard(m_mutex);
+      set_flag4(mem2chunk(mem));
+    }
+    HeapProfiler::recordAlloc(mem, size, site);
+  }
+}
+
+PLY_NO_INLINE void Heap_DL::sampleFree(void* mem) {
+  mchunkptr p = mem2chunk(mem);
+  if (flag4inuse(p)) {
+    {
+      LockGuard<Mutex_LazyInit> guard(m_mutex);
+      clear_flag4(p);
+    }
+    HeapProfiler::recordFree(mem);
+  }
+}
+#endif // PLY_WITH_HEAP_PROFILER
+
 } // namespace ply
 
 #endif // PLY_USE_DLMALLOC && !PLY_DLL_IMPORTING
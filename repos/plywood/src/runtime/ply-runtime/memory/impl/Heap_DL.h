@@ -4,9 +4,16 @@
 ------------------------------------*/
 #pragma once
 #include <ply-runtime/Core.h>
+#include <ply-runtime/memory/Arena.h>
+#include <ply-runtime/memory/HeapProfiler.h>
 #include <ply-runtime/thread/impl/Mutex_LazyInit.h>
 #include <string.h>
 
+// Set PLY_DLMALLOC_THREAD_CACHE to 0 to make every allocation lock the heap
+#if !defined(PLY_DLMALLOC_THREAD_CACHE)
+#define PLY_DLMALLOC_THREAD_CACHE 1
+#endif
+
 namespace ply {
 namespace memory_dl {
 
@@ -106,10 +113,33 @@ PLY_DLL_ENTRY size_t dlmalloc_usable_size(void*);
 
 } // namespace memory_dl
 
+//-----------------------------------------------------
+// Heap_DL
+//
+// When PLY_DLMALLOC_THREAD_CACHE is enabled, small blocks are allocated from, and freed to, a cache
+// owned by the calling thread, without locking the heap. The cache is refilled from the heap, and
+// returns blocks to it, in batches. A block can be freed on a different thread than the one that
+// allocated it; it goes into the cache of the thread that frees it. Each thread caches blocks for
+// the first heap it uses that has the cache enabled. Cached blocks are reported as in use by
+// getStats(), and are returned to the heap when the thread exits.
+//
+// While a ScopedArena is active on the calling thread, blocks are allocated from its Arena instead.
+//-----------------------------------------------------
 class Heap_DL {
 private:
     memory_dl::malloc_state m_mstate;
     Mutex_LazyInit m_mutex;
+#if PLY_DLMALLOC_THREAD_CACHE
+    bool m_threadCacheDisabled;
+    friend struct ThreadCacheFlusher;
+
+    PLY_DLL_ENTRY void* cachedAlloc(ureg size);
+    PLY_DLL_ENTRY void cachedFree(void* ptr);
+#endif
+#if PLY_WITH_HEAP_PROFILER
+    PLY_DLL_ENTRY void sampleAlloc(void* ptr, ureg size, const char* site);
+    PLY_DLL_ENTRY void sampleFree(void* ptr);
+#endif
 
 public:
     // If you create a Heap_DL at global scope, it will be automatically
@@ -121,33 +151,120 @@ public:
 
     typedef memory_dl::Stats Stats;
 
+    // The thread cache is enabled by default. Disable it before the heap is first used.
+    void setThreadCacheEnabled(bool enabled) {
+#if PLY_DLMALLOC_THREAD_CACHE
+        m_threadCacheDisabled = !enabled;
+#else
+        PLY_UNUSED(enabled);
+#endif
+    }
+
     class Operator {
     private:
         Heap_DL& m_mem;
+        const char* m_site; // File and line of the caller, passed to HeapProfiler
+
+        PLY_INLINE void* profileAlloc(void* ptr, ureg size) {
+#if PLY_WITH_HEAP_PROFILER
+            if (HeapProfiler::isRunning() && ptr) {
+                m_mem.sampleAlloc(ptr, size, m_site);
+            }
+#endif
+            return ptr;
+        }
+
+        PLY_INLINE void profileFree(void* ptr) {
+#if PLY_WITH_HEAP_PROFILER
+            if (HeapProfiler::isRunning() && ptr) {
+                m_mem.sampleFree(ptr);
+            }
+#endif
+        }
 
     public:
-        Operator(Heap_DL& mem) : m_mem(mem) {
+        Operator(Heap_DL& mem, const char* site) : m_mem(mem), m_site(site) {
         }
 
         // There may also be extra indirection/checks inside the functions
         PLY_NO_INLINE void* alloc(ureg size) {
-            LockGuard<Mutex_LazyInit> guard(m_mem.m_mutex);
-            return memory_dl::dlmalloc((size_t) size, &m_mem.m_mstate);
+#if PLY_WITH_ARENA
+            if (Arena* arena = Arena::current()) {
+                return arena->alloc(size);
+            }
+#endif
+#if PLY_DLMALLOC_THREAD_CACHE
+            return profileAlloc(m_mem.cachedAlloc(size), size);
+#else
+            void* ptr;
+            {
+                LockGuard<Mutex_LazyInit> guard(m_mem.m_mutex);
+                ptr = memory_dl::dlmalloc((size_t) size, &m_mem.m_mstate);
+            }
+            return profileAlloc(ptr, size);
+#endif
         }
 
         PLY_NO_INLINE void* realloc(void* ptr, ureg newSize) {
-            LockGuard<Mutex_LazyInit> guard(m_mem.m_mutex);
-            return memory_dl::dlrealloc(ptr, (size_t) newSize, &m_mem.m_mstate);
+#if PLY_WITH_ARENA
+            if (Arena::contains(ptr)) {
+                if (Arena* arena = Arena::getInPlaceArena(ptr))
+                    return arena->realloc(ptr, newSize);
+                Arena* arena = Arena::fromPtr(ptr);
+                void* newPtr;
+                {
+                    ScopedArena heapOnly{nullptr};
+                    newPtr = alloc(newSize);
+                }
+                if (newPtr) {
+                    memcpy(newPtr, ptr, min(newSize, arena->getBytesAfter(ptr)));
+                }
+                return newPtr;
+            }
+            if (!ptr) {
+                if (Arena* arena = Arena::current()) {
+                    return arena->alloc(newSize);
+                }
+            }
+#endif
+            profileFree(ptr);
+            {
+                LockGuard<Mutex_LazyInit> guard(m_mem.m_mutex);
+                ptr = memory_dl::dlrealloc(ptr, (size_t) newSize, &m_mem.m_mstate);
+            }
+            return profileAlloc(ptr, newSize);
         }
 
         PLY_NO_INLINE void free(void* ptr) {
+#if PLY_WITH_ARENA
+            if (Arena::contains(ptr)) {
+                if (Arena* arena = Arena::getInPlaceArena(ptr)) {
+                    arena->free(ptr);
+                }
+                return;
+            }
+#endif
+            profileFree(ptr);
+#if PLY_DLMALLOC_THREAD_CACHE
+            m_mem.cachedFree(ptr);
+#else
             LockGuard<Mutex_LazyInit> guard(m_mem.m_mutex);
-            return memory_dl::dlfree(ptr, &m_mem.m_mstate);
+            memory_dl::dlfree(ptr, &m_mem.m_mstate);
+#endif
         }
 
         PLY_NO_INLINE void* allocAligned(ureg size, ureg alignment) {
-            LockGuard<Mutex_LazyInit> guard(m_mem.m_mutex);
-            return memory_dl::dlmemalign((size_t) alignment, (size_t) size, &m_mem.m_mstate);
+#if PLY_WITH_ARENA
+            if (Arena* arena = Arena::current()) {
+                return arena->alloc(size, alignment);
+            }
+#endif
+            void* ptr;
+            {
+                LockGuard<Mutex_LazyInit> guard(m_mem.m_mutex);
+                ptr = memory_dl::dlmemalign((size_t) alignment, (size_t) size, &m_mem.m_mstate);
+            }
+            return profileAlloc(ptr, size);
         }
 
         void freeAligned(void* ptr) {
@@ -173,8 +290,8 @@ public:
         return memory_dl::dlmalloc_usable_size(ptr);
     }
 
-    Operator operate(const char*) {
-        return Operator(*this);
+    Operator operate(const char* site) {
+        return Operator(*this, site);
     }
 };
 
@@ -52,6 +52,7 @@ enum class IPResult : u8 {
   Unreachable,
   Refused,
   InUse,
+  WouldBlock,
 };
 
 } // namespace ply
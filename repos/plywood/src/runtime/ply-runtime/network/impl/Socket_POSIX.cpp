@@ -14,6 +14,7 @@
 #include <errno.h>
 #include <string.h>
 #include <signal.h>
+#include <fcntl.h>
 #include <ply-runtime/io/StdIO.h>
 
 #define PLY_IPPOSIX_ALLOW_UNKNOWN_ERRORS 1
@@ -64,6 +65,22 @@ PLY_NO_INLINE TCPConnection_POSIX::~TCPConnection_POSIX() {
     this->outPipe.fd = -1;
 }
 
+PLY_NO_INLINE bool setFDBlocking(int fd, bool blocking) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0)
+        return false;
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) == 0;
+}
+
+PLY_NO_INLINE bool TCPConnection_POSIX::setBlocking(bool blocking) {
+    return setFDBlocking(this->inPipe.fd, blocking);
+}
+
+PLY_NO_INLINE bool TCPListener_POSIX::setBlocking(bool blocking) {
+    return setFDBlocking(this->listenSocket, blocking);
+}
+
 PLY_NO_INLINE Owned<TCPConnection_POSIX> TCPListener_POSIX::accept() {
     if (this->listenSocket < 0) {
         Socket_POSIX::lastResult_.store(IPResult::NoSocket);
@@ -79,6 +96,16 @@ PLY_NO_INLINE Owned<TCPConnection_POSIX> TCPListener_POSIX::accept() {
     int hostSocket = ::accept(this->listenSocket, (struct sockaddr*) &remoteAddr, &remoteAddrLen);
 
     if (hostSocket <= 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Non-blocking listener has no pending connections
+            Socket_POSIX::lastResult_.store(IPResult::WouldBlock);
+            return nullptr;
+        }
+        if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+            // Out of file descriptors or socket buffers. The connection stays pending.
+            Socket_POSIX::lastResult_.store(IPResult::NoSocket);
+            return nullptr;
+        }
         // FIXME: Check errno
         PLY_ASSERT(PLY_IPPOSIX_ALLOW_UNKNOWN_ERRORS);
         Socket_POSIX::lastResult_.store(IPResult::Unknown);
@@ -172,7 +199,7 @@ PLY_NO_INLINE TCPListener_POSIX Socket_POSIX::bindTCP(u16 port) {
 
     rc = bind(listenSocket, (struct sockaddr*) &serverAddr, serverAddrLen);
     if (rc == 0) {
-        rc = listen(listenSocket, 1);
+        rc = listen(listenSocket, SOMAXCONN);
         if (rc == 0) {
             Socket_POSIX::lastResult_.store(IPResult::OK);
             return TCPListener_POSIX{listenSocket};
@@ -74,6 +74,9 @@ struct TCPConnection_POSIX {
     PLY_INLINE OutStream createOutStream() {
         return OutStream{borrow(&this->outPipe)};
     }
+    // Non-blocking connections are meant to be driven by an event loop such as epoll. Reads and
+    // writes through InStream/OutStream will fail with EAGAIN instead of waiting.
+    PLY_DLL_ENTRY bool setBlocking(bool blocking);
 };
 
 //------------------------------------------------------------------
@@ -114,6 +117,9 @@ public:
         }
     }
 
+    // In non-blocking mode, accept() returns nullptr when there are no pending connections, and
+    // lastResult() is WouldBlock. It's NoSocket when the process is out of file descriptors.
+    PLY_DLL_ENTRY bool setBlocking(bool blocking);
     PLY_DLL_ENTRY Owned<TCPConnection_POSIX> accept();
 };
 
@@ -150,7 +150,7 @@ PLY_NO_INLINE TCPListener_Winsock Socket_Winsock::bindTCP(u16 port) {
 
     rc = bind(listenSocket, (struct sockaddr*) &serverAddr, serverAddrLen);
     if (rc == 0) {
-        rc = listen(listenSocket, 1);
+        rc = listen(listenSocket, SOMAXCONN);
         if (rc == 0) {
             Socket_Winsock::lastResult_.store(IPResult::OK);
             return TCPListener_Winsock{listenSocket};
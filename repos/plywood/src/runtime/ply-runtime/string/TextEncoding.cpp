@@ -4,12 +4,177 @@
 ------------------------------------*/
 #include <ply-runtime/Precomp.h>
 #include <ply-runtime/string/TextEncoding.h>
+#if PLY_CPU_X86 || PLY_CPU_X64
+#include <emmintrin.h>
+#elif PLY_CPU_ARM64
+#include <arm_neon.h>
+#endif
+#if PLY_COMPILER_MSVC
+#include <intrin.h>
+#endif
 
 namespace ply {
 
+static PLY_INLINE u32 lowestBit(u32 mask) {
+    PLY_ASSERT(mask != 0);
+#if PLY_COMPILER_MSVC
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+//-------------------------------------------------------------------
+// Bulk conversion of ASCII runs
+//-------------------------------------------------------------------
+PLY_NO_INLINE void details::widenASCII(MutableStringView* dstBuf, StringView* srcBuf,
+                                       bool bigEndian) {
+    const u8* src = (const u8*) srcBuf->bytes;
+    u8* dst = (u8*) dstBuf->bytes;
+    u32 numUnits = min(srcBuf->numBytes, dstBuf->numBytes / 2);
+    u32 i = 0;
+#if PLY_CPU_X86 || PLY_CPU_X64
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= numUnits; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+        if (_mm_movemask_epi8(v) != 0)
+            break;
+        __m128i lo = bigEndian ? _mm_unpacklo_epi8(zero, v) : _mm_unpacklo_epi8(v, zero);
+        __m128i hi = bigEndian ? _mm_unpackhi_epi8(zero, v) : _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128((__m128i*) (dst + i * 2), lo);
+        _mm_storeu_si128((__m128i*) (dst + i * 2 + 16), hi);
+    }
+#elif PLY_CPU_ARM64
+    uint8x16_t zero = vdupq_n_u8(0);
+    for (; i + 16 <= numUnits; i += 16) {
+        uint8x16_t v = vld1q_u8(src + i);
+        if (vmaxvq_u8(v) >= 0x80)
+            break;
+        uint8x16x2_t units = bigEndian ? uint8x16x2_t{{zero, v}} : uint8x16x2_t{{v, zero}};
+        vst2q_u8(dst + i * 2, units);
+    }
+#endif
+    for (; i < numUnits && src[i] < 0x80; i++) {
+        dst[i * 2 + (bigEndian ? 1 : 0)] = src[i];
+        dst[i * 2 + (bigEndian ? 0 : 1)] = 0;
+    }
+    srcBuf->offsetHead(i);
+    dstBuf->offsetHead(i * 2);
+}
+
+PLY_NO_INLINE void details::narrowASCII(MutableStringView* dstBuf, StringView* srcBuf,
+                                        bool bigEndian) {
+    const u8* src = (const u8*) srcBuf->bytes;
+    u8* dst = (u8*) dstBuf->bytes;
+    u32 numUnits = min(srcBuf->numBytes / 2, dstBuf->numBytes);
+    u32 lowByte = bigEndian ? 1 : 0;
+    u32 i = 0;
+#if PLY_CPU_X86 || PLY_CPU_X64
+    __m128i highBits = _mm_set1_epi16(bigEndian ? (short) 0x80ff : (short) 0xff80);
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= numUnits; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (src + i * 2));
+        __m128i b = _mm_loadu_si128((const __m128i*) (src + i * 2 + 16));
+        __m128i nonASCII = _mm_and_si128(_mm_or_si128(a, b), highBits);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(nonASCII, zero)) != 0xffff)
+            break;
+        if (bigEndian) {
+            a = _mm_srli_epi16(a, 8);
+            b = _mm_srli_epi16(b, 8);
+        }
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(a, b));
+    }
+#elif PLY_CPU_ARM64
+    for (; i + 16 <= numUnits; i += 16) {
+        uint8x16x2_t units = vld2q_u8(src + i * 2);
+        uint8x16_t lo = units.val[lowByte];
+        uint8x16_t hi = units.val[1 - lowByte];
+        if (vmaxvq_u8(vorrq_u8(hi, vshrq_n_u8(lo, 7))) != 0)
+            break;
+        vst1q_u8(dst + i, lo);
+    }
+#endif
+    for (; i < numUnits; i++) {
+        u8 lo = src[i * 2 + lowByte];
+        if (src[i * 2 + 1 - lowByte] != 0 || lo >= 0x80)
+            break;
+        dst[i] = lo;
+    }
+    srcBuf->offsetHead(i * 2);
+    dstBuf->offsetHead(i);
+}
+
 //-------------------------------------------------------------------
 // UTF8
 //-------------------------------------------------------------------
+PLY_NO_INLINE u32 UTF8::numASCIIBytes(StringView view) {
+    const u8* bytes = (const u8*) view.bytes;
+    u32 i = 0;
+#if PLY_CPU_X86 || PLY_CPU_X64
+    for (; i + 16 <= view.numBytes; i += 16) {
+        u32 mask = (u32) _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) (bytes + i)));
+        if (mask != 0)
+            return i + lowestBit(mask);
+    }
+#elif PLY_CPU_ARM64
+    for (; i + 16 <= view.numBytes; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(bytes + i)) >= 0x80)
+            break;
+    }
+#endif
+    while (i < view.numBytes && bytes[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+PLY_NO_INLINE u32 UTF8::numValidBytes(StringView view) {
+    const u8* start = (const u8*) view.bytes;
+    const u8* end = start + view.numBytes;
+    const u8* cur = start;
+    while (cur < end) {
+        u8 first = *cur;
+        if (first < 0x80) {
+            cur += numASCIIBytes({(const char*) cur, u32(end - cur)});
+            continue;
+        }
+
+        // Allowed range of the second byte, from Table 3-7 of the Unicode Standard
+        u32 numBytes = 0;
+        u8 lo = 0x80;
+        u8 hi = 0xbf;
+        if (first >= 0xc2 && first <= 0xdf) {
+            numBytes = 2;
+        } else if (first >= 0xe0 && first <= 0xef) {
+            numBytes = 3;
+            if (first == 0xe0) {
+                lo = 0xa0; // Overlong
+            } else if (first == 0xed) {
+                hi = 0x9f; // Surrogates
+            }
+        } else if (first >= 0xf0 && first <= 0xf4) {
+            numBytes = 4;
+            if (first == 0xf0) {
+                lo = 0x90; // Overlong
+            } else if (first == 0xf4) {
+                hi = 0x8f; // Above U+10FFFF
+            }
+        } else {
+            break;
+        }
+        if (u32(end - cur) < numBytes || cur[1] < lo || cur[1] > hi)
+            break;
+        if (numBytes >= 3 && (cur[2] & 0xc0) != 0x80)
+            break;
+        if (numBytes >= 4 && (cur[3] & 0xc0) != 0x80)
+            break;
+        cur += numBytes;
+    }
+    return u32(cur - start);
+}
+
 PLY_NO_INLINE DecodeResult UTF8::decodePointSlowPath(StringView view) {
     if (view.numBytes == 0) {
         return {};
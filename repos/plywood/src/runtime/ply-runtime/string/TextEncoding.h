@@ -58,10 +58,32 @@ struct Enc_Bytes {
     }
 };
 
+//-------------------------------------------------------------------
+// Bulk conversion of ASCII runs between UTF-8 and UTF-16
+//-------------------------------------------------------------------
+namespace details {
+// Each function converts 16 units at a time when possible, stops at the first non-ASCII unit or
+// when either buffer runs out, and advances both buffers.
+PLY_DLL_ENTRY void widenASCII(MutableStringView* dstBuf, StringView* srcBuf, bool bigEndian);
+PLY_DLL_ENTRY void narrowASCII(MutableStringView* dstBuf, StringView* srcBuf, bool bigEndian);
+} // namespace details
+
 //-------------------------------------------------------------------
 // UTF8
 //-------------------------------------------------------------------
 struct UTF8 {
+    // Returns the number of leading bytes that are ASCII. Checks 16 bytes at a time.
+    static PLY_DLL_ENTRY u32 numASCIIBytes(StringView view);
+
+    // Returns the number of leading bytes that form well-formed UTF-8 as defined by RFC 3629, which
+    // excludes overlong encodings, surrogates and points above U+10FFFF. A sequence that is cut off
+    // by the end of the view isn't counted.
+    static PLY_DLL_ENTRY u32 numValidBytes(StringView view);
+
+    static PLY_INLINE bool isValid(StringView view) {
+        return numValidBytes(view) == view.numBytes;
+    }
+
     static PLY_DLL_ENTRY DecodeResult decodePointSlowPath(StringView view);
 
     static PLY_INLINE DecodeResult decodePoint(StringView view) {
@@ -213,6 +235,14 @@ struct UTF16 {
         PLY_ASSERT(false); // Passed buffer was too small
         return 0;
     }
+
+    // Converts leading ASCII characters from UTF-8 to UTF-16 or back. See details::widenASCII.
+    static PLY_INLINE void convertASCIIFromUTF8(MutableStringView* dstBuf, StringView* srcBuf) {
+        details::widenASCII(dstBuf, srcBuf, BigEndian);
+    }
+    static PLY_INLINE void convertASCIIToUTF8(MutableStringView* dstBuf, StringView* srcBuf) {
+        details::narrowASCII(dstBuf, srcBuf, BigEndian);
+    }
 };
 
 using UTF16_LE = UTF16<false>;
@@ -0,0 +1,188 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Precomp.h>
+#include <ply-runtime/thread/EventTracer.h>
+#include <ply-runtime/container/Array.h>
+#include <ply-runtime/io/OutStream.h>
+#include <ply-runtime/memory/Arena.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/thread/TID.h>
+
+namespace ply {
+
+static constexpr u64 EventIndexMask = PLY_EVENT_TRACER_EVENTS_PER_THREAD - 1;
+PLY_STATIC_ASSERT((PLY_EVENT_TRACER_EVENTS_PER_THREAD & EventIndexMask) == 0);
+
+struct EventTracer::ThreadBuffer {
+    Event events[PLY_EVENT_TRACER_EVENTS_PER_THREAD];
+    Atomic<u64> numEvents = 0;   // Total number written. Only modified by the owning thread.
+    Atomic<u32> isInUse = 1;     // Cleared when the owning thread exits
+    Atomic<u64> retireOrder = 0; // Buffers of exited threads are reused oldest first
+    u32 index = 0;               // Used as the thread ID in the trace
+    Mutex mutex;                 // Held while the buffer is read or handed to a new thread
+    u64 tid = 0;
+    String threadName;
+    ThreadBuffer* next = nullptr;
+};
+
+Atomic<u32> EventTracer::isEnabled_ = 1;
+// Buffers are never freed, so this list only grows
+static Atomic<EventTracer::ThreadBuffer*> firstBuffer = nullptr;
+static Atomic<u32> numBuffers = 0;
+static Atomic<u32> numRetiredBuffers = 0;
+static Atomic<u64> nextRetireOrder = 0;
+static CPUTimer::Point startTime = CPUTimer::get();
+
+struct ThreadBufferRef {
+    EventTracer::ThreadBuffer* buffer = nullptr;
+
+    ~ThreadBufferRef() {
+        if (this->buffer) {
+            this->buffer->retireOrder.store(nextRetireOrder.fetchAdd(1, Relaxed), Relaxed);
+            this->buffer->isInUse.store(0, Release);
+            numRetiredBuffers.fetchAdd(1, Relaxed);
+        }
+    }
+};
+static thread_local ThreadBufferRef currentBuffer;
+
+static PLY_NO_INLINE EventTracer::ThreadBuffer* claimBuffer() {
+    // Keep the events of recently exited threads. Once there are enough of them, reuse the buffer
+    // of the thread that exited first.
+    EventTracer::ThreadBuffer* buffer = nullptr;
+    while (!buffer && numRetiredBuffers.load(Relaxed) > PLY_EVENT_TRACER_RETIRED_BUFFERS) {
+        EventTracer::ThreadBuffer* oldest = nullptr;
+        for (EventTracer::ThreadBuffer* b = firstBuffer.load(Acquire); b; b = b->next) {
+            if (b->isInUse.load(Relaxed) == 0 &&
+                (!oldest || b->retireOrder.load(Relaxed) < oldest->retireOrder.load(Relaxed))) {
+                oldest = b;
+            }
+        }
+        u32 expected = 0;
+        if (oldest && oldest->isInUse.compareExchangeStrong(expected, 1, Acquire)) {
+            numRetiredBuffers.fetchSub(1, Relaxed);
+            buffer = oldest;
+        }
+    }
+    if (buffer) {
+        LockGuard<Mutex> guard{buffer->mutex};
+        buffer->numEvents.store(0, Relaxed);
+        buffer->threadName = {};
+    } else {
+        // Buffers outlive any ScopedArena
+        ScopedArena heapOnly{nullptr};
+        buffer = new EventTracer::ThreadBuffer;
+        buffer->index = numBuffers.fetchAdd(1, Relaxed);
+        EventTracer::ThreadBuffer* head = firstBuffer.load(Relaxed);
+        do {
+            buffer->next = head;
+        } while (!firstBuffer.compareExchangeWeak(head, buffer, Release, Relaxed));
+    }
+    buffer->tid = (u64) TID::getCurrentThreadID();
+    currentBuffer.buffer = buffer;
+    return buffer;
+}
+
+PLY_NO_INLINE void EventTracer::setThreadName(StringView name) {
+    ThreadBuffer* buffer = currentBuffer.buffer;
+    if (!buffer) {
+        buffer = claimBuffer();
+    }
+    LockGuard<Mutex> guard{buffer->mutex};
+    buffer->threadName = name;
+}
+
+PLY_NO_INLINE void EventTracer::record(EventType type, const char* name, s64 value) {
+    ThreadBuffer* buffer = currentBuffer.buffer;
+    if (!buffer) {
+        buffer = claimBuffer();
+    }
+    u64 n = buffer->numEvents.loadNonatomic();
+    Event& event = buffer->events[n & EventIndexMask];
+    event.time = CPUTimer::get();
+    event.name = name;
+    event.value = value;
+    event.type = type;
+    buffer->numEvents.store(n + 1, Release);
+}
+
+//-----------------------------------------------------------------------
+// Chrome trace-event JSON
+//-----------------------------------------------------------------------
+// Copies the events that are in the buffer and weren't overwritten while copying
+static PLY_NO_INLINE void copyEvents(EventTracer::ThreadBuffer* buffer,
+                                     Array<EventTracer::Event>* events) {
+    u64 end = buffer->numEvents.load(Acquire);
+    u64 begin = end > PLY_EVENT_TRACER_EVENTS_PER_THREAD ? end - PLY_EVENT_TRACER_EVENTS_PER_THREAD
+                                                         : 0;
+    events->resize(u32(end - begin));
+    for (u64 i = begin; i < end; i++) {
+        (*events)[u32(i - begin)] = buffer->events[i & EventIndexMask];
+    }
+    // The owning thread might be writing the event after endAfterCopy, which overwrites
+    // endAfterCopy - PLY_EVENT_TRACER_EVENTS_PER_THREAD
+    threadFenceAcquire();
+    u64 endAfterCopy = buffer->numEvents.load(Relaxed);
+    if (endAfterCopy + 1 > begin + PLY_EVENT_TRACER_EVENTS_PER_THREAD) {
+        u64 numOverwritten =
+            min<u64>(endAfterCopy + 1 - begin - PLY_EVENT_TRACER_EVENTS_PER_THREAD, end - begin);
+        events->erase(0, u32(numOverwritten));
+    }
+}
+
+PLY_NO_INLINE void EventTracer::writeChromeTrace(OutStream* outs) {
+    CPUTimer::Converter cvt;
+    double microsecondsPerTick = 1e6 / (double) s64(cvt.toDuration(1.f));
+    u64 pid = (u64) TID::getCurrentProcessID();
+
+    *outs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    Array<Event> events;
+    for (ThreadBuffer* buffer = firstBuffer.load(Acquire); buffer; buffer = buffer->next) {
+        LockGuard<Mutex> guard{buffer->mutex};
+        copyEvents(buffer, &events);
+        if (events.isEmpty())
+            continue;
+
+        if (!first) {
+            *outs << ",\n";
+        }
+        first = false;
+        outs->format(PLY_FMT("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},"
+                             "\"args\":{{\"name\":\""),
+                     pid, buffer->index);
+        if (buffer->threadName) {
+            *outs << fmt::EscapedString{buffer->threadName};
+        } else {
+            outs->format("Thread 0x{}", fmt::Hex{buffer->tid});
+        }
+        *outs << "\"}}";
+
+        // Skip End events whose Begin event was overwritten
+        u32 depth = 0;
+        for (const Event& event : events) {
+            if (event.type == EventType::End) {
+                if (depth == 0)
+                    continue;
+                depth--;
+            } else if (event.type == EventType::Begin) {
+                depth++;
+            }
+            static const char* phases[] = {"B", "E", "C"};
+            double ts = (double) s64(event.time - startTime) * microsecondsPerTick;
+            outs->format(PLY_FMT(",\n{{\"name\":\"{}\",\"ph\":\"{}\",\"ts\":{},"
+                                 "\"pid\":{},\"tid\":{}"),
+                         fmt::EscapedString{event.name}, phases[(u32) event.type], ts, pid,
+                         buffer->index);
+            if (event.type == EventType::Counter) {
+                outs->format(PLY_FMT(",\"args\":{{\"value\":{}}}"), event.value);
+            }
+            *outs << '}';
+        }
+    }
+    *outs << "\n]}\n";
+}
+
+} // namespace ply
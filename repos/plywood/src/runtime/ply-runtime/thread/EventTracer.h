@@ -0,0 +1,109 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/string/StringView.h>
+#include <ply-runtime/thread/Atomic.h>
+#include <ply-runtime/time/CPUTimer.h>
+
+// Set PLY_WITH_EVENT_TRACER to 0 to compile out PLY_TRACE_ZONE and PLY_TRACE_COUNTER
+#if !defined(PLY_WITH_EVENT_TRACER)
+#define PLY_WITH_EVENT_TRACER 1
+#endif
+
+// Must be a power of two
+#if !defined(PLY_EVENT_TRACER_EVENTS_PER_THREAD)
+#define PLY_EVENT_TRACER_EVENTS_PER_THREAD 16384
+#endif
+
+// Number of exited threads whose events are kept
+#if !defined(PLY_EVENT_TRACER_RETIRED_BUFFERS)
+#define PLY_EVENT_TRACER_RETIRED_BUFFERS 8
+#endif
+
+namespace ply {
+
+class OutStream;
+
+//-----------------------------------------------------------------------
+// EventTracer
+//
+// Records timestamped events to a buffer owned by the calling thread, without taking any locks.
+// Each buffer holds the last PLY_EVENT_TRACER_EVENTS_PER_THREAD events; older events are
+// overwritten. When a thread exits, its buffer is kept until PLY_EVENT_TRACER_RETIRED_BUFFERS newer
+// threads have exited. Event names must be string literals, or otherwise outlive the tracer.
+//
+// writeChromeTrace() can be called at any time, from any thread, to write the events currently in
+// every buffer as Chrome trace-event JSON. Open the result in chrome://tracing or
+// https://ui.perfetto.dev.
+//
+// Recording is enabled by default. Use PLY_TRACE_ZONE and PLY_TRACE_COUNTER instead of calling
+// record() directly; they skip the call while recording is disabled.
+//-----------------------------------------------------------------------
+struct EventTracer {
+    enum class EventType : u32 {
+        Begin,
+        End,
+        Counter,
+    };
+
+    struct Event {
+        CPUTimer::Point time;
+        const char* name;
+        s64 value; // Only used by counters
+        EventType type;
+    };
+
+    struct ThreadBuffer;
+
+    static PLY_DLL_ENTRY Atomic<u32> isEnabled_;
+
+    static PLY_INLINE bool isEnabled() {
+        return isEnabled_.load(Relaxed) != 0;
+    }
+    static PLY_INLINE void setEnabled(bool enabled) {
+        isEnabled_.store(enabled ? 1 : 0, Relaxed);
+    }
+
+    // Names the calling thread in the trace
+    static PLY_DLL_ENTRY void setThreadName(StringView name);
+
+    static PLY_DLL_ENTRY void record(EventType type, const char* name, s64 value = 0);
+
+    static PLY_DLL_ENTRY void writeChromeTrace(OutStream* outs);
+};
+
+// Records a Begin event when constructed and an End event when destroyed
+struct TraceZone {
+    const char* name; // nullptr if the Begin event wasn't recorded
+
+    PLY_INLINE TraceZone(const char* name) : name{EventTracer::isEnabled() ? name : nullptr} {
+        if (this->name) {
+            EventTracer::record(EventTracer::EventType::Begin, this->name);
+        }
+    }
+    PLY_INLINE ~TraceZone() {
+        if (this->name) {
+            EventTracer::record(EventTracer::EventType::End, this->name);
+        }
+    }
+};
+
+} // namespace ply
+
+// clang-format off
+#if PLY_WITH_EVENT_TRACER
+#define PLY_TRACE_ZONE(name) ply::TraceZone PLY_UNIQUE_VARIABLE(traceZone_){name}
+#define PLY_TRACE_COUNTER(name, value) \
+    do { \
+        if (ply::EventTracer::isEnabled()) { \
+            ply::EventTracer::record(ply::EventTracer::EventType::Counter, name, s64(value)); \
+        } \
+    } while (0)
+#else
+#define PLY_TRACE_ZONE(name) do {} while (0)
+#define PLY_TRACE_COUNTER(name, value) do {} while (0)
+#endif
+// clang-format on
@@ -0,0 +1,111 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Precomp.h>
+#include <ply-runtime/thread/QSBR.h>
+
+namespace ply {
+
+PLY_NO_INLINE void QSBR::onAllQuiescentStatesPassed(Array<Action>& actions) {
+    // Actions from the previous interval can run now. Actions from the current interval have to
+    // wait for one more interval, because a thread may have passed its quiescent state for this
+    // interval before the action was enqueued, then picked up a reference to the memory it frees.
+    actions = std::move(this->pendingActions);
+    this->pendingActions = std::move(this->deferredActions);
+    this->remaining = this->numContexts;
+    for (Status& status : this->status) {
+        status.wasIdle = false;
+    }
+}
+
+PLY_NO_INLINE QSBR::~QSBR() {
+    this->flush();
+}
+
+PLY_NO_INLINE QSBR::Context QSBR::createContext() {
+    LockGuard<Mutex> guard{this->mutex};
+    this->numContexts++;
+    this->remaining++;
+    Context context;
+    if (this->freeIndex != u32(-1)) {
+        context = this->freeIndex;
+        this->freeIndex = this->status[context].nextFree;
+    } else {
+        context = this->status.numItems();
+        this->status.append();
+    }
+    Status& status = this->status[context];
+    status.inUse = true;
+    status.wasIdle = false;
+    status.nextFree = u32(-1);
+    return context;
+}
+
+PLY_NO_INLINE void QSBR::destroyContext(Context context) {
+    Array<Action> actions;
+    {
+        LockGuard<Mutex> guard{this->mutex};
+        Status& status = this->status[context];
+        PLY_ASSERT(status.inUse);
+        if (!status.wasIdle) {
+            PLY_ASSERT(this->remaining > 0);
+            this->remaining--;
+        }
+        status.inUse = false;
+        status.nextFree = this->freeIndex;
+        this->freeIndex = context;
+        this->numContexts--;
+        if (this->remaining == 0) {
+            this->onAllQuiescentStatesPassed(actions);
+        }
+    }
+    for (Action& action : actions) {
+        action();
+    }
+}
+
+PLY_NO_INLINE void QSBR::enqueue(Action&& action) {
+    LockGuard<Mutex> guard{this->mutex};
+    this->deferredActions.append(std::move(action));
+}
+
+PLY_NO_INLINE void QSBR::onQuiescentState(Context context) {
+    Array<Action> actions;
+    {
+        LockGuard<Mutex> guard{this->mutex};
+        Status& status = this->status[context];
+        PLY_ASSERT(status.inUse);
+        if (status.wasIdle)
+            return;
+        status.wasIdle = true;
+        PLY_ASSERT(this->remaining > 0);
+        this->remaining--;
+        if (this->remaining > 0)
+            return;
+        this->onAllQuiescentStatesPassed(actions);
+    }
+    for (Action& action : actions) {
+        action();
+    }
+}
+
+PLY_NO_INLINE void QSBR::flush() {
+    Array<Action> actions;
+    {
+        LockGuard<Mutex> guard{this->mutex};
+        this->onAllQuiescentStatesPassed(actions);
+    }
+    for (Action& action : actions) {
+        action();
+    }
+    {
+        LockGuard<Mutex> guard{this->mutex};
+        this->onAllQuiescentStatesPassed(actions);
+    }
+    for (Action& action : actions) {
+        action();
+    }
+}
+
+} // namespace ply
@@ -0,0 +1,62 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/container/Array.h>
+#include <ply-runtime/container/Functor.h>
+#include <ply-runtime/thread/Mutex.h>
+
+namespace ply {
+
+//-----------------------------------------------------------------------
+// QSBR
+//
+// Quiescent state-based reclamation. Each thread that reads from a lock-free data structure owns a
+// Context, and calls onQuiescentState() at points where it holds no references into the structure,
+// such as between requests. An action passed to enqueue(), typically one that frees memory, runs
+// only once every registered thread has passed through a quiescent state twice, so no thread can
+// still be using the memory being freed. Threads that stop reading must destroy their context,
+// otherwise deferred actions will never run.
+//-----------------------------------------------------------------------
+class QSBR {
+public:
+    using Context = u32;
+    using Action = Functor<void()>;
+
+private:
+    struct Status {
+        bool inUse = false;
+        bool wasIdle = false;
+        u32 nextFree = 0;
+    };
+
+    Mutex mutex;
+    Array<Status> status;
+    u32 freeIndex = u32(-1);
+    u32 numContexts = 0;
+    u32 remaining = 0;
+    // Actions enqueued during the current interval
+    Array<Action> deferredActions;
+    // Actions enqueued during the previous interval
+    Array<Action> pendingActions;
+
+    // Must be called with the mutex held. Returns the actions that are now safe to run.
+    PLY_DLL_ENTRY void onAllQuiescentStatesPassed(Array<Action>& actions);
+
+public:
+    PLY_INLINE QSBR() = default;
+    // Runs every remaining action.
+    PLY_DLL_ENTRY ~QSBR();
+
+    PLY_DLL_ENTRY Context createContext();
+    PLY_DLL_ENTRY void destroyContext(Context context);
+    PLY_DLL_ENTRY void enqueue(Action&& action);
+    PLY_DLL_ENTRY void onQuiescentState(Context context);
+    // Runs every enqueued action immediately. Only safe to call when no other thread holds a
+    // reference into any structure protected by this QSBR.
+    PLY_DLL_ENTRY void flush();
+};
+
+} // namespace ply
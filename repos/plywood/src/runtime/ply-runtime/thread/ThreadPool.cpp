@@ -0,0 +1,165 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Precomp.h>
+#include <ply-runtime/thread/ThreadPool.h>
+#include <ply-runtime/thread/Affinity.h>
+
+namespace ply {
+
+ThreadLocal<ThreadPool::Worker*> ThreadPool::currentWorker_;
+
+PLY_NO_INLINE ThreadPool::ThreadPool(u32 numWorkers, u32 maxQueuedTasks)
+    : maxQueuedTasks{maxQueuedTasks} {
+    if (numWorkers == 0) {
+        numWorkers = max<u32>(Affinity{}.getNumHWThreads(), 1);
+    }
+    this->workers.resize(numWorkers);
+    for (u32 i = 0; i < numWorkers; i++) {
+        Worker* worker = new Worker;
+        worker->pool = this;
+        worker->index = i;
+        this->workers[i] = worker;
+    }
+    // Start the threads only after every worker exists, since workers steal from each other
+    for (Worker* worker : this->workers) {
+        worker->thread.run([worker] { worker->pool->workerEntry(worker); });
+    }
+}
+
+PLY_NO_INLINE ThreadPool::~ThreadPool() {
+    {
+        LockGuard<Mutex> guard{this->sleepMutex};
+        this->isShuttingDown = true;
+        this->wakeCond.wakeAll();
+    }
+    for (Worker* worker : this->workers) {
+        worker->thread.join();
+    }
+    PLY_ASSERT(this->numUnfinished.load(Relaxed) == 0);
+}
+
+PLY_NO_INLINE s32 ThreadPool::getCurrentWorkerIndex() const {
+    Worker* worker = currentWorker_.load();
+    if (!worker || worker->pool != this)
+        return -1;
+    return (s32) worker->index;
+}
+
+PLY_NO_INLINE void ThreadPool::pushTask(Task&& task) {
+    // numQueued was already incremented by the caller
+    this->numUnfinished.fetchAdd(1, Relaxed);
+    Worker* worker = currentWorker_.load();
+    if (!worker || worker->pool != this) {
+        u32 index = this->nextWorker.fetchAdd(1, Relaxed) % this->workers.numItems();
+        worker = this->workers[index];
+    }
+
+    {
+        LockGuard<Mutex> guard{worker->mutex};
+        u32 capacity = worker->ring.numItems();
+        if (worker->numTasks == capacity) {
+            // Grow the ring buffer, keeping its capacity a power of two
+            Array<Task> newRing;
+            newRing.resize(max<u32>(capacity * 2, 16));
+            for (u32 i = 0; i < worker->numTasks; i++) {
+                newRing[i] = std::move(worker->ring[(worker->head + i) & (capacity - 1)]);
+            }
+            worker->ring = std::move(newRing);
+            worker->head = 0;
+            capacity = worker->ring.numItems();
+        }
+        worker->ring[(worker->head + worker->numTasks) & (capacity - 1)] = std::move(task);
+        worker->numTasks++;
+    }
+
+    LockGuard<Mutex> guard{this->sleepMutex};
+    this->wakeCond.wakeOne();
+}
+
+PLY_NO_INLINE bool ThreadPool::popTask(Worker* worker, Task& task) {
+    // Take the newest task from our own queue
+    {
+        LockGuard<Mutex> guard{worker->mutex};
+        if (worker->numTasks > 0) {
+            worker->numTasks--;
+            u32 mask = worker->ring.numItems() - 1;
+            task = std::move(worker->ring[(worker->head + worker->numTasks) & mask]);
+            this->numQueued.fetchSub(1, Relaxed);
+            return true;
+        }
+    }
+
+    // Steal the oldest task from another worker
+    u32 numWorkers = this->workers.numItems();
+    for (u32 i = 1; i < numWorkers; i++) {
+        Worker* victim = this->workers[(worker->index + i) % numWorkers];
+        LockGuard<Mutex> guard{victim->mutex};
+        if (victim->numTasks > 0) {
+            u32 mask = victim->ring.numItems() - 1;
+            task = std::move(victim->ring[victim->head]);
+            victim->head = (victim->head + 1) & mask;
+            victim->numTasks--;
+            this->numQueued.fetchSub(1, Relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+PLY_NO_INLINE void ThreadPool::runTask(Task& task) {
+    {
+        // Destroy the task before it's counted as finished
+        Task toRun = std::move(task);
+        toRun();
+    }
+    if (this->numUnfinished.fetchSub(1, AcquireRelease) == 1) {
+        LockGuard<Mutex> guard{this->sleepMutex};
+        this->idleCond.wakeAll();
+    }
+}
+
+PLY_NO_INLINE void ThreadPool::workerEntry(Worker* worker) {
+    currentWorker_.store(worker);
+    for (;;) {
+        Task task;
+        if (this->popTask(worker, task)) {
+            this->runTask(task);
+            continue;
+        }
+
+        LockGuard<Mutex> guard{this->sleepMutex};
+        if (this->numQueued.load(Relaxed) > 0)
+            continue; // A task is being pushed; look again
+        if (this->isShuttingDown)
+            break;
+        this->wakeCond.wait(guard);
+    }
+    currentWorker_.store(nullptr);
+}
+
+PLY_NO_INLINE void ThreadPool::submit(Task&& task) {
+    this->numQueued.fetchAdd(1, Relaxed);
+    this->pushTask(std::move(task));
+}
+
+PLY_NO_INLINE bool ThreadPool::trySubmit(Task&& task) {
+    u32 n = this->numQueued.load(Relaxed);
+    do {
+        if (this->maxQueuedTasks > 0 && n >= this->maxQueuedTasks)
+            return false;
+    } while (!this->numQueued.compareExchangeWeak(n, n + 1, Relaxed, Relaxed));
+    this->pushTask(std::move(task));
+    return true;
+}
+
+PLY_NO_INLINE void ThreadPool::waitUntilIdle() {
+    PLY_ASSERT(this->getCurrentWorkerIndex() < 0);
+    LockGuard<Mutex> guard{this->sleepMutex};
+    while (this->numUnfinished.load(Acquire) > 0) {
+        this->idleCond.wait(guard);
+    }
+}
+
+} // namespace ply
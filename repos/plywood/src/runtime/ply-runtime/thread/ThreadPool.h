@@ -0,0 +1,96 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-runtime/Core.h>
+#include <ply-runtime/container/Array.h>
+#include <ply-runtime/container/Functor.h>
+#include <ply-runtime/container/Owned.h>
+#include <ply-runtime/thread/Atomic.h>
+#include <ply-runtime/thread/ConditionVariable.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-runtime/thread/ThreadLocal.h>
+
+namespace ply {
+
+//-----------------------------------------------------------------------
+// ThreadPool
+//
+// Runs tasks on a fixed set of worker threads. Every worker owns a task queue. Tasks submitted from
+// a worker thread go to that worker's own queue; tasks submitted from other threads are distributed
+// round-robin. A worker takes the most recently submitted task from its own queue first, and when
+// its queue is empty, it steals the oldest task from another worker's queue.
+//
+// The total number of queued tasks can be bounded by maxQueuedTasks. trySubmit() fails instead of
+// queueing past the bound, which lets callers apply backpressure. submit() always queues the task;
+// use it for work that must not be dropped, such as tasks spawned by other tasks.
+//-----------------------------------------------------------------------
+class ThreadPool {
+public:
+    using Task = Functor<void()>;
+
+private:
+    struct Worker {
+        ThreadPool* pool = nullptr;
+        u32 index = 0;
+        Mutex mutex;
+        // Ring buffer of tasks. The owning worker pops from the tail; thieves pop from the head.
+        Array<Task> ring;
+        u32 head = 0;
+        u32 numTasks = 0;
+        Thread thread;
+    };
+
+    Array<Owned<Worker>> workers;
+    u32 maxQueuedTasks = 0;
+    Atomic<u32> numQueued = 0;     // Tasks sitting in a queue
+    Atomic<u32> numUnfinished = 0; // Tasks queued or running
+    Atomic<u32> nextWorker = 0;    // Round-robin index for submissions from outside the pool
+    Mutex sleepMutex;
+    ConditionVariable wakeCond;    // Signaled when a task is queued or the pool shuts down
+    ConditionVariable idleCond;    // Signaled when numUnfinished drops to zero
+    bool isShuttingDown = false;
+
+    static ThreadLocal<Worker*> currentWorker_;
+
+    PLY_DLL_ENTRY void pushTask(Task&& task);
+    PLY_DLL_ENTRY bool popTask(Worker* worker, Task& task);
+    PLY_DLL_ENTRY void runTask(Task& task);
+    PLY_DLL_ENTRY void workerEntry(Worker* worker);
+
+public:
+    // If numWorkers is 0, one worker is created per hardware thread. If maxQueuedTasks is 0, the
+    // number of queued tasks is unbounded.
+    PLY_DLL_ENTRY ThreadPool(u32 numWorkers = 0, u32 maxQueuedTasks = 0);
+    // Runs all remaining tasks, then joins the worker threads.
+    PLY_DLL_ENTRY ~ThreadPool();
+
+    PLY_INLINE u32 getNumWorkers() const {
+        return this->workers.numItems();
+    }
+    PLY_INLINE u32 getMaxQueuedTasks() const {
+        return this->maxQueuedTasks;
+    }
+    PLY_INLINE u32 getNumQueuedTasks() const {
+        return this->numQueued.load(Relaxed);
+    }
+
+    // Returns the index of the calling worker thread, or -1 if the caller isn't one of this pool's
+    // workers.
+    PLY_DLL_ENTRY s32 getCurrentWorkerIndex() const;
+
+    // Queues a task even if the number of queued tasks exceeds maxQueuedTasks.
+    PLY_DLL_ENTRY void submit(Task&& task);
+
+    // Queues a task unless maxQueuedTasks tasks are already queued. Returns false, and leaves task
+    // untouched, if the queue is full.
+    PLY_DLL_ENTRY bool trySubmit(Task&& task);
+
+    // Blocks until every submitted task has finished, including tasks submitted while waiting. Must
+    // not be called from one of the pool's own worker threads.
+    PLY_DLL_ENTRY void waitUntilIdle();
+};
+
+} // namespace ply
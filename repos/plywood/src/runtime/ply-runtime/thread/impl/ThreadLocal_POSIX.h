@@ -42,6 +42,13 @@ public:
         return (T)(uptr) value;
     }
 
+    template <typename U = T, std::enable_if_t<std::is_pointer<U>::value, int> = 0>
+    PLY_INLINE void store(T value) {
+        int rc = pthread_setspecific(m_tlsKey, (void*) value);
+        PLY_ASSERT(rc == 0);
+        PLY_UNUSED(rc);
+    }
+
     template <typename U = T,
               std::enable_if_t<std::is_enum<U>::value || std::is_integral<U>::value, int> = 0>
     PLY_INLINE void store(U value) {
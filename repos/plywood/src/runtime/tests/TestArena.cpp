@@ -0,0 +1,135 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX Arena_
+
+PLY_TEST_CASE("ScopedArena allocates containers from an Arena") {
+    Arena arena;
+    Array<u32> outer;
+    outer.append(0u);
+    {
+        ScopedArena scope{&arena};
+        Array<String> strings;
+        for (u32 i = 0; i < 1000; i++) {
+            strings.append(String::from(i));
+        }
+        PLY_TEST_CHECK(Arena::contains(strings.get()));
+        PLY_TEST_CHECK(Arena::contains(strings[999].bytes));
+        PLY_TEST_CHECK(strings[999] == "999");
+        PLY_TEST_CHECK(arena.getUsedBytes() > 0);
+
+        // Blocks allocated before the scope stay on the heap
+        for (u32 i = 1; i < 1000; i++) {
+            outer.append(i);
+        }
+        PLY_TEST_CHECK(!Arena::contains(outer.get()));
+        {
+            ScopedArena heapOnly{nullptr};
+            String str = "heap";
+            PLY_TEST_CHECK(!Arena::contains(str.bytes));
+        }
+    }
+    PLY_TEST_CHECK(arena.getUsedBytes() == 0);
+    PLY_TEST_CHECK(outer.numItems() == 1000 && outer[999] == 999);
+}
+
+PLY_TEST_CASE("Nested ScopedArenas on the same Arena don't overwrite earlier blocks") {
+    Arena arena;
+    ScopedArena scope{&arena};
+    Array<u32> outer;
+    outer.append(0u);
+    String last = "last";
+    {
+        ScopedArena inner{&arena};
+        // outer was allocated before the inner scope, so it must not grow into the inner scope,
+        // which would release it
+        for (u32 i = 1; i < 1000; i++) {
+            outer.append(i);
+        }
+        PLY_TEST_CHECK(!Arena::contains(outer.get()));
+        // Freeing a block from before the inner scope must not move the inner scope's mark
+        last = {};
+    }
+    Array<u32> next;
+    next.resize(1000);
+    memset(next.get(), 0xff, 1000 * sizeof(u32));
+    PLY_TEST_CHECK(outer.numItems() == 1000);
+    bool intact = true;
+    for (u32 i = 0; i < 1000; i++) {
+        intact = intact && outer[i] == i;
+    }
+    PLY_TEST_CHECK(intact);
+}
+
+PLY_TEST_CASE("PLY_HEAP frees Arena blocks in place on the thread that uses the Arena") {
+    Arena arena;
+    ScopedArena scope{&arena};
+    void* ptr = PLY_HEAP.alloc(100);
+    PLY_TEST_CHECK(arena.getUsedBytes() == 100);
+    ptr = PLY_HEAP.realloc(ptr, 200);
+    PLY_TEST_CHECK(arena.getUsedBytes() == 200);
+    PLY_HEAP.free(ptr);
+    PLY_TEST_CHECK(arena.getUsedBytes() == 0);
+}
+
+PLY_TEST_CASE("PLY_HEAP can free and resize Arena blocks from another thread") {
+    Arena arena;
+    ScopedArena scope{&arena};
+    char* ptr = (char*) PLY_HEAP.alloc(100);
+    memset(ptr, 0xab, 100);
+    char* other = (char*) PLY_HEAP.alloc(100);
+    memset(other, 0xcd, 100);
+    ureg usedBytes = arena.getUsedBytes();
+
+    // The other thread leaves the arena alone. The freed block is released by the scope, and the
+    // resized block is moved to the heap.
+    char* resized = nullptr;
+    {
+        // Don't allocate the thread from the arena
+        ScopedArena heapOnly{nullptr};
+        Thread thread{[&] {
+            PLY_HEAP.free(other);
+            resized = (char*) PLY_HEAP.realloc(ptr, 1000);
+        }};
+        thread.join();
+    }
+    PLY_TEST_CHECK(arena.getUsedBytes() == usedBytes);
+    PLY_TEST_CHECK(!Arena::contains(resized));
+    bool intact = true;
+    for (u32 i = 0; i < 100; i++) {
+        intact = intact && resized[i] == (char) 0xab;
+    }
+    PLY_TEST_CHECK(intact);
+    PLY_HEAP.free(resized);
+}
+
+PLY_TEST_CASE("PLY_HEAP can free Arena blocks after the Arena is destroyed") {
+    Arena otherArena;
+    Arena* arena = new Arena;
+    void* ptr;
+    {
+        ScopedArena scope{arena};
+        ptr = PLY_HEAP.alloc(100);
+    }
+    delete arena;
+    PLY_HEAP.free(ptr);
+
+    // The same goes when another Arena is current
+    ScopedArena scope{&otherArena};
+    void* otherPtr = PLY_HEAP.alloc(100);
+    PLY_HEAP.free(ptr);
+    PLY_TEST_CHECK(otherArena.getUsedBytes() == 100);
+    PLY_HEAP.free(otherPtr);
+    PLY_TEST_CHECK(otherArena.getUsedBytes() == 0);
+}
+
+} // namespace tests
+} // namespace ply
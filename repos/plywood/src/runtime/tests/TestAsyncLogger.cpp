@@ -0,0 +1,95 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/log/Log.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX AsyncLogger_
+
+SLOG_CHANNEL(TestLog, "Test")
+
+struct CapturedLines {
+    Mutex mutex;
+    MemOutStream mout;
+
+    AsyncLogger::Options options(u32 bufferBytes, AsyncLogger::OnFull onFull) {
+        AsyncLogger::Options options;
+        options.bufferBytesPerThread = bufferBytes;
+        options.onFull = onFull;
+        options.installCrashHandler = false;
+        options.sink = [this](StringView lines) {
+            LockGuard<Mutex> guard{this->mutex};
+            this->mout << lines;
+        };
+        return options;
+    }
+
+    // Returns each line without its timestamp, thread ID and channel name
+    Array<String> getMessages() {
+        Array<String> messages;
+        String all = this->mout.moveToString();
+        for (StringView line : all.splitByte('\n')) {
+            messages.append(line.subStr(line.findByte(']') + 2));
+        }
+        return messages;
+    }
+};
+
+PLY_TEST_CASE("AsyncLogger keeps each thread's lines in order") {
+    CapturedLines captured;
+    AsyncLogger::start(captured.options(256, AsyncLogger::OnFull::Block));
+    Thread thread{[] {
+        for (u32 i = 0; i < 1000; i++) {
+            SLOG(TestLog, PLY_FMT("b {} {}"), i, fmt::Hex{i});
+        }
+    }};
+    for (u32 i = 0; i < 1000; i++) {
+        String str = String::from(i);
+        SLOG(TestLog, "a {} {}", str, i * 0.5);
+    }
+    thread.join();
+    AsyncLogger::stop();
+
+    u32 numA = 0;
+    u32 numB = 0;
+    for (StringView msg : captured.getMessages()) {
+        if (msg.startsWith("a ")) {
+            PLY_TEST_CHECK(msg == String::format("a {} {}", numA, numA * 0.5));
+            numA++;
+        } else {
+            PLY_TEST_CHECK(msg == String::format("b {} {}", numB, fmt::Hex{numB}));
+            numB++;
+        }
+    }
+    PLY_TEST_CHECK(numA == 1000);
+    PLY_TEST_CHECK(numB == 1000);
+}
+
+PLY_TEST_CASE("AsyncLogger counts dropped lines") {
+    CapturedLines captured;
+    AsyncLogger::Options options = captured.options(256, AsyncLogger::OnFull::Drop);
+    AsyncLogger::start(std::move(options));
+    {
+        // Block the sink so that the ring fills up
+        LockGuard<Mutex> guard{captured.mutex};
+        for (u32 i = 0; i < 100; i++) {
+            SLOG(TestLog, "Line {}", i);
+        }
+    }
+    AsyncLogger::stop();
+
+    Array<String> messages = captured.getMessages();
+    PLY_TEST_CHECK(messages.numItems() > 1 && messages.numItems() < 100);
+    u32 numDropped = messages.back().splitByte(' ')[0].to<u32>();
+    PLY_TEST_CHECK(messages.numItems() - 1 + numDropped == 100);
+}
+
+} // namespace tests
+} // namespace ply
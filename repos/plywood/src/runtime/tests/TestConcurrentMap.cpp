@@ -0,0 +1,71 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/container/ConcurrentMap.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX ConcurrentMap_
+
+PLY_TEST_CASE("ConcurrentMap assign, get and erase") {
+    QSBR qsbr;
+    ConcurrentMap<u32, uptr> map{&qsbr};
+    for (u32 i = 1; i <= 1000; i++) {
+        PLY_TEST_CHECK(map.assign(i, i * 2) == 0);
+    }
+    PLY_TEST_CHECK(map.assign(10, 7) == 20);
+    PLY_TEST_CHECK(map.insertIfAbsent(10, 9) == 7);
+    PLY_TEST_CHECK(map.insertIfAbsent(1001, 9) == 0);
+    for (u32 i = 1; i <= 1000; i += 2) {
+        PLY_TEST_CHECK(map.erase(i) == (i == 10 ? 7 : i * 2));
+    }
+    PLY_TEST_CHECK(map.erase(1) == 0);
+    for (u32 i = 1; i <= 1000; i++) {
+        uptr expected = (i % 2 == 1) ? 0 : (i == 10 ? 7 : i * 2);
+        PLY_TEST_CHECK(map.get(i) == expected);
+    }
+    PLY_TEST_CHECK(map.get(1001) == 9);
+    PLY_TEST_CHECK(map.get(2000) == 0);
+}
+
+PLY_TEST_CASE("ConcurrentMap with several writers") {
+    static constexpr u32 NumThreads = 4;
+    static constexpr u32 KeysPerThread = 20000;
+    QSBR qsbr;
+    ConcurrentMap<u64, uptr> map{&qsbr};
+    Thread threads[NumThreads];
+    for (u32 t = 0; t < NumThreads; t++) {
+        threads[t].run([&map, &qsbr, t] {
+            QSBR::Context context = qsbr.createContext();
+            for (u32 i = 0; i < KeysPerThread; i++) {
+                u64 key = u64(i) * NumThreads + t + 1;
+                map.assign(key, uptr(key + 1));
+                // Read back a key written by another thread, which may or may not exist yet
+                if (key > 1) {
+                    uptr value = map.get(key - 1);
+                    PLY_ASSERT(value == 0 || value == key);
+                    PLY_UNUSED(value);
+                }
+                if (i % 64 == 0) {
+                    qsbr.onQuiescentState(context);
+                }
+            }
+            qsbr.destroyContext(context);
+        });
+    }
+    for (u32 t = 0; t < NumThreads; t++) {
+        threads[t].join();
+    }
+    bool allFound = true;
+    for (u64 key = 1; key <= u64(NumThreads) * KeysPerThread; key++) {
+        allFound = allFound && (map.get(key) == uptr(key + 1));
+    }
+    PLY_TEST_CHECK(allFound);
+}
+
+} // namespace tests
+} // namespace ply
@@ -0,0 +1,149 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+
+#if PLY_KERNEL_LINUX
+
+#include <ply-runtime/filesystem/DirectoryWatcher.h>
+#include <ply-runtime/filesystem/FileSystem.h>
+#include <ply-runtime/thread/Mutex.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX DirectoryWatcher_
+
+// Collects the paths passed to a DirectoryWatcher's callback
+struct WatchedChanges {
+    struct Change {
+        String path;
+        bool mustRecurse;
+    };
+
+    Mutex mutex;
+    Array<Change> changes;
+
+    void add(StringView path, bool mustRecurse) {
+        LockGuard<Mutex> guard{this->mutex};
+        this->changes.append({path, mustRecurse});
+    }
+
+    // Waits up to timeoutMillis for the given path to be reported, then forgets every change
+    // reported so far. Returns false if the path wasn't reported.
+    bool waitFor(StringView path, bool mustRecurse, u32 timeoutMillis = 5000) {
+        for (u32 elapsed = 0; elapsed < timeoutMillis; elapsed += 10) {
+            {
+                LockGuard<Mutex> guard{this->mutex};
+                for (const Change& change : this->changes) {
+                    if (change.path == path && change.mustRecurse == mustRecurse) {
+                        this->changes.clear();
+                        return true;
+                    }
+                }
+            }
+            Thread::sleepMillis(10);
+        }
+        return false;
+    }
+};
+
+String initWatchedFolder() {
+    String root = NativePath::join(PLY_WORKSPACE_FOLDER, "data/tests/runtime/DirectoryWatcher");
+    if (FileSystem::native()->isDir(root)) {
+        FileSystem::native()->removeDirTree(root);
+    }
+    FileSystem::native()->makeDirs(NativePath::join(root, "existing"));
+    return root;
+}
+
+// The watcher thread adds its watches after start() returns, so touch a file until the watcher
+// reports it.
+bool waitUntilWatching(WatchedChanges* watched, StringView root) {
+    for (u32 i = 0; i < 50; i++) {
+        FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(NativePath::join(root, "ready"),
+                                                               String::from(i));
+        if (watched->waitFor("ready", false, 100))
+            return true;
+    }
+    return false;
+}
+
+PLY_TEST_CASE("DirectoryWatcher reports created, modified and deleted files") {
+    String root = initWatchedFolder();
+    WatchedChanges watched;
+    DirectoryWatcher watcher{
+        root, [&](StringView path, bool mustRecurse) { watched.add(path, mustRecurse); }};
+    PLY_TEST_CHECK(waitUntilWatching(&watched, root));
+
+    String path = NativePath::join(root, "a.txt");
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(path, "created");
+    PLY_TEST_CHECK(watched.waitFor("a.txt", false));
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(path, "modified");
+    PLY_TEST_CHECK(watched.waitFor("a.txt", false));
+    FileSystem::native()->deleteFile(path);
+    PLY_TEST_CHECK(watched.waitFor("a.txt", false));
+
+    // Subdirectories that existed when the watcher started are watched
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(
+        NativePath::join(root, "existing/b.txt"), "created");
+    PLY_TEST_CHECK(watched.waitFor("existing/b.txt", false));
+}
+
+PLY_TEST_CASE("DirectoryWatcher watches new subdirectories") {
+    String root = initWatchedFolder();
+    WatchedChanges watched;
+    DirectoryWatcher watcher{
+        root, [&](StringView path, bool mustRecurse) { watched.add(path, mustRecurse); }};
+    PLY_TEST_CHECK(waitUntilWatching(&watched, root));
+
+    FileSystem::native()->makeDirs(NativePath::join(root, "sub/inner"));
+    PLY_TEST_CHECK(watched.waitFor("sub", true));
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(
+        NativePath::join(root, "sub/inner/c.txt"), "created");
+    PLY_TEST_CHECK(watched.waitFor("sub/inner/c.txt", false));
+
+    // Removing a subdirectory is reported as a recursive change
+    FileSystem::native()->removeDirTree(NativePath::join(root, "sub"));
+    PLY_TEST_CHECK(watched.waitFor("sub", true));
+}
+
+PLY_TEST_CASE("DirectoryWatcher stops when the root is deleted") {
+    String root = initWatchedFolder();
+    WatchedChanges watched;
+    DirectoryWatcher watcher{
+        root, [&](StringView path, bool mustRecurse) { watched.add(path, mustRecurse); }};
+    PLY_TEST_CHECK(waitUntilWatching(&watched, root));
+
+    FileSystem::native()->removeDirTree(root);
+    PLY_TEST_CHECK(watched.waitFor({}, true));
+
+    // Recreating the root doesn't resume watching
+    FileSystem::native()->makeDirsAndSaveBinaryIfDifferent(NativePath::join(root, "d.txt"), "");
+    PLY_TEST_CHECK(!watched.waitFor("d.txt", false, 200));
+}
+
+PLY_TEST_CASE("DirectoryWatcher stops when the root is moved") {
+    String root = initWatchedFolder();
+    String movedRoot = root + ".moved";
+    if (FileSystem::native()->isDir(movedRoot)) {
+        FileSystem::native()->removeDirTree(movedRoot);
+    }
+    {
+        WatchedChanges watched;
+        DirectoryWatcher watcher{
+            root, [&](StringView path, bool mustRecurse) { watched.add(path, mustRecurse); }};
+        PLY_TEST_CHECK(waitUntilWatching(&watched, root));
+        PLY_TEST_CHECK(FileSystem::native()->moveFile(root, movedRoot) == FSResult::OK);
+        PLY_TEST_CHECK(watched.waitFor({}, true));
+    }
+    FileSystem::native()->removeDirTree(movedRoot);
+}
+
+} // namespace tests
+} // namespace ply
+
+#endif // PLY_KERNEL_LINUX
@@ -27,5 +27,31 @@ PLY_TEST_CASE("Decode truncated UTF-8") {
     PLY_TEST_CHECK(result == StringView{"\xe3\x00\x80\x00", 4});
 }
 
+PLY_TEST_CASE("Validate UTF-8") {
+    PLY_TEST_CHECK(UTF8::isValid("Plain ASCII text that is longer than sixteen bytes"));
+    PLY_TEST_CHECK(UTF8::isValid("\xc3\xa9t\xc3\xa9 \xe3\x80\x82 \xf0\x9f\x98\x80"));
+    PLY_TEST_CHECK(UTF8::numValidBytes("0123456789abcdef01234\xff") == 21);
+    PLY_TEST_CHECK(!UTF8::isValid("\xc0\xaf"));             // Overlong
+    PLY_TEST_CHECK(!UTF8::isValid("\xed\xa0\x80"));         // Surrogate
+    PLY_TEST_CHECK(!UTF8::isValid("\xf4\x90\x80\x80"));     // Above U+10FFFF
+    PLY_TEST_CHECK(UTF8::numValidBytes("ab\xe3\x80") == 2); // Truncated
+}
+
+PLY_TEST_CASE("Convert long UTF-8 text to UTF-16 and back") {
+    MemOutStream mout;
+    for (u32 i = 0; i < 100; i++) {
+        mout << "Some ASCII text " << i << " \xc3\xa9\xe3\x80\x82\xf0\x9f\x98\x80 ";
+    }
+    String utf8 = mout.moveToString();
+    String utf16 = TextConverter::convert<UTF16_BE, UTF8>(utf8);
+    PLY_TEST_CHECK(TextConverter::convert<UTF8, UTF16_BE>(utf16) == utf8);
+    // Each iteration has 9 bytes of UTF-8 that become 8 bytes of UTF-16
+    utf16 = convertWithOutPipe(utf8, TextEncoding::get<UTF8>(), TextEncoding::get<UTF16_LE>());
+    PLY_TEST_CHECK(utf16.numBytes == utf8.numBytes * 2 - 1000);
+    PLY_TEST_CHECK(convertWithOutPipe(utf16, TextEncoding::get<UTF16_LE>(),
+                                      TextEncoding::get<UTF8>()) == utf8);
+    PLY_TEST_CHECK(TextConverter::convert<UTF8, UTF8>(utf8) == utf8);
+}
+
 } // namespace tests
 } // namespace ply
@@ -0,0 +1,72 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX EventTracer_
+
+// Counts occurrences of str in the trace
+u32 countInTrace(StringView trace, StringView str) {
+    u32 count = 0;
+    for (s32 i = trace.findByte(str[0]); i >= 0; i = trace.findByte(str[0], u32(i) + 1)) {
+        if (trace.subStr(u32(i)).startsWith(str)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+PLY_TEST_CASE("EventTracer writes zones and counters from every thread") {
+    Thread thread{[] {
+        EventTracer::setThreadName("Test \"worker\"");
+        PLY_TRACE_ZONE("TestWorkerZone");
+        PLY_TRACE_COUNTER("TestCounter", 42);
+    }};
+    thread.join();
+    {
+        PLY_TRACE_ZONE("TestOuterZone");
+        PLY_TRACE_ZONE("TestInnerZone");
+    }
+
+    MemOutStream mout;
+    EventTracer::writeChromeTrace(&mout);
+    String trace = mout.moveToString();
+    PLY_TEST_CHECK(trace.startsWith("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    PLY_TEST_CHECK(trace.endsWith("]}\n"));
+    PLY_TEST_CHECK(countInTrace(trace, "\"name\":\"TestWorkerZone\",\"ph\":\"B\"") == 1);
+    PLY_TEST_CHECK(countInTrace(trace, "\"name\":\"TestWorkerZone\",\"ph\":\"E\"") == 1);
+    PLY_TEST_CHECK(countInTrace(trace, "\"name\":\"TestInnerZone\",\"ph\":\"B\"") == 1);
+    PLY_TEST_CHECK(countInTrace(trace, "\"ph\":\"C\"") >= 1);
+    PLY_TEST_CHECK(countInTrace(trace, "\"args\":{\"value\":42}") == 1);
+    PLY_TEST_CHECK(countInTrace(trace, "\"args\":{\"name\":\"Test \\\"worker\\\"\"}") == 1);
+}
+
+PLY_TEST_CASE("EventTracer keeps the most recent events") {
+    Thread thread{[] {
+        for (u32 i = 0; i < PLY_EVENT_TRACER_EVENTS_PER_THREAD; i++) {
+            PLY_TRACE_ZONE("TestOldZone");
+        }
+        PLY_TRACE_ZONE("TestNewZone");
+        // Stays in the trace after the thread exits
+        EventTracer::setThreadName("TestOverflowThread");
+    }};
+    thread.join();
+
+    MemOutStream mout;
+    EventTracer::writeChromeTrace(&mout);
+    String trace = mout.moveToString();
+    PLY_TEST_CHECK(countInTrace(trace, "\"name\":\"TestNewZone\",\"ph\":\"B\"") == 1);
+    PLY_TEST_CHECK(countInTrace(trace, "\"name\":\"TestNewZone\",\"ph\":\"E\"") == 1);
+    u32 numOldBegins = countInTrace(trace, "\"name\":\"TestOldZone\",\"ph\":\"B\"");
+    u32 numOldEnds = countInTrace(trace, "\"name\":\"TestOldZone\",\"ph\":\"E\"");
+    PLY_TEST_CHECK(numOldBegins < PLY_EVENT_TRACER_EVENTS_PER_THREAD / 2);
+    PLY_TEST_CHECK(numOldBegins == numOldEnds);
+}
+
+} // namespace tests
+} // namespace ply
@@ -0,0 +1,133 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/container/FlatHashMap.h>
+#include <ply-runtime/algorithm/Random.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX FlatHashMap_
+
+struct U32Traits {
+    using Key = u32;
+    struct Item {
+        u32 key;
+        u32 value = 0;
+        PLY_INLINE Item(u32 key) : key{key} {
+        }
+    };
+    static PLY_INLINE bool match(const Item& item, u32 key) {
+        return item.key == key;
+    }
+};
+
+struct StringTraits {
+    using Key = StringView;
+    using Item = String;
+    static PLY_INLINE bool match(const Item& item, Key key) {
+        return item == key;
+    }
+};
+
+// Every key has the same home slot, the last one in the table, so probes wrap around and erasing
+// has to shift items back.
+struct CollidingTraits : U32Traits {
+    static PLY_INLINE u32 hash(u32 key) {
+        return ((key & 3) << 25) | 0xffff;
+    }
+};
+
+PLY_TEST_CASE("FlatHashMap insert and find") {
+    FlatHashMap<U32Traits> map;
+    for (u32 i = 0; i < 1000; i++) {
+        auto cursor = map.insertOrFind(i * 7);
+        PLY_TEST_CHECK(!cursor.wasFound());
+        cursor->value = i;
+    }
+    PLY_TEST_CHECK(map.numItems() == 1000);
+    for (u32 i = 0; i < 1000; i++) {
+        auto cursor = map.find(i * 7);
+        PLY_TEST_CHECK(cursor.wasFound() && cursor->value == i);
+        PLY_TEST_CHECK(!map.find(i * 7 + 1).wasFound());
+    }
+    PLY_TEST_CHECK(map.insertOrFind(7).wasFound());
+    PLY_TEST_CHECK(map.numItems() == 1000);
+}
+
+PLY_TEST_CASE("FlatHashMap with string keys") {
+    FlatHashMap<StringTraits> map;
+    for (u32 i = 0; i < 100; i++) {
+        *map.insertOrFind(String::from(i)) = String::from(i);
+    }
+    const FlatHashMap<StringTraits>& constMap = map;
+    PLY_TEST_CHECK(*constMap.find("42") == "42");
+    PLY_TEST_CHECK(!constMap.find("100").wasFound());
+    u32 count = 0;
+    for (const String& str : constMap) {
+        PLY_TEST_CHECK(str.numBytes > 0);
+        count++;
+    }
+    PLY_TEST_CHECK(count == 100);
+}
+
+PLY_TEST_CASE("FlatHashMap erase keeps colliding items reachable") {
+    FlatHashMap<CollidingTraits> map;
+    bool present[64] = {};
+    Random random{123};
+    for (u32 i = 0; i < 10000; i++) {
+        u32 key = random.next32() % 64;
+        if (random.next32() % 2 == 0) {
+            map.insertOrFind(key);
+            present[key] = true;
+        } else {
+            auto cursor = map.find(key);
+            PLY_TEST_CHECK(cursor.wasFound() == present[key]);
+            if (cursor.wasFound()) {
+                cursor.erase();
+                present[key] = false;
+            }
+        }
+    }
+    u32 numPresent = 0;
+    for (u32 key = 0; key < 64; key++) {
+        PLY_TEST_CHECK(map.find(key).wasFound() == present[key]);
+        numPresent += present[key];
+    }
+    PLY_TEST_CHECK(map.numItems() == numPresent);
+}
+
+PLY_TEST_CASE("FlatHashMap insertMulti and Cursor::next") {
+    FlatHashMap<CollidingTraits> map;
+    for (u32 i = 0; i < 20; i++) {
+        map.insertMulti(i % 4)->value = i;
+    }
+    PLY_TEST_CHECK(map.numItems() == 20);
+    u32 valueMask = 0;
+    for (auto cursor = map.find(1); cursor.wasFound(); cursor.next(1)) {
+        PLY_TEST_CHECK(cursor->key == 1 && cursor->value % 4 == 1);
+        valueMask |= 1 << cursor->value;
+    }
+    PLY_TEST_CHECK(valueMask == 0x22222);
+
+    // Erase every item with key 2 while visiting them
+    u32 numErased = 0;
+    for (auto cursor = map.find(2); cursor.wasFound();) {
+        cursor.eraseAndAdvance(2);
+        numErased++;
+    }
+    PLY_TEST_CHECK(numErased == 5);
+    PLY_TEST_CHECK(!map.find(2).wasFound());
+    u32 numKey3 = 0;
+    const FlatHashMap<CollidingTraits>& constMap = map;
+    for (auto cursor = constMap.find(3); cursor.wasFound(); cursor.next(3)) {
+        numKey3++;
+    }
+    PLY_TEST_CHECK(numKey3 == 5);
+    PLY_TEST_CHECK(map.numItems() == 15);
+}
+
+} // namespace tests
+} // namespace ply
@@ -0,0 +1,89 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/algorithm/Random.h>
+#include <ply-test/TestSuite.h>
+#include <math.h> // for HUGE_VAL
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX Format_
+
+PLY_TEST_CASE("Print integers") {
+    PLY_TEST_CHECK(String::from(0u) == "0");
+    PLY_TEST_CHECK(String::from(1234567u) == "1234567");
+    PLY_TEST_CHECK(String::from(u64{Limits<u64>::Max}) == "18446744073709551615");
+    PLY_TEST_CHECK(String::from(s64{Limits<s64>::Min}) == "-9223372036854775808");
+    PLY_TEST_CHECK(String::format("{}", fmt::Hex{255u}) == "ff");
+}
+
+PLY_TEST_CASE("Print numbers to a small ViewOutStream") {
+    char buf[8];
+    ViewOutStream vout{{buf, sizeof(buf)}};
+    vout << 123u << ' ' << 1.5;
+    PLY_TEST_CHECK(!vout.atEOF());
+    PLY_TEST_CHECK(StringView{buf, u32(vout.curByte - buf)} == "123 1.5");
+}
+
+PLY_TEST_CASE("Width and zero-padding") {
+    PLY_TEST_CHECK(String::format("[{:5}]", 42) == "[   42]");
+    PLY_TEST_CHECK(String::format("[{:<5}]", 42) == "[42   ]");
+    PLY_TEST_CHECK(String::format("[{:05}]", -42) == "[-0042]");
+    PLY_TEST_CHECK(String::format("[{:2}]", "abcd") == "[abcd]");
+    PLY_TEST_CHECK(String::format("{{{}}}", 1) == "{1}");
+}
+
+PLY_TEST_CASE("Compiled format strings") {
+    MemOutStream mout;
+    mout.format(PLY_FMT("{}:{:02}.{:<3}|{{}}"), 1, 5, "x");
+    mout.format(PLY_FMT(" {:>6}"), fmt::Hex{255u});
+    mout.format(PLY_FMT(" done"));
+    PLY_TEST_CHECK(mout.moveToString() == "1:05.x  |{}     ff done");
+}
+
+PLY_TEST_CASE("Print shortest floats and doubles") {
+    PLY_TEST_CHECK(String::from(0.0) == "0.0");
+    PLY_TEST_CHECK(String::from(-0.0) == "-0.0");
+    PLY_TEST_CHECK(String::from(1.0) == "1.0");
+    PLY_TEST_CHECK(String::from(0.1) == "0.1");
+    PLY_TEST_CHECK(String::from(0.1f) == "0.1");
+    PLY_TEST_CHECK(String::from(-1.5) == "-1.5");
+    PLY_TEST_CHECK(String::from(123456.0) == "123456.0");
+    PLY_TEST_CHECK(String::from(0.0001) == "0.0001");
+    PLY_TEST_CHECK(String::from(0.00001) == "1e-5");
+    PLY_TEST_CHECK(String::from(1e16) == "1e16");
+    PLY_TEST_CHECK(String::from(1.7976931348623157e308) == "1.7976931348623157e308");
+    PLY_TEST_CHECK(String::from(5e-324) == "5e-324");
+    PLY_TEST_CHECK(String::from(3.4028235e38f) == "3.4028235e38");
+}
+
+PLY_TEST_CASE("Parse doubles") {
+    PLY_TEST_CHECK(StringView{"0.1"}.to<double>() == 0.1);
+    PLY_TEST_CHECK(StringView{"-2.5e-3"}.to<double>() == -2.5e-3);
+    PLY_TEST_CHECK(StringView{"9007199254740993"}.to<double>() == 9007199254740992.0);
+    PLY_TEST_CHECK(StringView{"2.2250738585072011e-308"}.to<double>() == 2.2250738585072011e-308);
+    PLY_TEST_CHECK(StringView{"4.9406564584124654e-324"}.to<double>() == 5e-324);
+    PLY_TEST_CHECK(StringView{"1e400"}.to<double>() == HUGE_VAL);
+    PLY_TEST_CHECK(StringView{"1e-400"}.to<double>() == 0.0);
+}
+
+PLY_TEST_CASE("Printed doubles parse back to the same value") {
+    Random random{1};
+    for (u32 i = 0; i < 10000; i++) {
+        u64 bits = random.next64();
+        double value;
+        memcpy(&value, &bits, 8);
+        if (value != value)
+            continue; // NaN
+        String str = String::from(value);
+        PLY_TEST_CHECK(str.to<double>() == value || str.endsWith("inf"));
+        float f = float(value);
+        PLY_TEST_CHECK(String::from(f).to<float>() == f || String::from(f).endsWith("inf"));
+    }
+}
+
+} // namespace tests
+} // namespace ply
@@ -0,0 +1,37 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/container/XXH3.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX Hash_
+
+// Expected values come from the reference implementation of XXH3
+PLY_TEST_CASE("XXH3 matches reference results") {
+    PLY_TEST_CHECK(XXH3::hash64("") == 0x2d06800538d394c2ull);
+    PLY_TEST_CHECK(XXH3::hash64("abc") == 0x78af5f94892f3950ull);
+    PLY_TEST_CHECK(XXH3::hash64("Plywood C++ Framework") == 0x6fc8b0628dc4cebaull);
+    u128 h = XXH3::hash128("Plywood C++ Framework");
+    PLY_TEST_CHECK(h.hi == 0x839d71ddf40b44a6ull && h.lo == 0xe78eb0c22b8a262cull);
+}
+
+PLY_TEST_CASE("XXH3 gives the same result when input is appended in pieces") {
+    char bytes[1000];
+    for (u32 i = 0; i < 1000; i++) {
+        bytes[i] = (char) i;
+    }
+    XXH3 hasher;
+    for (u32 i = 0; i < 1000; i += 90) {
+        hasher.append({bytes + i, min<u32>(90, 1000 - i)});
+    }
+    PLY_TEST_CHECK(hasher.get64() == 0xd33dd80b46f60e50ull);
+    u128 h = hasher.get128();
+    PLY_TEST_CHECK(h.hi == 0x076f7e02b7120d2aull && h.lo == 0xd33dd80b46f60e50ull);
+}
+
+} // namespace tests
+} // namespace ply
@@ -0,0 +1,68 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/Base.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX Heap_
+
+#if PLY_USE_DLMALLOC
+static Heap_DL testHeap;
+
+PLY_TEST_CASE("Heap_DL returns blocks freed on another thread") {
+    static constexpr u32 NumBlocks = 2000;
+    static void* blocks[NumBlocks];
+    Thread allocThread{[] {
+        for (u32 i = 0; i < NumBlocks; i++) {
+            blocks[i] = PLY_HEAP_DIRECT(testHeap).alloc(8 + (i * 7) % 600);
+            memset(blocks[i], 0xcd, 8);
+        }
+    }};
+    allocThread.join();
+    PLY_TEST_CHECK(PLY_HEAP_DIRECT(testHeap).getStats().inUseBytes > NumBlocks * 8);
+
+    Thread freeThread{[] {
+        for (u32 i = 0; i < NumBlocks; i++) {
+            PLY_HEAP_DIRECT(testHeap).free(blocks[i]);
+        }
+    }};
+    freeThread.join();
+    // Each thread returned its cached blocks when it exited
+    PLY_TEST_CHECK(PLY_HEAP_DIRECT(testHeap).getStats().inUseBytes == 0);
+}
+
+PLY_TEST_CASE("HeapProfiler counts live blocks per call site") {
+    HeapProfiler::start(1);
+    void* blocks[10];
+    static constexpr u32 AllocLine = __LINE__ + 2;
+    for (u32 i = 0; i < 10; i++) {
+        blocks[i] = PLY_HEAP.alloc(100);
+    }
+    for (u32 i = 0; i < 4; i++) {
+        PLY_HEAP.free(blocks[i]);
+    }
+    MemOutStream mout;
+    HeapProfiler::writeReport(&mout);
+    for (u32 i = 4; i < 10; i++) {
+        PLY_HEAP.free(blocks[i]);
+    }
+    HeapProfiler::stop();
+
+    String site = String::format("{}({})", __FILE__, AllocLine);
+    String expected = String::format("{:12}{:12}{:12}{:12}  {}", 600, 6, 1000, 10, site);
+    String report = mout.moveToString();
+    bool found = false;
+    for (StringView line : report.splitByte('\n')) {
+        found = found || (line == expected);
+    }
+    PLY_TEST_CHECK(found);
+}
+#endif // PLY_USE_DLMALLOC
+
+} // namespace tests
+} // namespace ply
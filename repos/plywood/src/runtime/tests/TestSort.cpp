@@ -0,0 +1,88 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/algorithm/ParallelSort.h>
+#include <ply-runtime/algorithm/Random.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX Sort_
+
+// Sorted, reversed, random and many-duplicates inputs
+Array<s32> makeSortInput(u32 kind, u32 numItems) {
+    Array<s32> arr;
+    arr.resize(numItems);
+    Random random{numItems};
+    for (u32 i = 0; i < numItems; i++) {
+        switch (kind) {
+            case 0: arr[i] = s32(i); break;
+            case 1: arr[i] = s32(numItems - i); break;
+            case 2: arr[i] = s32(random.next32()); break;
+            default: arr[i] = s32(random.next32() % 4) - 2; break;
+        }
+    }
+    return arr;
+}
+
+bool isSorted(ArrayView<const s32> view) {
+    for (u32 i = 1; i < view.numItems; i++) {
+        if (view[i] < view[i - 1])
+            return false;
+    }
+    return true;
+}
+
+PLY_TEST_CASE("sort(), radixSort() and parallelSort() sort various inputs") {
+    ThreadPool pool{4};
+    for (u32 kind = 0; kind < 4; kind++) {
+        for (u32 numItems : {0u, 1u, 5u, 100u, 1000u, 100000u}) {
+            Array<s32> a = makeSortInput(kind, numItems);
+            Array<s32> b = a;
+            Array<s32> c = a;
+            sort(a);
+            radixSort(b);
+            parallelSort(&pool, c.view());
+            PLY_TEST_CHECK(isSorted(a));
+            PLY_TEST_CHECK(a == b);
+            PLY_TEST_CHECK(a == c);
+        }
+    }
+}
+
+PLY_TEST_CASE("sort() handles an adversarial input") {
+    // Alternating halves defeat a median-of-3 pivot and used to make the old quicksort quadratic
+    Array<s32> arr;
+    for (u32 i = 0; i < 50000; i++) {
+        arr.append(s32(i % 2 == 0 ? i : 50000 + i));
+    }
+    sort(arr, [](s32 a, s32 b) { return a > b; });
+    for (u32 i = 1; i < arr.numItems(); i++) {
+        PLY_TEST_CHECK(arr[i - 1] >= arr[i]);
+    }
+}
+
+PLY_TEST_CASE("stableSort() and radixSort() preserve the order of equal keys") {
+    struct Item {
+        u32 key;
+        u32 order;
+    };
+    Array<Item> a;
+    Random random{1};
+    for (u32 i = 0; i < 1000; i++) {
+        a.append({random.next32() % 16, i});
+    }
+    Array<Item> b = a;
+    stableSort(a, [](const Item& x, const Item& y) { return x.key < y.key; });
+    radixSort(b, [](const Item& x) { return x.key; });
+    for (u32 i = 1; i < a.numItems(); i++) {
+        PLY_TEST_CHECK(a[i - 1].key < a[i].key ||
+                       (a[i - 1].key == a[i].key && a[i - 1].order < a[i].order));
+        PLY_TEST_CHECK(a[i].key == b[i].key && a[i].order == b[i].order);
+    }
+}
+
+} // namespace tests
+} // namespace ply
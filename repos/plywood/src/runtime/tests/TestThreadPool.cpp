@@ -0,0 +1,61 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-runtime/thread/ThreadPool.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX ThreadPool_
+
+PLY_TEST_CASE("ThreadPool runs every submitted task") {
+    ThreadPool pool{4};
+    Atomic<u32> counter = 0;
+    for (u32 i = 0; i < 1000; i++) {
+        pool.submit([&] { counter.fetchAdd(1, Relaxed); });
+    }
+    pool.waitUntilIdle();
+    PLY_TEST_CHECK(counter.load(Relaxed) == 1000);
+}
+
+PLY_TEST_CASE("ThreadPool runs tasks submitted from tasks") {
+    ThreadPool pool{4};
+    Atomic<u32> counter = 0;
+    for (u32 i = 0; i < 100; i++) {
+        pool.submit([&] {
+            PLY_TEST_CHECK(pool.getCurrentWorkerIndex() >= 0);
+            for (u32 j = 0; j < 10; j++) {
+                pool.submit([&] { counter.fetchAdd(1, Relaxed); });
+            }
+        });
+    }
+    pool.waitUntilIdle();
+    PLY_TEST_CHECK(counter.load(Relaxed) == 1000);
+    PLY_TEST_CHECK(pool.getCurrentWorkerIndex() == -1);
+}
+
+PLY_TEST_CASE("ThreadPool trySubmit fails when the queue is full") {
+    ThreadPool pool{1, 2};
+    Mutex mutex;
+    mutex.lock();
+    // Block the only worker, then fill the queue
+    Atomic<u32> numStarted = 0;
+    PLY_TEST_CHECK(pool.trySubmit([&] {
+        numStarted.fetchAdd(1, Relaxed);
+        LockGuard<Mutex> guard{mutex};
+    }));
+    while (numStarted.load(Relaxed) == 0) {
+    }
+    PLY_TEST_CHECK(pool.trySubmit([] {}));
+    PLY_TEST_CHECK(pool.trySubmit([] {}));
+    PLY_TEST_CHECK(!pool.trySubmit([] {}));
+    mutex.unlock();
+    pool.waitUntilIdle();
+    PLY_TEST_CHECK(pool.trySubmit([] {}));
+    pool.waitUntilIdle();
+}
+
+} // namespace tests
+} // namespace ply
@@ -16,6 +16,11 @@ void module_PlywoodTests(ModuleArgs* args) {
     args->buildTarget->targetType = BuildTargetType::EXE;
     args->addSourceFiles("PlywoodTests");
     args->addTarget(Visibility::Private, "test");
+    args->addTarget(Visibility::Private, "cook-tests");
     args->addTarget(Visibility::Private, "math-tests");
+    args->addTarget(Visibility::Private, "pylon-tests");
+    args->addTarget(Visibility::Private, "reflect-tests");
     args->addTarget(Visibility::Private, "runtime-tests");
+    args->addTarget(Visibility::Private, "web-common-tests");
+    args->addTarget(Visibility::Private, "web-serve-docs-tests");
 }
@@ -0,0 +1,87 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <web-common/FetchFromFileSystem.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX FetchFromFileSystem_
+
+using web::matchesETag;
+using web::RangeResult;
+
+PLY_TEST_CASE("matchesETag") {
+    StringView eTag = "\"3e8-5f1a\"";
+    PLY_TEST_CHECK(matchesETag("\"3e8-5f1a\"", eTag));
+    PLY_TEST_CHECK(matchesETag("*", eTag));
+    PLY_TEST_CHECK(matchesETag(" * ", eTag));
+    PLY_TEST_CHECK(matchesETag("\"abc\", \"3e8-5f1a\"", eTag));
+    PLY_TEST_CHECK(matchesETag("\"abc\",\"3e8-5f1a\" , \"def\"", eTag));
+    // Weak tags match using the weak comparison function
+    PLY_TEST_CHECK(matchesETag("W/\"3e8-5f1a\"", eTag));
+    PLY_TEST_CHECK(matchesETag("\"abc\", W/\"3e8-5f1a\"", eTag));
+    PLY_TEST_CHECK(!matchesETag("\"3e8-5f1\"", eTag));
+    PLY_TEST_CHECK(!matchesETag("3e8-5f1a", eTag));
+    PLY_TEST_CHECK(!matchesETag("\"abc\", \"def\"", eTag));
+    PLY_TEST_CHECK(!matchesETag("W/", eTag));
+    PLY_TEST_CHECK(!matchesETag("*, \"abc\"", eTag));
+}
+
+RangeResult getRangeResult(StringView range, u64 fileSize) {
+    u64 offset = 0;
+    u64 numBytes = 0;
+    return web::parseByteRange(range, fileSize, &offset, &numBytes);
+}
+
+// Returns true if range is satisfiable and selects the expected bytes
+bool isRange(StringView range, u64 fileSize, u64 expectedOffset, u64 expectedNumBytes) {
+    u64 offset = 0;
+    u64 numBytes = 0;
+    return web::parseByteRange(range, fileSize, &offset, &numBytes) == RangeResult::Satisfiable &&
+           offset == expectedOffset && numBytes == expectedNumBytes;
+}
+
+PLY_TEST_CASE("parseByteRange with a first and last position") {
+    PLY_TEST_CHECK(isRange("bytes=0-499", 1000, 0, 500));
+    PLY_TEST_CHECK(isRange(" bytes=10-10 ", 1000, 10, 1));
+    // The last position is clamped to the end of the file
+    PLY_TEST_CHECK(isRange("bytes=900-5000", 1000, 900, 100));
+    PLY_TEST_CHECK(getRangeResult("bytes=1000-1200", 1000) == RangeResult::Unsatisfiable);
+}
+
+PLY_TEST_CASE("parseByteRange with an open-ended range") {
+    PLY_TEST_CHECK(isRange("bytes=500-", 1000, 500, 500));
+    PLY_TEST_CHECK(isRange("bytes=999-", 1000, 999, 1));
+    PLY_TEST_CHECK(getRangeResult("bytes=1000-", 1000) == RangeResult::Unsatisfiable);
+    PLY_TEST_CHECK(getRangeResult("bytes=0-", 0) == RangeResult::Unsatisfiable);
+}
+
+PLY_TEST_CASE("parseByteRange with a suffix range") {
+    PLY_TEST_CHECK(isRange("bytes=-200", 1000, 800, 200));
+    // A suffix longer than the file selects the whole file
+    PLY_TEST_CHECK(isRange("bytes=-2000", 1000, 0, 1000));
+    PLY_TEST_CHECK(getRangeResult("bytes=-0", 1000) == RangeResult::Unsatisfiable);
+    PLY_TEST_CHECK(getRangeResult("bytes=-5", 0) == RangeResult::Unsatisfiable);
+}
+
+PLY_TEST_CASE("parseByteRange ignores ranges it doesn't serve") {
+    // The last position is before the first
+    PLY_TEST_CHECK(getRangeResult("bytes=500-100", 1000) == RangeResult::Ignored);
+    // Multiple ranges
+    PLY_TEST_CHECK(getRangeResult("bytes=0-1,5-9", 1000) == RangeResult::Ignored);
+    PLY_TEST_CHECK(getRangeResult("bytes=0-1, -5", 1000) == RangeResult::Ignored);
+    // Other units and malformed ranges
+    PLY_TEST_CHECK(getRangeResult("items=0-1", 1000) == RangeResult::Ignored);
+    PLY_TEST_CHECK(getRangeResult("bytes=", 1000) == RangeResult::Ignored);
+    PLY_TEST_CHECK(getRangeResult("bytes=-", 1000) == RangeResult::Ignored);
+    PLY_TEST_CHECK(getRangeResult("bytes=12", 1000) == RangeResult::Ignored);
+    PLY_TEST_CHECK(getRangeResult("bytes=a-9", 1000) == RangeResult::Ignored);
+    PLY_TEST_CHECK(getRangeResult("bytes=1-9x", 1000) == RangeResult::Ignored);
+    PLY_TEST_CHECK(getRangeResult("bytes=*", 1000) == RangeResult::Ignored);
+}
+
+} // namespace tests
+} // namespace ply
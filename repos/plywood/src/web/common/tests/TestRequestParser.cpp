@@ -0,0 +1,139 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <web-common/RequestParser.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX RequestParser_
+
+using web::Request;
+using web::RequestParser;
+
+StringView simpleRequest = "GET /index.html HTTP/1.1\r\n"
+                           "Host: example.com\r\n"
+                           "Accept-Encoding:  gzip \r\n"
+                           "\r\n";
+
+PLY_TEST_CASE("RequestParser parses a complete request") {
+    RequestParser parser;
+    Request request;
+    PLY_TEST_CHECK(parser.parse(&request, simpleRequest) == RequestParser::Complete);
+    PLY_TEST_CHECK(parser.getHeaderSize() == simpleRequest.numBytes);
+    PLY_TEST_CHECK(request.startLine.method == "GET");
+    PLY_TEST_CHECK(request.startLine.uri == "/index.html");
+    PLY_TEST_CHECK(request.startLine.httpVersion == "HTTP/1.1");
+    PLY_TEST_CHECK(request.headerFields.numItems() == 2);
+    PLY_TEST_CHECK(request.findHeaderField("host") == "example.com");
+    PLY_TEST_CHECK(request.findHeaderField("Accept-Encoding") == "gzip");
+    PLY_TEST_CHECK(request.findHeaderField("Cookie").isEmpty());
+}
+
+PLY_TEST_CASE("RequestParser handles a request split across reads") {
+    // Try every split point, including ones inside "\r\n"
+    for (u32 split = 0; split < simpleRequest.numBytes; split++) {
+        RequestParser parser;
+        Request request;
+        PLY_TEST_CHECK(parser.parse(&request, simpleRequest.left(split)) ==
+                       RequestParser::Incomplete);
+        // The buffer may be reallocated between calls
+        String copy = simpleRequest;
+        PLY_TEST_CHECK(parser.parse(&request, copy) == RequestParser::Complete);
+        PLY_TEST_CHECK(request.startLine.uri == "/index.html");
+        PLY_TEST_CHECK(request.findHeaderField("Host") == "example.com");
+    }
+
+    // One byte at a time
+    RequestParser parser;
+    Request request;
+    for (u32 i = 1; i < simpleRequest.numBytes; i++) {
+        PLY_TEST_CHECK(parser.parse(&request, simpleRequest.left(i)) == RequestParser::Incomplete);
+    }
+    PLY_TEST_CHECK(parser.parse(&request, simpleRequest) == RequestParser::Complete);
+}
+
+PLY_TEST_CASE("RequestParser parses pipelined requests") {
+    String buf =
+        String{"\r\n"} + simpleRequest + "HEAD /b HTTP/1.0\nHost: b\n\nGET /c HTTP/1.1\r\n";
+    RequestParser parser;
+    Request request;
+    PLY_TEST_CHECK(parser.parse(&request, buf) == RequestParser::Complete);
+    PLY_TEST_CHECK(request.startLine.uri == "/index.html");
+    StringView rest = buf.subStr(parser.getHeaderSize());
+
+    // Bare "\n" line endings are accepted
+    parser.reset();
+    PLY_TEST_CHECK(parser.parse(&request, rest) == RequestParser::Complete);
+    PLY_TEST_CHECK(request.startLine.method == "HEAD");
+    PLY_TEST_CHECK(request.startLine.uri == "/b");
+    PLY_TEST_CHECK(request.startLine.httpVersion == "HTTP/1.0");
+    PLY_TEST_CHECK(request.headerFields.numItems() == 1);
+    PLY_TEST_CHECK(request.findHeaderField("Host") == "b");
+    rest = rest.subStr(parser.getHeaderSize());
+
+    // The last request is incomplete
+    parser.reset();
+    PLY_TEST_CHECK(parser.parse(&request, rest) == RequestParser::Incomplete);
+}
+
+PLY_TEST_CASE("RequestParser enforces the header size limit") {
+    RequestParser parser;
+    parser.maxHeaderBytes = 64;
+    Request request;
+    String buf = String{"GET / HTTP/1.1\r\nX-Padding: "} + String{"a"} * 100;
+    PLY_TEST_CHECK(parser.parse(&request, buf) == RequestParser::TooLarge);
+    PLY_TEST_CHECK(web::getErrorResponseCode(RequestParser::TooLarge) ==
+                   web::ResponseCode::RequestHeaderFieldsTooLarge);
+
+    // A header that fits is still accepted
+    parser.reset();
+    PLY_TEST_CHECK(parser.parse(&request, "GET / HTTP/1.1\r\nHost: a\r\n\r\n") ==
+                   RequestParser::Complete);
+
+    // Too many fields
+    RequestParser fieldParser;
+    fieldParser.maxHeaderFields = 2;
+    PLY_TEST_CHECK(fieldParser.parse(&request, "GET / HTTP/1.1\r\nA: 1\r\nB: 2\r\nC: 3\r\n\r\n") ==
+                   RequestParser::TooLarge);
+}
+
+PLY_TEST_CASE("RequestParser rejects malformed request lines") {
+    for (StringView buf : {
+             "GET\r\n\r\n",
+             "GET /\r\n\r\n",
+             " / HTTP/1.1\r\n\r\n",
+             "GET  / HTTP/1.1\r\n\r\n",
+             "GET / \r\n\r\n",
+             "GET / HTTP/1.1 extra\r\n\r\n",
+         }) {
+        RequestParser parser;
+        Request request;
+        PLY_TEST_CHECK(parser.parse(&request, buf) == RequestParser::BadRequest);
+    }
+
+    // A header field without a colon
+    RequestParser parser;
+    Request request;
+    PLY_TEST_CHECK(parser.parse(&request, "GET / HTTP/1.1\r\nHost example.com\r\n\r\n") ==
+                   RequestParser::BadRequest);
+    PLY_TEST_CHECK(web::getErrorResponseCode(RequestParser::BadRequest) ==
+                   web::ResponseCode::BadRequest);
+}
+
+PLY_TEST_CASE("findLineFeed finds the first line feed") {
+    char buf[100];
+    memset(buf, 'a', sizeof(buf));
+    PLY_TEST_CHECK(web::findLineFeed(buf, buf + sizeof(buf)) == nullptr);
+    for (u32 i = 0; i < sizeof(buf); i++) {
+        buf[i] = '\n';
+        PLY_TEST_CHECK(web::findLineFeed(buf, buf + sizeof(buf)) == buf + i);
+        PLY_TEST_CHECK(web::findLineFeed(buf, buf + i) == nullptr);
+        buf[i] = 'a';
+    }
+}
+
+} // namespace tests
+} // namespace ply
@@ -4,10 +4,98 @@
 ------------------------------------*/
 #include <web-common/Core.h>
 #include <web-common/FetchFromFileSystem.h>
+#include <time.h>
+#if PLY_TARGET_WIN32
+#include <ply-runtime/filesystem/impl/FileSystem_Win32.h>
+#include <ply-runtime/io/impl/Pipe_Win32.h>
+#else
+#include <ply-runtime/filesystem/impl/FileSystem_POSIX.h>
+#include <ply-runtime/io/impl/Pipe_FD.h>
+#endif
 
 namespace ply {
 namespace web {
 
+// Formats a POSIX time as an HTTP-date, such as "Sun, 06 Nov 1994 08:49:37 GMT".
+PLY_NO_INLINE String formatHTTPDate(double posixTime) {
+    time_t t = (time_t) posixTime;
+    struct tm utc;
+#if PLY_TARGET_WIN32
+    gmtime_s(&utc, &t);
+#else
+    gmtime_r(&t, &utc);
+#endif
+    char buf[64];
+    size_t len = strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+    return StringView{buf, (u32) len};
+}
+
+PLY_NO_INLINE bool matchesETag(StringView ifNoneMatch, StringView eTag) {
+    if (ifNoneMatch.trim(isWhite) == "*")
+        return true;
+    for (StringView tag : ifNoneMatch.splitByte(',')) {
+        tag = tag.trim(isWhite);
+        if (tag.startsWith("W/")) {
+            tag.offsetHead(2);
+        }
+        if (tag == eTag)
+            return true;
+    }
+    return false;
+}
+
+PLY_NO_INLINE RangeResult parseByteRange(StringView range, u64 fileSize, u64* offset,
+                                         u64* numBytes) {
+    range = range.trim(isWhite);
+    if (!range.startsWith("bytes="))
+        return RangeResult::Ignored;
+    range.offsetHead(6);
+    if (range.findByte(',') >= 0)
+        return RangeResult::Ignored;
+    s32 dashPos = range.findByte('-');
+    if (dashPos < 0)
+        return RangeResult::Ignored;
+    StringView first = range.left(dashPos).trim(isWhite);
+    StringView last = range.subStr(dashPos + 1).trim(isWhite);
+    auto isNumber = [](StringView str) {
+        return str && str.findByte([](char c) { return !isDecimalDigit(c); }) < 0;
+    };
+    if ((first && !isNumber(first)) || (last && !isNumber(last)) || (!first && !last))
+        return RangeResult::Ignored;
+
+    if (!first) {
+        // Suffix range: the last N bytes
+        u64 suffixLength = last.to<u64>();
+        if (suffixLength == 0 || fileSize == 0)
+            return RangeResult::Unsatisfiable;
+        *numBytes = min(suffixLength, fileSize);
+        *offset = fileSize - *numBytes;
+        return RangeResult::Satisfiable;
+    }
+    u64 start = first.to<u64>();
+    if (start >= fileSize)
+        return RangeResult::Unsatisfiable;
+    u64 end = last ? min(last.to<u64>(), fileSize - 1) : fileSize - 1;
+    if (end < start)
+        return RangeResult::Ignored;
+    *offset = start;
+    *numBytes = end - start + 1;
+    return RangeResult::Satisfiable;
+}
+
+// Gets the status of the file that inPipe reads from. The open file is queried instead of its path,
+// since the file at that path could be replaced after it was opened.
+static FileStatus getFileStatus(InPipe* inPipe) {
+    FileStatus status;
+#if PLY_TARGET_WIN32
+    status.result = FSResult::OK;
+    FileSystem_Win32::getFileStatus(inPipe->cast<InPipe_Win32>()->handle, status);
+#else
+    FileSystem_POSIX::getFileStatus(inPipe->cast<InPipe_FD>()->fd, status);
+#endif
+    return status;
+}
+
 PLY_NO_INLINE FetchFromFileSystem::FetchFromFileSystem() {
     struct Pair {
         const char* key;
@@ -52,20 +140,72 @@ PLY_NO_INLINE void FetchFromFileSystem::serve(const FetchFromFileSystem* params,
     String nativePath =
         NativePath::join(params->rootDir, requestPath.ltrim([](char c) { return c == '/'; }));
 
-    // FIXME: Don't load the whole file completely in memory first.
-    // Could open the raw pipe and feed it to outs.
-    String bin = FileSystem::native()->loadBinary(nativePath);
-    if (FileSystem::native()->lastResult() != FSResult::OK) {
-        // file could not be loaded
+    Owned<InPipe> inPipe = FileSystem::native()->openPipeForRead(nativePath);
+    if (!inPipe) {
+        // file could not be opened
+        responseIface->respondGeneric(ResponseCode::NotFound);
+        return;
+    }
+    FileStatus status = getFileStatus(inPipe);
+    if (status.result != FSResult::OK) {
         responseIface->respondGeneric(ResponseCode::NotFound);
         return;
     }
 
-    OutStream* outs = responseIface->beginResponseHeader(ResponseCode::OK);
-    outs->format("Content-Type: {}\r\n", cursor->mimeType);
-    *outs << "Cache-Control: max-age=1200\r\n\r\n";
+    // The ETag is derived from the file's size and modification time
+    String eTag = String::format("\"{}-{}\"", fmt::Hex{status.fileSize},
+                                 fmt::Hex{u64(status.modificationTime * 1000000)});
+    String lastModified = formatHTTPDate(status.modificationTime);
+    auto writeCacheHeaders = [&](OutStream* outs) {
+        outs->format(PLY_FMT("ETag: {}\r\n"), eTag);
+        outs->format(PLY_FMT("Last-Modified: {}\r\n"), lastModified);
+        *outs << "Cache-Control: max-age=1200\r\n";
+    };
+
+    // Conditional requests. If-Modified-Since is only compared for an exact match against
+    // Last-Modified, like nginx does by default; browsers send back the value they received.
+    const Request& request = responseIface->request;
+    StringView ifNoneMatch = request.findHeaderField("If-None-Match");
+    bool notModified = ifNoneMatch ? matchesETag(ifNoneMatch, eTag)
+                                   : request.findHeaderField("If-Modified-Since") == lastModified;
+    if (notModified) {
+        OutStream* outs = responseIface->beginResponseHeader(ResponseCode::NotModified, 0);
+        writeCacheHeaders(outs);
+        *outs << "\r\n";
+        responseIface->endResponseHeader();
+        return;
+    }
+
+    // Byte ranges. A Range header is ignored if If-Range names a different version of the file.
+    u64 offset = 0;
+    u64 numBytes = status.fileSize;
+    bool isPartial = false;
+    StringView range = request.findHeaderField("Range");
+    StringView ifRange = request.findHeaderField("If-Range");
+    if (range && (!ifRange || ifRange == eTag || ifRange == lastModified)) {
+        RangeResult rr = parseByteRange(range, status.fileSize, &offset, &numBytes);
+        if (rr == RangeResult::Unsatisfiable) {
+            OutStream* outs =
+                responseIface->beginResponseHeader(ResponseCode::RangeNotSatisfiable, 0);
+            outs->format(PLY_FMT("Content-Range: bytes */{}\r\n\r\n"), status.fileSize);
+            responseIface->endResponseHeader();
+            return;
+        }
+        isPartial = (rr == RangeResult::Satisfiable);
+    }
+
+    OutStream* outs = responseIface->beginResponseHeader(
+        isPartial ? ResponseCode::PartialContent : ResponseCode::OK, numBytes);
+    outs->format(PLY_FMT("Content-Type: {}\r\n"), cursor->mimeType);
+    writeCacheHeaders(outs);
+    *outs << "Accept-Ranges: bytes\r\n";
+    if (isPartial) {
+        outs->format(PLY_FMT("Content-Range: bytes {}-{}/{}\r\n"), offset, offset + numBytes - 1,
+                     status.fileSize);
+    }
+    *outs << "\r\n";
     responseIface->endResponseHeader();
-    outs->write(bin);
+    responseIface->sendFile(std::move(inPipe), offset, numBytes);
 }
 
 } // namespace web
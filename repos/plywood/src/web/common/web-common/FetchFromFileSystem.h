@@ -9,6 +9,21 @@
 namespace ply {
 namespace web {
 
+// Returns true if an If-None-Match header value matches eTag. The value is either "*" or a
+// comma-separated list of entity tags, each of which may have a weak W/ prefix.
+PLY_DLL_ENTRY bool matchesETag(StringView ifNoneMatch, StringView eTag);
+
+enum class RangeResult {
+    Ignored, // Serve the whole file
+    Satisfiable,
+    Unsatisfiable,
+};
+
+// Parses a Range header value such as "bytes=0-499", "bytes=500-" or "bytes=-500". Only a single
+// range is supported; requests for multiple ranges get the whole file, which RFC 7233 allows.
+PLY_DLL_ENTRY RangeResult parseByteRange(StringView range, u64 fileSize, u64* offset,
+                                         u64* numBytes);
+
 struct FetchFromFileSystem {
     struct ContentTypeTraits {
         using Key = StringView;
@@ -19,7 +19,7 @@ PLY_NO_INLINE bool OutPipe_HTTPChunked_write(OutPipe* outPipe_, StringView srcBu
     OutPipe_HTTPChunked* outPipe = static_cast<OutPipe_HTTPChunked*>(outPipe_);
     if (outPipe->chunkMode) {
         PLY_ASSERT(srcBuf.numBytes > 0);
-        outPipe->outs->format("{}\r\n", fmt::Hex{srcBuf.numBytes, true});
+        outPipe->outs->format(PLY_FMT("{}\r\n"), fmt::Hex{srcBuf.numBytes, true});
     }
     outPipe->outs->write(srcBuf);
     if (outPipe->chunkMode) {
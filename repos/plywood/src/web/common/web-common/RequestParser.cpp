@@ -0,0 +1,135 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <web-common/Core.h>
+#include <web-common/RequestParser.h>
+#if PLY_CPU_X86 || PLY_CPU_X64
+#include <emmintrin.h>
+#if PLY_COMPILER_MSVC
+#include <intrin.h>
+#endif
+#endif
+
+namespace ply {
+namespace web {
+
+PLY_NO_INLINE const char* findLineFeed(const char* start, const char* end) {
+    const char* cur = start;
+#if PLY_CPU_X86 || PLY_CPU_X64
+    const __m128i lineFeeds = _mm_set1_epi8('\n');
+    while (end - cur >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*) cur);
+        u32 mask = (u32) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, lineFeeds));
+        if (mask != 0) {
+#if PLY_COMPILER_MSVC
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return cur + index;
+#else
+            return cur + __builtin_ctz(mask);
+#endif
+        }
+        cur += 16;
+    }
+#endif
+    for (; cur < end; cur++) {
+        if (*cur == '\n')
+            return cur;
+    }
+    return nullptr;
+}
+
+// Parses "method SP request-target SP HTTP-version". The offsets are relative to buf.
+bool RequestParser::parseStartLine(StringView buf, StringView line) {
+    s32 sp1 = line.findByte(' ');
+    if (sp1 <= 0)
+        return false;
+    s32 sp2 = line.findByte(' ', sp1 + 1);
+    if (sp2 <= sp1 + 1 || (u32) sp2 + 1 >= line.numBytes)
+        return false;
+    if (line.findByte(' ', sp2 + 1) >= 0)
+        return false;
+    u32 lineOfs = u32(line.bytes - buf.bytes);
+    this->method = {lineOfs, (u32) sp1};
+    this->uri = {lineOfs + sp1 + 1, u32(sp2 - sp1 - 1)};
+    this->httpVersion = {lineOfs + sp2 + 1, line.numBytes - sp2 - 1};
+    return true;
+}
+
+bool RequestParser::parseHeaderField(StringView buf, StringView line) {
+    s32 colonPos = line.findByte(':');
+    if (colonPos < 0)
+        return false;
+    StringView name = line.left(colonPos).rtrim(isWhite);
+    StringView value = line.subStr(colonPos + 1).trim(isWhite);
+    this->fields.append({{u32(name.bytes - buf.bytes), name.numBytes},
+                         {u32(value.bytes - buf.bytes), value.numBytes}});
+    return true;
+}
+
+PLY_NO_INLINE RequestParser::Result RequestParser::parse(Request* request, StringView buf) {
+    PLY_ASSERT(this->headerSize == 0); // Must call reset() after Complete
+    auto toView = [&](const Span& span) { return buf.subStr(span.start, span.numBytes); };
+
+    while (this->scanPos < buf.numBytes) {
+        const char* lineFeed = findLineFeed(buf.bytes + this->scanPos, buf.end());
+        if (!lineFeed) {
+            this->scanPos = buf.numBytes;
+            break;
+        }
+        u32 lineEnd = u32(lineFeed - buf.bytes);
+        this->scanPos = lineEnd + 1;
+        if (this->scanPos > this->maxHeaderBytes)
+            return TooLarge;
+
+        StringView line = buf.subStr(this->lineStart, lineEnd - this->lineStart);
+        if (line.numBytes > 0 && line.back() == '\r') {
+            line = line.shortenedBy(1);
+        }
+        this->lineStart = this->scanPos;
+
+        if (!this->parsedStartLine) {
+            // Ignore blank lines before the start line:
+            // https://tools.ietf.org/html/rfc7230#section-3.5
+            if (line.isEmpty())
+                continue;
+            if (!this->parseStartLine(buf, line))
+                return BadRequest;
+            this->parsedStartLine = true;
+        } else if (line.isEmpty()) {
+            // Blank line ends the header
+            this->headerSize = this->scanPos;
+            request->startLine = {toView(this->method), toView(this->uri),
+                                  toView(this->httpVersion)};
+            request->headerFields.resize(0);
+            request->headerFields.reserve(this->fields.numItems());
+            for (const FieldSpans& field : this->fields) {
+                request->headerFields.append({toView(field.name), toView(field.value)});
+            }
+            return Complete;
+        } else if (isWhite(line[0])) {
+            // FIXME: Support unfolding https://tools.ietf.org/html/rfc822#section-3.1
+        } else {
+            if (this->fields.numItems() >= this->maxHeaderFields)
+                return TooLarge;
+            if (!this->parseHeaderField(buf, line))
+                return BadRequest;
+        }
+    }
+
+    if (buf.numBytes >= this->maxHeaderBytes)
+        return TooLarge;
+    return Incomplete;
+}
+
+PLY_NO_INLINE void RequestParser::reset() {
+    this->parsedStartLine = false;
+    this->scanPos = 0;
+    this->lineStart = 0;
+    this->headerSize = 0;
+    this->fields.resize(0);
+}
+
+} // namespace web
+} // namespace ply
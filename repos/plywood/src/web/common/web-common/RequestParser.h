@@ -0,0 +1,80 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <web-common/Core.h>
+#include <web-common/Response.h>
+
+namespace ply {
+namespace web {
+
+//-----------------------------------------------------------------------
+// RequestParser
+//
+// Incrementally parses an HTTP/1.x request header directly from a receive buffer, without copying
+// it. Call parse() every time more bytes arrive. The buffer passed to parse() must begin at the
+// first byte of the request and must contain the bytes seen by previous calls, but it may be
+// reallocated between calls, since the parser only remembers offsets. Bytes that were already
+// scanned are never scanned again.
+//
+// When parse() returns Complete, the Request holds views into the buffer that remain valid until
+// the buffer is modified, and getHeaderSize() returns the number of bytes used by the header. Any
+// bytes after that belong to the next pipelined request. Call reset() before parsing it.
+//-----------------------------------------------------------------------
+class RequestParser {
+public:
+    enum Result {
+        Incomplete, // Need more bytes
+        Complete,
+        BadRequest, // Ill-formed request
+        TooLarge,   // Header exceeds maxHeaderBytes or has more than maxHeaderFields fields
+    };
+
+    u32 maxHeaderBytes = 16384;
+    u32 maxHeaderFields = 100;
+
+private:
+    struct Span {
+        u32 start = 0;
+        u32 numBytes = 0;
+    };
+    struct FieldSpans {
+        Span name;
+        Span value;
+    };
+
+    bool parsedStartLine = false;
+    u32 scanPos = 0;   // Offset of the next byte to scan
+    u32 lineStart = 0; // Offset of the first byte of the current line
+    u32 headerSize = 0;
+    Span method;
+    Span uri;
+    Span httpVersion;
+    Array<FieldSpans> fields; // Capacity is reused across requests
+
+    bool parseStartLine(StringView buf, StringView line);
+    bool parseHeaderField(StringView buf, StringView line);
+
+public:
+    PLY_DLL_ENTRY Result parse(Request* request, StringView buf);
+    PLY_DLL_ENTRY void reset();
+
+    PLY_INLINE u32 getHeaderSize() const {
+        return this->headerSize;
+    }
+};
+
+// Returns a pointer to the first '\n' in the range [start, end), or nullptr if there isn't one.
+// Scans 16 bytes at a time using SSE2 when available.
+PLY_DLL_ENTRY const char* findLineFeed(const char* start, const char* end);
+
+// Returns the response code to send for a request the parser rejected.
+PLY_INLINE ResponseCode getErrorResponseCode(RequestParser::Result result) {
+    PLY_ASSERT(result == RequestParser::BadRequest || result == RequestParser::TooLarge);
+    return (result == RequestParser::TooLarge) ? ResponseCode::RequestHeaderFieldsTooLarge
+                                               : ResponseCode::BadRequest;
+}
+
+} // namespace web
+} // namespace ply
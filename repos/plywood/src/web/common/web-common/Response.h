@@ -11,9 +11,14 @@ namespace web {
 enum class ResponseCode {
     Unknown = 0,
     OK,
+    PartialContent,
+    NotModified,
     BadRequest,
     NotFound,
+    RangeNotSatisfiable,
+    RequestHeaderFieldsTooLarge,
     InternalError,
+    ServiceUnavailable,
 };
 
 struct Request {
@@ -32,6 +37,10 @@ struct Request {
     u16 clientPort = 0;
     StartLine startLine;
     Array<HeaderField> headerFields;
+
+    // Returns the value of the first header field with the given name, ignoring case, or an empty
+    // view if there isn't one.
+    PLY_DLL_ENTRY StringView findHeaderField(StringView name) const;
 };
 
 // This interface exists so that the same response code can be used both from FastCGI or from a
@@ -43,6 +52,16 @@ struct ResponseIface {
     // followed by a blank \r\n line, followed by the content.
     virtual OutStream* beginResponseHeader(ResponseCode responseCode) = 0;
     virtual void endResponseHeader() = 0;
+
+    // Begins a response whose body is exactly contentLength bytes long. A Content-Length header is
+    // written for you, and the body isn't chunked, so it can be sent using sendFile().
+    virtual OutStream* beginResponseHeader(ResponseCode responseCode, u64 contentLength) = 0;
+
+    // Sends numBytes of inPipe, starting at offset, as the body of a response that was begun with
+    // a contentLength. Must be called after endResponseHeader(). When inPipe is a file, it's sent
+    // directly from the file to the socket where supported.
+    virtual void sendFile(Owned<InPipe>&& inPipe, u64 offset, u64 numBytes) = 0;
+
     void respondGeneric(ResponseCode responseCode);
 };
 
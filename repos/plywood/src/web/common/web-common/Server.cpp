@@ -4,13 +4,34 @@
 ------------------------------------*/
 #include <web-common/Core.h>
 #include <web-common/Server.h>
+#include <web-common/RequestParser.h>
 #include <ply-runtime/io/InStream.h>
 #include <ply-runtime/io/OutStream.h>
 #include <web-common/OutPipe_HTTPChunked.h>
+#include <ply-runtime/thread/Affinity.h>
+#include <ply-runtime/thread/Thread.h>
+#include <ply-runtime/thread/ThreadPool.h>
+#include <ply-runtime/log/Log.h>
+#if PLY_KERNEL_LINUX
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
 
 namespace ply {
 namespace web {
 
+static constexpr u32 MaxRequestHeaderBytes = 16384;
+static constexpr u32 InitialRecvBufferBytes = 1024;
+static constexpr u32 DefaultBlockingWorkersPerHWThread = 8;
+static constexpr u32 KeepAliveTimeoutSeconds = 5;
+// How long to wait before accepting again when the process runs out of file descriptors
+static constexpr int AcceptRetryMillis = 100;
+
+SLOG_CHANNEL(ServerLog, "Server")
+
 //-----------------------------------------------------------------------
 struct ThreadParams {
     Owned<TCPConnection> tcpConn;
@@ -21,16 +42,62 @@ PLY_NO_INLINE Tuple<StringView, StringView> getResponseDescription(ResponseCode
     switch (responseCode) {
         case ResponseCode::OK:
             return {"200", "OK"};
+        case ResponseCode::PartialContent:
+            return {"206", "Partial Content"};
+        case ResponseCode::NotModified:
+            return {"304", "Not Modified"};
         case ResponseCode::BadRequest:
             return {"400", "Bad Request"};
         case ResponseCode::NotFound:
             return {"404", "Not Found"};
+        case ResponseCode::RangeNotSatisfiable:
+            return {"416", "Range Not Satisfiable"};
+        case ResponseCode::RequestHeaderFieldsTooLarge:
+            return {"431", "Request Header Fields Too Large"};
+        case ResponseCode::ServiceUnavailable:
+            return {"503", "Service Unavailable"};
         case ResponseCode::InternalError:
         default:
             return {"500", "Internal Server Error"};
     }
 }
 
+// A file that makes up the body of a response. Used when the response isn't written directly to the
+// socket. inPipe is always an InPipe_FD.
+struct FileBody {
+    Owned<InPipe> inPipe;
+    u64 offset = 0;
+    u64 numBytes = 0;
+};
+
+#if PLY_KERNEL_LINUX
+// Sends as much of fileBody as the socket accepts, advancing fileBody as it goes. Returns -1 on
+// error, 0 if the socket is non-blocking and would block, or 1 once the whole body was sent.
+// inPipe must be an InPipe_FD.
+PLY_NO_INLINE s32 sendFileBody(int socketFD, InPipe* inPipe, u64* offset, u64* numBytes) {
+    if (inPipe->funcs != &InPipe_FD::Funcs_) {
+        PLY_ASSERT(0); // Other pipes must be copied through memory
+        return -1;
+    }
+    int fileFD = inPipe->cast<InPipe_FD>()->fd;
+    while (*numBytes > 0) {
+        off_t pos = (off_t) *offset;
+        ssize_t rc = ::sendfile(socketFD, fileFD, &pos, (size_t) *numBytes);
+        if (rc > 0) {
+            *offset += rc;
+            *numBytes -= rc;
+        } else if (rc < 0 && errno == EINTR) {
+            continue;
+        } else if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        } else {
+            return -1; // Error, or the file got shorter
+        }
+    }
+    return 1;
+}
+#endif
+
 struct ResponseIface_WebServer : ResponseIface {
     enum State { NoResponse, BeganResponse, EndedHeader };
 
@@ -38,14 +105,22 @@ struct ResponseIface_WebServer : ResponseIface {
     State state = NoResponse;
     bool isChunked = false; // implies keep-alive
     Owned<OutStream> outsChunked;
+    TCPConnection* tcpConn = nullptr; // If set, sendFile() sends directly to this socket
+    FileBody fileBody;                // Otherwise, sendFile() leaves InPipe_FDs here for the caller
 
     PLY_INLINE ResponseIface_WebServer(OutStream* outs) : outs{outs} {
     }
+    PLY_INLINE ~ResponseIface_WebServer() {
+        // Destroying outsChunked writes the terminating chunk. Then make sure the whole response
+        // is sent before waiting for the next request.
+        this->outsChunked.clear();
+        this->outs->flushMem();
+    }
     virtual OutStream* beginResponseHeader(ResponseCode responseCode) override {
         // FIXME: Handle ResponseCode::InternalError the same way we would handle a crash
         this->state = BeganResponse;
         Tuple<StringView, StringView> responseDesc = getResponseDescription(responseCode);
-        this->outs->format("HTTP/1.1 {} {}\r\n", responseDesc.first, responseDesc.second);
+        this->outs->format(PLY_FMT("HTTP/1.1 {} {}\r\n"), responseDesc.first, responseDesc.second);
         if (isChunked) {
             *this->outs << "Transfer-Encoding: chunked\r\n"
                            "Connection: keep-alive\r\n";
@@ -56,13 +131,65 @@ struct ResponseIface_WebServer : ResponseIface {
             return this->outs;
         }
     }
-    virtual void endResponseHeader() override {
+    virtual OutStream* beginResponseHeader(ResponseCode responseCode, u64 contentLength) override {
+        this->state = BeganResponse;
+        Tuple<StringView, StringView> responseDesc = getResponseDescription(responseCode);
+        this->outs->format(PLY_FMT("HTTP/1.1 {} {}\r\n"), responseDesc.first, responseDesc.second);
+        // A 304 response never has a body, and its Content-Length would describe the full resource
+        if (responseCode != ResponseCode::NotModified) {
+            this->outs->format(PLY_FMT("Content-Length: {}\r\n"), contentLength);
+        }
         if (isChunked) {
+            *this->outs << "Connection: keep-alive\r\n";
+        }
+        return this->outs;
+    }
+    virtual void endResponseHeader() override {
+        if (outsChunked) {
             outsChunked->flushMem();
             outsChunked->outPipe->cast<OutPipe_HTTPChunked>()->setChunkMode(true);
         }
         this->state = EndedHeader;
     }
+    virtual void sendFile(Owned<InPipe>&& inPipe, u64 offset, u64 numBytes) override {
+        PLY_ASSERT(this->state == EndedHeader && !this->outsChunked);
+#if PLY_KERNEL_LINUX
+        if (!this->tcpConn && inPipe->funcs == &InPipe_FD::Funcs_) {
+            // The I/O thread sends it with sendfile()
+            this->fileBody = {std::move(inPipe), offset, numBytes};
+            return;
+        }
+#endif
+        if (!this->copyFile(inPipe, offset, numBytes)) {
+            // The promised number of bytes wasn't sent, so the connection can't be reused
+            this->state = BeganResponse;
+        }
+    }
+    // Writes part of a file to outs, or directly to the socket if there is one
+    PLY_NO_INLINE bool copyFile(InPipe* inPipe, u64 offset, u64 numBytes) {
+#if PLY_KERNEL_LINUX
+        if (this->tcpConn && inPipe->funcs == &InPipe_FD::Funcs_) {
+            this->outs->flushMem();
+            return sendFileBody(this->tcpConn->getHandle(), inPipe, &offset, &numBytes) > 0;
+        }
+#endif
+        // Copy the file through memory
+        String buf = String::allocate(16384);
+        while (offset > 0) {
+            u32 numRead = inPipe->readSome({buf.bytes, (u32) min<u64>(offset, buf.numBytes)});
+            if (numRead == 0)
+                return false;
+            offset -= numRead;
+        }
+        while (numBytes > 0) {
+            u32 numRead = inPipe->readSome({buf.bytes, (u32) min<u64>(numBytes, buf.numBytes)});
+            if (numRead == 0)
+                return false;
+            this->outs->write(buf.left(numRead));
+            numBytes -= numRead;
+        }
+        return true;
+    }
     // Returns true if response was well-formed and it's possible to send another response over the
     // same connection:
     PLY_NO_INLINE bool handleMissingResponse() {
@@ -76,6 +203,25 @@ struct ResponseIface_WebServer : ResponseIface {
     }
 };
 
+PLY_INLINE char toLowerAsc(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+PLY_NO_INLINE StringView Request::findHeaderField(StringView name) const {
+    for (const HeaderField& field : this->headerFields) {
+        if (field.name.numBytes != name.numBytes)
+            continue;
+        u32 i = 0;
+        for (; i < name.numBytes; i++) {
+            if (toLowerAsc(field.name[i]) != toLowerAsc(name[i]))
+                break;
+        }
+        if (i == name.numBytes)
+            return field.value;
+    }
+    return {};
+}
+
 void ResponseIface::respondGeneric(ResponseCode responseCode) {
     OutStream* outs = this->beginResponseHeader(responseCode);
     Tuple<StringView, StringView> responseDesc = getResponseDescription(responseCode);
@@ -93,95 +239,577 @@ void ResponseIface::respondGeneric(ResponseCode responseCode) {
 }
 
 void serverThreadEntry(const ThreadParams& params) {
-    InStream ins = params.tcpConn->createInStream();
     OutStream outs = params.tcpConn->createOutStream();
 
+    // Request headers are parsed in place from recvBuf, which can also hold the start of the next
+    // pipelined request.
+    String recvBuf = String::allocate(InitialRecvBufferBytes);
+    u32 recvBytes = 0;
+    RequestParser parser;
+    parser.maxHeaderBytes = MaxRequestHeaderBytes;
+
     for (;;) {
         // Create responseIface
         ResponseIface_WebServer responseIface{&outs};
+        responseIface.tcpConn = params.tcpConn;
         responseIface.request.clientAddr = params.tcpConn->remoteAddress();
         responseIface.request.clientPort = params.tcpConn->remotePort();
 
-        // Parse HTTP headers: Read input lines up until a blank one
-        // FIXME: Limit the size of the header to something like 16KB, otherwise someone could take
-        // down the server.
-        Array<String> lines;
+        // Parse HTTP headers
+        RequestParser::Result result;
         for (;;) {
-            String line = ins.readString<fmt::Line>();
-            if (!line && ins.atEOF()) {
-                if (!lines.isEmpty()) {
+            result = parser.parse(&responseIface.request, {recvBuf.bytes, recvBytes});
+            if (result != RequestParser::Incomplete)
+                break;
+            if (recvBytes == recvBuf.numBytes) {
+                recvBuf.resize(min(recvBuf.numBytes * 2, MaxRequestHeaderBytes));
+            }
+            u32 numBytesRead = params.tcpConn->inPipe.readSome(
+                {recvBuf.bytes + recvBytes, recvBuf.numBytes - recvBytes});
+            if (numBytesRead == 0) {
+                if (recvBytes > 0) {
                     // Ill-formed request
                     responseIface.respondGeneric(ResponseCode::BadRequest);
                 }
                 return;
             }
-            if (line.findByte([](char u) { return !isWhite(u); }) < 0)
-                break; // Blank line
-            lines.append(line);
-        }
-        if (lines.numItems() == 0)
-            return; // Ill-formed request
-
-        // Split the start line into tokens:
-        // FIXME: Add ability to split by any whitespace instead of just splitByte
-        Array<StringView> tokens = lines[0].rtrim(isWhite).splitByte(' ');
-        if (tokens.numItems() != 3) {
-            // Ill-formed request
-            responseIface.respondGeneric(ResponseCode::BadRequest);
-            return;
+            recvBytes += numBytesRead;
         }
-        responseIface.request.startLine = {tokens[0], tokens[1], tokens[2]};
-
-        // Split remaining lines into name/value pairs:
-        for (u32 i = 1; i < lines.numItems(); i++) {
-            // FIXME: Support unfolding https://tools.ietf.org/html/rfc822#section-3.1
-            if (isWhite(lines[i][0]))
-                continue;
-            s32 colonPos = lines[i].findByte(':');
-            if (colonPos < 0) {
-                // Ill-formed request
-                responseIface.respondGeneric(ResponseCode::BadRequest);
-                return;
-            }
-            responseIface.request.headerFields.append(
-                {lines[i].left(colonPos).rtrim(isWhite),
-                 lines[i].subStr(colonPos + 1).trim(isWhite)});
+        if (result != RequestParser::Complete) {
+            responseIface.respondGeneric(getErrorResponseCode(result));
+            return;
         }
 
         // FIXME: Decide isChunked/keep-alive based on HTTP request headers
         responseIface.isChunked = (responseIface.request.startLine.httpVersion == "HTTP/1.1");
 
-        // Note: ins is still open, so in the future, we could continue reading past the HTTP
-        // header to support POST requests and WebSockets.
+        // Note: Any bytes following the header are still in recvBuf, so in the future, we could
+        // continue reading past the HTTP header to support POST requests and WebSockets.
 
         // Invoke request handler
-        params.reqHandler(tokens[1], &responseIface);
+        {
+            PLY_TRACE_ZONE("Handle HTTP request");
+            params.reqHandler(responseIface.request.startLine.uri, &responseIface);
+        }
 
         if (!responseIface.handleMissingResponse())
             return; // Close connection if unable to distinguish between responses
         if (!responseIface.isChunked)
             return; // Close connection if not keep-alive
+
+        // Discard the header that was just handled
+        u32 headerSize = parser.getHeaderSize();
+        memmove(recvBuf.bytes, recvBuf.bytes + headerSize, recvBytes - headerSize);
+        recvBytes -= headerSize;
+        parser.reset();
     }
 }
 
-bool runServer(u16 port, const RequestHandler& reqHandler) {
+PLY_NO_INLINE void respondServiceUnavailable(TCPConnection* tcpConn) {
+    OutStream outs = tcpConn->createOutStream();
+    ResponseIface_WebServer{&outs}.respondGeneric(ResponseCode::ServiceUnavailable);
+}
+
+bool runServerBlocking(u16 port, const RequestHandler& reqHandler, const ServerOptions& options) {
     TCPListener listener = Socket::bindTCP(port);
     if (!listener.isValid()) {
         StdErr::text().format("Error: Can't bind to port {}\n", port);
         return false;
     }
 
+    // Each worker serves a single connection at a time, so use more workers than hardware threads.
+    u32 numWorkers = options.numWorkerThreads;
+    if (numWorkers == 0) {
+        numWorkers = max<u32>(Affinity{}.getNumHWThreads(), 1) * DefaultBlockingWorkersPerHWThread;
+    }
+    ThreadPool pool{numWorkers, options.maxQueuedRequests};
+
     for (;;) {
-        ThreadParams params;
-        params.tcpConn = listener.accept();
+        Owned<TCPConnection> tcpConn = listener.accept();
+        if (!tcpConn) {
+            SLOG(ServerLog, "Can't accept connection: errno {}", errno);
+            if (Socket::lastResult() == IPResult::NoSocket) {
+                // Out of file descriptors. Give the workers a chance to close some connections
+                // instead of retrying in a loop.
+                Thread::sleepMillis(AcceptRetryMillis);
+            }
+            continue;
+        }
         // FIXME: Return if port stopped listening
 
-        params.reqHandler = reqHandler;
-        // FIXME: Use a thread pool instead of spawning a thread for every request
-        Thread{[params{std::move(params)}] { serverThreadEntry(params); }};
+#if PLY_TARGET_POSIX
+        // Don't let idle keep-alive connections hold on to workers forever
+        struct timeval timeout;
+        timeout.tv_sec = KeepAliveTimeoutSeconds;
+        timeout.tv_usec = 0;
+        setsockopt(tcpConn->getHandle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+
+        TCPConnection* conn = tcpConn.release();
+        bool submitted = pool.trySubmit([conn, &reqHandler] {
+            ThreadParams params;
+            params.tcpConn = conn;
+            params.reqHandler = reqHandler;
+            serverThreadEntry(params);
+        });
+        if (!submitted) {
+            // Too many connections are waiting for a worker
+            respondServiceUnavailable(conn);
+            delete conn;
+        }
     }
     return true;
 }
 
+#if PLY_KERNEL_LINUX
+
+//-----------------------------------------------------------------------
+// Event-driven server
+//
+// Each I/O thread owns an epoll instance. The listening socket is registered with every instance
+// using EPOLLEXCLUSIVE, so new connections are spread across threads, and each accepted connection
+// stays with the thread that accepted it for its whole lifetime. Connections are non-blocking and
+// registered edge-triggered, so every readiness notification must be drained until EAGAIN.
+//
+// I/O threads only parse requests. Each parsed request is submitted to a ThreadPool that runs the
+// RequestHandler, and the finished response is passed back to the connection's I/O thread through
+// an eventfd. A connection has at most one request in flight; pipelined requests wait in its
+// receive buffer until the previous response is queued.
+//-----------------------------------------------------------------------
+static constexpr u32 MaxEventsPerWait = 256;
+
+struct EpollIOThread;
+
+struct EpollConnection {
+    Owned<TCPConnection> tcpConn;
+    String recvBuf;     // Grows on demand up to MaxRequestHeaderBytes
+    u32 recvBytes = 0;  // Number of valid bytes at the start of recvBuf
+    RequestParser parser; // Parses the request at the start of recvBuf
+    Request request;      // Filled in by parser; views into recvBuf
+    String sendBuf;     // Response bytes not yet accepted by the kernel
+    u32 sendPos = 0;    // Offset of the first unsent byte in sendBuf
+    FileBody fileBody;  // Sent after sendBuf. No requests are dispatched until it's sent
+    bool closeAfterSend = false;
+    bool requestInFlight = false;
+    bool isClosed = false; // Socket was closed; waiting to be deleted
+};
+
+struct PendingRequest {
+    EpollIOThread* ioThread = nullptr;
+    EpollConnection* conn = nullptr;
+    Request request; // Views into the connection's recvBuf, which isn't modified until completion
+    String response;
+    FileBody fileBody;
+    bool keepAlive = false;
+};
+
+struct EpollIOThread {
+    TCPListener* listener = nullptr;
+    const RequestHandler* reqHandler = nullptr;
+    ThreadPool* pool = nullptr;
+    int epollFD = -1;
+    int eventFD = -1; // Signaled by workers when completedRequests is non-empty
+    Mutex completedMutex;
+    Array<PendingRequest*> completedRequests;
+    Array<EpollConnection*> closedConnections; // Deleted at the end of each batch of events
+    bool isListening = false; // Whether the listening socket is in the epoll set
+    CPUTimer::Point acceptRetryTime; // When to add the listening socket back if !isListening
+
+    void setListening(bool listening);
+    void postCompletedRequest(PendingRequest* pending);
+    void handleCompletedRequests();
+    void acceptConnections();
+    void dispatchRequests(EpollConnection* conn);
+    bool onReadable(EpollConnection* conn);
+    bool dispatchAndFlush(EpollConnection* conn);
+    void closeConnection(EpollConnection* conn);
+    void run();
+};
+
+// Appends a generic response to the connection's send buffer without invoking the RequestHandler.
+PLY_NO_INLINE void queueGenericResponse(EpollConnection* conn, ResponseCode responseCode,
+                                        bool keepAlive) {
+    MemOutStream mout;
+    {
+        ResponseIface_WebServer responseIface{&mout};
+        responseIface.isChunked = keepAlive;
+        responseIface.respondGeneric(responseCode);
+    }
+    conn->sendBuf += mout.moveToString();
+    if (!keepAlive) {
+        conn->closeAfterSend = true;
+    }
+}
+
+// Removes the request header that was just handled from the front of the receive buffer.
+PLY_NO_INLINE void consumeRequestHeader(EpollConnection* conn) {
+    u32 headerSize = conn->parser.getHeaderSize();
+    memmove(conn->recvBuf.bytes, conn->recvBuf.bytes + headerSize, conn->recvBytes - headerSize);
+    conn->recvBytes -= headerSize;
+    conn->parser.reset();
+}
+
+// Sends as much of the pending response data as the socket accepts. Returns false if the connection
+// should be closed.
+PLY_NO_INLINE bool flushSendBuffer(EpollConnection* conn) {
+    PLY_TRACE_ZONE("Send HTTP response");
+    int fd = conn->tcpConn->getHandle();
+    while (conn->sendPos < conn->sendBuf.numBytes) {
+        ssize_t rc = ::send(fd, conn->sendBuf.bytes + conn->sendPos,
+                            conn->sendBuf.numBytes - conn->sendPos, MSG_NOSIGNAL);
+        if (rc > 0) {
+            conn->sendPos += (u32) rc;
+        } else if (rc < 0 && errno == EINTR) {
+            continue;
+        } else if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true; // Resume when EPOLLOUT is signaled
+        } else {
+            return false;
+        }
+    }
+    conn->sendBuf.clear();
+    conn->sendPos = 0;
+    if (conn->fileBody.inPipe) {
+        s32 rc = sendFileBody(fd, conn->fileBody.inPipe, &conn->fileBody.offset,
+                              &conn->fileBody.numBytes);
+        if (rc <= 0)
+            return rc == 0;
+        conn->fileBody.inPipe.clear();
+    }
+    return !conn->closeAfterSend || conn->requestInFlight;
+}
+
+// Runs on a worker thread.
+PLY_NO_INLINE void runPendingRequest(PendingRequest* pending) {
+    PLY_TRACE_ZONE("Handle HTTP request");
+    MemOutStream mout;
+    {
+        // When responseIface is destroyed, its chunked OutStream writes the terminating chunk.
+        ResponseIface_WebServer responseIface{&mout};
+        responseIface.request = std::move(pending->request);
+        // FIXME: Decide isChunked/keep-alive based on HTTP request headers
+        responseIface.isChunked = (responseIface.request.startLine.httpVersion == "HTTP/1.1");
+        (*pending->ioThread->reqHandler)(responseIface.request.startLine.uri, &responseIface);
+        // Close connection if not keep-alive or unable to distinguish between responses
+        pending->keepAlive = responseIface.handleMissingResponse() && responseIface.isChunked;
+        pending->fileBody = std::move(responseIface.fileBody);
+    }
+    pending->response = mout.moveToString();
+    pending->ioThread->postCompletedRequest(pending);
+}
+
+void EpollIOThread::postCompletedRequest(PendingRequest* pending) {
+    {
+        LockGuard<Mutex> guard{this->completedMutex};
+        this->completedRequests.append(pending);
+    }
+    u64 one = 1;
+    ssize_t rc = ::write(this->eventFD, &one, sizeof(one));
+    PLY_UNUSED(rc);
+}
+
+void EpollIOThread::handleCompletedRequests() {
+    PLY_TRACE_ZONE("Handle completed HTTP requests");
+    u64 count;
+    ssize_t rc = ::read(this->eventFD, &count, sizeof(count));
+    PLY_UNUSED(rc);
+
+    Array<PendingRequest*> completed;
+    {
+        LockGuard<Mutex> guard{this->completedMutex};
+        completed = std::move(this->completedRequests);
+    }
+    for (PendingRequest* pending : completed) {
+        Owned<PendingRequest> owned = pending;
+        EpollConnection* conn = pending->conn;
+        conn->requestInFlight = false;
+        if (conn->isClosed) {
+            this->closedConnections.append(conn);
+            continue;
+        }
+        consumeRequestHeader(conn);
+        conn->sendBuf = conn->sendBuf.subStr(conn->sendPos) + pending->response;
+        conn->sendPos = 0;
+        conn->fileBody = std::move(pending->fileBody);
+        if (!pending->keepAlive) {
+            conn->closeAfterSend = true;
+        }
+        // Data that arrived while the request was in flight didn't trigger a new edge, so read
+        // whatever is available and handle the next pipelined request.
+        if (!this->onReadable(conn)) {
+            this->closeConnection(conn);
+        }
+    }
+}
+
+// Parses the next complete request in the receive buffer and submits it to the worker pool.
+PLY_NO_INLINE void EpollIOThread::dispatchRequests(EpollConnection* conn) {
+    while (!conn->requestInFlight && !conn->closeAfterSend && !conn->fileBody.inPipe) {
+        RequestParser::Result result;
+        {
+            PLY_TRACE_ZONE("Parse HTTP request");
+            result = conn->parser.parse(&conn->request, {conn->recvBuf.bytes, conn->recvBytes});
+        }
+        if (result == RequestParser::Incomplete)
+            return;
+        if (result != RequestParser::Complete) {
+            queueGenericResponse(conn, getErrorResponseCode(result), false);
+            return;
+        }
+
+        Owned<PendingRequest> pending = new PendingRequest;
+        pending->ioThread = this;
+        pending->conn = conn;
+        pending->request = std::move(conn->request);
+        pending->request.clientAddr = conn->tcpConn->remoteAddress();
+        pending->request.clientPort = conn->tcpConn->remotePort();
+        bool keepAlive = (pending->request.startLine.httpVersion == "HTTP/1.1");
+        PendingRequest* toSubmit = pending.release();
+        if (this->pool->trySubmit([toSubmit] { runPendingRequest(toSubmit); })) {
+            conn->requestInFlight = true;
+            PLY_TRACE_COUNTER("Queued HTTP requests", this->pool->getNumQueuedTasks());
+        } else {
+            // Worker queue is full
+            delete toSubmit;
+            queueGenericResponse(conn, ResponseCode::ServiceUnavailable, keepAlive);
+            consumeRequestHeader(conn);
+        }
+    }
+}
+
+// Reads everything available on the socket and dispatches complete requests. Returns false if the
+// connection should be closed.
+PLY_NO_INLINE bool EpollIOThread::onReadable(EpollConnection* conn) {
+    int fd = conn->tcpConn->getHandle();
+    bool peerClosed = false;
+    while (!peerClosed && !conn->closeAfterSend) {
+        if (conn->recvBytes == conn->recvBuf.numBytes) {
+            this->dispatchRequests(conn);
+            if (conn->closeAfterSend || conn->requestInFlight || conn->fileBody.inPipe)
+                break; // The request in flight refers to recvBuf, so it can't be reallocated yet
+            if (conn->recvBytes == conn->recvBuf.numBytes) {
+                // The parser reports TooLarge before the buffer reaches MaxRequestHeaderBytes
+                PLY_ASSERT(conn->recvBuf.numBytes < MaxRequestHeaderBytes);
+                conn->recvBuf.resize(min(conn->recvBuf.numBytes * 2, MaxRequestHeaderBytes));
+            }
+        }
+
+        ssize_t rc = ::recv(fd, conn->recvBuf.bytes + conn->recvBytes,
+                            conn->recvBuf.numBytes - conn->recvBytes, 0);
+        if (rc > 0) {
+            conn->recvBytes += (u32) rc;
+        } else if (rc == 0) {
+            peerClosed = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            return false;
+        }
+    }
+
+    if (peerClosed) {
+        // Send whatever responses are pending, then close
+        conn->closeAfterSend = true;
+    }
+    return this->dispatchAndFlush(conn);
+}
+
+// Dispatches pending requests and sends pending responses. Returns false if the connection should
+// be closed.
+PLY_NO_INLINE bool EpollIOThread::dispatchAndFlush(EpollConnection* conn) {
+    for (;;) {
+        this->dispatchRequests(conn);
+        bool wasSendingFile = conn->fileBody.inPipe;
+        if (!flushSendBuffer(conn))
+            return false;
+        // Dispatching was paused while a file was being sent, so resume it once the file is sent
+        if (!wasSendingFile || conn->fileBody.inPipe)
+            return true;
+    }
+}
+
+void EpollIOThread::closeConnection(EpollConnection* conn) {
+    if (conn->isClosed)
+        return;
+    // Closing the socket also removes it from the epoll set. The EpollConnection itself is deleted
+    // after the current batch of events, since later events in the batch may still refer to it. If
+    // a worker still refers to it, it's deleted once the request completes.
+    conn->tcpConn.clear();
+    conn->isClosed = true;
+    this->setListening(true); // A file descriptor was freed
+    if (!conn->requestInFlight) {
+        this->closedConnections.append(conn);
+    }
+}
+
+// Adds or removes the listening socket. It's removed when the process runs out of file descriptors,
+// so the level-triggered listener doesn't wake the I/O thread in a loop, and added back when a
+// connection closes or after AcceptRetryMillis. EPOLL_CTL_MOD can't be used on a file descriptor
+// that was added with EPOLLEXCLUSIVE, so it's deleted and added again instead.
+void EpollIOThread::setListening(bool listening) {
+    if (this->isListening == listening)
+        return;
+    int rc;
+    if (listening) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.ptr = this->listener; // Identifies the listening socket
+        rc = epoll_ctl(this->epollFD, EPOLL_CTL_ADD, this->listener->listenSocket, &ev);
+    } else {
+        rc = epoll_ctl(this->epollFD, EPOLL_CTL_DEL, this->listener->listenSocket, nullptr);
+        this->acceptRetryTime =
+            CPUTimer::get() + CPUTimer::Converter{}.toDuration(AcceptRetryMillis * 0.001f);
+    }
+    PLY_ASSERT(rc == 0);
+    PLY_UNUSED(rc);
+    this->isListening = listening;
+}
+
+void EpollIOThread::acceptConnections() {
+    for (;;) {
+        Owned<TCPConnection> tcpConn = this->listener->accept();
+        if (!tcpConn) {
+            int error = errno;
+            IPResult result = Socket::lastResult();
+            if (result == IPResult::WouldBlock)
+                break; // No more pending connections
+            if (result == IPResult::NoSocket) {
+                // Out of file descriptors. Stop listening until some are freed.
+                SLOG(ServerLog, "Can't accept connection: errno {}", error);
+                this->setListening(false);
+                break;
+            }
+            // Other errors, such as a connection that was aborted before it could be accepted, only
+            // affect a single pending connection
+            SLOG(ServerLog, "Can't accept connection: errno {}", error);
+            continue;
+        }
+        tcpConn->setBlocking(false);
+        int noDelay = 1;
+        setsockopt(tcpConn->getHandle(), IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        EpollConnection* conn = new EpollConnection;
+        conn->tcpConn = std::move(tcpConn);
+        conn->recvBuf = String::allocate(InitialRecvBufferBytes);
+        conn->parser.maxHeaderBytes = MaxRequestHeaderBytes;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = conn;
+        if (epoll_ctl(this->epollFD, EPOLL_CTL_ADD, conn->tcpConn->getHandle(), &ev) != 0) {
+            delete conn;
+        }
+    }
+}
+
+void EpollIOThread::run() {
+    EventTracer::setThreadName("HTTP I/O");
+    this->epollFD = epoll_create1(EPOLL_CLOEXEC);
+    PLY_ASSERT(this->epollFD >= 0);
+    this->eventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    PLY_ASSERT(this->eventFD >= 0);
+
+    // The data pointer identifies the listening socket and the eventfd
+    this->setListening(true);
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = this;
+    int rc = epoll_ctl(this->epollFD, EPOLL_CTL_ADD, this->eventFD, &ev);
+    PLY_ASSERT(rc == 0);
+    PLY_UNUSED(rc);
+
+    struct epoll_event events[MaxEventsPerWait];
+    for (;;) {
+        int timeout = -1;
+        if (!this->isListening) {
+            CPUTimer::Duration remaining = this->acceptRetryTime - CPUTimer::get();
+            timeout = max(0, int(CPUTimer::Converter{}.toSeconds(remaining) * 1000.f) + 1);
+        }
+        int numEvents = epoll_wait(this->epollFD, events, MaxEventsPerWait, timeout);
+        if (numEvents < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (!this->isListening && CPUTimer::get() >= this->acceptRetryTime) {
+            this->setListening(true);
+        }
+        for (int i = 0; i < numEvents; i++) {
+            void* ptr = events[i].data.ptr;
+            if (ptr == this->listener) {
+                this->acceptConnections();
+                continue;
+            }
+            if (ptr == this) {
+                this->handleCompletedRequests();
+                continue;
+            }
+
+            EpollConnection* conn = (EpollConnection*) ptr;
+            if (conn->isClosed)
+                continue;
+            bool keepOpen = true;
+            if (events[i].events & EPOLLERR) {
+                keepOpen = false;
+            } else if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                keepOpen = this->onReadable(conn);
+            } else if (events[i].events & EPOLLOUT) {
+                keepOpen = this->dispatchAndFlush(conn);
+            }
+            if (!keepOpen) {
+                this->closeConnection(conn);
+            }
+        }
+        for (EpollConnection* conn : this->closedConnections) {
+            delete conn;
+        }
+        this->closedConnections.clear();
+    }
+    ::close(this->eventFD);
+    ::close(this->epollFD);
+}
+
+bool runServerEventDriven(u16 port, const RequestHandler& reqHandler,
+                          const ServerOptions& options) {
+    TCPListener listener = Socket::bindTCP(port);
+    if (!listener.isValid()) {
+        StdErr::text().format("Error: Can't bind to port {}\n", port);
+        return false;
+    }
+    listener.setBlocking(false);
+
+    u32 numHWThreads = max<u32>(Affinity{}.getNumHWThreads(), 1);
+    ThreadPool pool{options.numWorkerThreads ? options.numWorkerThreads : numHWThreads,
+                    options.maxQueuedRequests};
+
+    Array<EpollIOThread> ioThreads;
+    ioThreads.resize(options.numIOThreads ? options.numIOThreads : numHWThreads);
+    Array<Thread> threads;
+    threads.resize(ioThreads.numItems());
+    for (u32 i = 0; i < ioThreads.numItems(); i++) {
+        EpollIOThread* ioThread = &ioThreads[i];
+        ioThread->listener = &listener;
+        ioThread->reqHandler = &reqHandler;
+        ioThread->pool = &pool;
+        threads[i].run([ioThread] { ioThread->run(); });
+    }
+    for (Thread& thread : threads) {
+        thread.join();
+    }
+    return true;
+}
+
+#endif // PLY_KERNEL_LINUX
+
+bool runServer(u16 port, const RequestHandler& reqHandler, const ServerOptions& options) {
+#if PLY_KERNEL_LINUX
+    if (options.mode == ServerOptions::EventDriven)
+        return runServerEventDriven(port, reqHandler, options);
+#endif
+    return runServerBlocking(port, reqHandler, options);
+}
+
 } // namespace web
 } // namespace ply
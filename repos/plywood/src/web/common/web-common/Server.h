@@ -9,7 +9,26 @@
 namespace ply {
 namespace web {
 
-bool runServer(u16 port, const RequestHandler& reqHandler);
+struct ServerOptions {
+    enum Mode {
+        // Each connection is served by a blocking worker thread for as long as it stays open.
+        // Idle keep-alive connections are closed after a few seconds to free up the worker.
+        Blocking,
+        // Multiplexes all connections over a fixed set of I/O threads using edge-triggered epoll
+        // and non-blocking sockets, and runs parsed requests on the worker threads. Only available
+        // on Linux; other platforms fall back to Blocking.
+        EventDriven,
+    };
+
+    Mode mode = Blocking;
+    u32 numIOThreads = 0;     // EventDriven only. 0 means one per hardware thread
+    u32 numWorkerThreads = 0; // 0 picks a default based on the number of hardware threads
+    // When this many connections (Blocking) or requests (EventDriven) are already waiting for a
+    // worker, the server responds with 503 Service Unavailable. 0 means unbounded.
+    u32 maxQueuedRequests = 1024;
+};
+
+bool runServer(u16 port, const RequestHandler& reqHandler, const ServerOptions& options = {});
 
 } // namespace web
 } // namespace ply
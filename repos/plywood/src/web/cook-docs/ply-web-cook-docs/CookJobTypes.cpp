@@ -12,19 +12,11 @@ extern cook::CookJobType CookJobType_StyleSheetID;
 extern cook::CookJobType CookJobType_Page;
 
 void initCookJobTypes() {
-    static BaseStaticPtr::PossibleValues pv;
-    for (cook::CookJobType* jobType : {
-             &docs::CookJobType_ExtractAPI,
-             &docs::CookJobType_StyleSheetID,
-             &docs::CookJobType_Page,
-         }) {
-        pv.enumeratorNames.append(jobType->name);
-        pv.ptrValues.append(jobType);
-    }
-
-    TypeDescriptor_StaticPtr* staticPtrType = TypeResolver<StaticPtr<cook::CookJobType>>::get();
-    PLY_ASSERT(!staticPtrType->possibleValues);
-    staticPtrType->possibleValues = &pv;
+    cook::registerCookJobTypes({
+        &docs::CookJobType_ExtractAPI,
+        &docs::CookJobType_StyleSheetID,
+        &docs::CookJobType_Page,
+    });
 }
 
 } // namespace docs
@@ -56,7 +56,7 @@ void dumpContents(OutStream* outs, const Contents* node, ArrayView<const Content
     }
 }
 
-void DocServer::init(StringView dataRoot) {
+void DocServer::init(StringView dataRoot, bool watchForChanges) {
     FileSystem* fs = FileSystem::native();
 
     this->dataRoot = dataRoot;
@@ -66,6 +66,15 @@ void DocServer::init(StringView dataRoot) {
         this->reloadContents();
         this->contentsModTime = contentsStatus.modificationTime;
     }
+    if (watchForChanges) {
+        auto onChange = [this](StringView path, bool mustRecurse) {
+            if (mustRecurse || NativePath::split(path).second == "contents.pylon") {
+                this->reloadContentsIfChanged();
+            }
+            this->pageCache.invalidateAll();
+        };
+        this->watcher = new DirectoryWatcher{dataRoot, std::move(onChange)};
+    }
 }
 
 void populateContentsMap(HashMap<DocServer::ContentsTraits>& pathToContents, Contents* node) {
@@ -101,21 +110,25 @@ void DocServer::reloadContents() {
     }
 }
 
-String getPageSource(DocServer* ds, StringView requestPath, ResponseIface* responseIface) {
-    FileSystem* fs = FileSystem::native();
-    if (NativePath::isAbsolute(requestPath)) {
-        responseIface->respondGeneric(ResponseCode::NotFound);
+// Returns the path of the HTML file that holds the source of a page, or an empty string if
+// requestPath is invalid.
+String getPageSourcePath(DocServer* ds, StringView requestPath) {
+    if (NativePath::isAbsolute(requestPath))
         return {};
-    }
     String absPath = NativePath::join(ds->dataRoot, "pages", requestPath);
     ExistsResult exists = FileSystem::native()->exists(absPath);
     if (exists == ExistsResult::Directory) {
-        absPath = NativePath::join(absPath, "index.html");
-    } else {
-        absPath += ".html";
+        return NativePath::join(absPath, "index.html");
+    }
+    return absPath + ".html";
+}
+
+String getPageSource(DocServer* ds, StringView requestPath, ResponseIface* responseIface) {
+    String absPath = getPageSourcePath(ds, requestPath);
+    String pageHtml;
+    if (absPath) {
+        pageHtml = FileSystem::native()->loadText(absPath, TextFormat::unixUTF8());
     }
-    String pageHtml =
-        fs->loadText(NativePath::join(ds->dataRoot, "pages", absPath), TextFormat::unixUTF8());
     if (!pageHtml) {
         responseIface->respondGeneric(ResponseCode::NotFound);
         return {};
@@ -123,38 +136,15 @@ String getPageSource(DocServer* ds, StringView requestPath, ResponseIface* respo
     return pageHtml;
 }
 
-void DocServer::serve(StringView requestPath, ResponseIface* responseIface) {
-    FileSystem* fs = FileSystem::native();
-
-    // Check if contents.pylon has been updated:
-    FileStatus contentsStatus = fs->getFileStatus(this->contentsPath);
-    if (contentsStatus.result == FSResult::OK) {
-        if (contentsStatus.modificationTime != this->contentsModTime.load(MemoryOrder::Acquire)) {
-            ply::LockGuard<ply::Mutex> guard{this->contentsMutex};
-            if (contentsStatus.modificationTime !=
-                this->contentsModTime.load(MemoryOrder::Relaxed)) {
-                this->reloadContents();
-            }
-            this->contentsModTime = contentsStatus.modificationTime;
-        }
-    }
-
-    if (!this->contents) {
-        responseIface->respondGeneric(ResponseCode::InternalError);
-        return;
-    }
-
-    // Load page
-    String pageHtml = getPageSource(this, requestPath, responseIface);
-    if (!pageHtml)
-        return;
+// Renders the complete HTML of a page, including the sidebar.
+void renderPage(OutStream* outs, DocServer* ds, StringView requestPath, StringView pageHtml) {
     ViewInStream vins{pageHtml};
     String pageTitle = vins.readView<fmt::Line>().trim(isWhite);
 
     // Figure out which TOC entries to expand
     Array<const Contents*> expandTo;
     {
-        auto cursor = this->pathToContents.find(
+        auto cursor = ds->pathToContents.find(
             requestPath ? (StringView{"/docs/"} + requestPath).view() : StringView{"/"});
         if (cursor.wasFound()) {
             const Contents* node = cursor->node;
@@ -165,9 +155,6 @@ void DocServer::serve(StringView requestPath, ResponseIface* responseIface) {
         }
     }
 
-    OutStream* outs = responseIface->beginResponseHeader(ResponseCode::OK);
-    *outs << "Content-Type: text/html; charset=utf-8\r\n\r\n";
-    responseIface->endResponseHeader();
     outs->format(R"#(<!DOCTYPE html>
 <html>
 <head>
@@ -201,7 +188,7 @@ void DocServer::serve(StringView requestPath, ResponseIface* responseIface) {
       <div class="inner">
         <ul>
 )#";
-    for (const Contents* node : this->contents) {
+    for (const Contents* node : ds->contents) {
         dumpContents(outs, node, expandTo);
     }
     outs->format(R"(
@@ -221,6 +208,138 @@ void DocServer::serve(StringView requestPath, ResponseIface* responseIface) {
 )";
 }
 
+// Returns the q-value in the parameters of a content coding, such as " q=0.5" in "gzip; q=0.5". The
+// default is 1.
+static double getQValue(StringView params) {
+    for (StringView param : params.splitByte(';')) {
+        s32 equals = param.findByte('=');
+        if (equals < 0)
+            continue;
+        StringView name = param.left(equals).trim(isWhite);
+        if (name == "q" || name == "Q")
+            return param.subStr(equals + 1).trim(isWhite).to<double>();
+    }
+    return 1;
+}
+
+bool acceptsGzip(StringView acceptEncoding) {
+    double gzipQ = -1; // Negative if gzip isn't listed
+    double anyQ = -1;  // Negative if * isn't listed
+    for (StringView coding : acceptEncoding.splitByte(',')) {
+        s32 semicolon = coding.findByte(';');
+        StringView name = (semicolon >= 0 ? coding.left(semicolon) : coding).trim(isWhite);
+        StringView params = (semicolon >= 0 ? coding.subStr(semicolon + 1) : StringView{});
+        if (name == "gzip") {
+            gzipQ = getQValue(params);
+        } else if (name == "*") {
+            anyQ = getQValue(params);
+        }
+    }
+    // * only applies to codings that aren't listed
+    return gzipQ >= 0 ? gzipQ > 0 : anyQ > 0;
+}
+
+void DocServer::reloadContentsIfChanged() {
+    FileStatus contentsStatus = FileSystem::native()->getFileStatus(this->contentsPath);
+    if (contentsStatus.result == FSResult::OK) {
+        if (contentsStatus.modificationTime != this->contentsModTime.load(MemoryOrder::Acquire)) {
+            ply::LockGuard<ply::Mutex> guard{this->contentsMutex};
+            if (contentsStatus.modificationTime !=
+                this->contentsModTime.load(MemoryOrder::Relaxed)) {
+                this->reloadContents();
+            }
+            this->contentsModTime = contentsStatus.modificationTime;
+        }
+    }
+}
+
+void DocServer::serve(StringView requestPath, ResponseIface* responseIface) {
+    FileSystem* fs = FileSystem::native();
+
+    // Unless a DirectoryWatcher is watching it, check if contents.pylon has been updated:
+    if (!this->watcher) {
+        this->reloadContentsIfChanged();
+    }
+
+    if (!this->contents) {
+        responseIface->respondGeneric(ResponseCode::InternalError);
+        return;
+    }
+
+    // Unless a DirectoryWatcher is watching the page sources, check the page source's modification
+    // time so that a cached copy is never stale.
+    String sourcePath;
+    double sourceModTime = 0;
+    if (!this->watcher) {
+        sourcePath = getPageSourcePath(this, requestPath);
+        FileStatus sourceStatus;
+        if (sourcePath) {
+            sourceStatus = fs->getFileStatus(sourcePath);
+        }
+        if (sourceStatus.result != FSResult::OK) {
+            responseIface->respondGeneric(ResponseCode::NotFound);
+            return;
+        }
+        sourceModTime = sourceStatus.modificationTime;
+    }
+
+    double contentsModTime = this->contentsModTime.load(MemoryOrder::Acquire);
+    Reference<CachedPage> page = this->pageCache.find(requestPath, contentsModTime, sourceModTime);
+    if (!page) {
+        // Load and render page. If the watcher invalidates the cache in the meantime, the page
+        // isn't cached.
+        u64 generation = this->pageCache.getGeneration();
+        String pageHtml = getPageSource(this, requestPath, responseIface);
+        if (!pageHtml)
+            return;
+        page = new CachedPage;
+        page->path = requestPath;
+        page->contentsModTime = contentsModTime;
+        page->sourceModTime = sourceModTime;
+        page->generation = generation;
+        MemOutStream mout;
+        renderPage(&mout, this, requestPath, pageHtml);
+        page->body = mout.moveToString();
+        if (this->gzip) {
+            page->gzipBody = this->gzip(page->body);
+        }
+        this->pageCache.insert(page);
+    }
+
+    bool useGzip = page->gzipBody &&
+                   acceptsGzip(responseIface->request.findHeaderField("Accept-Encoding"));
+    StringView body = useGzip ? page->gzipBody.view() : page->body.view();
+    OutStream* outs = responseIface->beginResponseHeader(ResponseCode::OK, body.numBytes);
+    *outs << "Content-Type: text/html; charset=utf-8\r\n";
+    if (page->gzipBody) {
+        *outs << "Vary: Accept-Encoding\r\n";
+    }
+    if (useGzip) {
+        *outs << "Content-Encoding: gzip\r\n";
+    }
+    *outs << "\r\n";
+    responseIface->endResponseHeader();
+    outs->write(body);
+}
+
+void DocServer::serveCacheStats(ResponseIface* responseIface) {
+    PageCache::Stats stats = this->pageCache.getStats();
+    MemOutStream mout;
+    mout.format("pages: {}\n", stats.numPages);
+    mout.format("bytes: {}\n", stats.numBytes);
+    mout.format("byteBudget: {}\n", stats.byteBudget);
+    mout.format("hits: {}\n", stats.numHits);
+    mout.format("misses: {}\n", stats.numMisses);
+    mout.format("evictions: {}\n", stats.numEvictions);
+    mout.format("invalidations: {}\n", stats.numInvalidations);
+    String text = mout.moveToString();
+
+    OutStream* outs = responseIface->beginResponseHeader(ResponseCode::OK, text.numBytes);
+    *outs << "Content-Type: text/plain\r\nCache-Control: no-store\r\n\r\n";
+    responseIface->endResponseHeader();
+    outs->write(text);
+}
+
 void DocServer::serveContentOnly(StringView requestPath, ResponseIface* responseIface) {
     String pageHtml = getPageSource(this, requestPath, responseIface);
     if (!pageHtml)
@@ -6,6 +6,8 @@
 #include <ply-web-serve-docs/Core.h>
 #include <web-common/Response.h>
 #include <web-documentation/Contents.h>
+#include <ply-web-serve-docs/PageCache.h>
+#include <ply-runtime/filesystem/DirectoryWatcher.h>
 
 namespace ply {
 namespace web {
@@ -33,11 +35,26 @@ struct DocServer {
     Array<Owned<Contents>> contents;
     HashMap<ContentsTraits> pathToContents;
 
-    void init(StringView dataRoot);
+    // Rendered pages. Pages are re-rendered when contents.pylon or the page source changes.
+    PageCache pageCache;
+    // Optional. If set, a gzip-compressed copy of each cached page is kept and served to clients
+    // that accept gzip encoding.
+    Functor<String(StringView)> gzip;
+    // If init() was asked to watch for changes, the watcher reloads contents.pylon when it changes
+    // and invalidates pageCache when anything else changes, so neither contents.pylon nor the page
+    // sources are checked for changes on every request.
+    Owned<DirectoryWatcher> watcher;
+
+    void init(StringView dataRoot, bool watchForChanges = false);
     void reloadContents();
+    void reloadContentsIfChanged();
     void serve(StringView requestPath, ResponseIface* responseIface);
     void serveContentOnly(StringView requestPath, ResponseIface* responseIface);
+    void serveCacheStats(ResponseIface* responseIface);
 };
 
+// Returns true if an Accept-Encoding header value accepts gzip, taking q-values into account.
+bool acceptsGzip(StringView acceptEncoding);
+
 } // namespace web
 } // namespace ply
@@ -0,0 +1,138 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-web-serve-docs/Core.h>
+#include <ply-web-serve-docs/PageCache.h>
+
+namespace ply {
+namespace web {
+
+PLY_NO_INLINE PageCache::PageCache(u64 byteBudget) {
+    this->stats.byteBudget = byteBudget;
+}
+
+PLY_NO_INLINE PageCache::~PageCache() {
+    this->invalidateAll();
+}
+
+void PageCache::unlink(CachedPage* page) {
+    if (page->prev) {
+        page->prev->next = page->next;
+    } else {
+        this->head = page->next;
+    }
+    if (page->next) {
+        page->next->prev = page->prev;
+    } else {
+        this->tail = page->prev;
+    }
+    page->prev = nullptr;
+    page->next = nullptr;
+}
+
+void PageCache::linkAtHead(CachedPage* page) {
+    page->prev = nullptr;
+    page->next = this->head;
+    if (this->head) {
+        this->head->prev = page;
+    } else {
+        this->tail = page;
+    }
+    this->head = page;
+}
+
+// Removes the page from the map and the LRU list, and drops the cache's reference to it.
+void PageCache::remove(CachedPage* page) {
+    auto cursor = this->pathToPage.find(page->path);
+    PLY_ASSERT(cursor.wasFound() && *cursor == page);
+    cursor.erase();
+    this->unlink(page);
+    this->stats.numPages--;
+    this->stats.numBytes -= page->getNumBytes();
+    page->decRef();
+}
+
+void PageCache::evictToBudget() {
+    while (this->tail && this->stats.numBytes > this->stats.byteBudget) {
+        this->remove(this->tail);
+        this->stats.numEvictions++;
+    }
+}
+
+PLY_NO_INLINE Reference<CachedPage> PageCache::find(StringView path, double contentsModTime,
+                                                    double sourceModTime) {
+    LockGuard<Mutex> guard{this->mutex};
+    auto cursor = this->pathToPage.find(path);
+    if (!cursor.wasFound()) {
+        this->stats.numMisses++;
+        return nullptr;
+    }
+    CachedPage* page = *cursor;
+    if (page->contentsModTime != contentsModTime || page->sourceModTime != sourceModTime) {
+        // Stale
+        this->remove(page);
+        this->stats.numInvalidations++;
+        this->stats.numMisses++;
+        return nullptr;
+    }
+    if (page != this->head) {
+        this->unlink(page);
+        this->linkAtHead(page);
+    }
+    this->stats.numHits++;
+    return page;
+}
+
+PLY_NO_INLINE u64 PageCache::getGeneration() const {
+    LockGuard<Mutex> guard{this->mutex};
+    return this->generation;
+}
+
+PLY_NO_INLINE void PageCache::insert(CachedPage* page) {
+    PLY_ASSERT(!page->prev && !page->next);
+    u64 numBytes = page->getNumBytes();
+    threadFenceRelease(); // The page's contents must be visible to threads that find it
+    LockGuard<Mutex> guard{this->mutex};
+    if (page->generation != this->generation) {
+        // invalidateAll() was called while the page was being rendered
+        this->stats.numInvalidations++;
+        return;
+    }
+    auto cursor = this->pathToPage.find(page->path);
+    if (cursor.wasFound()) {
+        this->remove(*cursor);
+    }
+    if (numBytes > this->stats.byteBudget)
+        return;
+
+    page->incRef();
+    *this->pathToPage.insertOrFind(page->path) = page;
+    this->linkAtHead(page);
+    this->stats.numPages++;
+    this->stats.numBytes += numBytes;
+    this->evictToBudget();
+}
+
+PLY_NO_INLINE void PageCache::invalidateAll() {
+    LockGuard<Mutex> guard{this->mutex};
+    this->generation++;
+    while (this->head) {
+        this->remove(this->head);
+        this->stats.numInvalidations++;
+    }
+}
+
+PLY_NO_INLINE void PageCache::setByteBudget(u64 byteBudget) {
+    LockGuard<Mutex> guard{this->mutex};
+    this->stats.byteBudget = byteBudget;
+    this->evictToBudget();
+}
+
+PLY_NO_INLINE PageCache::Stats PageCache::getStats() const {
+    LockGuard<Mutex> guard{this->mutex};
+    return this->stats;
+}
+
+} // namespace web
+} // namespace ply
@@ -0,0 +1,99 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#pragma once
+#include <ply-web-serve-docs/Core.h>
+#include <ply-runtime/container/Reference.h>
+
+namespace ply {
+namespace web {
+
+// A fully rendered response body. Pages are immutable once inserted into a PageCache, and they're
+// reference counted so that a page can be sent while another thread evicts it.
+struct CachedPage : RefCounted<CachedPage> {
+    String path;
+    double contentsModTime = 0; // Modification time of contents.pylon when the page was rendered
+    double sourceModTime = 0;   // Modification time of the page source when the page was rendered
+    u64 generation = 0;         // PageCache::getGeneration() before the page was rendered
+    String body;
+    String gzipBody; // Empty if no gzip copy was made
+
+    // Links in the PageCache's LRU list, protected by PageCache::mutex
+    CachedPage* prev = nullptr;
+    CachedPage* next = nullptr;
+
+    PLY_INLINE u64 getNumBytes() const {
+        return u64(this->body.numBytes) + this->gzipBody.numBytes;
+    }
+    PLY_INLINE void onRefCountZero() {
+        threadFenceAcquire();
+        delete this;
+    }
+};
+
+//-----------------------------------------------------------------------
+// PageCache
+//
+// A thread-safe LRU cache of rendered pages keyed on request path. A lookup only hits if the page
+// was rendered with the same contents.pylon and page source modification times that the caller
+// passes in, so stale pages are never served. The total size of cached pages is kept within
+// byteBudget by evicting the least recently used pages.
+//-----------------------------------------------------------------------
+class PageCache {
+public:
+    struct Stats {
+        u64 numHits = 0;
+        u64 numMisses = 0;
+        u64 numEvictions = 0;
+        u64 numInvalidations = 0;
+        u32 numPages = 0;
+        u64 numBytes = 0;
+        u64 byteBudget = 0;
+    };
+
+private:
+    struct Traits {
+        using Key = StringView;
+        using Item = CachedPage*;
+        static PLY_INLINE bool match(const Item& item, Key key) {
+            return item->path == key;
+        }
+    };
+
+    mutable Mutex mutex;
+    HashMap<Traits> pathToPage;
+    CachedPage* head = nullptr; // Most recently used
+    CachedPage* tail = nullptr; // Least recently used
+    u64 generation = 0;         // Incremented by invalidateAll()
+    Stats stats;
+
+    void unlink(CachedPage* page);
+    void linkAtHead(CachedPage* page);
+    void remove(CachedPage* page);
+    void evictToBudget();
+
+public:
+    PLY_DLL_ENTRY PageCache(u64 byteBudget = 64 * 1024 * 1024);
+    PLY_DLL_ENTRY ~PageCache();
+
+    // Returns the cached page for path if it was rendered with the given modification times, or
+    // null. Counts a hit or a miss.
+    PLY_DLL_ENTRY Reference<CachedPage> find(StringView path, double contentsModTime,
+                                             double sourceModTime);
+
+    // Call this before rendering a page, and store the result in the page's generation member
+    PLY_DLL_ENTRY u64 getGeneration() const;
+
+    // Inserts a page, replacing any existing page with the same path. Pages that don't fit within
+    // the byte budget by themselves aren't cached. Neither are pages that were rendered before the
+    // last call to invalidateAll(), since they may be stale.
+    PLY_DLL_ENTRY void insert(CachedPage* page);
+
+    PLY_DLL_ENTRY void invalidateAll();
+    PLY_DLL_ENTRY void setByteBudget(u64 byteBudget);
+    PLY_DLL_ENTRY Stats getStats() const;
+};
+
+} // namespace web
+} // namespace ply
@@ -0,0 +1,115 @@
+/*------------------------------------
+  ///\  Plywood C++ Framework
+  \\\/  https://plywood.arc80.com/
+------------------------------------*/
+#include <ply-web-serve-docs/DocServer.h>
+#include <ply-web-serve-docs/PageCache.h>
+#include <ply-test/TestSuite.h>
+
+namespace ply {
+namespace tests {
+
+#define PLY_TEST_CASE_PREFIX PageCache_
+
+using web::CachedPage;
+using web::PageCache;
+
+// Returns a page of numBytes bytes rendered with the given modification times
+Reference<CachedPage> makePage(PageCache* cache, StringView path, u32 numBytes,
+                               double sourceModTime = 1) {
+    Reference<CachedPage> page = new CachedPage;
+    page->path = path;
+    page->contentsModTime = 1;
+    page->sourceModTime = sourceModTime;
+    page->generation = cache->getGeneration();
+    page->body = StringView{"x"} * numBytes;
+    return page;
+}
+
+PLY_TEST_CASE("PageCache hits only when modification times match") {
+    PageCache cache;
+    PLY_TEST_CHECK(!cache.find("/a", 1, 1));
+    Reference<CachedPage> page = makePage(&cache, "/a", 100);
+    cache.insert(page);
+    PLY_TEST_CHECK(cache.find("/a", 1, 1) == page);
+    PLY_TEST_CHECK(!cache.find("/b", 1, 1));
+
+    // A page rendered from an older source is removed
+    PLY_TEST_CHECK(!cache.find("/a", 1, 2));
+    PLY_TEST_CHECK(!cache.find("/a", 1, 1));
+
+    PageCache::Stats stats = cache.getStats();
+    PLY_TEST_CHECK(stats.numHits == 1);
+    PLY_TEST_CHECK(stats.numMisses == 4);
+    PLY_TEST_CHECK(stats.numInvalidations == 1);
+    PLY_TEST_CHECK(stats.numPages == 0);
+    PLY_TEST_CHECK(stats.numBytes == 0);
+}
+
+PLY_TEST_CASE("PageCache evicts the least recently used pages") {
+    PageCache cache{250};
+    cache.insert(makePage(&cache, "/a", 100));
+    cache.insert(makePage(&cache, "/b", 100));
+    PLY_TEST_CHECK(cache.find("/a", 1, 1)); // Now /b is the least recently used
+    cache.insert(makePage(&cache, "/c", 100));
+    PLY_TEST_CHECK(cache.find("/a", 1, 1));
+    PLY_TEST_CHECK(!cache.find("/b", 1, 1));
+    PLY_TEST_CHECK(cache.find("/c", 1, 1));
+    PageCache::Stats stats = cache.getStats();
+    PLY_TEST_CHECK(stats.numEvictions == 1);
+    PLY_TEST_CHECK(stats.numPages == 2);
+    PLY_TEST_CHECK(stats.numBytes == 200);
+
+    // Replacing a page doesn't count its old size
+    cache.insert(makePage(&cache, "/a", 50));
+    PLY_TEST_CHECK(cache.getStats().numBytes == 150);
+
+    // Pages that don't fit by themselves aren't cached
+    cache.insert(makePage(&cache, "/d", 300));
+    PLY_TEST_CHECK(!cache.find("/d", 1, 1));
+    PLY_TEST_CHECK(cache.getStats().numPages == 2);
+
+    cache.setByteBudget(100);
+    PLY_TEST_CHECK(cache.getStats().numPages == 1);
+    PLY_TEST_CHECK(cache.find("/a", 1, 1));
+}
+
+PLY_TEST_CASE("PageCache drops pages rendered before invalidateAll") {
+    PageCache cache;
+    cache.insert(makePage(&cache, "/a", 100));
+    Reference<CachedPage> rendering = makePage(&cache, "/b", 100);
+    cache.invalidateAll();
+    PLY_TEST_CHECK(!cache.find("/a", 1, 1));
+    cache.insert(rendering);
+    PLY_TEST_CHECK(!cache.find("/b", 1, 1));
+    cache.insert(makePage(&cache, "/b", 100));
+    PLY_TEST_CHECK(cache.find("/b", 1, 1));
+}
+
+PLY_TEST_CASE("Pages found in a PageCache outlive their eviction") {
+    PageCache cache{100};
+    cache.insert(makePage(&cache, "/a", 100));
+    Reference<CachedPage> page = cache.find("/a", 1, 1);
+    cache.insert(makePage(&cache, "/b", 100));
+    PLY_TEST_CHECK(!cache.find("/a", 1, 1));
+    PLY_TEST_CHECK(page->body.numBytes == 100);
+}
+
+PLY_TEST_CASE("acceptsGzip") {
+    PLY_TEST_CHECK(web::acceptsGzip("gzip"));
+    PLY_TEST_CHECK(web::acceptsGzip("deflate, gzip;q=1.0, *;q=0.5"));
+    PLY_TEST_CHECK(web::acceptsGzip("gzip; q=0.001"));
+    PLY_TEST_CHECK(web::acceptsGzip("br, *"));
+    PLY_TEST_CHECK(!web::acceptsGzip(""));
+    PLY_TEST_CHECK(!web::acceptsGzip("deflate, br"));
+    PLY_TEST_CHECK(!web::acceptsGzip("gzip;q=0"));
+    PLY_TEST_CHECK(!web::acceptsGzip("gzip; q=0.000"));
+    PLY_TEST_CHECK(!web::acceptsGzip("br, *;q=0"));
+    // An explicit gzip entry overrides *, whichever comes first
+    PLY_TEST_CHECK(!web::acceptsGzip("*, gzip;q=0"));
+    PLY_TEST_CHECK(!web::acceptsGzip("gzip;q=0, *"));
+    PLY_TEST_CHECK(web::acceptsGzip("*;q=0, gzip"));
+}
+
+} // namespace tests
+} // namespace ply
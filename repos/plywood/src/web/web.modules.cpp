@@ -27,6 +27,14 @@ void module_webCommon(ModuleArgs* args) {
     args->addTarget(Visibility::Public, "runtime");
 }
 
+// [ply module="web-common-tests"]
+void module_webCommonTests(ModuleArgs* args) {
+    args->buildTarget->targetType = BuildTargetType::ObjectLib;
+    args->addSourceFiles("common/tests");
+    args->addTarget(Visibility::Private, "web-common");
+    args->addTarget(Visibility::Private, "test");
+}
+
 // [ply module="web-documentation"]
 void module_webDocumentation(ModuleArgs* args) {
     args->addIncludeDir(Visibility::Public, "documentation");
@@ -69,6 +77,16 @@ void module_webServeDocs(ModuleArgs* args) {
     args->addTarget(Visibility::Private, "web-common"); // for ResponseIface
 }
 
+// [ply module="web-serve-docs-tests"]
+void module_webServeDocsTests(ModuleArgs* args) {
+    args->buildTarget->targetType = BuildTargetType::ObjectLib;
+    args->addSourceFiles("serve-docs/tests");
+    args->addTarget(Visibility::Private, "web-serve-docs");
+    args->addTarget(Visibility::Private, "web-common");
+    args->addTarget(Visibility::Private, "web-documentation");
+    args->addTarget(Visibility::Private, "test");
+}
+
 // [ply extern="libsass" provider="macports"]
 ExternResult extern_libsass_macports(ExternCommand cmd, ExternProviderArgs* args) {
     PackageProvider prov{PackageProvider::MacPorts, "libsass", [&](StringView prefix) {